@@ -156,7 +156,10 @@ public:
   std::shared_ptr<LanguageService> GetLanguageService(uint32_t key);
 
   /** dispatch call, by language ID */
-  void CallLanguage(uint32_t language_key, BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call);
+  void CallLanguage(uint32_t language_key, BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call, MessageUtilities::ArrayBlockHandler *handler = 0);
+
+  /** dispatch a call batch, by language ID. see LanguageService::CallBatch */
+  void CallLanguageBatch(uint32_t language_key, BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call);
 
   /** update (rebuild) function list; this must be done on the main thread */
   int UpdateFunctions();
@@ -26,6 +26,8 @@
 #include <vector>
 #include <string>
 #include <regex>
+#include <atomic>
+#include <unordered_map>
 
 #include "windows_api_functions.h"
 #include "process_exit_codes.h"
@@ -35,6 +37,12 @@
 
 #define PIPE_BUFFER_SIZE (1024*8)
 
+// block size (elements) we request for streamed results
+#define STREAM_BLOCK_SIZE (64*1024)
+
+// shared memory ring size, per direction, in MB (configurable)
+#define DEFAULT_SHARED_MEMORY_SIZE_MB (DEFAULT_SHARED_RING_SIZE / (1024 * 1024))
+
 /**
  * class abstracts common language service features
  */
@@ -42,13 +50,46 @@ class LanguageService {
 
 private:
 
-  /** ID generator */
-  static uint32_t transaction_id_;
+  /** ID generator. shared by all services, and calls can come from any thread. */
+  static std::atomic<uint32_t> transaction_id_;
 
 protected:
 
-  /** get next id */
-  static uint32_t transaction_id() { return transaction_id_++; }
+  /** get next id. we don't use 0, so skip it if we roll over. */
+  static uint32_t transaction_id() { 
+    uint32_t id = transaction_id_.fetch_add(1);
+    return id ? id : transaction_id_.fetch_add(1);
+  }
+
+  /**
+   * outstanding request. responses are matched to transactions by id, so 
+   * there can be any number of these on the pipe at once. the transaction
+   * lives on the caller's stack; the event is signaled when it's complete
+   * (or when the caller should take over reading, see Call()).
+   */
+  struct Transaction {
+    uint32_t id;
+    BERTBuffers::CallResponse *response;
+    MessageUtilities::ArrayBlockHandler *handler;
+    HANDLE event;
+    bool complete;
+
+    /** streamed results: after the header, blocks go to the handler (or get appended) */
+    bool streaming;
+    int stream_offset;
+    int stream_length;
+
+    /**
+     * callbacks raised by this call, handed over by another thread (see 
+     * RouteCallback): one from the pipe (we own the message), or one the 
+     * callback thread is holding. guarded by transaction_lock_.
+     */
+    BERTBuffers::CallResponse *callback;
+    bool callback_signaled;
+
+    /** thread that made the call (and has to run its callbacks) */
+    DWORD thread_id;
+  };
 
   /** FIXME: unify threads, move to BERT */
   static unsigned __stdcall CallbackThreadFunction(void *param) {
@@ -81,9 +122,12 @@ protected:
   /** name for ui/reference */
   std::string language_name_;
 
-  /** overlapped structure for nonblocking io */
+  /** overlapped structure for nonblocking io (reads) */
   OVERLAPPED io_;
 
+  /** overlapped structure for writes, guarded by write_lock_ */
+  OVERLAPPED write_io_;
+
   /** child process */
   DWORD child_process_id_;
     
@@ -93,8 +137,82 @@ protected:
   /** flag */
   bool configured_;
 
-  /** read/write buffer */
+  /** 
+   * flag: the control process understands packed arrays. if not, we unpack
+   * before sending. set in Initialize().
+   */
+  bool packed_arrays_;
+
+  /**
+   * compress messages at least this large (serialized bytes), or 0 for no
+   * compression. read from config, and reset to 0 in Initialize() if the
+   * control process doesn't support it.
+   */
+  uint32_t compression_threshold_;
+
+  /** flag: the control process supports call batches. set in Initialize(). */
+  bool call_batch_;
+
+  /**
+   * shared memory rings for large messages: calls go out via call_ring_, 
+   * responses come back via response_ring_. we create them; they're only 
+   * valid if the control process opened them in Initialize(). size is from
+   * config (0 to disable).
+   */
+  SharedRing call_ring_;
+  SharedRing response_ring_;
+  uint64_t shared_memory_size_;
+
+  /**
+   * flag: the control process can queue requests and respond by id, so we
+   * can have more than one transaction outstanding. if not, calls are 
+   * serialized (call_lock_). set in Initialize().
+   */
+  bool pipelined_;
+
+  /** read buffer. only used by the reader. */
   char *buffer_;
+
+  /** 
+   * framing buffer for writes, reused across calls. this is safe because 
+   * we hold the write lock until the write completes.
+   */
+  std::string write_buffer_;
+
+  /** decoder for reads on the main pipe. only used by the reader. */
+  FrameDecoder decoder_;
+
+  /** scratch message for the reader */
+  BERTBuffers::CallResponse read_message_;
+
+  /** outstanding transactions by id. guarded by transaction_lock_. */
+  std::unordered_map<uint32_t, Transaction*> transactions_;
+
+  /** completion events, reused. guarded by transaction_lock_. */
+  std::vector<HANDLE> event_pool_;
+
+  /**
+   * flags: some thread is acting as the reader; there's a read outstanding
+   * on the pipe (which may have been started by a different thread). 
+   * guarded by transaction_lock_.
+   */
+  bool reading_;
+  bool read_pending_;
+
+  /** count of threads waiting on transactions. guarded by transaction_lock_. */
+  int waiting_;
+
+  /** guards transaction state */
+  CRITICAL_SECTION transaction_lock_;
+
+  /** serializes writes (write buffer, write io and the call ring) */
+  CRITICAL_SECTION write_lock_;
+
+  /** serializes calls if the control process doesn't support pipelining */
+  CRITICAL_SECTION call_lock_;
+
+  /** ensures only one waiting thread handles a callback signal */
+  CRITICAL_SECTION callback_lock_;
     
   /** path to executable */
   std::string child_path_;
@@ -127,7 +245,7 @@ public:
   LanguageService(CallbackInfo &callback_info, COMObjectMap &object_map, DWORD dev_flags, const json11::Json &config, const std::string &home_directory, const LanguageDescriptor &descriptor);
 
   /** preferentially use the shutdown method instead of destructor */
-  ~LanguageService() {}
+  ~LanguageService();
 
 public:
 
@@ -142,6 +260,8 @@ public:
 
   bool connected() { return connected_; }
 
+  bool packed_arrays() { return packed_arrays_; }
+
   /** accessor */
   std::string prefix() { return language_prefix_;  }
 
@@ -156,6 +276,65 @@ protected:
   /** abstracts process launch (we use common properties) */
   int LaunchProcess(HANDLE job_handle, char *command_line);
 
+  /** frame and write a message. thread-safe. returns false on pipe error. */
+  bool WriteMessage(BERTBuffers::CallResponse &message);
+
+  /**
+   * wait for a transaction to complete. one waiting thread at a time reads
+   * the pipe and dispatches responses to whichever transaction they belong
+   * to; the others wait on their events. callbacks are run by the thread
+   * that made the call they came from (see RouteCallback).
+   */
+  void WaitTransaction(Transaction &transaction);
+
+  /**
+   * read and dispatch until the transaction is complete, or we have to 
+   * stop reading (callback or error). call with the reader flag set; this
+   * clears it before returning.
+   */
+  void ReadTransactions(Transaction &transaction);
+
+  /** 
+   * route a response (or stream block) to its transaction. returns false if
+   * there's no matching transaction.
+   */
+  bool DispatchResponse(BERTBuffers::CallResponse &message);
+
+  /** complete a transaction. call with transaction lock held. */
+  void CompleteTransaction(Transaction *transaction);
+
+  /** fail all outstanding transactions (on pipe or parse errors) */
+  void FailTransactions(const std::string &message);
+
+  /** clear the reader flag, and wake another waiting thread to take over */
+  void ReleaseReader();
+
+  /**
+   * find the thread that should run a callback. the control process tags
+   * callbacks with the id of the call they were made from, and the callback
+   * may do excel or COM work that has to happen on that call's thread (a 
+   * UDF's callback on excel's thread, not on a console or file-watcher 
+   * thread that happens to be waiting at the same time).
+   *
+   * returns the owning transaction if it's waiting on another thread, or 0
+   * if it's ours to run: it's our call, or it isn't from any waiting call
+   * (console code), which any thread can run. call with transaction lock 
+   * held.
+   */
+  Transaction* RouteCallback(uint32_t id, const Transaction &transaction);
+
+  /** run a callback that came in on the main pipe, and write the response */
+  void RunCallback(BERTBuffers::CallResponse &callback);
+
+  /** run the callback the callback thread is holding, and release it */
+  void RunSignaledCallback();
+
+  /** 
+   * take a callback signaled by the callback thread, if nobody else has, 
+   * and run it or hand it to the thread that owns it.
+   */
+  void HandleSignaledCallback(Transaction &transaction);
+
 public:
 
   /**
@@ -217,8 +396,22 @@ public:
    * to assign an ID for transaction management.
    *
    * function call is based on class fields only, so the default should be generally usable.
+   *
+   * if the result is streamed and there's a handler, blocks are passed to the handler
+   * and the response only has the (streamed) header. otherwise we reassemble the array.
+   *
+   * this is thread-safe. calls from different threads share the pipe and 
+   * don't wait for each other (if the control process supports pipelining).
+   */
+  void Call(BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call, MessageUtilities::ArrayBlockHandler *handler = 0);
+
+  /**
+   * make a batch of function calls in one transaction. call has a call_batch
+   * with the calls (which are consumed); the response has a call_batch with 
+   * one result per call. if the control process doesn't support batches, 
+   * we make the calls one at a time and return the same response.
    */
-  void Call(BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call);
+  void CallBatch(BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call);
 
   /**
    * replace tokens in string. FIXME: make more generic
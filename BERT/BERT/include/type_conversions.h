@@ -19,6 +19,15 @@
 
 #pragma once
 
+#include "message_utilities.h"
+#include "transcode.h"
+#include "xloper_arena.h"
+#include "xloper_scanner.h"
+#include "work_pool.h"
+#include "array_conversion.h"
+#include "variant_fill.h"
+#include "xloper_fill.h"
+
 /**
  * conversion utilities. converting between Excel/COM/PB types.
  *
@@ -36,25 +45,9 @@ public:
    * FIXME: this is a string function, move to string utilities.
    */
   static std::string WideStringToUtf8(const WCHAR *source, int len) {
-
-    // FIXME: static buffer -- not thread safe. lock, use TLS 
-    // storage, or allocate on each call
-
-    static char *buffer = 0;
-    static int buffer_length = 0;
-
-    int u8_length = WideCharToMultiByte(CP_UTF8, 0, source, len, 0, 0, 0, 0);
-
-    if (buffer_length < u8_length) {
-      if (buffer) delete buffer;
-      buffer_length = ((u8_length / 1024) + 1) * 1024;
-      buffer = new char[buffer_length];
-    }
-
-    WideCharToMultiByte(CP_UTF8, 0, source, len, buffer, buffer_length, 0, 0);
-    std::string u8(buffer, u8_length);
+    std::string u8;
+    Transcode::Utf16ToUtf8(source, len, u8);
     return u8;
-
   }
 
   /** excel -> std::string */
@@ -62,25 +55,34 @@ public:
     return WideStringToUtf8(&(x->val.str[1]), x->val.str[0]);
   }
 
-  /** std::string -> excel */
-  static void StringToXLOPER(LPXLOPER12 target, const std::string &source, bool flag_dll_free = true) {
+  /** 
+   * excel -> std::string, replacing contents. use this to write directly 
+   * into a message field, or to reuse a string.
+   */
+  static void XLOPERToString(LPXLOPER12 x, std::string &target) {
+    Transcode::Utf16ToUtf8(&(x->val.str[1]), x->val.str[0], target);
+  }
 
-    // FIXME: use a static (heap) buffer, and stop deleting it in the autofree routine
+  /** 
+   * std::string -> excel. excel strings are limited to 32767 characters,
+   * longer strings are truncated.
+   */
+  static void StringToXLOPER(LPXLOPER12 target, const std::string &source, bool flag_dll_free = true) {
 
-        // FIXME: absolutely not. there might be multiple allocated xlopers in flight at 
-        // the same time. if you want more efficiency, think about using a slab allocator.
+    // UTF-16 is never longer (in units) than UTF-8 (in bytes), so we can 
+    // allocate once and convert in place. plus one for the length prefix.
 
-    int wide_char_count = MultiByteToWideChar(CP_UTF8, 0, source.c_str(), -1, 0, 0);
+    size_t bound = Transcode::Utf16Bound(source.length());
+    WCHAR *wide_string = new WCHAR[bound + 1];
 
-    // plus one for length. excel doesn't use the zero terminator, but when we call 
-    // MBTWC again (below), it will expect space for it.
-    WCHAR *wide_string = new WCHAR[wide_char_count + 1];
+    size_t length = Transcode::Utf8ToUtf16(source.c_str(), source.length(), wide_string + 1);
+    if (length > 32767) {
+      length = 32767;
+      if (wide_string[length] >= 0xD800 && wide_string[length] <= 0xDBFF) length--; // don't split a pair
+    }
 
     // set length in WCHAR[0]
-    wide_string[0] = wide_char_count - 1;
-
-    // copy string starting at WCHAR[1]
-    if (wide_char_count > 0) MultiByteToWideChar(CP_UTF8, 0, source.c_str(), -1, wide_string + 1, wide_char_count);
+    wide_string[0] = (WCHAR)length;
 
     target->xltype = xltypeStr;
     if (flag_dll_free) target->xltype |= xlbitDLLFree;
@@ -103,11 +105,8 @@ public:
       variable->set_boolean(variant.boolVal);
       break;
     case VT_BSTR:
-    {
-      CComBSTR string_value(variant.bstrVal);
-      variable->set_str(WideStringToUtf8(string_value.m_str, string_value.Length()));
+      Transcode::Utf16ToUtf8(variant.bstrVal, SysStringLen(variant.bstrVal), *variable->mutable_str());
       break;
-    }
 
     case VT_ERROR:
       if (variant.scode == DISP_E_PARAMNOTFOUND) {
@@ -177,14 +176,17 @@ public:
     void *data_pointer;
     SafeArrayAccessData(variant.parray, &data_pointer);
 
+    MessageUtilities::ArraySummaryBuilder summary;
+
     switch (vartype) {
     case VT_BSTR:
     {
       BSTR *pv = reinterpret_cast<BSTR*>(data_pointer);
       for (int i = 0; i < length; i++)
       {
-        CComBSTR bstr(pv[i]);
-        array_data->add_data()->set_str(WideStringToUtf8(bstr.m_str, bstr.Length()));
+        std::string *str = array_data->add_data()->mutable_str();
+        Transcode::Utf16ToUtf8(pv[i], SysStringLen(pv[i]), *str);
+        summary.AddString(str->length());
       }
       break;
     }
@@ -197,6 +199,7 @@ public:
       {
         array_data->add_data()->set_integer(pv[i]);
       }
+      summary.AddType(MessageUtilities::TypeFlags::integer, length);
       break;
     }
     case VT_R4:
@@ -207,6 +210,7 @@ public:
       {
         array_data->add_data()->set_real(pv[i]);
       }
+      summary.AddType(MessageUtilities::TypeFlags::real, length);
       break;
     }
     case VT_BOOL:
@@ -216,6 +220,7 @@ public:
       {
         array_data->add_data()->set_boolean(pv[i]);
       }
+      summary.AddType(MessageUtilities::TypeFlags::logical, length);
       break;
     }
     case VT_VARIANT:
@@ -223,7 +228,9 @@ public:
       VARIANT *pv = reinterpret_cast<VARIANT*>(data_pointer);
       for (int i = 0; i < length; i++)
       {
-        VariantToVariable(array_data->add_data(), pv[i]);
+        auto element = array_data->add_data();
+        VariantToVariable(element, pv[i]);
+        summary.Add(*element);
       }
       break;
     }
@@ -232,9 +239,36 @@ public:
     }
     
     SafeArrayUnaccessData(variant.parray);
+    summary.Set(array_data);
     
   }
 
+  /** 
+   * element setters for filling safearrays in place (see VariantArrayFill).
+   * elements start out empty, so there's nothing to clear.
+   */
+  struct VariantTraits {
+
+    typedef VARIANT Element;
+
+    static void SetReal(VARIANT *v, double value) { v->vt = VT_R8; v->dblVal = value; }
+    static void SetInteger(VARIANT *v, int32_t value) { v->vt = VT_I4; v->lVal = value; }
+    static void SetBoolean(VARIANT *v, bool value) { v->vt = VT_BOOL; v->boolVal = value ? VARIANT_TRUE : VARIANT_FALSE; }
+    static void SetNull(VARIANT *v) { v->vt = VT_NULL; }
+    static void SetMissing(VARIANT *v) { v->vt = VT_ERROR; v->scode = DISP_E_PARAMNOTFOUND; }
+
+    static void SetString(VARIANT *v, const uint16_t *str, size_t length) {
+      v->vt = VT_BSTR;
+      v->bstrVal = SysAllocStringLen(reinterpret_cast<const OLECHAR*>(str), static_cast<UINT>(length));
+    }
+
+    /** anything else (nested arrays, errors) goes through the general case */
+    static void SetVariable(VARIANT *v, const BERTBuffers::Variable &var) {
+      VariableToVariant(var).Detach(v);
+    }
+
+  };
+
   /** pb -> com */
   static CComVariant VariableToVariant(const BERTBuffers::Variable &var) {
 
@@ -267,14 +301,15 @@ public:
       break;
     case BERTBuffers::Variable::ValueCase::kArr:
     {
-      auto arr = var.arr();
+      const auto &arr = var.arr();
+
       int rows = arr.rows();
       int cols = arr.cols();
-      int length = arr.data_size();
+      int length = MessageUtilities::ArrayLength(arr);
 
       // ensure there's data. if not, treat as missing.
 
-      if (arr.data_size() == 0) {
+      if (length == 0) {
         variant.vt = VT_ERROR;
         variant.scode = DISP_E_PARAMNOTFOUND;
       }
@@ -316,49 +351,24 @@ public:
 
         CComSafeArray<VARIANT> variant_array(array_bounds, 2);
 
-        int32_t index = 0;
-        LONG indexes[2]; // is this type architecture-dependent? otherwise it should be === int32_t, no?
-
-        int c_offset = (row_names ? 1 : 0);
-        int r_offset = (col_names ? 1 : 0);
+        // fill the array data in place. safearray data is column-major
+        // (leftmost index varies fastest), same as ours.
 
-        /*
-        for (int col = 0; col < cols; col++) {
-          indexes[1] = col;
-          for (int row = 0; row < rows; row++) {
-            indexes[0] = row;
-            variant_array.MultiDimSetAt(indexes, VariableToVariant(arr.data(index++)));
-          }
+        VARIANT *grid = 0;
+        if (FAILED(SafeArrayAccessData(variant_array.m_psa, reinterpret_cast<void**>(&grid)))) {
+          variant.vt = VT_ERROR;
+          break;
         }
-        */
+        VariantArrayFill<VariantTraits>::Fill(grid, rows, cols, arr, row_names, col_names);
+        SafeArrayUnaccessData(variant_array.m_psa);
 
-        for (int c = 0; c < cols; c++) {
-          indexes[1] = c;
-          if (row_names && c == 0) {
-            if (col_names) //StringToXLOPER(&(x->val.array.lparray[0]), "");
-              variant_array.MultiDimSetAt(indexes, CComVariant(CComBSTR("")));
-            for (int r = r_offset; r < rows; r++) {
-              //StringToXLOPER(&(x->val.array.lparray[r * cols + c]), arr.rownames(r - r_offset));
-              variant_array.MultiDimSetAt(indexes, CComVariant(CComBSTR(arr.rownames(r - r_offset).c_str())));
-            }
-          }
-          else {
-            for (int r = 0; r < rows; r++) {
-              indexes[0] = r;
-              if (col_names && r == 0) {
-                //StringToXLOPER(&(x->val.array.lparray[r * cols + c]), arr.colnames(c - c_offset));
-                variant_array.MultiDimSetAt(indexes, CComVariant(CComBSTR(arr.colnames(c - c_offset).c_str())));
-              }
-              else {
-                //VariableToXLOPER(&(x->val.array.lparray[r * cols + c]), arr.data(index++));
-                variant_array.MultiDimSetAt(indexes, VariableToVariant(arr.data(index++)));
-              }
-            }
-          }
-        }
+        // hand over the array rather than copying it (CComVariant(CComSafeArray) 
+        // copies the whole thing)
 
-        return CComVariant(variant_array);
+        variant.vt = VT_ARRAY | VT_VARIANT;
+        variant.parray = variant_array.Detach();
       }
+      break;
     }
 
     case BERTBuffers::Variable::ValueCase::kErr:
@@ -369,6 +379,82 @@ public:
     return variant;
   }
 
+  /** 
+   * string space (in the arena) for the names and string values in an 
+   * array. packed strings are stored once per dictionary entry.
+   */
+  static size_t ArrayStringUnits(const BERTBuffers::Array &arr) {
+
+    size_t units = XLOPERArena::StringUnits(0); // corner
+    for (const auto &name : arr.rownames()) units += XLOPERArena::StringUnits(name.length());
+    for (const auto &name : arr.colnames()) units += XLOPERArena::StringUnits(name.length());
+
+    if (MessageUtilities::IsColumnar(arr)) {
+      for (const auto &column : arr.columns()) units += ArrayStringUnits(column);
+    }
+    else if (MessageUtilities::IsPacked(arr)) {
+      if (arr.packed_type() == MessageUtilities::TypeFlags::string) {
+        for (const auto &entry : arr.dictionary()) units += XLOPERArena::StringUnits(entry.length());
+      }
+    }
+    else {
+      for (const auto &element : arr.data()) {
+        if (element.value_case() == BERTBuffers::Variable::ValueCase::kStr) units += XLOPERArena::StringUnits(element.str().length());
+        else if (element.value_case() == BERTBuffers::Variable::ValueCase::kCpx) units += 64;
+      }
+    }
+
+    return units;
+  }
+
+  /** 
+   * excel array fill (see XLOPERArrayFill): anything that isn't a plain
+   * value goes through the general case.
+   */
+  struct XLOPERTraits {
+    static void SetVariable(LPXLOPER12 x, const BERTBuffers::Variable &var, XLOPERArena &arena) { ElementToXLOPER(x, var, arena); }
+  };
+
+  typedef XLOPERArrayFill<XLOPERTraits>::Sink XLOPERSink;
+
+  /** 
+   * unpacked array element -> excel, in an arena array. strings go in the
+   * arena. excel can't show nested arrays, so those are errors.
+   */
+  static LPXLOPER12 ElementToXLOPER(LPXLOPER12 x, const BERTBuffers::Variable &var, XLOPERArena &arena) {
+
+    switch (var.value_case()) {
+    case BERTBuffers::Variable::ValueCase::kStr:
+      arena.SetString(x, var.str());
+      break;
+
+    case BERTBuffers::Variable::ValueCase::kCpx:
+      arena.SetString(x, ComplexToString(var.cpx()));
+      break;
+
+    case BERTBuffers::Variable::ValueCase::kArr:
+      x->xltype = xltypeErr;
+      x->val.err = xlerrValue;
+      break;
+
+    default:
+      VariableToXLOPER(x, var);
+      break;
+    }
+
+    return x;
+  }
+
+  /** format complex value */
+  static std::string ComplexToString(const BERTBuffers::Complex &complex) {
+    std::stringstream ss;
+    ss << complex.r();
+    if (complex.i() >= 0) ss << "+";
+    ss << complex.i();
+    ss << "i"; // FIXME: customizable
+    return ss.str();
+  }
+
   /** pb -> excel */
   static LPXLOPER12 VariableToXLOPER(LPXLOPER12 x, const BERTBuffers::Variable &var) {
 
@@ -393,16 +479,8 @@ public:
       break;
 
     case BERTBuffers::Variable::ValueCase::kCpx:
-    {
-      std::stringstream ss;
-      auto complex = var.cpx();
-      ss << complex.r();
-      if (complex.i() >= 0) ss << "+";
-      ss << complex.i();
-      ss << "i"; // FIXME: customizable
-      StringToXLOPER(x, ss.str());
+      StringToXLOPER(x, ComplexToString(var.cpx()));
       break;
-    }
 
     case BERTBuffers::Variable::ValueCase::kArr:
     {
@@ -410,7 +488,7 @@ public:
       int rows = arr.rows();
       int cols = arr.cols();
       int count = rows * cols;
-      int len = arr.data_size();
+      int len = MessageUtilities::ArrayLength(arr);
 
       bool col_names = (cols && arr.colnames_size() == cols);
       bool row_names = (rows && arr.rownames_size() == rows);
@@ -432,34 +510,16 @@ public:
         if (col_names) rows++;
         if (row_names) cols++;
 
-        x->xltype = xltypeMulti | xlbitDLLFree;
-        x->val.array.columns = cols;
-        x->val.array.rows = rows;
-        x->val.array.lparray = new XLOPER12[rows * cols];
-
-        int c_offset = (row_names ? 1 : 0);
-        int r_offset = (col_names ? 1 : 0);
-
-        int index = 0;
-        for (int c = 0; c < cols; c++) {
-          if (row_names && c == 0) {
-            if (col_names) StringToXLOPER(&(x->val.array.lparray[0]), "");
-            for (int r = r_offset; r < rows; r++) {
-              StringToXLOPER(&(x->val.array.lparray[r * cols + c]), arr.rownames(r - r_offset));
-            }
-          }
-          else {
-            for (int r = 0; r < rows; r++) {
-              if (col_names && r == 0) {
-                StringToXLOPER(&(x->val.array.lparray[r * cols + c]), arr.colnames(c - c_offset));
-              }
-              else {
-                VariableToXLOPER(&(x->val.array.lparray[r * cols + c]), arr.data(index++));
-              }
-            }
-          }
+        // grid and strings in one block, freed in xlAutoFree12
+
+        XLOPERArena arena;
+        if (!arena.Allocate(x, rows, cols, ArrayStringUnits(arr))) {
+          std::cerr << "ERROR: array allocation failed" << std::endl;
+          return x;
         }
 
+        XLOPERArrayFill<XLOPERTraits>::Fill(arena, x->val.array.lparray, rows, cols, arr, row_names, col_names);
+
       }
       else {
         x->xltype = xltypeErr;
@@ -528,7 +588,7 @@ public:
   static BERTBuffers::Variable * XLOPERToVariable(BERTBuffers::Variable *var, LPXLOPER12 x) {
 
     if (x->xltype & xltypeStr) {
-      var->set_str(XLOPERToString(x));
+      XLOPERToString(x, *var->mutable_str());
     }
     else if (x->xltype & xltypeNum) {
       var->set_real(x->val.num);
@@ -556,11 +616,21 @@ public:
       arr->set_cols(cols);
       arr->set_rows(rows);
 
+      // single-type ranges go out as packed arrays (this is the common 
+      // case, and it's much cheaper than one Variable per cell), and tables
+      // with typed columns as columnar arrays.
+
+      if (XLOPERRangeScanner::Scan(arr, x, XLOPERToVariable)) return var;
+
+      // summarize as we go, so the other side doesn't have to scan
+
+      MessageUtilities::ArraySummaryBuilder summary;
       for (int c = 0; c < cols; c++) {
         for (int r = 0; r < rows; r++) {
-          XLOPERToVariable(arr->add_data(), &(x->val.array.lparray[r * cols + c]));
+          summary.Add(*XLOPERToVariable(arr->add_data(), &(x->val.array.lparray[r * cols + c])));
         }
       }
+      summary.Set(arr);
 
     }
     else if ((x->xltype & xltypeSRef) || (x->xltype & xltypeRef)) {
@@ -605,3 +675,127 @@ public:
   }
 
 };
+
+/**
+ * builds an excel array from a streamed result, converting blocks as they
+ * arrive (so we never hold the complete array message). layout is the same
+ * as Convert::VariableToXLOPER for arrays. pass to BERT::CallLanguage; if 
+ * the result was streamed, the target is complete when the call returns.
+ */
+class XLOPERArrayBuilder : public MessageUtilities::ArrayBlockHandler {
+
+protected:
+
+  /** target xloper; this is usually the static function result */
+  LPXLOPER12 target_;
+
+  /** data shape, not including names */
+  int rows_;
+
+  /** offsets for names */
+  int r_offset_;
+  int c_offset_;
+
+  /** 
+   * storage for the target array. we don't know string sizes up front, 
+   * so strings (other than names) go in overflow blocks. 
+   */
+  XLOPERArena arena_;
+
+public:
+  XLOPERArrayBuilder(LPXLOPER12 target) : target_(target), rows_(0), r_offset_(0), c_offset_(0) {}
+
+public:
+
+  virtual void Begin(const BERTBuffers::Array &header) {
+
+    int rows = header.rows();
+    int cols = header.cols();
+    int len = header.packed_length();
+
+    bool col_names = (cols && header.colnames_size() == cols);
+    bool row_names = (rows && header.rownames_size() == rows);
+
+    if (len > 0 && rows * cols == 0) {
+      cols = len;
+      rows = 1;
+    }
+    else if (len <= 0 || rows * cols > len) {
+      target_->xltype = xltypeErr;
+      target_->val.err = xlerrValue;
+      std::cerr << "ERROR: invalid count/length" << std::endl;
+      rows_ = 0;
+      return;
+    }
+
+    rows_ = rows;
+    r_offset_ = (col_names ? 1 : 0);
+    c_offset_ = (row_names ? 1 : 0);
+
+    rows += r_offset_;
+    cols += c_offset_;
+
+    // cells are empty (nil) until the data arrives
+
+    if (!arena_.Allocate(target_, rows, cols, Convert::ArrayStringUnits(header))) {
+      std::cerr << "ERROR: array allocation failed" << std::endl;
+      rows_ = 0;
+      return;
+    }
+
+    if (row_names) {
+      if (col_names) arena_.SetString(&(target_->val.array.lparray[0]), "", 0);
+      for (int r = r_offset_; r < rows; r++) {
+        arena_.SetString(&(target_->val.array.lparray[r * cols]), header.rownames(r - r_offset_));
+      }
+    }
+    if (col_names) {
+      for (int c = c_offset_; c < cols; c++) {
+        arena_.SetString(&(target_->val.array.lparray[c]), header.colnames(c - c_offset_));
+      }
+    }
+  }
+
+  virtual void Block(const BERTBuffers::Array &block, int offset) {
+
+    if (!rows_) return;
+
+    int cols = target_->val.array.columns;
+    int limit = rows_ * (cols - c_offset_);
+    int count = MessageUtilities::ArrayLength(block);
+
+    // elements are in column-major order; we are row-major, so convert the
+    // block in runs, one per (partial) column. each block has its own 
+    // dictionary.
+
+    if (offset + count > limit) count = limit - offset;
+
+    std::vector<const XCHAR*> dictionary;
+    Convert::XLOPERSink sink(arena_, dictionary);
+    if (block.packed_type() == MessageUtilities::TypeFlags::string) sink.Dictionary(block);
+
+    for (int i = 0; i < count; ) {
+      int r = (offset + i) % rows_;
+      int c = (offset + i) / rows_;
+      int run = (std::min)(count - i, rows_ - r);
+      sink.Target(&(target_->val.array.lparray[(r + r_offset_) * cols + c + c_offset_]), cols);
+      ArrayConversion::Run(sink, 0, block, i, run);
+      i += run;
+    }
+  }
+
+  virtual void End(bool success) {
+
+    if (success || !rows_) return;
+
+    // on error, drop the array and return an error value
+
+    XLOPERArena::Release(target_);
+
+    target_->xltype = xltypeErr;
+    target_->val.err = xlerrValue;
+    rows_ = 0;
+  }
+
+};
+
@@ -0,0 +1,181 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+
+#include "message_utilities.h"
+#include "array_conversion.h"
+#include "transcode.h"
+#include "work_pool.h"
+
+/**
+ * bulk fill for COM arrays (a SAFEARRAY of VARIANTs). instead of setting 
+ * one element at a time (MultiDimSetAt, with a temporary CComVariant per 
+ * cell), lock the array data and write the elements in place.
+ *
+ * SAFEARRAY data is column-major (the leftmost index varies fastest), the
+ * same order as our arrays, so each column of values is a contiguous run 
+ * of elements, converted with ArrayConversion. packed strings are 
+ * converted to UTF-16 once per dictionary entry, and only copied per cell.
+ *
+ * Traits supplies the element type and setters, so the fill and ordering
+ * logic doesn't depend on COM (see Convert::VariantTraits). it needs:
+ *
+ *   Element
+ *   SetReal(Element*, double), SetInteger(Element*, int32_t), 
+ *   SetBoolean(Element*, bool), SetNull(Element*), SetMissing(Element*),
+ *   SetString(Element*, const uint16_t*, size_t),
+ *   SetVariable(Element*, const BERTBuffers::Variable&) for anything else
+ *
+ * elements are assumed to be empty (new arrays are).
+ */
+template <class Traits> class VariantArrayFill {
+
+public:
+
+  typedef typename Traits::Element Element;
+
+protected:
+
+  /** UTF-16 dictionary strings, in one buffer */
+  struct Dictionary {
+    std::vector<uint16_t> units;
+    std::vector<size_t> offsets;
+
+    void Build(const BERTBuffers::Array &arr) {
+      size_t total = 0;
+      for (const auto &entry : arr.dictionary()) total += Transcode::Utf16Bound(entry.length());
+      units.resize(total + 1);
+      offsets.resize(arr.dictionary_size() + 1);
+      size_t offset = 0;
+      for (int i = 0; i < arr.dictionary_size(); i++) {
+        offsets[i] = offset;
+        offset += Transcode::Utf8ToUtf16(arr.dictionary(i).c_str(), arr.dictionary(i).length(), &(units[offset]));
+      }
+      offsets[arr.dictionary_size()] = offset;
+    }
+
+    void Set(Element *element, int entry) const {
+      Traits::SetString(element, &(units[offsets[entry]]), offsets[entry + 1] - offsets[entry]);
+    }
+  };
+
+  static void SetString(Element *element, const std::string &str, std::vector<uint16_t> &buffer) {
+    buffer.resize(Transcode::Utf16Bound(str.length()) + 1);
+    Traits::SetString(element, &(buffer[0]), Transcode::Utf8ToUtf16(str.c_str(), str.length(), &(buffer[0])));
+  }
+
+  /** array conversion sink for a contiguous run of elements */
+  class RunSink : public ArrayConversion::Sink<RunSink> {
+
+  protected:
+    Element *elements_;
+    const Dictionary *dictionary_;
+    std::vector<uint16_t> &buffer_;
+
+  public:
+    RunSink(Element *elements, const Dictionary *dictionary, std::vector<uint16_t> &buffer) 
+      : elements_(elements), dictionary_(dictionary), buffer_(buffer) {}
+
+    void Real(int out, double value) { Traits::SetReal(elements_ + out, value); }
+    void Integer(int out, int32_t value) { Traits::SetInteger(elements_ + out, value); }
+    void Logical(int out, bool value) { Traits::SetBoolean(elements_ + out, value); }
+    void String(int out, const std::string &str) { SetString(elements_ + out, str, buffer_); }
+    void Entry(int out, const BERTBuffers::Array &arr, int entry) { dictionary_->Set(elements_ + out, entry); }
+    void NA(int out) { Traits::SetNull(elements_ + out); }
+    void Missing(int out) { Traits::SetMissing(elements_ + out); }
+    void Other(int out, const BERTBuffers::Variable &var) { Traits::SetVariable(elements_ + out, var); }
+  };
+
+public:
+
+  /**
+   * fill a grid of rows x cols elements (column-major) from an array. rows
+   * and cols include names, if row_names or col_names are set; the values
+   * are the rest of the grid. assumes the array length has been checked.
+   *
+   * large arrays are filled in parallel, by blocks of columns. the traits 
+   * setters have to be thread safe for that.
+   */
+  static void Fill(Element *grid, int rows, int cols, const BERTBuffers::Array &arr, bool row_names, bool col_names) {
+    Fill(grid, rows, cols, arr, row_names, col_names, WorkPool::Instance());
+  }
+
+  /** fill using a particular pool (the default is the shared pool) */
+  static void Fill(Element *grid, int rows, int cols, const BERTBuffers::Array &arr, bool row_names, bool col_names, WorkPool &pool) {
+
+    int r_offset = (col_names ? 1 : 0);
+    int c_offset = (row_names ? 1 : 0);
+    int data_rows = rows - r_offset;
+    int data_cols = cols - c_offset;
+
+    std::vector<uint16_t> buffer;
+
+    if (row_names) {
+      if (col_names) SetString(grid, std::string(), buffer);
+      for (int r = 0; r < data_rows; r++) SetString(grid + r_offset + r, arr.rownames(r), buffer);
+    }
+    if (col_names) {
+      for (int c = 0; c < data_cols; c++) SetString(grid + (size_t)(c + c_offset) * rows, arr.colnames(c), buffer);
+    }
+
+    // dictionaries are converted up front, so the fill only copies them
+
+    bool columnar = MessageUtilities::IsColumnar(arr);
+
+    Dictionary dictionary;
+    std::vector<Dictionary> column_dictionaries;
+
+    if (columnar) {
+      column_dictionaries.resize(data_cols);
+      for (int c = 0; c < data_cols; c++) {
+        const auto &column = arr.columns(c);
+        if (column.packed_type() == MessageUtilities::TypeFlags::string) column_dictionaries[c].Build(column);
+      }
+    }
+    else if (arr.packed_type() == MessageUtilities::TypeFlags::string) dictionary.Build(arr);
+
+    auto fill_columns = [&](int begin, int end) {
+      std::vector<uint16_t> column_buffer;
+      for (int c = begin; c < end; c++) {
+        Element *elements = grid + (size_t)(c + c_offset) * rows + r_offset;
+        if (columnar) {
+          RunSink sink(elements, &(column_dictionaries[c]), column_buffer);
+          ArrayConversion::Run(sink, 0, arr.columns(c), 0, data_rows);
+        }
+        else {
+          RunSink sink(elements, &dictionary, column_buffer);
+          ArrayConversion::Run(sink, 0, arr, c * data_rows, data_rows);
+        }
+      }
+    };
+
+    if (data_rows * data_cols >= PARALLEL_CONVERSION_THRESHOLD) {
+      int block_columns = data_rows < PARALLEL_CONVERSION_BLOCK_SIZE ? PARALLEL_CONVERSION_BLOCK_SIZE / data_rows : 1;
+      pool.ParallelFor(data_cols, block_columns, fill_columns);
+    }
+    else fill_columns(0, data_cols);
+
+  }
+
+};
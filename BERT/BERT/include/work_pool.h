@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// array conversions with fewer elements than this run on the calling 
+// thread; below this the handoff costs more than it saves. this should be
+// at least the crossover bench_work_pool shows on a multi-core machine, 
+// and it's well past where the loop itself costs under 1% (~16K).
+#define PARALLEL_CONVERSION_THRESHOLD   (256 * 1024)
+
+// block size (elements) for parallel conversions. per-block cost is under
+// 1% from ~4K (bench_work_pool), and fill time is flat from 4K to 1M, so 
+// this is small enough for 8 blocks at the threshold. it's a multiple of 8 
+// so blocks of bitsets (NA, logicals) don't share bytes.
+#define PARALLEL_CONVERSION_BLOCK_SIZE  (32 * 1024)
+
+/**
+ * small work-stealing thread pool for bulk work (array conversions). the 
+ * only operation is a parallel loop: split a range into blocks, run them
+ * on the workers and the calling thread, and return when they're all done.
+ *
+ * each worker has its own queue; it takes work from the back of its queue
+ * and steals from the front of the others when it runs out. the calling 
+ * thread runs the first block itself, then helps with whatever is queued
+ * while it waits. loops started from a worker push to that worker's queue,
+ * so nested loops are fine.
+ *
+ * threads are started on first use. call Shutdown before unloading (we 
+ * can't join threads from static destructors in a DLL); after that, loops
+ * run on the calling thread.
+ *
+ * loop functions must not throw, and must not call excel.
+ */
+class WorkPool {
+
+public:
+
+  /** loop body, for elements [begin, end) */
+  typedef std::function<void(int begin, int end)> RangeFunction;
+
+protected:
+
+  struct Group;
+
+  struct Task {
+    Group *group;
+    int begin;
+    int end;
+  };
+
+  struct Queue {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  /** number of worker threads we will start */
+  int thread_count_;
+
+  /** queued tasks, for sleeping workers */
+  std::atomic<int> pending_;
+
+  /** submission order, for spreading tasks over queues */
+  std::atomic<uint32_t> next_queue_;
+
+  std::mutex lock_;
+  std::condition_variable wake_;
+  bool started_;
+  bool stopped_;
+
+  /** queue index for worker threads, -1 elsewhere */
+  static thread_local int worker_index_;
+
+protected:
+
+  /** start threads if necessary. returns false if there are no workers. */
+  bool Start();
+
+  /** take a task, from our queue if we have one, otherwise steal */
+  bool Take(int index, Task &task);
+
+  void Run(const Task &task);
+
+  void WorkerThread(int index);
+
+public:
+
+  /**
+   * run function over [0, count) in blocks of block_size elements (the 
+   * last one may be shorter). runs on the calling thread if there's only 
+   * one block.
+   */
+  void ParallelFor(int count, int block_size, const RangeFunction &function);
+
+  /** stop and join worker threads. don't call this while loops are running. */
+  void Shutdown();
+
+  /** threads that run loops, including the calling thread */
+  int concurrency() { return thread_count_ + 1; }
+
+  /** shared pool, sized for the machine */
+  static WorkPool& Instance();
+
+public:
+
+  /** threads < 0 means one per core, less the calling thread */
+  WorkPool(int threads = -1);
+  ~WorkPool();
+
+  WorkPool(const WorkPool&) = delete;
+  WorkPool& operator=(const WorkPool&) = delete;
+
+};
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "XLCALL.h"
+
+/**
+ * single-allocation storage for array results. the XLOPER12 grid and all
+ * the string bodies for an array are carved out of one block, so building
+ * a 50k-cell string result is one allocation instead of 50k, and freeing 
+ * it (when excel calls xlAutoFree12) is one operation instead of a walk 
+ * over the grid.
+ *
+ * the block header sits directly in front of the grid, so we can find it
+ * from the XLOPER (lparray) without any other bookkeeping. if the string 
+ * space runs out (we don't always know sizes up front, e.g. for streamed
+ * results) we chain overflow blocks; those are released with the array.
+ *
+ * arena arrays are always flagged xlbitDLLFree, and everything we build
+ * with that flag is an arena array (see resetXlOper). cells are plain 
+ * xltypeStr; they're owned by the arena, not flagged individually. since 
+ * cells are never freed individually they can also share string bodies 
+ * (we do that for packed string arrays).
+ *
+ * this only depends on the XLOPER12 definitions, not on excel, so it can
+ * be built and tested elsewhere.
+ */
+class XLOPERArena {
+
+protected:
+
+  struct Block;
+
+  /** primary block, in front of the grid */
+  Block *block_;
+
+protected:
+
+  static Block *AllocateBlock(size_t grid_bytes, size_t string_units);
+
+  /** allocate string space from the last block, chaining a new one if necessary */
+  XCHAR *Reserve(size_t units);
+
+public:
+
+  /**
+   * allocate an array into x, with space for string_units characters of 
+   * strings (including one length prefix per string). cells are set to 
+   * nil. returns false (and sets x to an error) if allocation fails.
+   */
+  bool Allocate(LPXLOPER12 x, int rows, int cols, size_t string_units = 0);
+
+  /** 
+   * convert and store a (UTF-8) string, and point the cell at it. returns
+   * the stored string, so other cells can share it.
+   */
+  const XCHAR *SetString(LPXLOPER12 cell, const char *source, size_t length);
+
+  const XCHAR *SetString(LPXLOPER12 cell, const std::string &source) {
+    return SetString(cell, source.c_str(), source.length());
+  }
+
+  /** point the cell at a string already stored in this arena */
+  static void ShareString(LPXLOPER12 cell, const XCHAR *str) {
+    cell->xltype = xltypeStr;
+    cell->val.str = const_cast<XCHAR*>(str);
+  }
+
+  /** string space for a UTF-8 string, for sizing Allocate */
+  static size_t StringUnits(size_t length) { return length + 1; }
+
+  /** check if x is an arena array */
+  static bool IsArenaArray(LPXLOPER12 x);
+
+  /** free an arena array (grid, strings and overflow) and set x to nil */
+  static void Release(LPXLOPER12 x);
+
+public:
+
+  /** empty; call Allocate */
+  XLOPERArena() : block_(0) {}
+
+  /** attach to an existing arena array, to add strings */
+  XLOPERArena(LPXLOPER12 x);
+
+};
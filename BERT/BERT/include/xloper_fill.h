@@ -0,0 +1,207 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "message_utilities.h"
+#include "array_conversion.h"
+#include "xloper_arena.h"
+#include "work_pool.h"
+
+/**
+ * fill for excel arrays (an arena grid of XLOPER12s). excel is row-major,
+ * so a run of our (column-major) elements is a strided column. NA is nil
+ * (an empty cell), strings go in the arena.
+ *
+ * Traits handles anything that isn't a plain value (nested arrays, errors,
+ * complex), so this doesn't depend on the rest of Convert (see 
+ * Convert::XLOPERTraits). it needs:
+ *
+ *   SetVariable(LPXLOPER12, const BERTBuffers::Variable&, XLOPERArena&)
+ *
+ * that's only called for unpacked arrays, which are never filled in 
+ * parallel.
+ */
+template <class Traits> class XLOPERArrayFill {
+
+public:
+
+  /**
+   * array conversion sink (see ArrayConversion). packed strings are 
+   * converted once per dictionary entry and shared; if the dictionary was 
+   * converted up front (PackedDictionary), this only shares strings, so 
+   * it's safe to run on multiple threads.
+   */
+  class Sink : public ArrayConversion::Sink<Sink> {
+
+  protected:
+    LPXLOPER12 first_;
+    int stride_;
+    XLOPERArena &arena_;
+    std::vector<const XCHAR*> &dictionary_;
+
+    LPXLOPER12 At(int out) { return first_ + (size_t)out * stride_; }
+
+  public:
+    Sink(XLOPERArena &arena, std::vector<const XCHAR*> &dictionary, LPXLOPER12 first = 0, int stride = 1)
+      : first_(first), stride_(stride), arena_(arena), dictionary_(dictionary) {}
+
+    /** set target for the next run */
+    void Target(LPXLOPER12 first, int stride) { 
+      first_ = first;
+      stride_ = stride;
+    }
+
+    void Real(int out, double value) {
+      LPXLOPER12 x = At(out);
+      x->xltype = xltypeNum;
+      x->val.num = value;
+    }
+
+    void Integer(int out, int32_t value) {
+      LPXLOPER12 x = At(out);
+      x->xltype = xltypeInt;
+      x->val.w = value;
+    }
+
+    void Logical(int out, bool value) {
+      LPXLOPER12 x = At(out);
+      x->xltype = xltypeBool;
+      x->val.xbool = value;
+    }
+
+    void String(int out, const std::string &str) { arena_.SetString(At(out), str); }
+
+    void Entry(int out, const BERTBuffers::Array &arr, int entry) {
+      const XCHAR *str = dictionary_[entry];
+      if (str) XLOPERArena::ShareString(At(out), str);
+      else dictionary_[entry] = arena_.SetString(At(out), arr.dictionary(entry));
+    }
+
+    void NA(int out) { At(out)->xltype = xltypeNil; }
+
+    /** same as VariableToXLOPER */
+    void Missing(int out) {
+      LPXLOPER12 x = At(out);
+      x->xltype = xltypeErr;
+      x->val.err = xlerrNA;
+    }
+
+    void Other(int out, const BERTBuffers::Variable &var) { Traits::SetVariable(At(out), var, arena_); }
+
+    /** new dictionary (per array, or per column for columnar arrays) */
+    void Dictionary(const BERTBuffers::Array &arr) { dictionary_.assign(arr.dictionary_size(), 0); }
+
+  };
+
+  /**
+   * convert all the dictionary strings for a packed string array up front.
+   * then Sink only shares strings, so it's safe to run on multiple threads.
+   */
+  static void PackedDictionary(const BERTBuffers::Array &arr, XLOPERArena &arena, std::vector<const XCHAR*> &dictionary) {
+    XLOPER12 scratch;
+    int dictionary_size = arr.dictionary_size();
+    dictionary.resize(dictionary_size, 0);
+    for (int i = 0; i < dictionary_size; i++) dictionary[i] = arena.SetString(&scratch, arr.dictionary(i));
+  }
+
+  /**
+   * fill a grid of rows x cols cells, allocated in arena, from an array. 
+   * rows and cols include names, if row_names or col_names are set; the 
+   * values are the rest of the grid. assumes the array length has been 
+   * checked, and that the arena has space for the strings (see 
+   * Convert::ArrayStringUnits).
+   *
+   * large packed arrays are filled in parallel, by blocks of columns. 
+   */
+  static void Fill(XLOPERArena &arena, LPXLOPER12 grid, int rows, int cols, const BERTBuffers::Array &arr, bool row_names, bool col_names) {
+    Fill(arena, grid, rows, cols, arr, row_names, col_names, WorkPool::Instance());
+  }
+
+  /** 
+   * fill using a particular pool (the default is the shared pool). the 
+   * threshold and block size are parameters so they can be measured (see
+   * Bench/bench_work_pool.cc); otherwise use the defaults.
+   */
+  static void Fill(XLOPERArena &arena, LPXLOPER12 grid, int rows, int cols, const BERTBuffers::Array &arr, bool row_names, bool col_names, 
+    WorkPool &pool, int threshold = PARALLEL_CONVERSION_THRESHOLD, int block_size = PARALLEL_CONVERSION_BLOCK_SIZE) {
+
+    int c_offset = (row_names ? 1 : 0);
+    int r_offset = (col_names ? 1 : 0);
+
+    // names
+
+    if (row_names) {
+      if (col_names) arena.SetString(&(grid[0]), "", 0);
+      for (int r = r_offset; r < rows; r++) {
+        arena.SetString(&(grid[r * cols]), arr.rownames(r - r_offset));
+      }
+    }
+    if (col_names) {
+      for (int c = c_offset; c < cols; c++) {
+        arena.SetString(&(grid[c]), arr.colnames(c - c_offset));
+      }
+    }
+
+    // values, by column (columnar arrays have a dictionary per column). 
+    // large packed arrays fill in parallel; for those, strings are 
+    // converted first, so cells only share them.
+
+    int data_rows = rows - r_offset;
+    int data_cols = cols - c_offset;
+
+    bool packed = MessageUtilities::IsPacked(arr);
+    bool columnar = MessageUtilities::IsColumnar(arr);
+
+    std::vector<const XCHAR*> dictionary;
+
+    if (packed && (data_rows * data_cols >= threshold)) {
+      if (arr.packed_type() == MessageUtilities::TypeFlags::string) PackedDictionary(arr, arena, dictionary);
+      int block_columns = (std::max)(1, block_size / data_rows);
+      pool.ParallelFor(data_cols, block_columns, [&](int begin, int end) {
+        Sink sink(arena, dictionary);
+        for (int c = begin; c < end; c++) {
+          sink.Target(grid + (size_t)r_offset * cols + c + c_offset, cols);
+          ArrayConversion::Run(sink, 0, arr, c * data_rows, data_rows);
+        }
+      });
+    }
+    else {
+      Sink sink(arena, dictionary);
+      if (packed && arr.packed_type() == MessageUtilities::TypeFlags::string) sink.Dictionary(arr);
+      for (int c = 0; c < data_cols; c++) {
+        sink.Target(grid + (size_t)r_offset * cols + c + c_offset, cols);
+        if (columnar) {
+          const BERTBuffers::Array &column = arr.columns(c);
+          if (column.packed_type() == MessageUtilities::TypeFlags::string) sink.Dictionary(column);
+          ArrayConversion::Run(sink, 0, column, 0, data_rows);
+        }
+        else ArrayConversion::Run(sink, 0, arr, c * data_rows, data_rows);
+      }
+    }
+
+  }
+
+};
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <vector>
+
+#include "XLCALL.h"
+#include "message_utilities.h"
+
+class WorkPool;
+
+/**
+ * excel range (multi) -> array, without going through one Variable per
+ * cell. excel arrays are row-major and ours are column-major, so a naive 
+ * conversion walks the grid with a stride of one row for every element.
+ *
+ * instead we make two passes. the first is a linear walk over the grid 
+ * that just accumulates cell types per column. then, if the whole range 
+ * has a single type, we build a packed array; if it doesn't, but columns 
+ * do (a table), we build a columnar array with one packed array per typed
+ * column. the second pass fills the (presized) typed fields in tiles, so 
+ * reads stay within a small block of the grid and writes are contiguous 
+ * runs per column. large ranges are filled in parallel (see WorkPool).
+ *
+ * this only depends on the XLOPER12 definitions, not on excel, so it can
+ * be built and tested elsewhere.
+ */
+class XLOPERRangeScanner {
+
+public:
+
+  /**
+   * conversion for individual cells, for columns without a single type 
+   * (normally Convert::XLOPERToVariable).
+   */
+  typedef BERTBuffers::Variable* (*CellConverter)(BERTBuffers::Variable *var, LPXLOPER12 x);
+
+protected:
+
+  /** output for one column of the range, see Scan */
+  struct Column;
+
+  struct BlockDictionary;
+
+  static void InitPacked(BERTBuffers::Array *arr, MessageUtilities::TypeFlags packed_type, int length, bool na);
+
+  static void FillTile(Column &column, LPXLOPER12 cell, int stride, int first_row, int last_row, std::string &str, CellConverter converter);
+
+  /** fill elements [begin, end), in column-major order, in tiles */
+  static void FillRange(std::vector<Column> &columns, LPXLOPER12 grid, int rows, int begin, int end, CellConverter converter);
+
+  /** build the array dictionary from per-block dictionaries, and remap indexes */
+  static void MergeDictionaries(BERTBuffers::Array *arr, std::vector<BlockDictionary> &blocks, int block_size);
+
+public:
+
+  /** 
+   * packed type for an OR of cell types (nil and missing are NA), or nil 
+   * if they can't be packed
+   */
+  static MessageUtilities::TypeFlags PackedType(DWORD xltypes);
+
+  /**
+   * convert a multi to a packed or columnar array. rows and cols should 
+   * already be set. returns false if the range is empty or has neither a 
+   * single type nor typed columns, in which case the array is not modified.
+   */
+  static bool Scan(BERTBuffers::Array *arr, LPXLOPER12 x, CellConverter converter);
+
+  /** scan using a particular pool (the default is the shared pool) */
+  static bool Scan(BERTBuffers::Array *arr, LPXLOPER12 x, CellConverter converter, WorkPool &pool);
+
+};
@@ -76,9 +76,16 @@ LPXLOPER12 BERTFunctionCall(
 		Convert::XLOPERToVariable(argument, arglist[i]);
 	}
 
-  bert->CallLanguage(function_descriptor->language_key_, response, call);
+  // large array results may be streamed, in which case the builder 
+  // constructs rslt as the data arrives
 
-  if (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) {
+  XLOPERArrayBuilder builder(&rslt);
+  bert->CallLanguage(function_descriptor->language_key_, response, call, &builder);
+
+  if (MessageUtilities::IsStreamedResult(response)) {
+    // already built
+  }
+  else if (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) {
     Convert::VariableToXLOPER(&rslt, response.result());
   }
   else {
@@ -109,9 +116,13 @@ LPXLOPER12 BERT_Exec_Generic(uint32_t language_key, LPXLOPER12 code) {
   auto message = call.mutable_code();
   for (auto line : lines) message->add_line(line);
 
-  BERT::Instance()->CallLanguage(language_key, response, call);
+  XLOPERArrayBuilder builder(&rslt);
+  BERT::Instance()->CallLanguage(language_key, response, call, &builder);
 
-  if (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) {
+  if (MessageUtilities::IsStreamedResult(response)) {
+    // already built
+  }
+  else if (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) {
     Convert::VariableToXLOPER(&rslt, response.result());
   }
   else {
@@ -155,9 +166,13 @@ LPXLOPER12 BERT_Call_Generic(uint32_t language_key, LPXLOPER12 func,
     Convert::XLOPERToVariable(argument, arglist[i]);
   }
 
-  BERT::Instance()->CallLanguage(language_key, response, call);
+  XLOPERArrayBuilder builder(&rslt);
+  BERT::Instance()->CallLanguage(language_key, response, call, &builder);
 
-  if (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) {
+  if (MessageUtilities::IsStreamedResult(response)) {
+    // already built
+  }
+  else if (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) {
     Convert::VariableToXLOPER(&rslt, response.result());
   }
   else {
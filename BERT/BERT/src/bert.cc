@@ -29,6 +29,7 @@
 #include "windows_api_functions.h"
 #include "module_functions.h"
 #include "message_utilities.h"
+#include "work_pool.h"
 #include "..\resource.h"
 
 #include "excel_com_type_libraries.h"
@@ -300,6 +301,9 @@ unsigned BERT::InstanceConsoleThreadFunction(){
   bool reading = false;
   bool connected = false;
 
+  // messages may span reads (the buffer is small)
+  FrameDecoder decoder;
+
   console_notification_handle_ = ::CreateEvent(0, TRUE, FALSE, 0);
 
   HANDLE handle = CreateNamedPipeA(pipe_name.c_str(),
@@ -353,7 +357,7 @@ unsigned BERT::InstanceConsoleThreadFunction(){
     result = WaitForMultipleObjects(2, &(handles[0]), FALSE, 1000);
     if (result == WAIT_OBJECT_0 + 1) {
       ::ResetEvent(handles[1]);
-      std::string message = console_notifications_[0];
+      std::string message = std::move(console_notifications_[0]);
       console_notifications_.erase(console_notifications_.begin());
       WriteFile(handle, message.c_str(), (DWORD)message.length(), &bytes_written, &write_io);
       result = GetOverlappedResultEx(handle, &write_io, &bytes_written, INFINITE, FALSE);
@@ -362,43 +366,57 @@ unsigned BERT::InstanceConsoleThreadFunction(){
       ResetEvent(read_io.hEvent);
       reading = false;
       result = GetOverlappedResultEx(handle, &read_io, &bytes_read, 0, FALSE);
-      if (result) {
+      if (!result && GetLastError() == ERROR_MORE_DATA) {
+
+        // partial message: the next read reuses the buffer before we take
+        // anything out of the decoder, so it has to copy this part
+
+        decoder.Append(buffer, bytes_read);
+      }
+      else if (result) {
         if (!connected) {
           std::cout << " * connected to mgmt pipe " << std::endl;
           connected = true;
         }
         else {
-          std::cout << " * read message mgmt pipe " << std::endl;
-          BERTBuffers::CallResponse call, reply;
-          MessageUtilities::Unframe(call, buffer, bytes_read);
-
-          reply.set_id(call.id());
-          auto result = reply.mutable_result();
-          bool success = false;
-
-          switch (call.operation_case()) {
-          case BERTBuffers::CallResponse::OperationCase::kFunctionCall:
-          {
-            const std::string &function = call.function_call().function();
-            // we should validate target
-            std::cout << "console: " << function << std::endl;
-            if (!function.compare("hide-console")) {
-
-              // can we do this on this thread? (...)
-              HideConsole();
+          decoder.Feed(buffer, bytes_read);
+          const char *frame;
+          uint32_t frame_length;
+          while (decoder.Next(&frame, &frame_length)) {
+            std::cout << " * read message mgmt pipe " << std::endl;
+            BERTBuffers::CallResponse call, reply;
+            if (!MessageUtilities::Unframe(call, frame, frame_length)) {
+              std::cerr << "error parsing management message" << std::endl;
+              continue;
             }
-            break;
-          }
-          default:
-            std::cout << "Unexpected operation case: " << call.operation_case() << std::endl;
-            break;
-          }
-          
-          result->set_boolean(success);
-          std::string data = MessageUtilities::Frame(reply);
 
-          WriteFile(handle, data.c_str(), (DWORD)data.length(), NULL, &write_io);
+            reply.set_id(call.id());
+            auto result = reply.mutable_result();
+            bool success = false;
+
+            switch (call.operation_case()) {
+            case BERTBuffers::CallResponse::OperationCase::kFunctionCall:
+            {
+              const std::string &function = call.function_call().function();
+              // we should validate target
+              std::cout << "console: " << function << std::endl;
+              if (!function.compare("hide-console")) {
+
+                // can we do this on this thread? (...)
+                HideConsole();
+              }
+              break;
+            }
+            default:
+              std::cout << "Unexpected operation case: " << call.operation_case() << std::endl;
+              break;
+            }
+            
+            result->set_boolean(success);
+            std::string data = MessageUtilities::Frame(reply);
 
+            WriteFile(handle, data.c_str(), (DWORD)data.length(), NULL, &write_io);
+          }
         }
       }
       else {
@@ -408,6 +426,7 @@ unsigned BERT::InstanceConsoleThreadFunction(){
           // reset and wait for reconnect
 
           std::cout << " * broken pipe [2] " << std::endl;
+          decoder.Reset();
 
           ResetEvent(read_io.hEvent);
           ResetEvent(write_io.hEvent);
@@ -705,6 +724,7 @@ int BERT::ExcelCallback(const BERTBuffers::CallResponse &call, BERTBuffers::Call
 
   if (callback.arguments_size() > 0) {
     auto arguments_array = callback.arguments(0).arr();
+    MessageUtilities::UnpackArray(&arguments_array); // this is a copy
 
     int count = arguments_array.data().size();
     if (count > 0) {
@@ -905,9 +925,14 @@ std::shared_ptr<LanguageService> BERT::GetLanguageService(uint32_t key) {
   return language_services_[key];
 }
 
-void BERT::CallLanguage(uint32_t language_key, BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call) {
+void BERT::CallLanguage(uint32_t language_key, BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call, MessageUtilities::ArrayBlockHandler *handler) {
   auto language_service = GetLanguageService(language_key);
-  if (language_service) language_service->Call(response, call);
+  if (language_service) language_service->Call(response, call, handler);
+}
+
+void BERT::CallLanguageBatch(uint32_t language_key, BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call) {
+  auto language_service = GetLanguageService(language_key);
+  if (language_service) language_service->CallBatch(response, call);
 }
 
 void BERT::Close() {
@@ -922,6 +947,9 @@ void BERT::Close() {
     language_service->Shutdown();
   }
 
+  // conversion threads. we have to join these before the DLL is unloaded.
+  WorkPool::Instance().Shutdown();
+
   // free marshalled pointer
   if (stream_pointer_) AtlFreeMarshalStream(stream_pointer_);
 
@@ -24,6 +24,7 @@
 #include "bert.h"
 #include "basic_functions.h"
 #include "type_conversions.h"
+#include "xloper_arena.h"
 #include "windows_api_functions.h"
 
 #include "excel_api_functions.h"
@@ -38,6 +39,13 @@ void resetXlOper(LPXLOPER12 x)
     x->val.str = 0;
 
   }
+  else if (XLOPERArena::IsArenaArray(x))
+  {
+    // our arrays are a single block, including strings
+
+    XLOPERArena::Release(x);
+    return;
+  }
   else if ((x->xltype == xltypeMulti || x->xltype == (xltypeMulti | xlbitDLLFree)) && x->val.array.lparray)
   {
     // have to consider the case that there are strings
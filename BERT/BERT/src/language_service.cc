@@ -24,9 +24,8 @@
 #include "language_service.h"
 #include "string_utilities.h"
 
-// by convention we don't use transaction 0. 
-// this may cause a problem if it rolls over.
-uint32_t LanguageService::transaction_id_ = 1;
+// by convention we don't use transaction 0 (see transaction_id()).
+std::atomic<uint32_t> LanguageService::transaction_id_(1);
 
 LanguageService::LanguageService(CallbackInfo &callback_info, COMObjectMap &object_map, DWORD dev_flags, const json11::Json &config, const std::string &home_directory, const LanguageDescriptor &descriptor)
   : callback_info_(callback_info)
@@ -34,10 +33,25 @@ LanguageService::LanguageService(CallbackInfo &callback_info, COMObjectMap &obje
   , dev_flags_(dev_flags)
   , connected_(false)
   , configured_(false)
+  , packed_arrays_(false)
+  , compression_threshold_(0)
+  , call_batch_(false)
+  , shared_memory_size_(0)
+  , pipelined_(false)
+  , buffer_(0)
+  , reading_(false)
+  , read_pending_(false)
+  , waiting_(0)
   , resource_id_(0)
   , language_descriptor_(descriptor)
 {
   memset(&io_, 0, sizeof(io_));
+  memset(&write_io_, 0, sizeof(write_io_));
+
+  InitializeCriticalSectionAndSpinCount(&transaction_lock_, 0x00000400);
+  InitializeCriticalSectionAndSpinCount(&write_lock_, 0x00000400);
+  InitializeCriticalSection(&call_lock_);
+  InitializeCriticalSection(&callback_lock_);
 
   // comment out language (or delete) to deactivate.
   
@@ -54,6 +68,24 @@ LanguageService::LanguageService(CallbackInfo &callback_info, COMObjectMap &obje
   configured_ = language_home_.length();
   if (!configured_) return;
 
+  // compression threshold is shared by all languages. off by default (see
+  // DEFAULT_COMPRESSION_THRESHOLD); a size turns it on.
+
+  compression_threshold_ = DEFAULT_COMPRESSION_THRESHOLD;
+  if (config["BERT"]["compressionThreshold"].is_number()) {
+    int threshold = config["BERT"]["compressionThreshold"].int_value();
+    compression_threshold_ = threshold > 0 ? threshold : 0;
+  }
+
+  // shared memory size (MB, per direction) is also shared. 0 to disable.
+
+  shared_memory_size_ = DEFAULT_SHARED_MEMORY_SIZE_MB;
+  if (config["BERT"]["sharedMemorySize"].is_number()) {
+    int size = config["BERT"]["sharedMemorySize"].int_value();
+    shared_memory_size_ = size > 0 ? size : 0;
+  }
+  shared_memory_size_ *= 1024 * 1024;
+
   DWORD result = ExpandEnvironmentStringsA(language_home_.c_str(), 0, 0);
   if (result) {
     char *buffer = new char[result + 1];
@@ -88,11 +120,113 @@ LanguageService::LanguageService(CallbackInfo &callback_info, COMObjectMap &obje
 
 }
 
+LanguageService::~LanguageService() {
+  for (auto event : event_pool_) CloseHandle(event);
+  DeleteCriticalSection(&transaction_lock_);
+  DeleteCriticalSection(&write_lock_);
+  DeleteCriticalSection(&call_lock_);
+  DeleteCriticalSection(&callback_lock_);
+}
+
 void LanguageService::Initialize() {
 
   if (connected_) {
     uintptr_t callback_thread_ptr = _beginthreadex(0, 0, CallbackThreadFunction, this, 0, 0);
 
+    // check if the control process supports packed arrays. older versions 
+    // will return an error (boolean false) for an unknown system call.
+
+    {
+      BERTBuffers::CallResponse call, response;
+      call.set_wait(true);
+      call.mutable_function_call()->set_function("packed-arrays");
+      call.mutable_function_call()->set_target(BERTBuffers::CallTarget::system);
+      Call(response, call);
+      packed_arrays_ = (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) && response.result().boolean();
+    }
+
+    // compression. the control process will compress responses above the 
+    // threshold we send; if it accepts, we compress our messages as well.
+    // this call itself has to go uncompressed.
+
+    {
+      uint32_t threshold = compression_threshold_;
+      compression_threshold_ = 0;
+      if (threshold) {
+        BERTBuffers::CallResponse call, response;
+        call.set_wait(true);
+        call.mutable_function_call()->set_function("compression");
+        call.mutable_function_call()->set_target(BERTBuffers::CallTarget::system);
+        call.mutable_function_call()->add_arguments()->set_integer(threshold);
+        Call(response, call);
+        if ((response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) && response.result().boolean()) {
+          compression_threshold_ = threshold;
+        }
+      }
+    }
+
+    // pipelining: the control process handles requests in order, and tags
+    // responses with the request id, so we can send more than one request
+    // at a time. that breaks if it reads callback responses on the main 
+    // pipe, so it has to opt in. until then, calls are serialized.
+
+    {
+      BERTBuffers::CallResponse call, response;
+      call.set_wait(true);
+      call.mutable_function_call()->set_function("pipelined");
+      call.mutable_function_call()->set_target(BERTBuffers::CallTarget::system);
+      Call(response, call);
+      pipelined_ = (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) && response.result().boolean();
+    }
+
+    // call batches. older versions will return false for the system call.
+
+    {
+      BERTBuffers::CallResponse call, response;
+      call.set_wait(true);
+      call.mutable_function_call()->set_function("call-batch");
+      call.mutable_function_call()->set_target(BERTBuffers::CallTarget::system);
+      Call(response, call);
+      call_batch_ = (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) && response.result().boolean();
+    }
+
+    // shared memory. we create the rings and send the names; if the control
+    // process can't open them (or doesn't support it), close them and we 
+    // just use the pipe. large messages go through the rings in both 
+    // directions, with a descriptor on the pipe.
+
+    if (shared_memory_size_) {
+      bool accepted = false;
+      if (call_ring_.Create(pipe_name_ + "-SHM-C", shared_memory_size_) && response_ring_.Create(pipe_name_ + "-SHM-R", shared_memory_size_)) {
+        BERTBuffers::CallResponse call, response;
+        call.set_wait(true);
+        call.mutable_function_call()->set_function("shared-memory");
+        call.mutable_function_call()->set_target(BERTBuffers::CallTarget::system);
+        call.mutable_function_call()->add_arguments()->set_str(call_ring_.name());
+        call.mutable_function_call()->add_arguments()->set_str(response_ring_.name());
+        call.mutable_function_call()->add_arguments()->set_integer(DEFAULT_SHARED_RING_THRESHOLD);
+        Call(response, call);
+        accepted = (response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult) && response.result().boolean();
+      }
+      if (!accepted) {
+        call_ring_.Close();
+        response_ring_.Close();
+      }
+    }
+
+    // streamed results are packed, so only ask if we have packed arrays. 
+    // we don't need to check the response; if it's not supported we just 
+    // won't get any streamed results.
+
+    if (packed_arrays_) {
+      BERTBuffers::CallResponse call, response;
+      call.set_wait(true);
+      call.mutable_function_call()->set_function("stream-results");
+      call.mutable_function_call()->set_target(BERTBuffers::CallTarget::system);
+      call.mutable_function_call()->add_arguments()->set_integer(STREAM_BLOCK_SIZE);
+      Call(response, call);
+    }
+
     // get embedded startup code, split into lines
     // FIXME: why do we require that this be in multiple lines?
 
@@ -158,7 +292,8 @@ void LanguageService::RunCallbackThread() {
     DWORD bytes = 0;
     OVERLAPPED io;
 
-    std::string message_buffer;
+    FrameDecoder decoder;
+    std::string write_buffer;
 
     memset(&io, 0, sizeof(io));
     io.hEvent = CreateEvent(0, TRUE, FALSE, 0);
@@ -168,7 +303,20 @@ void LanguageService::RunCallbackThread() {
       if (result == WAIT_OBJECT_0) {
         ResetEvent(io.hEvent);
         DWORD rslt = GetOverlappedResultEx(callback_pipe_handle, &io, &bytes, 0, FALSE);
-        if (rslt) {
+        DWORD err = rslt ? 0 : GetLastError();
+
+        if (!rslt && err != ERROR_MORE_DATA) {
+          DebugOut("ERR in GORE: %d\n", err);
+          // ...
+          break;
+        }
+
+        decoder.Feed(buffer, bytes);
+
+        const char *frame;
+        uint32_t frame_length;
+
+        while (decoder.Next(&frame, &frame_length)) {
 
           BERTBuffers::CallResponse &call = callback_info_.callback_call_;
           BERTBuffers::CallResponse &response = callback_info_.callback_response_;
@@ -176,42 +324,25 @@ void LanguageService::RunCallbackThread() {
           call.Clear();
           response.Clear();
 
-          if (message_buffer.length()) {
-            message_buffer.append(buffer, bytes);
-            MessageUtilities::Unframe(call, message_buffer);
-            message_buffer = "";
-          }
-          else {
-            MessageUtilities::Unframe(call, buffer, bytes);
+          if (!MessageUtilities::Unframe(call, frame, frame_length)) {
+            DebugOut("callback parse err\n");
+            continue;
           }
 
           bert->HandleCallback(language_name_);
           //DumpJSON(response);
 
           if (call.wait()) {
-            std::string str_response = MessageUtilities::Frame(response);
-            WriteFile(callback_pipe_handle, str_response.c_str(), (int32_t)str_response.size(), &bytes, &io);
+            if (!packed_arrays_) MessageUtilities::UnpackMessage(response);
+            MessageUtilities::Frame(response, write_buffer);
+            WriteFile(callback_pipe_handle, write_buffer.c_str(), (int32_t)write_buffer.size(), &bytes, &io);
             result = GetOverlappedResultEx(callback_pipe_handle, &io, &bytes, INFINITE, FALSE);
           }
-
-          // restart
-          ResetEvent(io.hEvent);
-          ReadFile(callback_pipe_handle, buffer, buffer_size, 0, &io);
-
-        }
-        else {
-          DWORD err = GetLastError();
-          if (err == ERROR_MORE_DATA) {
-            message_buffer.append(buffer, bytes);
-            ResetEvent(io.hEvent);
-            ReadFile(callback_pipe_handle, buffer, buffer_size, 0, &io);
-          }
-          else {
-            DebugOut("ERR in GORE: %d\n", err);
-            // ...
-            break;
-          }
         }
+
+        // restart
+        ResetEvent(io.hEvent);
+        ReadFile(callback_pipe_handle, buffer, buffer_size, 0, &io);
       }
       else if (result != WAIT_TIMEOUT) {
         DebugOut("callback pipe error: %d\n", GetLastError());
@@ -269,6 +400,7 @@ void LanguageService::Connect(HANDLE job_handle) {
 
   buffer_ = new char[PIPE_BUFFER_SIZE];
   io_.hEvent = CreateEvent(0, TRUE, TRUE, 0); // FIXME: clean this up
+  write_io_.hEvent = CreateEvent(0, TRUE, TRUE, 0);
 
   if (!rslt) {
 
@@ -398,117 +530,433 @@ void LanguageService::Shutdown() {
     pipe_handle_ = 0;
   }
 
+  call_ring_.Close();
+  response_ring_.Close();
+
   if (buffer_) delete buffer_;
 
 }
 
-void LanguageService::Call(BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call) {
+void LanguageService::CallBatch(BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call) {
+
+  // we always want results, whichever way the batch runs
+
+  call.set_wait(true);
+
+  if (call_batch_) {
+    Call(response, call);
+    return;
+  }
+
+  MessageUtilities::RunCallBatch(response, call, [this](BERTBuffers::CallResponse &single_response, BERTBuffers::CallResponse &single_call) {
+    Call(single_response, single_call);
+  });
+}
+
+bool LanguageService::WriteMessage(BERTBuffers::CallResponse &message) {
 
   DWORD bytes;
-  uint32_t id = LanguageService::transaction_id();
 
-  auto bert = BERT::Instance();
+  // large messages go via the call ring. that's single-producer, and the 
+  // descriptors have to go through the pipe in ring order, so the whole 
+  // thing is under the lock.
 
-  call.set_id(id);
+  EnterCriticalSection(&write_lock_);
 
-  std::string framed_message = MessageUtilities::Frame(call);
+  if (!MessageUtilities::FrameShared(message, &call_ring_, write_buffer_, DEFAULT_SHARED_RING_THRESHOLD)) {
+    MessageUtilities::Frame(message, write_buffer_, compression_threshold_);
+  }
 
-  ResetEvent(io_.hEvent);
-  bool write_result = WriteFile(pipe_handle_, framed_message.c_str(), (int32_t)framed_message.length(), NULL, &io_);
+  ResetEvent(write_io_.hEvent);
+  WriteFile(pipe_handle_, write_buffer_.c_str(), (int32_t)write_buffer_.length(), NULL, &write_io_);
 
-  // wait for the write to complete. FIXME: there's no need to wait if we don't need a 
-  // result, but in that case we will need to make sure it's clear before we send another message.
+  // wait for the write to complete, so we can reuse the buffer. 
 
-  GetOverlappedResultEx(pipe_handle_, &io_, &bytes, INFINITE, false);
+  BOOL result = GetOverlappedResultEx(pipe_handle_, &write_io_, &bytes, INFINITE, FALSE);
 
-  if (call.wait()) {
+  LeaveCriticalSection(&write_lock_);
 
-    ResetEvent(callback_info_.default_unsignaled_event_);
-    HANDLE handles[2] = { io_.hEvent, callback_info_.default_unsignaled_event_ };
+  return result ? true : false;
+}
 
-    ResetEvent(io_.hEvent);
-    ReadFile(pipe_handle_, buffer_, PIPE_BUFFER_SIZE, 0, &io_);
+void LanguageService::CompleteTransaction(Transaction *transaction) {
+  transactions_.erase(transaction->id);
+  transaction->complete = true;
+  SetEvent(transaction->event);
+}
 
-    std::string message_buffer;
+void LanguageService::FailTransactions(const std::string &message) {
+  EnterCriticalSection(&transaction_lock_);
+  while (transactions_.size()) {
+    Transaction *transaction = transactions_.begin()->second;
+    if (transaction->streaming && transaction->handler) transaction->handler->End(false);
+    transaction->response->set_err(message);
+    CompleteTransaction(transaction);
+  }
+  LeaveCriticalSection(&transaction_lock_);
+}
 
-    while (true) {
-      ResetEvent(callback_info_.default_signaled_event_); // set unsignaled
-      DWORD signaled = WaitForMultipleObjectsEx(2, handles, FALSE, INFINITE, FALSE);
-      if (signaled == WAIT_OBJECT_0) {
-
-        DWORD rslt = GetOverlappedResultEx(pipe_handle_, &io_, &bytes, INFINITE, FALSE);
-        if (rslt) {
-
-          if (message_buffer.length()) {
-            message_buffer.append(buffer_, bytes);
-            if (!MessageUtilities::Unframe(response, message_buffer)) {
-              DebugOut("parse err [2]!\n");
-              response.set_err("parse error (0x10)");
-              break;
-            }
-          }
-          else {
-            if (!MessageUtilities::Unframe(response, buffer_, bytes)) {
-              DebugOut("parse err [1]!\n");
-              response.set_err("parse error (0x11)");
-              break;
-            }
-          }
+void LanguageService::ReleaseReader() {
 
-          // check for callback
-          bool complete = false;
-          switch (response.operation_case()) {
-          case BERTBuffers::CallResponse::OperationCase::kFunctionCall: // callback
+  // any outstanding transaction can take over. the read (if there is one)
+  // stays pending; overlapped io isn't tied to the thread that started it.
 
-            // temp, use existing
-            //callback_info_.callback_call_.CopyFrom(response);
-            bert->HandleCallbackOnThread(language_name_, &response);
+  EnterCriticalSection(&transaction_lock_);
+  reading_ = false;
+  if (transactions_.size()) SetEvent(transactions_.begin()->second->event);
+  LeaveCriticalSection(&transaction_lock_);
+}
 
-            // write
-            ResetEvent(io_.hEvent);
-            framed_message = MessageUtilities::Frame(callback_info_.callback_response_);
-            WriteFile(pipe_handle_, framed_message.c_str(), (int32_t)framed_message.length(), NULL, &io_);
+LanguageService::Transaction* LanguageService::RouteCallback(uint32_t id, const Transaction &transaction) {
 
-            // wait?
-            GetOverlappedResultEx(pipe_handle_, &io_, &bytes, INFINITE, FALSE);
+  if (!id) return 0;
 
-            // ok
-            ResetEvent(io_.hEvent);
-            ReadFile(pipe_handle_, buffer_, PIPE_BUFFER_SIZE, 0, &io_);
+  auto iter = transactions_.find(id);
+  if (iter == transactions_.end()) return 0;
 
-            break;
-          default:
-            complete = true;
-            break;
-          }
+  // if the owner is on this thread, it's waiting on a nested call (made
+  // from one of its callbacks), so it can't take this one. we run it.
 
-          if (complete) break;
-        }
-        else {
-          DWORD err = GetLastError();
-          if (err == ERROR_MORE_DATA) {
-            message_buffer.append(buffer_, bytes);
-            ResetEvent(io_.hEvent);
-            ReadFile(pipe_handle_, buffer_, PIPE_BUFFER_SIZE, 0, &io_);
-          }
-          else {
-            std::stringstream ss;
-            ss << "pipe error " << err;
-            response.set_err(ss.str());
-            break;
-          }
+  Transaction *owner = iter->second;
+  if (owner == &transaction || owner->thread_id == transaction.thread_id) return 0;
+  return owner;
+}
+
+void LanguageService::RunCallback(BERTBuffers::CallResponse &callback) {
+  BERTBuffers::CallResponse &callback_response = callback_info_.callback_response_;
+  BERT::Instance()->HandleCallbackOnThread(language_name_, &callback);
+  if (!packed_arrays_) MessageUtilities::UnpackMessage(callback_response);
+  WriteMessage(callback_response);
+}
+
+void LanguageService::RunSignaledCallback() {
+  DebugOut("other handle signaled, do something\n");
+  BERT::Instance()->HandleCallbackOnThread(language_name_);
+  SetEvent(callback_info_.default_signaled_event_); // signal callback thread
+}
+
+void LanguageService::HandleSignaledCallback(Transaction &transaction) {
+
+  // if there's more than one thread waiting, they'll all see the event. 
+  // whoever gets here first takes it, and runs it if it's theirs (or 
+  // nobody's); otherwise it goes to the thread that made the call.
+
+  EnterCriticalSection(&callback_lock_);
+  bool signaled = (WaitForSingleObject(callback_info_.default_unsignaled_event_, 0) == WAIT_OBJECT_0);
+  if (signaled) ResetEvent(callback_info_.default_unsignaled_event_);
+  LeaveCriticalSection(&callback_lock_);
+
+  if (!signaled) return;
+
+  EnterCriticalSection(&transaction_lock_);
+  Transaction *owner = RouteCallback(callback_info_.callback_call_.id(), transaction);
+  if (owner) {
+    owner->callback_signaled = true;
+    SetEvent(owner->event);
+  }
+  LeaveCriticalSection(&transaction_lock_);
+
+  if (!owner) RunSignaledCallback();
+}
+
+bool LanguageService::DispatchResponse(BERTBuffers::CallResponse &message) {
+
+  Transaction *transaction = 0;
+
+  EnterCriticalSection(&transaction_lock_);
+  auto iter = transactions_.find(message.id());
+  if (iter != transactions_.end()) transaction = iter->second;
+  LeaveCriticalSection(&transaction_lock_);
+
+  if (!transaction) return false;
+
+  // the transaction won't go away until it's complete, and we're the only
+  // thread that completes transactions (other than on error), so we don't 
+  // need to hold the lock here.
+
+  bool complete = false;
+  BERTBuffers::CallResponse &response = *(transaction->response);
+  MessageUtilities::ArrayBlockHandler *handler = transaction->handler;
+
+  if (transaction->streaming) {
+
+    int count = 0;
+    if (message.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult
+      && message.result().value_case() == BERTBuffers::Variable::ValueCase::kArr) {
+      count = MessageUtilities::ArrayLength(message.result().arr());
+    }
+
+    if (count <= 0) {
+      DebugOut("stream err!\n");
+      if (handler) handler->End(false);
+      response.set_err("stream error");
+      complete = true;
+    }
+    else {
+      if (handler) handler->Block(message.result().arr(), transaction->stream_offset);
+      else MessageUtilities::AppendArrayBlock(response.mutable_result()->mutable_arr(), message.result().arr(), transaction->stream_offset);
+      transaction->stream_offset += count;
+
+      if (transaction->stream_offset >= transaction->stream_length) {
+        if (handler) handler->End(true);
+        else response.mutable_result()->mutable_arr()->set_streamed(false);
+        complete = true;
+      }
+    }
+  }
+  else {
+
+    response.Swap(&message);
+
+    // streamed result: this is the header, blocks follow (with the same id)
+
+    if (MessageUtilities::IsStreamedResult(response) && response.result().arr().packed_length() > 0) {
+      transaction->streaming = true;
+      transaction->stream_length = response.result().arr().packed_length();
+      if (handler) handler->Begin(response.result().arr());
+    }
+    else complete = true;
+  }
+
+  if (complete) {
+    EnterCriticalSection(&transaction_lock_);
+    CompleteTransaction(transaction);
+    LeaveCriticalSection(&transaction_lock_);
+  }
+
+  return true;
+}
+
+void LanguageService::ReadTransactions(Transaction &transaction) {
+
+  DWORD bytes;
+  HANDLE handles[3] = { io_.hEvent, callback_info_.default_unsignaled_event_, transaction.event };
+
+  while (true) {
+
+    // there may be frames left over from a previous reader, so drain the 
+    // decoder before reading. there's usually one frame per read, but there 
+    // may be more (or none, if the frame isn't complete).
+
+    const char *frame;
+    uint32_t frame_length;
+
+    while (decoder_.Next(&frame, &frame_length)) {
+
+      if (!MessageUtilities::Unframe(read_message_, frame, frame_length, &response_ring_)) {
+
+        // we don't know which transaction this was, so we can't recover
+
+        DebugOut("parse err!\n");
+        FailTransactions("parse error (0x10)");
+        ReleaseReader();
+        return;
+      }
+
+      if (read_message_.operation_case() == BERTBuffers::CallResponse::OperationCase::kFunctionCall) {
+
+        // callback. if it's from a call another thread is waiting on, hand
+        // it over and keep reading (the control process won't send anything
+        // else until it has the response).
+
+        EnterCriticalSection(&transaction_lock_);
+        Transaction *owner = RouteCallback(read_message_.id(), transaction);
+        if (owner) {
+          owner->callback = new BERTBuffers::CallResponse;
+          owner->callback->Swap(&read_message_);
+          SetEvent(owner->event);
         }
+        LeaveCriticalSection(&transaction_lock_);
+
+        if (owner) continue;
+
+        // otherwise we run it. this may call back into Call(), so give up 
+        // reading first (the scratch message belongs to the reader, so take 
+        // it).
+
+        BERTBuffers::CallResponse callback;
+        callback.Swap(&read_message_);
+        ReleaseReader();
+        RunCallback(callback);
+        return;
       }
-      else {
-        ResetEvent(callback_info_.default_unsignaled_event_);
-        DebugOut("other handle signaled, do something\n");
-        bert->HandleCallbackOnThread(language_name_);
-        SetEvent(callback_info_.default_signaled_event_); // signal callback thread
+
+      if (!DispatchResponse(read_message_)) {
+        DebugOut("unexpected response (id %u)\n", read_message_.id());
       }
+
+      if (transaction.complete) {
+        ReleaseReader();
+        return;
+      }
+    }
+
+    // in message mode, messages larger than the buffer return ERROR_MORE_DATA
+    // and we read the rest with additional reads. the decoder assembles frames.
+
+    EnterCriticalSection(&transaction_lock_);
+    if (!read_pending_) {
+      ResetEvent(io_.hEvent);
+      ReadFile(pipe_handle_, buffer_, PIPE_BUFFER_SIZE, 0, &io_);
+      read_pending_ = true;
+    }
+    LeaveCriticalSection(&transaction_lock_);
+
+    ResetEvent(callback_info_.default_signaled_event_); // set unsignaled
+    DWORD signaled = WaitForMultipleObjectsEx(3, handles, FALSE, INFINITE, FALSE);
+    if (signaled == WAIT_OBJECT_0) {
+
+      DWORD rslt = GetOverlappedResultEx(pipe_handle_, &io_, &bytes, INFINITE, FALSE);
+      DWORD err = rslt ? 0 : GetLastError();
+
+      EnterCriticalSection(&transaction_lock_);
+      read_pending_ = false;
+      LeaveCriticalSection(&transaction_lock_);
+
+      if (!rslt && err != ERROR_MORE_DATA) {
+        std::stringstream ss;
+        ss << "pipe error " << err;
+        FailTransactions(ss.str());
+        ReleaseReader();
+        return;
+      }
+
+      decoder_.Feed(buffer_, bytes);
     }
+    else if (signaled == WAIT_OBJECT_0 + 2) {
+
+      // our event: another thread handed us a callback from our call. we
+      // can't run it while we're the reader. (the event may also be left 
+      // over from an earlier handoff; then just keep reading.)
 
+      EnterCriticalSection(&transaction_lock_);
+      bool handed = transaction.callback || transaction.callback_signaled;
+      LeaveCriticalSection(&transaction_lock_);
+
+      if (handed) {
+        ReleaseReader();
+        return;
+      }
+    }
+    else {
+      ReleaseReader();
+      HandleSignaledCallback(transaction);
+      return;
+    }
+  }
+
+}
+
+void LanguageService::WaitTransaction(Transaction &transaction) {
+
+  HANDLE handles[2] = { transaction.event, callback_info_.default_unsignaled_event_ };
+
+  EnterCriticalSection(&transaction_lock_);
+  while (!transaction.complete) {
+
+    // callbacks from our call, picked up by another thread
+
+    if (transaction.callback || transaction.callback_signaled) {
+      BERTBuffers::CallResponse *callback = transaction.callback;
+      bool callback_signaled = transaction.callback_signaled;
+      transaction.callback = 0;
+      transaction.callback_signaled = false;
+      LeaveCriticalSection(&transaction_lock_);
+
+      if (callback) {
+        RunCallback(*callback);
+        delete callback;
+      }
+      if (callback_signaled) RunSignaledCallback();
+
+      EnterCriticalSection(&transaction_lock_);
+      continue;
+    }
+
+    // if nobody is reading, we're the reader. otherwise wait until we're 
+    // complete or we're asked to take over.
+
+    bool reader = !reading_;
+    if (reader) reading_ = true;
+    LeaveCriticalSection(&transaction_lock_);
+
+    if (reader) ReadTransactions(transaction);
+    else {
+      ResetEvent(callback_info_.default_signaled_event_); // set unsignaled
+      DWORD signaled = WaitForMultipleObjectsEx(2, handles, FALSE, INFINITE, FALSE);
+      if (signaled != WAIT_OBJECT_0) HandleSignaledCallback(transaction);
+    }
+
+    EnterCriticalSection(&transaction_lock_);
+  }
+
+  // if the call failed with a callback still waiting for us, nobody wants
+  // the response any more, but the callback thread has to be released.
+
+  if (transaction.callback) delete transaction.callback;
+  transaction.callback = 0;
+  if (transaction.callback_signaled) {
+    transaction.callback_signaled = false;
+    callback_info_.callback_response_.set_err("call failed");
+    SetEvent(callback_info_.default_signaled_event_);
   }
-  SetEvent(callback_info_.default_signaled_event_); // default signaled
+
+  LeaveCriticalSection(&transaction_lock_);
+
+}
+
+void LanguageService::Call(BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call, MessageUtilities::ArrayBlockHandler *handler) {
+
+  // if the control process can't handle more than one transaction at a 
+  // time, we have to wait for any other calls. this is reentrant (for the
+  // same thread), so calls from callbacks still work.
+
+  if (!pipelined_) EnterCriticalSection(&call_lock_);
+
+  uint32_t id = LanguageService::transaction_id();
+  call.set_id(id);
+
+  if (!packed_arrays_) MessageUtilities::UnpackMessage(call);
+
+  Transaction transaction = { id, &response, handler, 0, false, false, 0, 0, 0, false, GetCurrentThreadId() };
+
+  // register before writing, so the response can't get here first. while 
+  // any thread is waiting, the callback thread should signal us (rather
+  // than running the callback itself).
+
+  if (call.wait()) {
+    EnterCriticalSection(&transaction_lock_);
+    if (event_pool_.size()) {
+      transaction.event = event_pool_.back();
+      event_pool_.pop_back();
+      ResetEvent(transaction.event);
+    }
+    else transaction.event = CreateEvent(0, FALSE, FALSE, 0);
+    transactions_[id] = &transaction;
+    if (!waiting_++) ResetEvent(callback_info_.default_signaled_event_);
+    LeaveCriticalSection(&transaction_lock_);
+  }
+
+  if (!WriteMessage(call) && call.wait()) {
+    std::stringstream ss;
+    ss << "pipe error " << GetLastError();
+    EnterCriticalSection(&transaction_lock_);
+    if (!transaction.complete) {
+      response.set_err(ss.str());
+      CompleteTransaction(&transaction);
+    }
+    LeaveCriticalSection(&transaction_lock_);
+  }
+
+  if (call.wait()) {
+    WaitTransaction(transaction);
+    EnterCriticalSection(&transaction_lock_);
+    event_pool_.push_back(transaction.event);
+    if (!--waiting_) SetEvent(callback_info_.default_signaled_event_); // default signaled
+    LeaveCriticalSection(&transaction_lock_);
+  }
+
+  if (!pipelined_) LeaveCriticalSection(&call_lock_);
 
 }
 
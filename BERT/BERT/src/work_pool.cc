@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "work_pool.h"
+
+#include <algorithm>
+
+// upper limit for the default pool; conversions are memory-bound, so more
+// threads than this don't help
+#define MAX_DEFAULT_WORK_POOL_THREADS 15
+
+/** 
+ * tasks in a loop. remaining is only changed under the lock, so the caller
+ * (which owns the group) can't see it reach zero and return while a worker
+ * is still signaling.
+ */
+struct WorkPool::Group {
+  const RangeFunction *function;
+  std::atomic<int> remaining;
+  std::mutex lock;
+  std::condition_variable done;
+};
+
+thread_local int WorkPool::worker_index_ = -1;
+
+WorkPool::WorkPool(int threads)
+  : thread_count_(threads)
+  , pending_(0)
+  , next_queue_(0)
+  , started_(false)
+  , stopped_(false)
+{
+  if (thread_count_ < 0) {
+    int cores = (int)std::thread::hardware_concurrency();
+    thread_count_ = std::min(std::max(cores - 1, 0), MAX_DEFAULT_WORK_POOL_THREADS);
+  }
+}
+
+WorkPool::~WorkPool() {
+  Shutdown();
+}
+
+WorkPool& WorkPool::Instance() {
+
+  // never destroyed; see Shutdown
+
+  static WorkPool *instance = new WorkPool();
+  return *instance;
+}
+
+bool WorkPool::Start() {
+
+  if (!thread_count_) return false;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  if (stopped_) return false;
+  if (!started_) {
+    for (int i = 0; i < thread_count_; i++) queues_.emplace_back(new Queue);
+    for (int i = 0; i < thread_count_; i++) threads_.emplace_back(&WorkPool::WorkerThread, this, i);
+    started_ = true;
+  }
+  return true;
+}
+
+void WorkPool::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (stopped_) return;
+    stopped_ = true;
+  }
+  wake_.notify_all();
+  for (auto &thread : threads_) thread.join();
+  threads_.clear();
+}
+
+bool WorkPool::Take(int index, Task &task) {
+
+  int count = (int)queues_.size();
+
+  // ours first (newest), then steal from the others (oldest)
+
+  if (index >= 0) {
+    Queue &queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    if (!queue.tasks.empty()) {
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+      pending_--;
+      return true;
+    }
+  }
+
+  for (int i = 1; i <= count; i++) {
+    int victim = (index + i + count) % count;
+    if (victim == index) continue;
+    Queue &queue = *queues_[victim];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    if (!queue.tasks.empty()) {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      pending_--;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void WorkPool::Run(const Task &task) {
+  Group *group = task.group;
+  (*group->function)(task.begin, task.end);
+  std::lock_guard<std::mutex> lock(group->lock);
+  if (--group->remaining == 0) group->done.notify_all();
+}
+
+void WorkPool::WorkerThread(int index) {
+
+  worker_index_ = index;
+
+  Task task;
+  while (true) {
+    if (Take(index, task)) {
+      Run(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(lock_);
+    wake_.wait(lock, [this] { return stopped_ || pending_.load() > 0; });
+    if (stopped_) break;
+  }
+
+}
+
+void WorkPool::ParallelFor(int count, int block_size, const RangeFunction &function) {
+
+  if (count <= 0) return;
+  if (block_size <= 0) block_size = count;
+
+  int blocks = (count - 1) / block_size + 1;
+  if (blocks == 1 || !Start()) {
+    function(0, count);
+    return;
+  }
+
+  Group group;
+  group.function = &function;
+  group.remaining = blocks;
+
+  // queue everything but the first block. from a worker, that's our own
+  // queue; otherwise spread the blocks over the workers.
+
+  int index = worker_index_;
+  int queue_count = (int)queues_.size();
+
+  for (int i = 1; i < blocks; i++) {
+    int queue_index = (index >= 0) ? index : (int)(next_queue_++ % queue_count);
+    Queue &queue = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    queue.tasks.push_back(Task{ &group, i * block_size, std::min(count, (i + 1) * block_size) });
+  }
+
+  pending_ += (blocks - 1);
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+  }
+  wake_.notify_all();
+
+  Run(Task{ &group, 0, block_size });
+
+  // help until there's nothing left to take, then wait for the rest
+
+  Task task;
+  while (group.remaining.load() > 0 && Take(index, task)) Run(task);
+
+  std::unique_lock<std::mutex> lock(group.lock);
+  group.done.wait(lock, [&group] { return group.remaining.load() == 0; });
+
+}
@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "xloper_arena.h"
+#include "transcode.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define XLOPER_ARENA_MAGIC      0x41524c58 // "XLRA"
+
+// minimum overflow block size, in characters
+#define MIN_OVERFLOW_UNITS      (32 * 1024)
+
+// excel's string length limit
+#define MAX_STRING_UNITS        32767
+
+/**
+ * block header. for the primary block the grid follows the header, then 
+ * string space; overflow blocks are all string space. sized so the grid
+ * is aligned for XLOPER12 (which has doubles and pointers).
+ */
+struct XLOPERArena::Block {
+  uint32_t magic;
+  uint32_t reserved;
+  Block *overflow;  // chain, starting from the primary block
+  Block *last;      // primary block only: current block for strings
+  XCHAR *next;      // next free string character
+  XCHAR *end;       // end of string space
+};
+
+XLOPERArena::Block *XLOPERArena::AllocateBlock(size_t grid_bytes, size_t string_units) {
+
+  static_assert(sizeof(Block) % sizeof(double) == 0, "arena block header breaks alignment");
+
+  size_t size = sizeof(Block) + grid_bytes + string_units * sizeof(XCHAR);
+  Block *block = reinterpret_cast<Block*>(malloc(size));
+  if (!block) return 0;
+
+  block->magic = XLOPER_ARENA_MAGIC;
+  block->reserved = 0;
+  block->overflow = 0;
+  block->last = block;
+  block->next = reinterpret_cast<XCHAR*>(reinterpret_cast<char*>(block + 1) + grid_bytes);
+  block->end = block->next + string_units;
+
+  return block;
+}
+
+XLOPERArena::XLOPERArena(LPXLOPER12 x) : block_(0) {
+  if (IsArenaArray(x)) block_ = reinterpret_cast<Block*>(x->val.array.lparray) - 1;
+}
+
+bool XLOPERArena::Allocate(LPXLOPER12 x, int rows, int cols, size_t string_units) {
+
+  size_t count = (size_t)rows * cols;
+  block_ = (rows > 0 && cols > 0) ? AllocateBlock(count * sizeof(XLOPER12), string_units) : 0;
+
+  if (!block_) {
+    x->xltype = xltypeErr;
+    x->val.err = xlerrValue;
+    return false;
+  }
+
+  LPXLOPER12 grid = reinterpret_cast<LPXLOPER12>(block_ + 1);
+  for (size_t i = 0; i < count; i++) grid[i].xltype = xltypeNil;
+
+  x->xltype = xltypeMulti | xlbitDLLFree;
+  x->val.array.rows = rows;
+  x->val.array.columns = cols;
+  x->val.array.lparray = grid;
+
+  return true;
+}
+
+XCHAR *XLOPERArena::Reserve(size_t units) {
+
+  Block *last = block_->last;
+  if ((size_t)(last->end - last->next) >= units) return last->next;
+
+  size_t size = units < MIN_OVERFLOW_UNITS ? MIN_OVERFLOW_UNITS : units;
+  Block *block = AllocateBlock(0, size);
+  if (!block) return 0;
+
+  last->overflow = block;
+  block_->last = block;
+  return block->next;
+}
+
+const XCHAR *XLOPERArena::SetString(LPXLOPER12 cell, const char *source, size_t length) {
+
+  // reserve the worst case, convert, then keep only what we used
+
+  XCHAR *str = block_ ? Reserve(Transcode::Utf16Bound(length) + 1) : 0;
+  if (!str) {
+    cell->xltype = xltypeErr;
+    cell->val.err = xlerrValue;
+    return 0;
+  }
+
+  size_t units = Transcode::Utf8ToUtf16(source, length, reinterpret_cast<uint16_t*>(str + 1));
+  if (units > MAX_STRING_UNITS) {
+    units = MAX_STRING_UNITS;
+    if (str[units] >= 0xD800 && str[units] <= 0xDBFF) units--; // don't split a pair
+  }
+  str[0] = (XCHAR)units;
+  block_->last->next = str + units + 1;
+
+  ShareString(cell, str);
+  return str;
+}
+
+bool XLOPERArena::IsArenaArray(LPXLOPER12 x) {
+  if (x->xltype != (xltypeMulti | xlbitDLLFree) || !x->val.array.lparray) return false;
+  return (reinterpret_cast<Block*>(x->val.array.lparray) - 1)->magic == XLOPER_ARENA_MAGIC;
+}
+
+void XLOPERArena::Release(LPXLOPER12 x) {
+
+  if (IsArenaArray(x)) {
+    Block *block = reinterpret_cast<Block*>(x->val.array.lparray) - 1;
+    block->magic = 0;
+    while (block) {
+      Block *overflow = block->overflow;
+      free(block);
+      block = overflow;
+    }
+  }
+
+  x->xltype = xltypeNil;
+  x->val.err = xlerrNull;
+}
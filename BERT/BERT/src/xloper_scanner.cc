@@ -0,0 +1,333 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "xloper_scanner.h"
+#include "transcode.h"
+#include "work_pool.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+// tile size for the fill pass. XLOPER12 is 32 bytes (x64), so a tile is 
+// 32K of the grid.
+#define SCAN_TILE_ROWS    64
+#define SCAN_TILE_COLS    16
+
+/**
+ * output for one column of the range: either a slice of the packed array
+ * (starting at offset), or a column array. unpacked columns have type nil 
+ * and use the cell converter.
+ *
+ * the NA bitset is allocated up front if the column has any empty cells,
+ * so blocks can be filled in parallel. for strings, the dictionary and its
+ * values are the array's unless we're building per-block dictionaries.
+ */
+struct XLOPERRangeScanner::Column {
+  MessageUtilities::TypeFlags type;
+  BERTBuffers::Array *target;
+  int offset;
+  double *reals;
+  int32_t *integers;
+  std::string *logicals;
+  std::string *na;
+  std::unordered_map<std::string, int> *dictionary;
+  google::protobuf::RepeatedPtrField<std::string> *values;
+};
+
+/** per-block dictionary for parallel string arrays, merged afterwards */
+struct XLOPERRangeScanner::BlockDictionary {
+  std::unordered_map<std::string, int> dictionary;
+  google::protobuf::RepeatedPtrField<std::string> values;
+};
+
+MessageUtilities::TypeFlags XLOPERRangeScanner::PackedType(DWORD xltypes) {
+
+  DWORD values = xltypes & ~(xltypeNil | xltypeMissing | xlbitXLFree | xlbitDLLFree);
+
+  if (values == xltypeStr) return MessageUtilities::TypeFlags::string;
+  if (values == xltypeBool) return MessageUtilities::TypeFlags::logical;
+  if (values == xltypeInt) return MessageUtilities::TypeFlags::integer;
+  if (values && !(values & ~(xltypeNum | xltypeInt))) return MessageUtilities::TypeFlags::real;
+
+  return MessageUtilities::TypeFlags::nil;
+}
+
+void XLOPERRangeScanner::InitPacked(BERTBuffers::Array *arr, MessageUtilities::TypeFlags packed_type, int length, bool na) {
+
+  switch (packed_type) {
+  case MessageUtilities::TypeFlags::real: arr->mutable_reals()->Resize(length, 0); break;
+  case MessageUtilities::TypeFlags::logical: arr->mutable_logicals()->assign(MessageUtilities::BitsetLength(length), 0); break;
+  default: arr->mutable_integers()->Resize(length, 0); break;
+  }
+
+  if (na) arr->mutable_na()->assign(MessageUtilities::BitsetLength(length), 0);
+
+  arr->set_packed_type(packed_type);
+  arr->set_packed_length(length);
+}
+
+void XLOPERRangeScanner::FillTile(Column &column, LPXLOPER12 cell, int stride, int first_row, int last_row, std::string &str, CellConverter converter) {
+
+  int index = column.offset + first_row;
+  int end = column.offset + last_row;
+
+  // switch on the column type outside of the loop; within a column we only
+  // need to check for NA. NA values are already zero.
+
+  switch (column.type) {
+  case MessageUtilities::TypeFlags::real:
+    for (; index < end; index++, cell += stride) {
+      if (cell->xltype & xltypeNum) column.reals[index] = cell->val.num;
+      else if (cell->xltype & xltypeInt) column.reals[index] = cell->val.w;
+      else MessageUtilities::SetBit(*column.na, index);
+    }
+    break;
+
+  case MessageUtilities::TypeFlags::integer:
+    for (; index < end; index++, cell += stride) {
+      if (cell->xltype & xltypeInt) column.integers[index] = cell->val.w;
+      else MessageUtilities::SetBit(*column.na, index);
+    }
+    break;
+
+  case MessageUtilities::TypeFlags::logical:
+    for (; index < end; index++, cell += stride) {
+      if (cell->xltype & xltypeBool) {
+        if (cell->val.xbool) MessageUtilities::SetBit(*column.logicals, index);
+      }
+      else MessageUtilities::SetBit(*column.na, index);
+    }
+    break;
+
+  case MessageUtilities::TypeFlags::string:
+    for (; index < end; index++, cell += stride) {
+      if (cell->xltype & xltypeStr) {
+
+        // see MessageUtilities::PackArray. look up before inserting, so we 
+        // don't copy the string for repeated values.
+
+        Transcode::Utf16ToUtf8(reinterpret_cast<const uint16_t*>(cell->val.str + 1), cell->val.str[0], str);
+        auto entry = column.dictionary->find(str);
+        if (entry != column.dictionary->end()) column.integers[index] = entry->second;
+        else {
+          int dictionary_index = (int)column.dictionary->size();
+          column.dictionary->emplace(str, dictionary_index);
+          column.values->Add()->assign(str);
+          column.integers[index] = dictionary_index;
+        }
+      }
+      else {
+        column.integers[index] = -1;
+        MessageUtilities::SetBit(*column.na, index);
+      }
+    }
+    break;
+
+  default:
+    for (; index < end; index++, cell += stride) {
+      converter(column.target->add_data(), cell);
+    }
+    break;
+  }
+
+}
+
+void XLOPERRangeScanner::FillRange(std::vector<Column> &columns, LPXLOPER12 grid, int rows, int begin, int end, CellConverter converter) {
+
+  // begin and end are element indexes (column-major) over the whole range,
+  // so the first and last column may be partial.
+
+  int cols = (int)columns.size();
+  int first_column = begin / rows;
+  int last_column = (end - 1) / rows;
+
+  int first_row = (first_column == last_column) ? begin % rows : 0;
+  int last_row = (first_column == last_column) ? (end - 1) % rows + 1 : rows;
+
+  std::string str;
+
+  for (int r0 = first_row; r0 < last_row; r0 += SCAN_TILE_ROWS) {
+    int r1 = (std::min)(last_row, r0 + SCAN_TILE_ROWS);
+    for (int c0 = first_column; c0 <= last_column; c0 += SCAN_TILE_COLS) {
+      int c1 = (std::min)(last_column + 1, c0 + SCAN_TILE_COLS);
+      for (int c = c0; c < c1; c++) {
+        int start = (c == first_column) ? (std::max)(r0, begin % rows) : r0;
+        int stop = (c == last_column) ? (std::min)(r1, (end - 1) % rows + 1) : r1;
+        if (start < stop) FillTile(columns[c], grid + (size_t)start * cols + c, cols, start, stop, str, converter);
+      }
+    }
+  }
+
+}
+
+void XLOPERRangeScanner::MergeDictionaries(BERTBuffers::Array *arr, std::vector<BlockDictionary> &blocks, int block_size) {
+
+  std::unordered_map<std::string, int> dictionary;
+  std::vector<int> map;
+
+  int length = arr->packed_length();
+  int32_t *integers = arr->mutable_integers()->mutable_data();
+
+  for (int i = 0; i < (int)blocks.size(); i++) {
+
+    auto &values = blocks[i].values;
+    map.resize(values.size());
+
+    for (int j = 0; j < values.size(); j++) {
+      auto entry = dictionary.find(values.Get(j));
+      if (entry != dictionary.end()) map[j] = entry->second;
+      else {
+        map[j] = (int)dictionary.size();
+        dictionary.emplace(values.Get(j), map[j]);
+        arr->add_dictionary()->swap(*values.Mutable(j));
+      }
+    }
+
+    int end = (std::min)(length, (i + 1) * block_size);
+    for (int index = i * block_size; index < end; index++) {
+      if (integers[index] >= 0) integers[index] = map[integers[index]];
+    }
+  }
+
+}
+
+bool XLOPERRangeScanner::Scan(BERTBuffers::Array *arr, LPXLOPER12 x, CellConverter converter) {
+  return Scan(arr, x, converter, WorkPool::Instance());
+}
+
+bool XLOPERRangeScanner::Scan(BERTBuffers::Array *arr, LPXLOPER12 x, CellConverter converter, WorkPool &pool) {
+
+  int cols = x->val.array.columns;
+  int rows = x->val.array.rows;
+  int length = rows * cols;
+
+  if (rows <= 0 || cols <= 0) return false;
+
+  LPXLOPER12 grid = x->val.array.lparray;
+
+  // pass 1: types, by column. this is linear over the grid.
+
+  std::vector<DWORD> column_types(cols, 0);
+  for (int r = 0; r < rows; r++) {
+    LPXLOPER12 row = grid + (size_t)r * cols;
+    for (int c = 0; c < cols; c++) column_types[c] |= row[c].xltype;
+  }
+
+  DWORD types = 0;
+  for (auto column_type : column_types) types |= column_type;
+
+  std::vector<Column> columns(cols);
+  std::vector<std::unordered_map<std::string, int>> dictionaries;
+
+  auto set_pointers = [](Column &column) {
+    if (column.type == MessageUtilities::TypeFlags::real) column.reals = column.target->mutable_reals()->mutable_data();
+    else if (column.type == MessageUtilities::TypeFlags::logical) column.logicals = column.target->mutable_logicals();
+    else if (column.type) column.integers = column.target->mutable_integers()->mutable_data();
+    column.na = column.target->na().length() ? column.target->mutable_na() : 0;
+    column.values = column.target->mutable_dictionary();
+  };
+
+  MessageUtilities::TypeFlags packed_type = PackedType(types);
+  bool parallel = (length >= PARALLEL_CONVERSION_THRESHOLD);
+
+  if (packed_type) {
+
+    // single type: one packed array, each column is a slice of it
+
+    InitPacked(arr, packed_type, length, (types & (xltypeNil | xltypeMissing)) != 0);
+    dictionaries.resize(1);
+
+    for (int c = 0; c < cols; c++) {
+      Column &column = columns[c];
+      column.type = packed_type;
+      column.target = arr;
+      column.offset = c * rows;
+      column.dictionary = &(dictionaries[0]);
+      set_pointers(column);
+    }
+
+  }
+  else {
+
+    // columnar, if that's worth doing: it has to be a table (a single row 
+    // or column gains nothing) and at least one column has to have a type.
+
+    if (rows < 2 || cols < 2) return false;
+
+    int typed_columns = 0;
+    for (auto column_type : column_types) {
+      if (PackedType(column_type)) typed_columns++;
+    }
+    if (!typed_columns) return false;
+
+    dictionaries.resize(cols);
+
+    for (int c = 0; c < cols; c++) {
+      Column &column = columns[c];
+      column.type = PackedType(column_types[c]);
+      column.target = arr->add_columns();
+      column.target->set_rows(rows);
+      column.target->set_cols(1);
+      column.offset = 0;
+      column.dictionary = &(dictionaries[c]);
+      if (column.type) InitPacked(column.target, column.type, rows, (column_types[c] & (xltypeNil | xltypeMissing)) != 0);
+      else column.target->mutable_data()->Reserve(rows);
+      set_pointers(column);
+    }
+
+  }
+
+  // pass 2: fill, in tiles. each column in a tile is a contiguous run in 
+  // the output, and unpacked columns are still filled in row order.
+
+  if (!parallel) FillRange(columns, grid, rows, 0, length, converter);
+
+  // large ranges are split into blocks and filled in parallel. columnar 
+  // blocks are whole columns, which are independent. packed blocks are
+  // runs of elements (aligned for the bitsets); for strings each block 
+  // has its own dictionary, and we merge them afterwards.
+
+  else if (!packed_type) {
+    int block_columns = (std::max)(1, PARALLEL_CONVERSION_BLOCK_SIZE / rows);
+    pool.ParallelFor(cols, block_columns, [&](int begin, int end) {
+      FillRange(columns, grid, rows, begin * rows, end * rows, converter);
+    });
+  }
+  else if (packed_type != MessageUtilities::TypeFlags::string) {
+    pool.ParallelFor(length, PARALLEL_CONVERSION_BLOCK_SIZE, [&](int begin, int end) {
+      FillRange(columns, grid, rows, begin, end, converter);
+    });
+  }
+  else {
+    std::vector<BlockDictionary> blocks((length - 1) / PARALLEL_CONVERSION_BLOCK_SIZE + 1);
+    pool.ParallelFor(length, PARALLEL_CONVERSION_BLOCK_SIZE, [&](int begin, int end) {
+      BlockDictionary &block = blocks[begin / PARALLEL_CONVERSION_BLOCK_SIZE];
+      std::vector<Column> block_columns(columns);
+      for (auto &column : block_columns) {
+        column.dictionary = &(block.dictionary);
+        column.values = &(block.values);
+      }
+      FillRange(block_columns, grid, rows, begin, end, converter);
+    });
+    MergeDictionaries(arr, blocks, PARALLEL_CONVERSION_BLOCK_SIZE);
+  }
+
+  return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * minimal XLOPER12 definitions, for building the array code (arena, 
+ * scanner, conversion) off windows. the windows build uses XLCALL.h from
+ * the excel SDK; this matches its layout for the types and fields we use,
+ * with XCHAR as a 16-bit character as it is there.
+ */
+
+typedef char16_t XCHAR;
+typedef int32_t RW;
+typedef int32_t COL;
+typedef uint32_t DWORD;
+typedef uint16_t WORD;
+typedef uint8_t BYTE;
+typedef int BOOL;
+typedef uintptr_t DWORD_PTR;
+typedef DWORD_PTR IDSHEET;
+
+typedef struct xlref12 {
+  RW rwFirst;
+  RW rwLast;
+  COL colFirst;
+  COL colLast;
+} XLREF12, *LPXLREF12;
+
+typedef struct xlmref12 {
+  WORD count;
+  XLREF12 reftbl[1];
+} XLMREF12, *LPXLMREF12;
+
+typedef struct xloper12 {
+  union {
+    double num;
+    XCHAR *str;
+    BOOL xbool;
+    int err;
+    int w;
+    struct {
+      WORD count;
+      XLREF12 ref;
+    } sref;
+    struct {
+      XLMREF12 *lpmref;
+      IDSHEET idSheet;
+    } mref;
+    struct {
+      struct xloper12 *lparray;
+      RW rows;
+      COL columns;
+    } array;
+    struct {
+      union {
+        int level;
+        int tbctrl;
+        IDSHEET idSheet;
+      } valflow;
+      RW rw;
+      COL col;
+      BYTE xlflow;
+    } flow;
+    struct {
+      union {
+        BYTE *lpbData;
+        void *hdata;
+      } h;
+      long cbData;
+    } bigdata;
+  } val;
+  DWORD xltype;
+} XLOPER12, *LPXLOPER12;
+
+#define xltypeNum        0x0001
+#define xltypeStr        0x0002
+#define xltypeBool       0x0004
+#define xltypeRef        0x0008
+#define xltypeErr        0x0010
+#define xltypeFlow       0x0020
+#define xltypeMulti      0x0040
+#define xltypeMissing    0x0080
+#define xltypeNil        0x0100
+#define xltypeSRef       0x0400
+#define xltypeInt        0x0800
+#define xltypeBigData    (xltypeStr | xltypeInt)
+
+#define xlbitXLFree      0x1000
+#define xlbitDLLFree     0x4000
+
+#define xlerrNull        0
+#define xlerrDiv0        7
+#define xlerrValue       15
+#define xlerrRef         23
+#define xlerrName        29
+#define xlerrNum         36
+#define xlerrNA          42
+#define xlerrGettingData 43
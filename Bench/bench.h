@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * helpers for the linux benchmarks and tests (see CMakeLists.txt). these
+ * only cover the platform-independent code; anything that talks to excel
+ * or COM is windows-only and isn't built here.
+ */
+namespace Bench {
+
+  /**
+   * best time of several runs, in microseconds. best rather than mean 
+   * because we want the cost of the code, not of whatever else the 
+   * machine was doing.
+   */
+  inline double Time(const std::function<void()> &function, int runs = 5) {
+    double best = 0;
+    for (int i = 0; i < runs; i++) {
+      auto start = std::chrono::high_resolution_clock::now();
+      function();
+      double elapsed = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+      if (!i || elapsed < best) best = elapsed;
+    }
+    return best;
+  }
+
+  /** fewer runs for big inputs, so the whole thing finishes in reasonable time */
+  inline int RunsFor(size_t size) {
+    return size >= (8 * 1024 * 1024) ? 3 : size >= (256 * 1024) ? 5 : 25;
+  }
+
+  /**
+   * stand-in for the windows named pipe (Common/pipe.cc): an os pipe with 
+   * the same 8k buffer, read in buffer-sized chunks and appended, which is 
+   * what Pipe::Read does. the writer is a separate thread, as the other 
+   * process would be.
+   */
+  class LocalPipe {
+  public:
+    static const int buffer_size = 8 * 1024;
+
+  public:
+    /** send data through the pipe; received gets everything that was read */
+    static void Transfer(const std::string &data, std::string &received) {
+
+      int fds[2];
+      if (pipe(fds)) {
+        perror("pipe");
+        exit(1);
+      }
+      fcntl(fds[1], F_SETPIPE_SZ, buffer_size);
+
+      std::thread writer([&]() {
+        const char *p = data.data();
+        size_t remaining = data.length();
+        while (remaining) {
+          ssize_t written = write(fds[1], p, remaining);
+          if (written <= 0) break;
+          p += written;
+          remaining -= written;
+        }
+        close(fds[1]);
+      });
+
+      char buffer[buffer_size];
+      received.clear();
+      while (true) {
+        ssize_t bytes = read(fds[0], buffer, buffer_size);
+        if (bytes <= 0) break;
+        received.append(buffer, bytes);
+      }
+
+      writer.join();
+      close(fds[0]);
+
+    }
+  };
+
+}
+
+/** for tests; fails the test (process) with a message */
+#define CHECK(condition) do { \
+  if (!(condition)) { \
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+    exit(1); \
+  } \
+} while (0)
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "message_utilities.h"
+#include "compression.h"
+
+#include <random>
+#include <vector>
+
+/**
+ * where does compression start to pay? for each payload type and size we
+ * send a framed result through a pipe (see Bench::LocalPipe) and unframe 
+ * it, once raw and once compressed, and report the end-to-end times. the 
+ * compressed time includes compressing and decompressing. the crossover 
+ * is the smallest message where compressed wins. on a local pipe there 
+ * isn't one, which is why DEFAULT_COMPRESSION_THRESHOLD is 0 (off).
+ *
+ * payloads are results as we actually send them: a packed string column 
+ * (a dictionary of a few hundred distinct values plus indexes), the same
+ * strings unpacked (one Variable per element, as for clients without 
+ * packed arrays), prices (reals with few distinct values) and random 
+ * reals, which don't compress at all.
+ *
+ * the pipe here is local and fast, so it's close to the best case for 
+ * sending raw. for slower transports, the codec throughput (compress,
+ * decompress and a plain copy of the serialized message, in MB/s) is 
+ * printed as well.
+ */
+
+typedef void(*PayloadFunction)(BERTBuffers::Array *arr, int count, std::mt19937 &rng);
+
+static const char *words[] = { "north", "south", "east", "west", "equity", "bond", "future", "option", "open", "closed", "pending", "settled" };
+
+static std::string Category(std::mt19937 &rng) {
+  std::string str = words[rng() % 12];
+  str += "-";
+  str += words[rng() % 12];
+  str += "-";
+  str += std::to_string(rng() % 4);
+  return str;
+}
+
+static void PackedStrings(BERTBuffers::Array *arr, int count, std::mt19937 &rng) {
+  for (int i = 0; i < 12 * 12 * 4; i++) arr->add_dictionary(Category(rng));
+  for (int i = 0; i < count; i++) arr->add_integers(rng() % arr->dictionary_size());
+  arr->set_packed_type(MessageUtilities::TypeFlags::string);
+  arr->set_packed_length(count);
+}
+
+static void UnpackedStrings(BERTBuffers::Array *arr, int count, std::mt19937 &rng) {
+  for (int i = 0; i < count; i++) arr->add_data()->set_str(Category(rng));
+}
+
+static void Prices(BERTBuffers::Array *arr, int count, std::mt19937 &rng) {
+  for (int i = 0; i < count; i++) arr->add_reals(100 + (rng() % 2000) * 0.05);
+  arr->set_packed_type(MessageUtilities::TypeFlags::real);
+  arr->set_packed_length(count);
+}
+
+static void RandomReals(BERTBuffers::Array *arr, int count, std::mt19937 &rng) {
+  std::uniform_real_distribution<double> distribution;
+  for (int i = 0; i < count; i++) arr->add_reals(distribution(rng));
+  arr->set_packed_type(MessageUtilities::TypeFlags::real);
+  arr->set_packed_length(count);
+}
+
+/** frame, send, unframe; returns the frame length */
+static size_t RoundTrip(const BERTBuffers::CallResponse &message, uint32_t compression_threshold, std::string &frame, std::string &received, BERTBuffers::CallResponse &result) {
+  MessageUtilities::Frame(message, frame, compression_threshold);
+  Bench::LocalPipe::Transfer(frame, received);
+  if (!MessageUtilities::Unframe(result, received.data(), (uint32_t)received.length())) {
+    fprintf(stderr, "unframe failed\n");
+    exit(1);
+  }
+  return frame.length();
+}
+
+int main(int argc, char **argv) {
+
+  struct { const char *name; PayloadFunction function; } payloads[] = {
+    { "packed strings", PackedStrings },
+    { "unpacked strings", UnpackedStrings },
+    { "prices", Prices },
+    { "random reals", RandomReals },
+  };
+
+  printf("compression threshold (default): %d (0 is off)\n", DEFAULT_COMPRESSION_THRESHOLD);
+
+  for (auto &payload : payloads) {
+
+    printf("\n%s\n", payload.name);
+    printf("%10s %12s %12s %12s %12s %8s\n", "elements", "bytes", "compressed", "raw us", "comp us", "speedup");
+
+    size_t crossover = 0;
+    std::string frame, received;
+    BERTBuffers::CallResponse message, result;
+
+    for (int count = 16; count <= (1 << 20); count *= 4) {
+
+      std::mt19937 rng(count);
+      message.Clear();
+      message.set_id(1);
+      payload.function(message.mutable_result()->mutable_arr(), count, rng);
+      message.mutable_result()->mutable_arr()->set_rows(count);
+      message.mutable_result()->mutable_arr()->set_cols(1);
+
+      size_t size = message.ByteSizeLong();
+      int runs = Bench::RunsFor(size);
+      size_t raw_length = 0, compressed_length = 0;
+
+      double raw = Bench::Time([&]() { raw_length = RoundTrip(message, 0, frame, received, result); }, runs);
+      double compressed = Bench::Time([&]() { compressed_length = RoundTrip(message, 1, frame, received, result); }, runs);
+
+      printf("%10d %12zu %12zu %12.1f %12.1f %8.2f\n", count, raw_length, compressed_length, raw, compressed, raw / compressed);
+      if (!crossover && compressed < raw) crossover = size;
+      if (crossover && compressed >= raw) crossover = 0; // noise; wait until it stays ahead
+
+    }
+
+    if (crossover) printf("crossover: ~%zu bytes\n", crossover);
+    else printf("crossover: none (compression never wins)\n");
+
+    // codec only, on the largest message
+
+    std::string serialized;
+    message.SerializeToString(&serialized);
+    std::string copy(serialized.length(), 0), restored(serialized.length(), 0);
+    std::vector<char> compressed(Compression::CompressBound(serialized.length()));
+    size_t compressed_length = 0;
+
+    double copy_time = Bench::Time([&]() { memcpy(&copy[0], serialized.data(), serialized.length()); });
+    double compress_time = Bench::Time([&]() { compressed_length = Compression::Compress(serialized.data(), serialized.length(), compressed.data(), compressed.size()); }, 3);
+    double decompress_time = Bench::Time([&]() { Compression::Decompress(compressed.data(), compressed_length, &restored[0], restored.length()); }, 3);
+
+    auto mbps = [&](double us) { return serialized.length() / us; };
+    printf("codec (%zu -> %zu bytes): copy %.0f MB/s, compress %.0f MB/s, decompress %.0f MB/s\n", serialized.length(), compressed_length, mbps(copy_time), mbps(compress_time), mbps(decompress_time));
+
+  }
+
+  return 0;
+
+}
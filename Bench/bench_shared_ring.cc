@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "message_utilities.h"
+#include "shared_ring.h"
+
+#include <random>
+
+/**
+ * shared-memory ring vs. the pipe, for large results. each round trip 
+ * frames a result, sends it, and unframes it on the other side: through
+ * the pipe (see Bench::LocalPipe) the frame is the whole message; through
+ * the ring the message is serialized into shared memory, and only the 
+ * descriptor goes through the pipe. the reader parses in place and 
+ * releases the block, as the control processes do.
+ *
+ * both rings are in this process, but they're separate mappings of the 
+ * same shared memory object, the same as across processes. the ring is
+ * mapped for the life of the process, so we run it around a couple of 
+ * times first; otherwise we'd be measuring first-touch page faults.
+ */
+
+static void Reals(BERTBuffers::Array *arr, int count, std::mt19937 &rng) {
+  std::uniform_real_distribution<double> distribution;
+  for (int i = 0; i < count; i++) arr->add_reals(distribution(rng));
+  arr->set_packed_type(MessageUtilities::TypeFlags::real);
+  arr->set_packed_length(count);
+}
+
+static void Strings(BERTBuffers::Array *arr, int count, std::mt19937 &rng) {
+  for (int i = 0; i < count; i++) arr->add_data()->set_str("value " + std::to_string(rng() % 100000));
+}
+
+static void Check(bool success, const char *what) {
+  if (!success) {
+    fprintf(stderr, "%s failed\n", what);
+    exit(1);
+  }
+}
+
+int main(int argc, char **argv) {
+
+  std::string name = "bert-bench-ring-" + std::to_string(getpid());
+  SharedRing writer, reader;
+  Check(writer.Create(name, DEFAULT_SHARED_RING_SIZE), "create ring");
+  Check(reader.Open(name), "open ring");
+
+  {
+    std::mt19937 rng(0);
+    BERTBuffers::CallResponse message, result;
+    std::string frame;
+    Reals(message.mutable_result()->mutable_arr(), 128 * 1024, rng);
+    for (uint64_t total = 0; total < writer.capacity() * 2; total += message.ByteSizeLong()) {
+      Check(MessageUtilities::FrameShared(message, &writer, frame, 0), "frame (warmup)");
+      Check(MessageUtilities::Unframe(result, frame.data(), (uint32_t)frame.length(), &reader), "unframe (warmup)");
+    }
+  }
+
+  printf("ring: %llu MB, threshold (default) %d\n", (unsigned long long)(writer.capacity() / (1024 * 1024)), DEFAULT_SHARED_RING_THRESHOLD);
+
+  struct { const char *name; void(*function)(BERTBuffers::Array*, int, std::mt19937&); } payloads[] = {
+    { "packed reals", Reals },
+    { "unpacked strings", Strings },
+  };
+
+  for (auto &payload : payloads) {
+
+    printf("\n%s\n", payload.name);
+    printf("%10s %12s %12s %12s %8s\n", "elements", "bytes", "pipe us", "ring us", "speedup");
+
+    std::string frame, received;
+    BERTBuffers::CallResponse message, result;
+
+    for (int count = 1024; count <= (1 << 21); count *= 2) {
+
+      std::mt19937 rng(count);
+      message.Clear();
+      message.set_id(1);
+      payload.function(message.mutable_result()->mutable_arr(), count, rng);
+      size_t size = message.ByteSizeLong();
+
+      // the ring only takes messages that fit (with room to spare)
+
+      if (size > writer.capacity() / 2) break;
+      int runs = Bench::RunsFor(size);
+
+      double pipe_time = Bench::Time([&]() {
+        MessageUtilities::Frame(message, frame);
+        Bench::LocalPipe::Transfer(frame, received);
+        Check(MessageUtilities::Unframe(result, received.data(), (uint32_t)received.length()), "unframe (pipe)");
+      }, runs);
+
+      double ring_time = Bench::Time([&]() {
+        Check(MessageUtilities::FrameShared(message, &writer, frame, 0), "frame (ring)");
+        Bench::LocalPipe::Transfer(frame, received);
+        Check(MessageUtilities::Unframe(result, received.data(), (uint32_t)received.length(), &reader), "unframe (ring)");
+      }, runs);
+
+      printf("%10d %12zu %12.1f %12.1f %8.2f\n", count, size, pipe_time, ring_time, pipe_time / ring_time);
+
+    }
+  }
+
+  reader.Close();
+  writer.Close();
+
+  return 0;
+
+}
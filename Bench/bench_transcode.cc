@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "transcode.h"
+
+#include <iconv.h>
+
+#include <codecvt>
+#include <locale>
+#include <random>
+#include <vector>
+
+/**
+ * Transcode vs. what it replaced. Convert used to call WideCharToMultiByte
+ * (and MultiByteToWideChar) twice per string, once to measure and once to
+ * convert into a static buffer, and then copy the result into a string. 
+ * the windows functions aren't available here, so the baselines are a 
+ * plain scalar converter called the same way (measure, convert, copy), 
+ * std::codecvt, and iconv. 
+ *
+ * inputs are string columns like the ones we convert from excel: each 
+ * string is converted separately, as Convert does per cell. 
+ */
+
+typedef std::vector<std::u16string> Column;
+
+/** scalar UTF-16 -> UTF-8, no validation tricks; measure if dest is null */
+static size_t ScalarUtf16ToUtf8(const char16_t *source, size_t length, char *dest) {
+  size_t count = 0;
+  for (size_t i = 0; i < length; i++) {
+    uint32_t c = source[i];
+    if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length && source[i + 1] >= 0xDC00 && source[i + 1] <= 0xDFFF) {
+      c = 0x10000 + ((c - 0xD800) << 10) + (source[++i] - 0xDC00);
+    }
+    else if (c >= 0xD800 && c <= 0xDFFF) c = 0xFFFD;
+    char buffer[4];
+    int n;
+    if (c < 0x80) { buffer[0] = (char)c; n = 1; }
+    else if (c < 0x800) { buffer[0] = (char)(0xC0 | (c >> 6)); buffer[1] = (char)(0x80 | (c & 0x3F)); n = 2; }
+    else if (c < 0x10000) { buffer[0] = (char)(0xE0 | (c >> 12)); buffer[1] = (char)(0x80 | ((c >> 6) & 0x3F)); buffer[2] = (char)(0x80 | (c & 0x3F)); n = 3; }
+    else { buffer[0] = (char)(0xF0 | (c >> 18)); buffer[1] = (char)(0x80 | ((c >> 12) & 0x3F)); buffer[2] = (char)(0x80 | ((c >> 6) & 0x3F)); buffer[3] = (char)(0x80 | (c & 0x3F)); n = 4; }
+    if (dest) memcpy(dest + count, buffer, n);
+    count += n;
+  }
+  return count;
+}
+
+/** the old WideStringToUtf8 pattern: measure, convert into a static buffer, copy */
+static std::string TwoPass(const char16_t *source, size_t length) {
+  static std::vector<char> buffer;
+  size_t u8_length = ScalarUtf16ToUtf8(source, length, 0);
+  if (buffer.size() < u8_length) buffer.resize(((u8_length / 1024) + 1) * 1024);
+  ScalarUtf16ToUtf8(source, length, buffer.data());
+  return std::string(buffer.data(), u8_length);
+}
+
+static Column MakeColumn(const std::vector<std::u16string> &alphabet, size_t min_length, size_t max_length, int count) {
+  std::mt19937 rng(count + (int)min_length);
+  Column column(count);
+  for (auto &str : column) {
+    size_t length = min_length + rng() % (max_length - min_length + 1);
+    while (str.length() < length) str += alphabet[rng() % alphabet.size()];
+  }
+  return column;
+}
+
+static std::vector<std::u16string> Alphabet(const char16_t *characters) {
+  std::vector<std::u16string> alphabet;
+  for (const char16_t *p = characters; *p; p++) {
+    if (*p >= 0xD800 && *p <= 0xDBFF) {
+      alphabet.push_back(std::u16string(p, 2));
+      p++;
+    }
+    else alphabet.push_back(std::u16string(1, *p));
+  }
+  return alphabet;
+}
+
+int main(int argc, char **argv) {
+
+  const int count = 100000;
+
+  struct { const char *name; Column column; } columns[] = {
+    { "ascii codes (4-12)", MakeColumn(Alphabet(u"ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"), 4, 12, count) },
+    { "ascii text (40-200)", MakeColumn(Alphabet(u"the quick brown fox jumps over a lazy dog, 0123456789. "), 40, 200, count) },
+    { "latin names (6-20)", MakeColumn(Alphabet(u"abcdefghijklmnopqrstuvwxyzéèüöäçñß"), 6, 20, count) },
+    { "cjk (2-10)", MakeColumn(Alphabet(u"日本語中文漢字한국어"), 2, 10, count) },
+    { "with emoji (10-30)", MakeColumn(Alphabet(u"abcdefgh \U0001F600\U0001F680\U0001F4C8"), 10, 30, count) },
+  };
+
+  iconv_t to_utf8 = iconv_open("UTF-8", "UTF-16LE");
+  iconv_t to_utf16 = iconv_open("UTF-16LE", "UTF-8");
+  std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> codecvt;
+
+  printf("%d strings per column; times in ms for the whole column\n", count);
+
+  for (auto &column : columns) {
+
+    std::vector<std::string> utf8(count);
+    std::string scratch;
+    std::vector<char> buffer;
+    std::vector<uint16_t> wide;
+
+    printf("\n%s\n", column.name);
+
+    // UTF-16 -> UTF-8 (excel/COM -> message)
+
+    double transcode = Bench::Time([&]() {
+      for (int i = 0; i < count; i++) Transcode::Utf16ToUtf8((const uint16_t*)column.column[i].data(), column.column[i].length(), utf8[i]);
+    }) / 1000;
+
+    double two_pass = Bench::Time([&]() {
+      for (int i = 0; i < count; i++) utf8[i] = TwoPass(column.column[i].data(), column.column[i].length());
+    }) / 1000;
+
+    double std_codecvt = Bench::Time([&]() {
+      for (int i = 0; i < count; i++) utf8[i] = codecvt.to_bytes(column.column[i]);
+    }) / 1000;
+
+    double iconv_time = Bench::Time([&]() {
+      for (int i = 0; i < count; i++) {
+        const std::u16string &str = column.column[i];
+        buffer.resize(str.length() * 3);
+        char *in = (char*)str.data(), *out = buffer.data();
+        size_t in_left = str.length() * 2, out_left = buffer.size();
+        iconv(to_utf8, &in, &in_left, &out, &out_left);
+        utf8[i].assign(buffer.data(), out - buffer.data());
+      }
+    }) / 1000;
+
+    for (int i = 0; i < count; i++) {
+      Transcode::Utf16ToUtf8((const uint16_t*)column.column[i].data(), column.column[i].length(), scratch);
+      CHECK(scratch == utf8[i]);
+    }
+
+    printf("  utf-16 -> utf-8:  transcode %7.2f   two-pass %7.2f   codecvt %7.2f   iconv %7.2f\n", transcode, two_pass, std_codecvt, iconv_time);
+
+    // UTF-8 -> UTF-16 (message -> excel)
+
+    double transcode_back = Bench::Time([&]() {
+      for (int i = 0; i < count; i++) {
+        wide.resize(Transcode::Utf16Bound(utf8[i].length()));
+        Transcode::Utf8ToUtf16(utf8[i].data(), utf8[i].length(), wide.data());
+      }
+    }) / 1000;
+
+    double codecvt_back = Bench::Time([&]() {
+      for (int i = 0; i < count; i++) {
+        std::u16string str = codecvt.from_bytes(utf8[i]);
+      }
+    }) / 1000;
+
+    double iconv_back = Bench::Time([&]() {
+      for (int i = 0; i < count; i++) {
+        wide.resize(utf8[i].length());
+        char *in = (char*)utf8[i].data(), *out = (char*)wide.data();
+        size_t in_left = utf8[i].length(), out_left = wide.size() * 2;
+        iconv(to_utf16, &in, &in_left, &out, &out_left);
+      }
+    }) / 1000;
+
+    printf("  utf-8 -> utf-16:  transcode %7.2f   %8s %7s   codecvt %7.2f   iconv %7.2f\n", transcode_back, "", "", codecvt_back, iconv_back);
+
+  }
+
+  iconv_close(to_utf8);
+  iconv_close(to_utf16);
+
+  return 0;
+
+}
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "convert.h"
+
+#include <random>
+#include <vector>
+
+/**
+ * ValidUTF8 against the validator it replaced (byte at a time, from 
+ * zedwood.com; it also let through overlong forms and values past 
+ * U+10FFFF), over string columns like the ones that come back from R: 
+ * each string is checked separately, with its length, as 
+ * CharsxpToString does.
+ */
+
+/** out of line, like ValidUTF8 (it was in convert.cc) */
+__attribute__((noinline)) static bool LegacyValidUTF8(const char *string, int len) {
+  if (len <= 0) len = (int)strlen(string);
+  int c, i, ix, n, j;
+  for (i = 0, ix = len; i < ix; i++) {
+    c = (unsigned char)string[i];
+    if (0x00 <= c && c <= 0x7f) n = 0;
+    else if ((c & 0xE0) == 0xC0) n = 1;
+    else if (c == 0xed && i < (ix - 1) && ((unsigned char)string[i + 1] & 0xa0) == 0xa0) return false;
+    else if ((c & 0xF0) == 0xE0) n = 2;
+    else if ((c & 0xF8) == 0xF0) n = 3;
+    else return false;
+    for (j = 0; j < n && i < ix; j++) {
+      if ((++i == ix) || (((unsigned char)string[i] & 0xC0) != 0x80)) return false;
+    }
+  }
+  return true;
+}
+
+typedef std::vector<std::string> Column;
+
+/** 
+ * strings of min-max characters from an alphabet of UTF-8 characters; 
+ * accent is the chance (per string) of one character from accents.
+ */
+static Column MakeColumn(int count, size_t min_length, size_t max_length, const std::vector<std::string> &alphabet, 
+  double accent = 0, const std::vector<std::string> &accents = std::vector<std::string>()) {
+
+  std::mt19937 rng((uint32_t)(count + min_length * 31 + max_length));
+  std::uniform_real_distribution<double> uniform(0, 1);
+  Column column(count);
+  for (auto &str : column) {
+    size_t length = min_length + rng() % (max_length - min_length + 1);
+    size_t accent_position = (uniform(rng) < accent) ? rng() % length : length;
+    for (size_t i = 0; i < length; i++) {
+      if (i == accent_position) str += accents[rng() % accents.size()];
+      else str += alphabet[rng() % alphabet.size()];
+    }
+  }
+  return column;
+}
+
+static std::vector<std::string> Characters(const char *characters) {
+  std::vector<std::string> alphabet;
+  for (const unsigned char *p = (const unsigned char*)characters; *p; ) {
+    int n = (*p < 0x80) ? 1 : (*p < 0xe0) ? 2 : (*p < 0xf0) ? 3 : 4;
+    alphabet.push_back(std::string((const char*)p, n));
+    p += n;
+  }
+  return alphabet;
+}
+
+int main(int argc, char **argv) {
+
+  const int count = 200000;
+
+  auto upper = Characters("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+  auto text = Characters("abcdefghijklmnopqrstuvwxyz      ,.ABCDEFGHIJ0123456789");
+  auto json = Characters("{}[]\":,0123456789abcdefghijklmnopqrstuvwxyz");
+  auto accents = Characters("\xc3\xa9\xc3\xa8\xc3\xbc\xc3\xb6\xc3\xb1\xc3\xa7\xc3\x85\xc3\x9f"); // éèüöñçÅß
+  auto cjk = Characters("\xe6\x9d\xb1\xe4\xba\xac\xe5\xa4\xa7\xe9\x98\xaa\xe5\x90\x8d\xe5\x8f\xa4\xe5\xb1\x8b\xe6\x9c\xad\xe5\xb9\x8c"); // 東京大阪名古屋札幌
+  auto emoji = Characters("\xf0\x9f\x98\x80\xf0\x9f\x93\x88\xf0\x9f\x9a\x80"); // 😀📈🚀
+
+  struct Case {
+    const char *name;
+    Column column;
+  };
+
+  std::vector<Case> cases = {
+    { "tickers (ASCII, 3-8)", MakeColumn(count, 3, 8, upper) },
+    { "names (10-30, 10% accented)", MakeColumn(count, 10, 30, text, 0.1, accents) },
+    { "free text (80-200, 5% emoji)", MakeColumn(count, 80, 200, text, 0.05, emoji) },
+    { "CJK place names (2-8)", MakeColumn(count, 2, 8, cjk) },
+    { "JSON blobs (ASCII, 1-4K)", MakeColumn(count / 100, 1024, 4096, json) }
+  };
+
+  printf("%-30s %10s %14s %14s %8s\n", "column", "MB", "legacy MB/s", "ValidUTF8 MB/s", "speedup");
+
+  for (const auto &test : cases) {
+
+    size_t bytes = 0;
+    for (const auto &str : test.column) {
+      bytes += str.length();
+      CHECK(ValidUTF8(str.c_str(), (int)str.length()));
+      CHECK(LegacyValidUTF8(str.c_str(), (int)str.length()));
+    }
+
+    int valid = 0;
+    double legacy = Bench::Time([&]() {
+      for (const auto &str : test.column) valid += LegacyValidUTF8(str.c_str(), (int)str.length());
+    }, 10);
+    double current = Bench::Time([&]() {
+      for (const auto &str : test.column) valid += ValidUTF8(str.c_str(), (int)str.length());
+    }, 10);
+    CHECK(valid == (int)test.column.size() * 20);
+
+    double mb = bytes / 1e6;
+    printf("%-30s %10.2f %14.0f %14.0f %7.2fx\n", test.name, mb, mb / (legacy / 1e6), mb / (current / 1e6), legacy / current);
+  }
+
+  return 0;
+
+}
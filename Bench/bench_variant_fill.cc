@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "variant_fill.h"
+
+#include <random>
+#include <vector>
+
+/**
+ * VariantArrayFill against the per-element path it replaced (a temporary
+ * CComVariant per cell from PackedElementToVariant, copied into the array
+ * by MultiDimSetAt). VARIANT is a small stand-in here: strings are heap
+ * copies, like BSTRs, and the old CComBSTR(const char*) conversion is a 
+ * scalar two-pass decode (measure, then convert), like MultiByteToWideChar.
+ */
+struct Variant {
+  enum { Empty, Null, Real, Integer, Boolean, String } vt = Empty;
+  union {
+    double real;
+    int32_t integer;
+    bool boolean;
+    uint16_t *str;
+  };
+
+  void Clear() {
+    if (vt == String) delete[] str;
+    vt = Empty;
+  }
+
+  void Copy(const Variant &source) {
+    vt = source.vt;
+    if (vt == String) {
+      size_t length = source.str[0];
+      str = new uint16_t[length + 1];
+      memcpy(str, source.str, (length + 1) * sizeof(uint16_t));
+    }
+    else real = source.real;
+  }
+};
+
+/** the same setters as Convert::VariantTraits, for the stand-in */
+struct VariantTraits {
+
+  typedef Variant Element;
+
+  static void SetReal(Variant *v, double value) { v->vt = Variant::Real; v->real = value; }
+  static void SetInteger(Variant *v, int32_t value) { v->vt = Variant::Integer; v->integer = value; }
+  static void SetBoolean(Variant *v, bool value) { v->vt = Variant::Boolean; v->boolean = value; }
+  static void SetNull(Variant *v) { v->vt = Variant::Null; }
+  static void SetMissing(Variant *v) { v->vt = Variant::Null; }
+  static void SetString(Variant *v, const uint16_t *units, size_t length) {
+    v->vt = Variant::String;
+    v->str = new uint16_t[length + 1];
+    v->str[0] = (uint16_t)length; // length prefix, like BSTR
+    memcpy(v->str + 1, units, length * sizeof(uint16_t));
+  }
+  static void SetVariable(Variant *v, const BERTBuffers::Variable &var) { v->vt = Variant::Null; }
+};
+
+/** scalar UTF-8 -> UTF-16; measure if dest is null */
+static size_t ScalarUtf8ToUtf16(const char *source, size_t length, uint16_t *dest) {
+  size_t count = 0;
+  const uint8_t *s = (const uint8_t*)source;
+  for (size_t i = 0; i < length; ) {
+    uint32_t c = s[i];
+    int n = (c < 0x80) ? 1 : (c < 0xE0) ? 2 : (c < 0xF0) ? 3 : 4;
+    if (i + n > length) break;
+    if (n == 2) c = ((c & 0x1F) << 6) | (s[i + 1] & 0x3F);
+    else if (n == 3) c = ((c & 0x0F) << 12) | ((s[i + 1] & 0x3F) << 6) | (s[i + 2] & 0x3F);
+    else if (n == 4) c = ((c & 0x07) << 18) | ((s[i + 1] & 0x3F) << 12) | ((s[i + 2] & 0x3F) << 6) | (s[i + 3] & 0x3F);
+    i += n;
+    if (c >= 0x10000) {
+      if (dest) {
+        dest[count] = (uint16_t)(0xD800 + ((c - 0x10000) >> 10));
+        dest[count + 1] = (uint16_t)(0xDC00 + ((c - 0x10000) & 0x3FF));
+      }
+      count += 2;
+    }
+    else {
+      if (dest) dest[count] = (uint16_t)c;
+      count++;
+    }
+  }
+  return count;
+}
+
+/** old PackedElementToVariant, with the stand-in */
+static Variant LegacyElement(const BERTBuffers::Array &arr, int index) {
+  Variant variant;
+  if (MessageUtilities::IsNA(arr, index)) {
+    variant.vt = Variant::Null;
+    return variant;
+  }
+  switch (arr.packed_type()) {
+  case MessageUtilities::TypeFlags::real:
+    VariantTraits::SetReal(&variant, arr.reals(index));
+    break;
+  case MessageUtilities::TypeFlags::integer:
+    VariantTraits::SetInteger(&variant, arr.integers(index));
+    break;
+  case MessageUtilities::TypeFlags::string: {
+    const std::string &str = MessageUtilities::PackedString(arr, index);
+    size_t length = ScalarUtf8ToUtf16(str.c_str(), str.length(), 0);
+    variant.vt = Variant::String;
+    variant.str = new uint16_t[length + 1];
+    variant.str[0] = (uint16_t)length;
+    ScalarUtf8ToUtf16(str.c_str(), str.length(), variant.str + 1);
+    break;
+  }
+  }
+  return variant;
+}
+
+/** per element: temporary, copy in (MultiDimSetAt), destroy the temporary */
+static void LegacyFill(Variant *grid, const BERTBuffers::Array &arr) {
+  int length = arr.rows() * arr.cols();
+  for (int i = 0; i < length; i++) {
+    Variant temporary = LegacyElement(arr, i);
+    grid[i].Copy(temporary);
+    temporary.Clear();
+  }
+}
+
+static void ClearGrid(std::vector<Variant> &grid) {
+  for (auto &v : grid) v.Clear();
+}
+
+int main(int argc, char **argv) {
+
+  const int cols = 10;
+  std::mt19937 rng(1);
+
+  // a realistic string column: a few hundred distinct labels, some NA
+
+  std::vector<std::string> labels(500);
+  for (size_t i = 0; i < labels.size(); i++) {
+    labels[i] = (i % 5) ? "ticker " + std::to_string(rng() % 100000) : "r\xc3\xa9gion " + std::to_string(i); // some non-ASCII
+  }
+
+  printf("%10s %10s %12s %12s %8s\n", "cells", "type", "legacy ms", "fill ms", "speedup");
+
+  for (int cells : { 10 * 1000, 100 * 1000, 1000 * 1000, 4000 * 1000 }) {
+
+    int rows = cells / cols;
+    int runs = Bench::RunsFor((size_t)cells * 8);
+
+    for (uint32_t type : { MessageUtilities::TypeFlags::real, MessageUtilities::TypeFlags::integer, MessageUtilities::TypeFlags::string }) {
+
+      BERTBuffers::Array arr;
+      arr.set_rows(rows);
+      arr.set_cols(cols);
+      arr.set_packed_type(type);
+      arr.set_packed_length(cells);
+
+      if (type == MessageUtilities::TypeFlags::real) {
+        for (int i = 0; i < cells; i++) arr.add_reals(rng() * 0.001);
+      }
+      else if (type == MessageUtilities::TypeFlags::integer) {
+        for (int i = 0; i < cells; i++) arr.add_integers((int32_t)rng());
+      }
+      else {
+        for (const auto &label : labels) arr.add_dictionary(label);
+        for (int i = 0; i < cells; i++) arr.add_integers(rng() % labels.size());
+        std::string na(MessageUtilities::BitsetLength(cells), 0);
+        for (int i = 0; i < cells; i += 97) MessageUtilities::SetBit(na, i);
+        arr.set_na(na);
+      }
+
+      std::vector<Variant> legacy_grid(cells), fill_grid(cells);
+
+      double legacy = Bench::Time([&]() {
+        ClearGrid(legacy_grid);
+        LegacyFill(legacy_grid.data(), arr);
+      }, runs);
+
+      double fill = Bench::Time([&]() {
+        ClearGrid(fill_grid);
+        VariantArrayFill<VariantTraits>::Fill(fill_grid.data(), rows, cols, arr, false, false);
+      }, runs);
+
+      for (int i = 0; i < cells; i++) {
+        CHECK(legacy_grid[i].vt == fill_grid[i].vt);
+        if (fill_grid[i].vt == Variant::String) CHECK(!memcmp(legacy_grid[i].str, fill_grid[i].str, (fill_grid[i].str[0] + 1) * sizeof(uint16_t)));
+        else if (fill_grid[i].vt != Variant::Null) CHECK(legacy_grid[i].real == fill_grid[i].real);
+      }
+
+      const char *name = (type == MessageUtilities::TypeFlags::real) ? "real" : (type == MessageUtilities::TypeFlags::integer) ? "integer" : "string";
+      printf("%10d %10s %12.2f %12.2f %7.2fx\n", cells, name, legacy / 1000, fill / 1000, legacy / fill);
+
+      ClearGrid(legacy_grid);
+      ClearGrid(fill_grid);
+
+    }
+  }
+
+  return 0;
+
+}
@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "xloper_scanner.h"
+#include "xloper_arena.h"
+#include "xloper_fill.h"
+#include "work_pool.h"
+
+#include <climits>
+#include <random>
+#include <vector>
+
+/**
+ * the two bulk conversions that run on the pool: excel -> message 
+ * (XLOPERRangeScanner) and message -> excel (XLOPERArrayFill, which is 
+ * what VariableToXLOPER calls for arrays). 
+ *
+ * first conversion time against thread count, with the default threshold
+ * and block size. then the numbers PARALLEL_CONVERSION_THRESHOLD and 
+ * PARALLEL_CONVERSION_BLOCK_SIZE come from: 
+ *
+ *  - pool overhead: the cost of a parallel loop (queueing, waking workers 
+ *    and waiting for them), and the cost per block. these are means, not 
+ *    best times, since waking is the cost we're after.
+ *  - threshold: serial against parallel fill by array size. the threshold
+ *    should be where parallel starts to win. with one core it never does,
+ *    so we also show the smallest size where the loop cost is under 1% of
+ *    the serial fill, which is where it stops mattering.
+ *  - block size: parallel fill of one array by block size, and the 
+ *    smallest block where the per-block cost is under 1% of its fill. 
+ *    past that, smaller is better for balance.
+ *
+ * each thread count gets its own pool (threads includes the calling 
+ * thread). results are only meaningful up to the number of cores.
+ */
+
+static BERTBuffers::Variable *CellToVariable(BERTBuffers::Variable *var, LPXLOPER12 x) {
+  var->set_nil(true);
+  return var;
+}
+
+/** packed arrays only, so nothing goes through the general case */
+struct BenchTraits {
+  static void SetVariable(LPXLOPER12 x, const BERTBuffers::Variable &var, XLOPERArena &arena) { x->xltype = xltypeNil; }
+};
+
+typedef XLOPERArrayFill<BenchTraits> Fill;
+
+/** allocate and fill, as VariableToXLOPER does */
+static void ToArena(WorkPool &pool, const BERTBuffers::Array &arr, XLOPER12 &result, 
+  int threshold = PARALLEL_CONVERSION_THRESHOLD, int block_size = PARALLEL_CONVERSION_BLOCK_SIZE) {
+
+  XLOPERArena arena;
+  size_t units = 0;
+  for (const auto &str : arr.dictionary()) units += XLOPERArena::StringUnits(str.length());
+  CHECK(arena.Allocate(&result, arr.rows(), arr.cols(), units));
+  Fill::Fill(arena, result.val.array.lparray, arr.rows(), arr.cols(), arr, false, false, pool, threshold, block_size);
+
+}
+
+static double FillTime(WorkPool &pool, const BERTBuffers::Array &arr, int threshold, int block_size) {
+  XLOPER12 result;
+  return Bench::Time([&]() {
+    ToArena(pool, arr, result, threshold, block_size);
+    XLOPERArena::Release(&result);
+  }, Bench::RunsFor((size_t)arr.rows() * arr.cols()));
+}
+
+static BERTBuffers::Array PackedReals(std::mt19937 &rng, int rows, int cols) {
+  BERTBuffers::Array arr;
+  arr.set_rows(rows);
+  arr.set_cols(cols);
+  arr.set_packed_type(MessageUtilities::TypeFlags::real);
+  arr.set_packed_length(rows * cols);
+  for (int i = 0; i < rows * cols; i++) arr.add_reals(rng() * 0.001);
+  return arr;
+}
+
+static BERTBuffers::Array PackedStrings(std::mt19937 &rng, int rows, int cols) {
+  BERTBuffers::Array arr;
+  arr.set_rows(rows);
+  arr.set_cols(cols);
+  arr.set_packed_type(MessageUtilities::TypeFlags::string);
+  arr.set_packed_length(rows * cols);
+  for (int i = 0; i < 1000; i++) arr.add_dictionary("label " + std::to_string(rng()));
+  for (int i = 0; i < rows * cols; i++) arr.add_integers(rng() % 1000);
+  return arr;
+}
+
+int main(int argc, char **argv) {
+
+  const int rows = 100 * 1000, cols = 40; // 4M cells
+  int cores = (int)std::thread::hardware_concurrency();
+
+  std::vector<int> thread_counts = { 1, 2, 4 };
+  if (cores > 4) thread_counts.push_back(cores);
+
+  // excel grid: numbers and strings, alternating columns
+
+  std::mt19937 rng(1);
+  std::vector<std::u16string> strings(1000);
+  for (size_t i = 0; i < strings.size(); i++) {
+    std::u16string body = u"row label ";
+    for (char c : std::to_string(rng())) body += (char16_t)c;
+    strings[i] = std::u16string(1, (char16_t)body.length()) + body;
+  }
+
+  std::vector<XLOPER12> numbers((size_t)rows * cols), mixed((size_t)rows * cols);
+  for (size_t i = 0; i < numbers.size(); i++) {
+    numbers[i].xltype = xltypeNum;
+    numbers[i].val.num = rng() * 0.001;
+    if ((i % cols) & 1) {
+      mixed[i].xltype = xltypeStr;
+      mixed[i].val.str = &(strings[rng() % strings.size()][0]);
+    }
+    else mixed[i] = numbers[i];
+  }
+
+  auto multi = [&](std::vector<XLOPER12> &cells) {
+    XLOPER12 x;
+    x.xltype = xltypeMulti;
+    x.val.array.rows = rows;
+    x.val.array.columns = cols;
+    x.val.array.lparray = cells.data();
+    return x;
+  };
+  XLOPER12 number_grid = multi(numbers), mixed_grid = multi(mixed);
+
+  // packed arrays for the other direction
+
+  BERTBuffers::Array packed_reals = PackedReals(rng, rows, cols), packed_strings = PackedStrings(rng, rows, cols);
+
+  printf("%d x %d (%d cells), %d cores; times in ms (speedup vs. 1 thread)\n\n", rows, cols, rows * cols, cores);
+  printf("%8s %18s %18s %18s %18s\n", "threads", "scan numbers", "scan table", "fill reals", "fill strings");
+
+  double base[4] = { 0, 0, 0, 0 };
+
+  for (int threads : thread_counts) {
+
+    WorkPool pool(threads - 1);
+    double times[4];
+
+    times[0] = Bench::Time([&]() {
+      BERTBuffers::Array arr;
+      arr.set_rows(rows);
+      arr.set_cols(cols);
+      CHECK(XLOPERRangeScanner::Scan(&arr, &number_grid, CellToVariable, pool));
+    }, 3);
+
+    times[1] = Bench::Time([&]() {
+      BERTBuffers::Array arr;
+      arr.set_rows(rows);
+      arr.set_cols(cols);
+      CHECK(XLOPERRangeScanner::Scan(&arr, &mixed_grid, CellToVariable, pool));
+    }, 3);
+
+    times[2] = FillTime(pool, packed_reals, PARALLEL_CONVERSION_THRESHOLD, PARALLEL_CONVERSION_BLOCK_SIZE);
+    times[3] = FillTime(pool, packed_strings, PARALLEL_CONVERSION_THRESHOLD, PARALLEL_CONVERSION_BLOCK_SIZE);
+
+    printf("%8d", threads);
+    for (int i = 0; i < 4; i++) {
+      times[i] /= 1000;
+      if (threads == 1) base[i] = times[i];
+      printf(" %10.2f (%4.2fx)", times[i], base[i] / times[i]);
+    }
+    printf("\n");
+
+    pool.Shutdown();
+
+  }
+
+  // the rest uses one pool, at least 2 threads so there's a handoff
+
+  int threads = (std::max)(cores, 2);
+  WorkPool pool(threads - 1);
+
+  // pool overhead: mean time for an empty loop with one block per thread,
+  // and with 1024 blocks
+
+  std::atomic<int> sink(0);
+  auto empty = [&](int begin, int end) { sink += end - begin; };
+  auto mean = [&](int blocks, int runs) {
+    pool.ParallelFor(blocks, 1, empty); // start threads
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < runs; i++) pool.ParallelFor(blocks, 1, empty);
+    return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+  };
+  double call_us = mean(threads, 10000);
+  double block_us = (mean(1024, 100) - call_us) / 1023;
+
+  printf("\n%d threads: parallel loop %.1fus, plus %.2fus per block\n", threads, call_us, block_us);
+
+  // threshold: serial (threshold past the size) against parallel (threshold 
+  // 0), by size. 40 columns, default block size.
+
+  printf("\n%10s %12s %12s %12s %12s %12s %12s\n", "cells", "reals ser", "reals par", "speedup", "strings ser", "strings par", "speedup");
+
+  int crossover = 0, amortized = 0;
+  for (int size = 16 * 1024; size <= 4 * 1024 * 1024; size *= 2) {
+    int size_rows = size / cols;
+    BERTBuffers::Array reals = PackedReals(rng, size_rows, cols), strs = PackedStrings(rng, size_rows, cols);
+    double rs = FillTime(pool, reals, INT_MAX, PARALLEL_CONVERSION_BLOCK_SIZE);
+    double rp = FillTime(pool, reals, 0, PARALLEL_CONVERSION_BLOCK_SIZE);
+    double ss = FillTime(pool, strs, INT_MAX, PARALLEL_CONVERSION_BLOCK_SIZE);
+    double sp = FillTime(pool, strs, 0, PARALLEL_CONVERSION_BLOCK_SIZE);
+    printf("%10d %10.0fus %10.0fus %11.2fx %10.0fus %10.0fus %11.2fx\n", size_rows * cols, rs, rp, rs / rp, ss, sp, ss / sp);
+    if (rp <= rs && sp <= ss) { if (!crossover) crossover = size; }
+    else crossover = 0;
+    if (!amortized && call_us < 0.01 * (std::min)(rs, ss)) amortized = size;
+  }
+
+  printf("\nthreshold: parallel wins from ");
+  if (crossover) printf("%d cells", crossover);
+  else printf("(never, on %d core%s)", cores, cores == 1 ? "" : "s");
+  printf("; loop cost is under 1%% from %d cells (default %d)\n", amortized, PARALLEL_CONVERSION_THRESHOLD);
+
+  // block size: one 4M-cell array, 4096 rows, so blocks of 4K-1M cells are 
+  // 1-256 columns.
+
+  const int block_rows = 4096, block_cols = 1024;
+  BERTBuffers::Array block_reals = PackedReals(rng, block_rows, block_cols), block_strings = PackedStrings(rng, block_rows, block_cols);
+
+  printf("\n%10s %10s %12s %12s\n", "block", "blocks", "reals", "strings");
+  int block = 0;
+  for (int block_size = 4 * 1024; block_size <= 1024 * 1024; block_size *= 2) {
+    int blocks = (block_cols - 1) / (block_size / block_rows) + 1;
+    double rt = FillTime(pool, block_reals, 0, block_size), st = FillTime(pool, block_strings, 0, block_size);
+    printf("%10d %10d %10.0fus %10.0fus\n", block_size, blocks, rt, st);
+    if (!block && block_us < 0.01 * (std::min)(rt, st) / blocks) block = block_size;
+  }
+  printf("\nblock size: per-block cost is under 1%% from %d cells (default %d)\n", block, PARALLEL_CONVERSION_BLOCK_SIZE);
+
+  pool.Shutdown();
+  CHECK(sink.load() > 0);
+
+  return 0;
+
+}
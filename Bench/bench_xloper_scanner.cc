@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "xloper_scanner.h"
+#include "transcode.h"
+
+#include <random>
+#include <vector>
+
+/**
+ * XLOPERRangeScanner vs. the per-cell conversion it replaced (one Variable 
+ * per cell, walking the row-major grid in column-major order), on 
+ * synthetic grids from 1k to 10M cells. grids are plain XLOPER12 arrays, 
+ * as excel passes them; string cells share a pool of string bodies.
+ *
+ * the per-cell baseline is skipped for the largest grids, where it needs
+ * more memory than the machine may have (one message per cell).
+ */
+
+#define LEGACY_MAX_CELLS (1000 * 1000)
+
+/** the old XLOPERToVariable, for scalars; also the scanner's cell converter */
+static BERTBuffers::Variable *CellToVariable(BERTBuffers::Variable *var, LPXLOPER12 x) {
+  if (x->xltype & xltypeStr) Transcode::Utf16ToUtf8((const uint16_t*)(x->val.str + 1), x->val.str[0], *(var->mutable_str()));
+  else if (x->xltype & xltypeNum) var->set_real(x->val.num);
+  else if (x->xltype & xltypeInt) var->set_integer(x->val.w);
+  else if (x->xltype & xltypeBool) var->set_boolean(x->val.xbool ? true : false);
+  else if (x->xltype & xltypeMissing) var->set_missing(true);
+  else if (x->xltype & xltypeNil) var->set_nil(true);
+  else var->mutable_err()->set_type(BERTBuffers::ErrorType::GENERIC);
+  return var;
+}
+
+/** the old multi conversion */
+static void LegacyConvert(BERTBuffers::Array *arr, LPXLOPER12 x) {
+  int cols = x->val.array.columns;
+  int rows = x->val.array.rows;
+  arr->set_cols(cols);
+  arr->set_rows(rows);
+  for (int c = 0; c < cols; c++) {
+    for (int r = 0; r < rows; r++) {
+      CellToVariable(arr->add_data(), &(x->val.array.lparray[r * cols + c]));
+    }
+  }
+}
+
+/** cell kinds for a column */
+enum class Kind { number, sparse_number, string, logical };
+
+struct Grid {
+
+  std::vector<XLOPER12> cells;
+  std::vector<std::u16string> strings; // length-prefixed bodies
+  XLOPER12 multi;
+
+  Grid(int rows, const std::vector<Kind> &kinds) : strings(1000) {
+
+    std::mt19937 rng(rows);
+    for (size_t i = 0; i < strings.size(); i++) {
+      std::u16string body = u"item ";
+      for (char c : std::to_string(rng() % 100000)) body += (char16_t)c;
+      strings[i] = std::u16string(1, (char16_t)body.length()) + body;
+    }
+
+    int cols = (int)kinds.size();
+    cells.resize((size_t)rows * cols);
+
+    for (int r = 0; r < rows; r++) {
+      for (int c = 0; c < cols; c++) {
+        XLOPER12 &x = cells[(size_t)r * cols + c];
+        switch (kinds[c]) {
+        case Kind::sparse_number:
+          if (rng() % 20 == 0) {
+            x.xltype = xltypeNil;
+            break;
+          }
+          // fall through
+        case Kind::number:
+          x.xltype = xltypeNum;
+          x.val.num = (rng() % 100000) * 0.01;
+          break;
+        case Kind::string:
+          x.xltype = xltypeStr;
+          x.val.str = &(strings[rng() % strings.size()][0]);
+          break;
+        case Kind::logical:
+          x.xltype = xltypeBool;
+          x.val.xbool = rng() & 1;
+          break;
+        }
+      }
+    }
+
+    multi.xltype = xltypeMulti;
+    multi.val.array.rows = rows;
+    multi.val.array.columns = cols;
+    multi.val.array.lparray = cells.data();
+
+  }
+};
+
+int main(int argc, char **argv) {
+
+  struct { const char *name; std::vector<Kind> kinds; } layouts[] = {
+    { "numbers", { Kind::number, Kind::number, Kind::number, Kind::number, Kind::number, Kind::number, Kind::number, Kind::number, Kind::number, Kind::number } },
+    { "numbers with blanks", { Kind::sparse_number, Kind::sparse_number, Kind::sparse_number, Kind::sparse_number, Kind::sparse_number, Kind::sparse_number, Kind::sparse_number, Kind::sparse_number, Kind::sparse_number, Kind::sparse_number } },
+    { "strings", { Kind::string, Kind::string, Kind::string, Kind::string, Kind::string, Kind::string, Kind::string, Kind::string, Kind::string, Kind::string } },
+    { "logicals", { Kind::logical, Kind::logical, Kind::logical, Kind::logical, Kind::logical, Kind::logical, Kind::logical, Kind::logical, Kind::logical, Kind::logical } },
+    { "table (columnar)", { Kind::string, Kind::number, Kind::number, Kind::sparse_number, Kind::logical, Kind::string, Kind::number, Kind::number, Kind::number, Kind::number } },
+  };
+
+  printf("10 columns; times in ms\n");
+
+  for (auto &layout : layouts) {
+
+    printf("\n%s\n", layout.name);
+    printf("%10s %12s %10s %12s %8s\n", "cells", "scan", "ns/cell", "per-cell", "speedup");
+
+    for (int cells = 1000; cells <= 10 * 1000 * 1000; cells *= 10) {
+
+      Grid grid(cells / (int)layout.kinds.size(), layout.kinds);
+      int runs = Bench::RunsFor((size_t)cells * sizeof(XLOPER12));
+
+      double scan = Bench::Time([&]() {
+        BERTBuffers::Array arr;
+        arr.set_rows(grid.multi.val.array.rows);
+        arr.set_cols(grid.multi.val.array.columns);
+        CHECK(XLOPERRangeScanner::Scan(&arr, &grid.multi, CellToVariable));
+        CHECK(MessageUtilities::ArrayLength(arr) == cells);
+      }, runs) / 1000;
+
+      if (cells <= LEGACY_MAX_CELLS) {
+        double legacy = Bench::Time([&]() {
+          BERTBuffers::Array arr;
+          LegacyConvert(&arr, &grid.multi);
+        }, runs) / 1000;
+        printf("%10d %12.3f %10.1f %12.3f %8.1f\n", cells, scan, scan * 1e6 / cells, legacy, legacy / scan);
+      }
+      else printf("%10d %12.3f %10.1f %12s %8s\n", cells, scan, scan * 1e6 / cells, "-", "-");
+
+    }
+  }
+
+  return 0;
+
+}
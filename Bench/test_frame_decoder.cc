@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "frame_decoder.h"
+
+#include <vector>
+
+/**
+ * FrameDecoder with callers that reuse one read buffer, the way the pipe
+ * readers do: a frame split over two reads, with the first part either 
+ * appended (copied) or fed and drained before the buffer is reused.
+ */
+
+static std::string MakeFrame(size_t payload_length, char fill) {
+  std::string frame(FRAME_HEADER_SIZE + payload_length, fill);
+  FrameDecoder::WriteHeader(&(frame[0]), (uint32_t)payload_length);
+  for (size_t i = 0; i < payload_length; i++) frame[FRAME_HEADER_SIZE + i] = (char)(fill + i % 7);
+  return frame;
+}
+
+/** "read" part of a message into the reused buffer, scribbling over the rest */
+static void Read(std::vector<char> &buffer, const std::string &message, size_t offset, size_t length) {
+  memset(buffer.data(), 0x55, buffer.size());
+  memcpy(buffer.data(), message.c_str() + offset, length);
+}
+
+static void TestAppendTwoChunks() {
+
+  std::string frame = MakeFrame(1000, 'a');
+  std::vector<char> buffer(600);
+  FrameDecoder decoder;
+  const char *data;
+  uint32_t length;
+
+  // first read is partial (ERROR_MORE_DATA): append, and read again into 
+  // the same buffer without draining
+
+  Read(buffer, frame, 0, 600);
+  decoder.Append(buffer.data(), 600);
+
+  Read(buffer, frame, 600, frame.length() - 600);
+  decoder.Feed(buffer.data(), frame.length() - 600);
+
+  CHECK(decoder.Next(&data, &length));
+  CHECK(length == frame.length());
+  CHECK(!memcmp(data, frame.c_str(), length));
+  CHECK(!decoder.Next(&data, &length));
+  CHECK(decoder.errors() == 0);
+
+}
+
+static void TestAppendAfterHeldChunk() {
+
+  // a complete frame fed in place, then another appended in two parts 
+  // before the first was taken out: the held chunk is copied first, so
+  // the frames stay in order
+
+  std::string first = MakeFrame(10, 'x'), second = MakeFrame(300, 'y');
+  std::vector<char> buffer(256);
+  FrameDecoder decoder;
+  const char *data;
+  uint32_t length;
+
+  decoder.Feed(first.c_str(), first.length());
+
+  Read(buffer, second, 0, 200);
+  decoder.Append(buffer.data(), 200);
+  Read(buffer, second, 200, second.length() - 200);
+  decoder.Append(buffer.data(), second.length() - 200);
+  memset(buffer.data(), 0x55, buffer.size());
+
+  CHECK(decoder.Next(&data, &length));
+  CHECK(length == first.length() && !memcmp(data, first.c_str(), length));
+  CHECK(decoder.Next(&data, &length));
+  CHECK(length == second.length() && !memcmp(data, second.c_str(), length));
+  CHECK(!decoder.Next(&data, &length));
+
+}
+
+static void TestFeedAndDrain() {
+
+  // Feed doesn't copy, but draining with Next before the next read keeps
+  // the partial frame
+
+  std::string frame = MakeFrame(1000, 'b');
+  std::vector<char> buffer(400);
+  FrameDecoder decoder;
+  const char *data;
+  uint32_t length;
+
+  size_t offset = 0;
+  int frames = 0;
+  while (offset < frame.length()) {
+    size_t chunk = std::min(buffer.size(), frame.length() - offset);
+    Read(buffer, frame, offset, chunk);
+    offset += chunk;
+    decoder.Feed(buffer.data(), chunk);
+    while (decoder.Next(&data, &length)) {
+      CHECK(length == frame.length() && !memcmp(data, frame.c_str(), length));
+      frames++;
+    }
+  }
+  CHECK(frames == 1);
+
+}
+
+static void TestResync() {
+
+  // garbage before a frame is skipped and counted
+
+  std::string frame = MakeFrame(20, 'c');
+  std::string message = std::string("garbage") + frame + frame;
+  FrameDecoder decoder;
+  const char *data;
+  uint32_t length;
+
+  decoder.Append(message.c_str(), message.length());
+  CHECK(decoder.Next(&data, &length) && length == frame.length() && !memcmp(data, frame.c_str(), length));
+  CHECK(decoder.Next(&data, &length) && length == frame.length());
+  CHECK(!decoder.Next(&data, &length));
+  CHECK(decoder.errors() > 0);
+
+}
+
+int main(int argc, char **argv) {
+
+  TestAppendTwoChunks();
+  TestAppendAfterHeldChunk();
+  TestFeedAndDrain();
+  TestResync();
+
+  printf("ok\n");
+  return 0;
+
+}
@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "convert.h"
+
+#include <vector>
+
+/**
+ * ValidUTF8 against RFC 3629: overlong forms, surrogates, code points past
+ * U+10FFFF and truncated sequences are invalid. named edge cases first, 
+ * then exhaustive (1-3 bytes) and sampled (4 bytes) comparisons with a 
+ * plain decode-and-check reference. each case is also run after ASCII 
+ * prefixes of different lengths, so the sequence lands in the block, word
+ * and byte paths of the ASCII scan, and at the end of the string.
+ */
+
+/** decode, then check range, minimal length and surrogates */
+static bool Reference(const unsigned char *s, int len) {
+  static const uint32_t minimum[] = { 0, 0, 0x80, 0x800, 0x10000 };
+  for (int i = 0; i < len; ) {
+    uint32_t c = s[i];
+    int n;
+    if (c < 0x80) n = 1;
+    else if ((c & 0xe0) == 0xc0) { n = 2; c &= 0x1f; }
+    else if ((c & 0xf0) == 0xe0) { n = 3; c &= 0x0f; }
+    else if ((c & 0xf8) == 0xf0) { n = 4; c &= 0x07; }
+    else return false;
+    if (i + n > len) return false;
+    for (int j = 1; j < n; j++) {
+      if ((s[i + j] & 0xc0) != 0x80) return false;
+      c = (c << 6) | (s[i + j] & 0x3f);
+    }
+    if (n > 1 && c < minimum[n]) return false;
+    if (c >= 0xd800 && c <= 0xdfff) return false;
+    if (c > 0x10ffff) return false;
+    i += n;
+  }
+  return true;
+}
+
+/** check bytes alone, and after ASCII prefixes of 1 to 40 bytes */
+static bool Valid(const std::string &bytes) {
+  bool result = ValidUTF8(bytes.c_str(), (int)bytes.length());
+  for (int prefix = 1; prefix <= 40; prefix++) {
+    std::string padded = std::string(prefix, 'a') + bytes;
+    if (ValidUTF8(padded.c_str(), (int)padded.length()) != result) {
+      fprintf(stderr, "prefix %d changes the result\n", prefix);
+      exit(1);
+    }
+  }
+  return result;
+}
+
+static void TestEdgeCases() {
+
+  // valid, at each length and the range limits
+
+  CHECK(Valid("plain ASCII"));
+  CHECK(Valid("\x7f"));
+  CHECK(Valid("\xc2\x80"));             // U+0080
+  CHECK(Valid("\xdf\xbf"));             // U+07FF
+  CHECK(Valid("\xe0\xa0\x80"));         // U+0800
+  CHECK(Valid("\xed\x9f\xbf"));         // U+D7FF, below the surrogates
+  CHECK(Valid("\xee\x80\x80"));         // U+E000, above them
+  CHECK(Valid("\xef\xbf\xbf"));         // U+FFFF
+  CHECK(Valid("\xf0\x90\x80\x80"));     // U+10000
+  CHECK(Valid("\xf4\x8f\xbf\xbf"));     // U+10FFFF
+  CHECK(Valid("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80")); // é € 😀
+
+  // overlong forms
+
+  CHECK(!Valid("\xc0\xaf"));            // '/'
+  CHECK(!Valid("\xc0\x80"));            // NUL
+  CHECK(!Valid("\xc1\xbf"));            // largest overlong 2-byte
+  CHECK(!Valid("\xe0\x80\xaf"));
+  CHECK(!Valid("\xe0\x9f\xbf"));        // largest overlong 3-byte
+  CHECK(!Valid("\xf0\x80\x80\xaf"));
+  CHECK(!Valid("\xf0\x8f\xbf\xbf"));    // largest overlong 4-byte
+
+  // surrogates, alone and paired (CESU-8)
+
+  CHECK(!Valid("\xed\xa0\x80"));        // U+D800
+  CHECK(!Valid("\xed\xbf\xbf"));        // U+DFFF
+  CHECK(!Valid("\xed\xa0\xbd\xed\xb8\x80"));
+
+  // past U+10FFFF, and bytes that never appear
+
+  CHECK(!Valid("\xf4\x90\x80\x80"));    // U+110000
+  CHECK(!Valid("\xf7\xbf\xbf\xbf"));
+  CHECK(!Valid("\xf5\x80\x80\x80"));
+  CHECK(!Valid("\xf8\x88\x80\x80\x80")); // old 5-byte form
+  CHECK(!Valid("\xfc\x84\x80\x80\x80\x80"));
+  CHECK(!Valid("\xfe"));
+  CHECK(!Valid("\xff"));
+
+  // stray continuations, and truncated tails
+
+  CHECK(!Valid("\x80"));
+  CHECK(!Valid("\xbf"));
+  CHECK(!Valid("ab\x80" "cd"));
+  CHECK(!Valid("\xc3"));
+  CHECK(!Valid("\xe2\x82"));            // € less one byte
+  CHECK(!Valid("\xf0\x9f\x98"));        // 😀 less one byte
+  CHECK(!Valid("\xf0\x9f"));
+  CHECK(!Valid("\xe2\x82" "a"));        // interrupted by ASCII
+  CHECK(!Valid("\xf0\x9f\x98" "a"));
+
+  // the length is respected: a valid string cut inside a sequence
+
+  const char *euro = "x\xe2\x82\xac";
+  CHECK(ValidUTF8(euro, 4));
+  CHECK(!ValidUTF8(euro, 3));
+  CHECK(!ValidUTF8(euro, 2));
+
+  // len <= 0 means null-terminated
+
+  CHECK(ValidUTF8("caf\xc3\xa9", 0));
+  CHECK(!ValidUTF8("caf\xc3", -1));
+
+}
+
+/** 
+ * short strings (under 16 bytes) that start with ASCII are checked with 
+ * overlapping loads; put one stray byte, then one é, at every position of
+ * every short length, so each lands in the head, the tail and the overlap.
+ */
+static void TestShortStrings() {
+  for (int len = 1; len <= 17; len++) {
+    std::string ascii(len, 'a');
+    CHECK(ValidUTF8(ascii.c_str(), len));
+    for (int i = 0; i < len; i++) {
+      std::string stray = ascii;
+      stray[i] = '\x80';
+      CHECK(!ValidUTF8(stray.c_str(), len));
+      if (i + 1 < len) {
+        std::string accent = ascii;
+        accent[i] = '\xc3';
+        accent[i + 1] = '\xa9';
+        CHECK(ValidUTF8(accent.c_str(), len));
+      }
+    }
+  }
+}
+
+/** every 1-, 2- and 3-byte string */
+static void TestExhaustive() {
+  unsigned char s[3];
+  for (int a = 0; a < 256; a++) {
+    s[0] = (unsigned char)a;
+    CHECK(ValidUTF8((const char*)s, 1) == Reference(s, 1));
+    for (int b = 0; b < 256; b++) {
+      s[1] = (unsigned char)b;
+      CHECK(ValidUTF8((const char*)s, 2) == Reference(s, 2));
+      for (int c = 0; c < 256; c++) {
+        s[2] = (unsigned char)c;
+        if (ValidUTF8((const char*)s, 3) != Reference(s, 3)) {
+          fprintf(stderr, "mismatch: %02x %02x %02x\n", a, b, c);
+          exit(1);
+        }
+      }
+    }
+  }
+}
+
+/** 4-byte strings: every lead and second byte, with boundary values after */
+static void TestFourByte() {
+  const unsigned char tails[] = { 0x00, 0x41, 0x7f, 0x80, 0x8f, 0x90, 0xbf, 0xc0, 0xf4, 0xff };
+  unsigned char s[4];
+  for (int a = 0; a < 256; a++) {
+    for (int b = 0; b < 256; b++) {
+      for (unsigned char c : tails) {
+        for (unsigned char d : tails) {
+          s[0] = (unsigned char)a;
+          s[1] = (unsigned char)b;
+          s[2] = c;
+          s[3] = d;
+          if (ValidUTF8((const char*)s, 4) != Reference(s, 4)) {
+            fprintf(stderr, "mismatch: %02x %02x %02x %02x\n", a, b, c, d);
+            exit(1);
+          }
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+
+  TestEdgeCases();
+  TestShortStrings();
+  TestExhaustive();
+  TestFourByte();
+
+  printf("ok\n");
+  return 0;
+
+}
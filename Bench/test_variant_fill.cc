@@ -0,0 +1,324 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "variant_fill.h"
+
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+/**
+ * VariantArrayFill with a mock element in place of VARIANT: each cell 
+ * records what was set, how many times, and on which thread.
+ */
+struct Cell {
+  enum Kind { Empty, Real, Integer, Boolean, Null, Missing, String, Other };
+  Kind kind = Empty;
+  double real = 0;
+  int32_t integer = 0;
+  bool boolean = false;
+  const uint16_t *units = 0;
+  std::u16string text;
+  int sets = 0;
+  std::thread::id thread;
+};
+
+/** if set, the first element of the fill (real 0) stalls, so workers take the other blocks */
+static bool stall_first = false;
+
+struct MockTraits {
+
+  typedef Cell Element;
+
+  static void Touch(Cell *cell, Cell::Kind kind) {
+    cell->kind = kind;
+    cell->sets++;
+    cell->thread = std::this_thread::get_id();
+  }
+
+  static void SetReal(Cell *cell, double value) {
+    if (stall_first && value == 0) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    Touch(cell, Cell::Real);
+    cell->real = value;
+  }
+  static void SetInteger(Cell *cell, int32_t value) {
+    Touch(cell, Cell::Integer);
+    cell->integer = value;
+  }
+  static void SetBoolean(Cell *cell, bool value) {
+    Touch(cell, Cell::Boolean);
+    cell->boolean = value;
+  }
+  static void SetNull(Cell *cell) { Touch(cell, Cell::Null); }
+  static void SetMissing(Cell *cell) { Touch(cell, Cell::Missing); }
+  static void SetString(Cell *cell, const uint16_t *units, size_t length) {
+    Touch(cell, Cell::String);
+    cell->units = units;
+    cell->text.assign(units, units + length);
+  }
+  static void SetVariable(Cell *cell, const BERTBuffers::Variable &var) { Touch(cell, Cell::Other); }
+};
+
+typedef VariantArrayFill<MockTraits> Fill;
+
+static bool IsString(const Cell &cell, const std::u16string &expected) {
+  return cell.kind == Cell::String && cell.text == expected;
+}
+
+static bool IsReal(const Cell &cell, double expected) {
+  return cell.kind == Cell::Real && cell.real == expected;
+}
+
+static void CheckSetOnce(const std::vector<Cell> &grid) {
+  for (const auto &cell : grid) CHECK(cell.sets == 1);
+}
+
+/** unpacked 3x2 array, with names: ordering, offsets and per-type setters */
+static void TestOrderAndNames() {
+
+  BERTBuffers::Array arr;
+  arr.set_rows(3);
+  arr.set_cols(2);
+  arr.add_rownames("r1");
+  arr.add_rownames("r2");
+  arr.add_rownames("r3");
+  arr.add_colnames("c1");
+  arr.add_colnames("c2");
+
+  // column 1: real, integer, boolean; column 2: string, nil, missing
+
+  arr.add_data()->set_real(1.5);
+  arr.add_data()->set_integer(7);
+  arr.add_data()->set_boolean(true);
+  arr.add_data()->set_str("x");
+  arr.add_data()->set_nil(true);
+  arr.add_data()->set_missing(true);
+
+  // names on both sides: 4 x 3 grid, column-major
+
+  std::vector<Cell> grid(4 * 3);
+  Fill::Fill(grid.data(), 4, 3, arr, true, true);
+  CheckSetOnce(grid);
+
+  CHECK(IsString(grid[0], u""));
+  CHECK(IsString(grid[1], u"r1") && IsString(grid[2], u"r2") && IsString(grid[3], u"r3"));
+  CHECK(IsString(grid[4], u"c1") && IsString(grid[8], u"c2"));
+
+  CHECK(IsReal(grid[5], 1.5));
+  CHECK(grid[6].kind == Cell::Integer && grid[6].integer == 7);
+  CHECK(grid[7].kind == Cell::Boolean && grid[7].boolean);
+  CHECK(IsString(grid[9], u"x"));
+  CHECK(grid[10].kind == Cell::Null);
+  CHECK(grid[11].kind == Cell::Missing);
+
+  // row names only: 3 x 3, values start at column 1, row 0
+
+  std::vector<Cell> rows_only(3 * 3);
+  Fill::Fill(rows_only.data(), 3, 3, arr, true, false);
+  CheckSetOnce(rows_only);
+  CHECK(IsString(rows_only[0], u"r1") && IsString(rows_only[2], u"r3"));
+  CHECK(IsReal(rows_only[3], 1.5) && IsString(rows_only[6], u"x"));
+
+  // column names only: 4 x 2, values start at row 1
+
+  std::vector<Cell> cols_only(4 * 2);
+  Fill::Fill(cols_only.data(), 4, 2, arr, false, true);
+  CheckSetOnce(cols_only);
+  CHECK(IsString(cols_only[0], u"c1") && IsString(cols_only[4], u"c2"));
+  CHECK(IsReal(cols_only[1], 1.5) && IsString(cols_only[5], u"x") && cols_only[7].kind == Cell::Missing);
+
+  // no names
+
+  std::vector<Cell> bare(3 * 2);
+  Fill::Fill(bare.data(), 3, 2, arr, false, false);
+  CheckSetOnce(bare);
+  CHECK(IsReal(bare[0], 1.5) && IsString(bare[3], u"x") && bare[5].kind == Cell::Missing);
+
+  // anything else goes to SetVariable
+
+  BERTBuffers::Array other;
+  other.set_rows(1);
+  other.set_cols(1);
+  other.add_data()->mutable_err();
+  Cell cell;
+  Fill::Fill(&cell, 1, 1, other, false, false);
+  CHECK(cell.kind == Cell::Other && cell.sets == 1);
+
+}
+
+/** packed strings: dictionary entries are converted once and shared; NA and bad indexes */
+static void TestPackedStrings() {
+
+  BERTBuffers::Array arr;
+  arr.set_rows(4);
+  arr.set_cols(2);
+  arr.set_packed_type(MessageUtilities::TypeFlags::string);
+  arr.set_packed_length(8);
+  arr.add_dictionary("alpha");
+  arr.add_dictionary("\xce\xb2-gamma"); // β
+  arr.add_dictionary("");
+
+  int entries[] = { 0, 1, 0, -1, 2, 1, 0, 5 };
+  for (int entry : entries) arr.add_integers(entry);
+
+  std::string na(MessageUtilities::BitsetLength(8), 0);
+  MessageUtilities::SetBit(na, 2); // valid entry, but NA
+  arr.set_na(na);
+
+  std::vector<Cell> grid(8);
+  Fill::Fill(grid.data(), 4, 2, arr, false, false);
+  CheckSetOnce(grid);
+
+  CHECK(IsString(grid[0], u"alpha"));
+  CHECK(IsString(grid[1], u"β-gamma"));
+  CHECK(grid[2].kind == Cell::Null);
+  CHECK(grid[3].kind == Cell::Null);
+  CHECK(IsString(grid[4], u""));
+  CHECK(IsString(grid[5], u"β-gamma"));
+  CHECK(IsString(grid[6], u"alpha"));
+  CHECK(grid[7].kind == Cell::Null);
+
+  // same entry, same converted string, across columns
+
+  CHECK(grid[0].units == grid[6].units);
+  CHECK(grid[1].units == grid[5].units);
+  CHECK(grid[0].units != grid[1].units);
+
+}
+
+/** columnar arrays: per-column types and dictionaries */
+static void TestColumnar() {
+
+  BERTBuffers::Array arr;
+  arr.set_rows(3);
+  arr.set_cols(2);
+  arr.add_colnames("n");
+  arr.add_colnames("s");
+
+  BERTBuffers::Array *reals = arr.add_columns();
+  reals->set_rows(3);
+  reals->set_cols(1);
+  reals->set_packed_type(MessageUtilities::TypeFlags::real);
+  reals->set_packed_length(3);
+  reals->add_reals(1);
+  reals->add_reals(2);
+  reals->add_reals(3);
+  std::string na(1, 0);
+  MessageUtilities::SetBit(na, 1);
+  reals->set_na(na);
+
+  BERTBuffers::Array *strings = arr.add_columns();
+  strings->set_rows(3);
+  strings->set_cols(1);
+  strings->set_packed_type(MessageUtilities::TypeFlags::string);
+  strings->set_packed_length(3);
+  strings->add_dictionary("a");
+  strings->add_dictionary("b");
+  strings->add_integers(1);
+  strings->add_integers(0);
+  strings->add_integers(1);
+
+  std::vector<Cell> grid(4 * 2);
+  Fill::Fill(grid.data(), 4, 2, arr, false, true);
+  CheckSetOnce(grid);
+
+  CHECK(IsString(grid[0], u"n") && IsString(grid[4], u"s"));
+  CHECK(IsReal(grid[1], 1) && grid[2].kind == Cell::Null && IsReal(grid[3], 3));
+  CHECK(IsString(grid[5], u"b") && IsString(grid[6], u"a") && IsString(grid[7], u"b"));
+  CHECK(grid[5].units == grid[7].units);
+
+}
+
+/**
+ * large arrays are split into blocks of whole columns. each block runs on
+ * one thread, the calling thread runs the first; stalling that one makes 
+ * sure the workers pick up the rest.
+ */
+static void TestParallelSplit() {
+
+  const int data_rows = 16 * 1024, data_cols = 20;
+  const int block_columns = PARALLEL_CONVERSION_BLOCK_SIZE / data_rows;
+  CHECK(data_rows * data_cols >= PARALLEL_CONVERSION_THRESHOLD && block_columns == 2);
+
+  BERTBuffers::Array arr;
+  arr.set_rows(data_rows);
+  arr.set_cols(data_cols);
+  arr.set_packed_type(MessageUtilities::TypeFlags::real);
+  arr.set_packed_length(data_rows * data_cols);
+  for (int i = 0; i < data_rows * data_cols; i++) arr.add_reals(i);
+  for (int r = 0; r < data_rows; r++) arr.add_rownames("r");
+  for (int c = 0; c < data_cols; c++) arr.add_colnames("c");
+
+  int rows = data_rows + 1, cols = data_cols + 1;
+  std::vector<Cell> grid((size_t)rows * cols);
+
+  WorkPool pool(3);
+  stall_first = true;
+  Fill::Fill(grid.data(), rows, cols, arr, true, true, pool);
+  stall_first = false;
+  CheckSetOnce(grid);
+
+  std::thread::id caller = std::this_thread::get_id();
+  std::set<std::thread::id> threads;
+
+  for (int c = 0; c < data_cols; c++) {
+    const Cell *column = &(grid[(size_t)(c + 1) * rows]);
+    CHECK(IsString(column[0], u"c") && column[0].thread == caller);
+    std::thread::id block_thread = grid[(size_t)((c / block_columns) * block_columns + 1) * rows + 1].thread;
+    for (int r = 0; r < data_rows; r++) {
+      CHECK(IsReal(column[r + 1], (double)c * data_rows + r));
+      CHECK(column[r + 1].thread == block_thread);
+    }
+    if (c < block_columns) CHECK(block_thread == caller);
+    threads.insert(block_thread);
+  }
+  CHECK(threads.size() > 1);
+
+  // below the threshold, everything runs on the calling thread
+
+  BERTBuffers::Array small;
+  small.set_rows(1024);
+  small.set_cols(4);
+  small.set_packed_type(MessageUtilities::TypeFlags::real);
+  small.set_packed_length(4096);
+  for (int i = 0; i < 4096; i++) small.add_reals(i);
+
+  std::vector<Cell> small_grid(4096);
+  Fill::Fill(small_grid.data(), 1024, 4, small, false, false, pool);
+  CheckSetOnce(small_grid);
+  for (int i = 0; i < 4096; i++) CHECK(IsReal(small_grid[i], i) && small_grid[i].thread == caller);
+
+  pool.Shutdown();
+
+}
+
+int main(int argc, char **argv) {
+
+  TestOrderAndNames();
+  TestPackedStrings();
+  TestColumnar();
+  TestParallelSplit();
+
+  printf("ok\n");
+  return 0;
+
+}
@@ -0,0 +1,227 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench.h"
+#include "xloper_arena.h"
+
+#include <vector>
+
+/** compare an arena (excel) string with ASCII */
+static bool Equals(const XCHAR *str, const std::string &expected) {
+  if (str[0] != expected.length()) return false;
+  for (size_t i = 0; i < expected.length(); i++) {
+    if (str[i + 1] != (XCHAR)expected[i]) return false;
+  }
+  return true;
+}
+
+static void TestAllocate() {
+
+  XLOPER12 x;
+  XLOPERArena arena;
+  CHECK(arena.Allocate(&x, 3, 4, 64));
+  CHECK(x.xltype == (xltypeMulti | xlbitDLLFree));
+  CHECK(x.val.array.rows == 3 && x.val.array.columns == 4);
+  for (int i = 0; i < 12; i++) CHECK(x.val.array.lparray[i].xltype == xltypeNil);
+  CHECK(XLOPERArena::IsArenaArray(&x));
+  XLOPERArena::Release(&x);
+
+  // empty or negative shapes fail, and leave an error
+
+  XLOPER12 empty;
+  XLOPERArena empty_arena;
+  CHECK(!empty_arena.Allocate(&empty, 0, 4));
+  CHECK(empty.xltype == xltypeErr && empty.val.err == xlerrValue);
+  CHECK(!empty_arena.Allocate(&empty, -1, 1));
+
+  // no string space: strings still work, via overflow
+
+  XLOPER12 y;
+  XLOPERArena no_strings;
+  CHECK(no_strings.Allocate(&y, 1, 1));
+  CHECK(Equals(no_strings.SetString(y.val.array.lparray, "abc"), "abc"));
+  XLOPERArena::Release(&y);
+
+}
+
+static void TestStrings() {
+
+  XLOPER12 x;
+  XLOPERArena arena;
+  CHECK(arena.Allocate(&x, 2, 2, XLOPERArena::StringUnits(5) + XLOPERArena::StringUnits(0)));
+  LPXLOPER12 grid = x.val.array.lparray;
+
+  const XCHAR *hello = arena.SetString(grid, "hello");
+  CHECK(grid[0].xltype == xltypeStr && grid[0].val.str == hello);
+  CHECK(Equals(hello, "hello"));
+
+  // shared strings point at the same body
+
+  XLOPERArena::ShareString(grid + 1, hello);
+  CHECK(grid[1].xltype == xltypeStr && grid[1].val.str == hello);
+
+  // empty string
+
+  CHECK(arena.SetString(grid + 2, "", 0)[0] == 0);
+
+  // non-ASCII: é is one unit, the emoji is a surrogate pair
+
+  const XCHAR *str = arena.SetString(grid + 3, std::string("\xC3\xA9\xF0\x9F\x98\x80"));
+  CHECK(str[0] == 3 && str[1] == 0xE9 && str[2] == 0xD83D && str[3] == 0xDE00);
+
+  // attach to the array later to add more strings
+
+  XLOPERArena attached(&x);
+  CHECK(Equals(attached.SetString(grid + 1, "later"), "later"));
+  CHECK(Equals(hello, "hello"));
+
+  XLOPERArena::Release(&x);
+
+}
+
+/** 
+ * chaining: fill well past the primary block and the minimum overflow 
+ * size (32k units), and check that earlier strings aren't disturbed. 
+ */
+static void TestOverflow() {
+
+  const int count = 200;
+  XLOPER12 x;
+  XLOPERArena arena;
+  CHECK(arena.Allocate(&x, count, 1, 16));
+
+  std::vector<std::string> expected(count);
+  std::vector<const XCHAR*> stored(count);
+
+  for (int i = 0; i < count; i++) {
+    expected[i] = std::string(500 + i * 3, (char)('a' + i % 26));
+    stored[i] = arena.SetString(x.val.array.lparray + i, expected[i]);
+    CHECK(stored[i]);
+  }
+
+  // a single string bigger than an overflow block gets its own block
+
+  std::string big(40 * 1024, 'z');
+  XLOPER12 cell;
+  const XCHAR *big_stored = arena.SetString(&cell, big);
+  CHECK(big_stored && big_stored[0] == 32767);
+
+  for (int i = 0; i < count; i++) {
+    CHECK(x.val.array.lparray[i].val.str == stored[i]);
+    CHECK(Equals(stored[i], expected[i]));
+  }
+
+  XLOPERArena::Release(&x);
+
+}
+
+/** excel strings are limited to 32767 units; truncation must not split a pair */
+static void TestTruncation() {
+
+  std::string emoji = "\xF0\x9F\x98\x80";
+  XLOPER12 x;
+  XLOPERArena arena;
+  CHECK(arena.Allocate(&x, 3, 1));
+  LPXLOPER12 grid = x.val.array.lparray;
+
+  // the pair would straddle the limit: drop the whole pair
+
+  const XCHAR *str = arena.SetString(grid, std::string(32766, 'a') + emoji);
+  CHECK(str[0] == 32766 && str[32766] == 'a');
+
+  // the pair ends exactly at the limit: keep it
+
+  str = arena.SetString(grid + 1, std::string(32765, 'a') + emoji);
+  CHECK(str[0] == 32767 && str[32766] == 0xD83D && str[32767] == 0xDE00);
+
+  // plain overlong string
+
+  str = arena.SetString(grid + 2, std::string(32768, 'b'));
+  CHECK(str[0] == 32767 && str[32767] == 'b');
+
+  XLOPERArena::Release(&x);
+
+}
+
+static void TestIsArenaArray() {
+
+  // not multi, or not flagged
+
+  XLOPER12 number;
+  number.xltype = xltypeNum;
+  number.val.num = 1;
+  CHECK(!XLOPERArena::IsArenaArray(&number));
+
+  XLOPER12 x;
+  XLOPERArena arena;
+  CHECK(arena.Allocate(&x, 1, 1));
+  x.xltype = xltypeMulti;
+  CHECK(!XLOPERArena::IsArenaArray(&x));
+  x.xltype |= xlbitDLLFree;
+  CHECK(XLOPERArena::IsArenaArray(&x));
+
+  // a flagged array that we didn't build (no header in front of the grid)
+
+  std::vector<double> buffer(64, 0);
+  XLOPER12 other;
+  other.xltype = xltypeMulti | xlbitDLLFree;
+  other.val.array.lparray = reinterpret_cast<LPXLOPER12>(&buffer[32]);
+  other.val.array.rows = other.val.array.columns = 1;
+  CHECK(!XLOPERArena::IsArenaArray(&other));
+
+  // null grid
+
+  other.val.array.lparray = 0;
+  CHECK(!XLOPERArena::IsArenaArray(&other));
+
+  XLOPERArena::Release(&x);
+
+}
+
+static void TestRelease() {
+
+  XLOPER12 x;
+  XLOPERArena arena;
+  CHECK(arena.Allocate(&x, 10, 10, 8));
+  for (int i = 0; i < 100; i++) arena.SetString(x.val.array.lparray + i, std::string(1000, 'x')); // forces overflow blocks
+
+  XLOPERArena::Release(&x);
+  CHECK(x.xltype == xltypeNil);
+  CHECK(!XLOPERArena::IsArenaArray(&x));
+
+  // releasing something that isn't an arena array just resets it
+
+  XLOPER12 number;
+  number.xltype = xltypeNum;
+  XLOPERArena::Release(&number);
+  CHECK(number.xltype == xltypeNil);
+
+}
+
+int main(int argc, char **argv) {
+  TestAllocate();
+  TestStrings();
+  TestOverflow();
+  TestTruncation();
+  TestIsArenaArray();
+  TestRelease();
+  printf("ok\n");
+  return 0;
+}
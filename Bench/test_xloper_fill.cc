@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "bench.h"
+#include "xloper_fill.h"
+
+#include <climits>
+#include <vector>
+
+/**
+ * XLOPERArrayFill (VariableToXLOPER's array case): layout with names, 
+ * columnar arrays, and parallel fills matching serial ones.
+ */
+
+/** anything that isn't a plain value is marked with an error we can check */
+struct MockTraits {
+  static void SetVariable(LPXLOPER12 x, const BERTBuffers::Variable &var, XLOPERArena &arena) {
+    x->xltype = xltypeErr;
+    x->val.err = xlerrRef;
+  }
+};
+
+typedef XLOPERArrayFill<MockTraits> Fill;
+
+static bool Equals(const XLOPER12 &x, const std::string &expected) {
+  if (x.xltype != xltypeStr || x.val.str[0] != expected.length()) return false;
+  for (size_t i = 0; i < expected.length(); i++) {
+    if (x.val.str[i + 1] != (XCHAR)expected[i]) return false;
+  }
+  return true;
+}
+
+/** 
+ * allocate and fill, as VariableToXLOPER does (rows and cols include the
+ * names). string space is left to overflow, which is fine here.
+ */
+static LPXLOPER12 ToArena(XLOPER12 &x, const BERTBuffers::Array &arr, int rows, int cols, bool row_names, bool col_names, 
+  WorkPool &pool, int threshold = PARALLEL_CONVERSION_THRESHOLD, int block_size = PARALLEL_CONVERSION_BLOCK_SIZE) {
+  XLOPERArena arena;
+  CHECK(arena.Allocate(&x, rows, cols));
+  Fill::Fill(arena, x.val.array.lparray, rows, cols, arr, row_names, col_names, pool, threshold, block_size);
+  return x.val.array.lparray;
+}
+
+/** unpacked 2x2 with names: row-major, names in the first row and column */
+static void TestOrderAndNames(WorkPool &pool) {
+
+  BERTBuffers::Array arr;
+  arr.set_rows(2);
+  arr.set_cols(2);
+  arr.add_rownames("r1");
+  arr.add_rownames("r2");
+  arr.add_colnames("a");
+  arr.add_colnames("b");
+  arr.add_data()->set_real(1.5);               // r1, a
+  arr.add_data()->set_str("x");                // r2, a
+  arr.add_data()->set_boolean(true);           // r1, b
+  arr.add_data()->mutable_err();               // r2, b
+
+  XLOPER12 x;
+  LPXLOPER12 grid = ToArena(x, arr, 3, 3, true, true, pool);
+
+  CHECK(Equals(grid[0], ""));
+  CHECK(Equals(grid[1], "a") && Equals(grid[2], "b"));
+  CHECK(Equals(grid[3], "r1") && Equals(grid[6], "r2"));
+  CHECK(grid[4].xltype == xltypeNum && grid[4].val.num == 1.5);
+  CHECK(Equals(grid[7], "x"));
+  CHECK(grid[5].xltype == xltypeBool && grid[5].val.xbool);
+  CHECK(grid[8].xltype == xltypeErr && grid[8].val.err == xlerrRef);
+
+  XLOPERArena::Release(&x);
+
+}
+
+/** columnar: each column has its own type and dictionary */
+static void TestColumnar(WorkPool &pool) {
+
+  BERTBuffers::Array arr;
+  arr.set_rows(3);
+  arr.set_cols(2);
+
+  BERTBuffers::Array *reals = arr.add_columns();
+  reals->set_rows(3);
+  reals->set_cols(1);
+  reals->set_packed_type(MessageUtilities::TypeFlags::real);
+  reals->set_packed_length(3);
+  for (int i = 1; i <= 3; i++) reals->add_reals(i);
+  std::string na(1, 0);
+  MessageUtilities::SetBit(na, 1);
+  reals->set_na(na);
+
+  BERTBuffers::Array *strings = arr.add_columns();
+  strings->set_rows(3);
+  strings->set_cols(1);
+  strings->set_packed_type(MessageUtilities::TypeFlags::string);
+  strings->set_packed_length(3);
+  strings->add_dictionary("a");
+  strings->add_dictionary("b");
+  strings->add_integers(1);
+  strings->add_integers(0);
+  strings->add_integers(5); // invalid entry -> NA
+
+  XLOPER12 x;
+  LPXLOPER12 grid = ToArena(x, arr, 3, 2, false, false, pool);
+
+  CHECK(grid[0].xltype == xltypeNum && grid[0].val.num == 1);
+  CHECK(grid[2].xltype == xltypeNil);
+  CHECK(grid[4].xltype == xltypeNum && grid[4].val.num == 3);
+  CHECK(Equals(grid[1], "b") && Equals(grid[3], "a"));
+  CHECK(grid[5].xltype == xltypeNil);
+
+  XLOPERArena::Release(&x);
+
+}
+
+/** 
+ * packed strings and reals with NAs and names, filled serially and in 
+ * parallel (small blocks, so there are many): the grids should match, 
+ * and parallel string cells share the up-front dictionary.
+ */
+static void TestParallelMatchesSerial(WorkPool &pool) {
+
+  const int rows = 1000, cols = 24;
+
+  for (auto type : { MessageUtilities::TypeFlags::real, MessageUtilities::TypeFlags::string }) {
+
+    BERTBuffers::Array arr;
+    arr.set_rows(rows);
+    arr.set_cols(cols);
+    arr.set_packed_type(type);
+    arr.set_packed_length(rows * cols);
+    for (int c = 0; c < cols; c++) arr.add_colnames("c" + std::to_string(c));
+    std::string na(MessageUtilities::BitsetLength(rows * cols), 0);
+    for (int i = 0; i < rows * cols; i++) {
+      if (type == MessageUtilities::TypeFlags::real) arr.add_reals(i * 0.5);
+      else arr.add_integers(i % 7);
+      if (i % 11 == 3) MessageUtilities::SetBit(na, i);
+    }
+    if (type == MessageUtilities::TypeFlags::string) {
+      for (int i = 0; i < 7; i++) arr.add_dictionary("entry " + std::to_string(i));
+    }
+    arr.set_na(na);
+
+    XLOPER12 serial, parallel;
+    LPXLOPER12 a = ToArena(serial, arr, rows + 1, cols, false, true, pool, INT_MAX);
+    LPXLOPER12 b = ToArena(parallel, arr, rows + 1, cols, false, true, pool, 0, 2 * rows);
+
+    for (int i = 0; i < (rows + 1) * cols; i++) {
+      CHECK(a[i].xltype == b[i].xltype);
+      if (a[i].xltype == xltypeNum) CHECK(a[i].val.num == b[i].val.num);
+      else if (a[i].xltype == xltypeStr) {
+        CHECK(a[i].val.str[0] == b[i].val.str[0]);
+        CHECK(!memcmp(a[i].val.str, b[i].val.str, (a[i].val.str[0] + 1) * sizeof(XCHAR)));
+      }
+    }
+
+    // element 3 (first column) is NA; grid row 0 is names
+
+    CHECK(b[(3 + 1) * cols].xltype == xltypeNil);
+    CHECK(b[(4 + 1) * cols].xltype != xltypeNil);
+    if (type == MessageUtilities::TypeFlags::string) {
+      CHECK(Equals(b[1 * cols + 1], "entry " + std::to_string(rows % 7)));
+      CHECK(b[2 * cols].val.str == b[(2 + 7) * cols].val.str);
+    }
+
+    XLOPERArena::Release(&serial);
+    XLOPERArena::Release(&parallel);
+  }
+
+}
+
+int main(int argc, char **argv) {
+
+  WorkPool pool(3);
+
+  TestOrderAndNames(pool);
+  TestColumnar(pool);
+  TestParallelMatchesSerial(pool);
+
+  pool.Shutdown();
+
+  printf("ok\n");
+  return 0;
+
+}
@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include "message_utilities.h"
+
+/**
+ * shared conversion core for arrays going out to the languages and to 
+ * excel/COM. this used to be a switch on each element's type, written 
+ * separately in each bridge and each handling a slightly different set 
+ * of types. now the type dispatch happens once per run of elements, and
+ * the inner loops are generated per (source type, target) pair.
+ *
+ * a target is a "sink", a small adapter class (derive from Sink, below).
+ * elements are delivered by output index, so the sink decides where they
+ * go (a flat vector, a strided excel column, a julia array...). 
+ *
+ *   Real(int out, double)
+ *   Integer(int out, int32_t)            default: Real
+ *   Logical(int out, bool)
+ *   String(int out, const std::string&)  unpacked strings
+ *   Entry(int out, const Array&, int)    packed strings, by dictionary 
+ *                                        index; default: String
+ *   NA(int out)                          packed NA, nil, invalid entry
+ *   Missing(int out)                     default: NA
+ *   Other(int out, const Variable&)      anything else (nested arrays,
+ *                                        errors, complex...); default: NA
+ *   Dictionary(const Array&)             before a packed string array is 
+ *                                        converted; cache entries here
+ *
+ * the NA semantics are the same everywhere: packed NA, nil, and invalid 
+ * dictionary indexes are NA; missing is separate, but defaults to NA.
+ *
+ * sink methods should be small and inline, as they're called per element.
+ */
+namespace ArrayConversion {
+
+  /** sink base class with defaults (CRTP, so there are no virtual calls) */
+  template <class Derived> class Sink {
+
+  protected:
+    Derived &self() { return static_cast<Derived&>(*this); }
+
+  public:
+    void Integer(int out, int32_t value) { self().Real(out, value); }
+    void Real(int out, double value) { self().NA(out); }
+    void Logical(int out, bool value) { self().NA(out); }
+    void String(int out, const std::string &str) { self().NA(out); }
+    void Entry(int out, const BERTBuffers::Array &arr, int entry) { self().String(out, arr.dictionary(entry)); }
+    void Missing(int out) { self().NA(out); }
+    void Other(int out, const BERTBuffers::Variable &var) { self().NA(out); }
+    void Dictionary(const BERTBuffers::Array &arr) {}
+  };
+
+  /** element sources, one per packed type */
+
+  struct RealSource {
+    template <class S> static void Put(S &sink, int out, const BERTBuffers::Array &arr, int index) {
+      sink.Real(out, arr.reals(index));
+    }
+  };
+
+  struct IntegerSource {
+    template <class S> static void Put(S &sink, int out, const BERTBuffers::Array &arr, int index) {
+      sink.Integer(out, arr.integers(index));
+    }
+  };
+
+  struct LogicalSource {
+    template <class S> static void Put(S &sink, int out, const BERTBuffers::Array &arr, int index) {
+      sink.Logical(out, MessageUtilities::TestBit(arr.logicals(), index));
+    }
+  };
+
+  struct StringSource {
+    template <class S> static void Put(S &sink, int out, const BERTBuffers::Array &arr, int index) {
+      int entry = arr.integers(index);
+      if (entry < 0 || entry >= arr.dictionary_size()) sink.NA(out);
+      else sink.Entry(out, arr, entry);
+    }
+  };
+
+  /**
+   * packed run. without NAs, there's no per-element test; with NAs, we 
+   * skip the test for any group of 8 elements with no NAs in it.
+   */
+  template <class Source, class S> void PackedRun(S &sink, int out, const BERTBuffers::Array &arr, int first, int count) {
+
+    const std::string &na = arr.na();
+    int end = first + count;
+
+    if (na.empty()) {
+      for (int i = first; i < end; i++, out++) Source::Put(sink, out, arr, i);
+      return;
+    }
+
+    for (int i = first; i < end; ) {
+      int group_end = (i | 7) + 1;
+      if (group_end > end) group_end = end;
+      if (!na[i >> 3]) {
+        for (; i < group_end; i++, out++) Source::Put(sink, out, arr, i);
+      }
+      else {
+        for (; i < group_end; i++, out++) {
+          if (MessageUtilities::TestBit(na, i)) sink.NA(out);
+          else Source::Put(sink, out, arr, i);
+        }
+      }
+    }
+  }
+
+  /** unpacked run, dispatching per element */
+  template <class S> void UnpackedRun(S &sink, int out, const BERTBuffers::Array &arr, int first, int count) {
+
+    int end = first + count;
+
+    for (int i = first; i < end; i++, out++) {
+      const BERTBuffers::Variable &element = arr.data(i);
+      switch (element.value_case()) {
+      case BERTBuffers::Variable::ValueCase::kReal:
+        sink.Real(out, element.real());
+        break;
+      case BERTBuffers::Variable::ValueCase::kInteger:
+        sink.Integer(out, element.integer());
+        break;
+      case BERTBuffers::Variable::ValueCase::kBoolean:
+        sink.Logical(out, element.boolean());
+        break;
+      case BERTBuffers::Variable::ValueCase::kStr:
+        sink.String(out, element.str());
+        break;
+      case BERTBuffers::Variable::ValueCase::kNil:
+        sink.NA(out);
+        break;
+      case BERTBuffers::Variable::ValueCase::kMissing:
+        sink.Missing(out);
+        break;
+      default:
+        sink.Other(out, element);
+        break;
+      }
+    }
+  }
+
+  /** unknown packed type (ArrayLength won't accept these, so shouldn't happen) */
+  template <class S> void InvalidRun(S &sink, int out, const BERTBuffers::Array &arr, int first, int count) {
+    for (int i = 0; i < count; i++) sink.NA(out + i);
+  }
+
+  /** dispatch table index for packed type; 0 is unpacked */
+  inline int RunIndex(uint32_t packed_type) {
+    switch (packed_type) {
+    case 0: return 0;
+    case MessageUtilities::TypeFlags::real: return 1;
+    case MessageUtilities::TypeFlags::integer: return 2;
+    case MessageUtilities::TypeFlags::logical: return 3;
+    case MessageUtilities::TypeFlags::string: return 4;
+    default: return 5;
+    }
+  }
+
+  /**
+   * convert count elements from arr, starting at element first, to sink 
+   * output indexes starting at out. arr is packed or unpacked, not 
+   * columnar (convert those by column). this doesn't call Dictionary, so 
+   * it's safe to run on blocks of an array in parallel if the sink is.
+   * assumes the array length has been checked (see ArrayLength).
+   */
+  template <class S> void Run(S &sink, int out, const BERTBuffers::Array &arr, int first, int count) {
+
+    typedef void(*RunFunction)(S&, int, const BERTBuffers::Array&, int, int);
+
+    static const RunFunction table[] = {
+      &UnpackedRun<S>,
+      &PackedRun<RealSource, S>,
+      &PackedRun<IntegerSource, S>,
+      &PackedRun<LogicalSource, S>,
+      &PackedRun<StringSource, S>,
+      &InvalidRun<S>
+    };
+
+    table[RunIndex(arr.packed_type())](sink, out, arr, first, count);
+  }
+
+  /**
+   * convert a complete array, in column-major order (columnar arrays are 
+   * converted by column, so the output order is the same as ArrayElement).
+   * pass the length from ArrayLength.
+   */
+  template <class S> void Convert(S &sink, const BERTBuffers::Array &arr, int length) {
+
+    if (MessageUtilities::IsColumnar(arr)) {
+      int rows = arr.rows();
+      int cols = arr.columns_size();
+      for (int c = 0; c < cols && (c + 1) * rows <= length; c++) {
+        const BERTBuffers::Array &column = arr.columns(c);
+        if (column.packed_type() == MessageUtilities::TypeFlags::string) sink.Dictionary(column);
+        Run(sink, c * rows, column, 0, rows);
+      }
+      return;
+    }
+
+    if (arr.packed_type() == MessageUtilities::TypeFlags::string) sink.Dictionary(arr);
+    Run(sink, 0, arr, 0, length);
+  }
+
+  /**
+   * per-conversion cache of language strings (CHARSXPs, julia Strings) by
+   * message string, so repeated strings (categories, codes, tickers...) 
+   * are created once. keys point into the message, which has to outlive
+   * the cache. the cache doesn't root or protect anything; store values
+   * in a rooted container before the next allocation.
+   */
+  template <typename Value, Value(*Create)(const std::string&)> class StringCache {
+
+    struct Hash {
+      size_t operator()(const std::string *str) const { return std::hash<std::string>()(*str); }
+    };
+
+    struct Equal {
+      bool operator()(const std::string *a, const std::string *b) const { return *a == *b; }
+    };
+
+    std::unordered_map<const std::string*, Value, Hash, Equal> cache_;
+
+  public:
+    Value Get(const std::string &str) {
+      auto entry = cache_.emplace(&str, Value());
+      if (entry.second) entry.first->second = Create(str);
+      return entry.first->second;
+    }
+  };
+
+}
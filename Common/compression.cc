@@ -0,0 +1,213 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compression.h"
+
+#include <string.h>
+
+// format constants. the last 5 bytes are always literals, and the last
+// match has to start at least 12 bytes before the end of the block.
+
+#define MIN_MATCH       4
+#define LAST_LITERALS   5
+#define MATCH_LIMIT     12
+#define MAX_OFFSET      65535
+
+#define HASH_BITS       12
+#define SKIP_STRENGTH   6
+
+namespace Compression {
+
+  static inline uint32_t Read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(uint32_t));
+    return value;
+  }
+
+  static inline uint32_t Hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - HASH_BITS);
+  }
+
+  /** write a length extension (after the 15 in the token) */
+  static inline uint8_t* WriteLength(uint8_t *op, size_t length) {
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+  }
+
+  /** read a length extension; returns false if we run out of input */
+  static inline bool ReadLength(const uint8_t *&ip, const uint8_t *end, size_t &length) {
+    uint8_t b;
+    do {
+      if (ip >= end) return false;
+      b = *ip++;
+      length += b;
+    } while (b == 255);
+    return true;
+  }
+
+  size_t CompressBound(size_t length) {
+    return length + (length / 255) + 16;
+  }
+
+  size_t Compress(const char *source, size_t length, char *dest, size_t capacity) {
+
+    const uint8_t *base = reinterpret_cast<const uint8_t*>(source);
+    const uint8_t *end = base + length;
+    const uint8_t *ip = base;
+    const uint8_t *anchor = base;
+
+    uint8_t *op = reinterpret_cast<uint8_t*>(dest);
+    uint8_t *op_end = op + capacity;
+
+    if (length > MATCH_LIMIT) {
+
+      const uint8_t *match_end = end - LAST_LITERALS;
+      const uint8_t *search_end = end - MATCH_LIMIT;
+
+      // positions are offsets from base. 0 is ambiguous (empty or base),
+      // but we check the bytes anyway so that doesn't matter.
+
+      uint32_t table[1 << HASH_BITS];
+      memset(table, 0, sizeof(table));
+
+      ip++;
+      while (ip < search_end) {
+
+        uint32_t sequence = Read32(ip);
+        uint32_t hash = Hash(sequence);
+        const uint8_t *ref = base + table[hash];
+        table[hash] = (uint32_t)(ip - base);
+
+        if (ref >= ip || ip - ref > MAX_OFFSET || Read32(ref) != sequence) {
+
+          // step faster through data that doesn't match
+
+          ip += 1 + ((ip - anchor) >> SKIP_STRENGTH);
+          continue;
+        }
+
+        // extend backwards (into pending literals) and forwards
+
+        while (ip > anchor && ref > base && ip[-1] == ref[-1]) { ip--; ref--; }
+
+        const uint8_t *mp = ip + MIN_MATCH;
+        const uint8_t *rp = ref + MIN_MATCH;
+        while (mp < match_end && *mp == *rp) { mp++; rp++; }
+
+        size_t literal_length = ip - anchor;
+        size_t match_length = (mp - ip) - MIN_MATCH;
+
+        // token + literals + offset + length extensions
+
+        if ((size_t)(op_end - op) < 1 + literal_length + (literal_length / 255) + 1 + 2 + (match_length / 255) + 1) return 0;
+
+        uint8_t *token = op++;
+        if (literal_length >= 15) {
+          *token = 15 << 4;
+          op = WriteLength(op, literal_length - 15);
+        }
+        else *token = (uint8_t)(literal_length << 4);
+
+        memcpy(op, anchor, literal_length);
+        op += literal_length;
+
+        uint16_t offset = (uint16_t)(ip - ref);
+        *op++ = (uint8_t)(offset & 0xff);
+        *op++ = (uint8_t)(offset >> 8);
+
+        if (match_length >= 15) {
+          *token |= 15;
+          op = WriteLength(op, match_length - 15);
+        }
+        else *token |= (uint8_t)match_length;
+
+        ip = anchor = mp;
+
+        // index a position inside the match, helps with runs
+
+        if (ip - 2 > base && ip < search_end) table[Hash(Read32(ip - 2))] = (uint32_t)(ip - 2 - base);
+      }
+    }
+
+    // remaining literals
+
+    size_t literal_length = end - anchor;
+    if ((size_t)(op_end - op) < 1 + literal_length + (literal_length / 255) + 1) return 0;
+
+    if (literal_length >= 15) {
+      *op++ = 15 << 4;
+      op = WriteLength(op, literal_length - 15);
+    }
+    else *op++ = (uint8_t)(literal_length << 4);
+
+    memcpy(op, anchor, literal_length);
+    op += literal_length;
+
+    return op - reinterpret_cast<uint8_t*>(dest);
+  }
+
+  bool Decompress(const char *source, size_t length, char *dest, size_t dest_length) {
+
+    const uint8_t *ip = reinterpret_cast<const uint8_t*>(source);
+    const uint8_t *end = ip + length;
+
+    uint8_t *base = reinterpret_cast<uint8_t*>(dest);
+    uint8_t *op = base;
+    uint8_t *op_end = base + dest_length;
+
+    while (ip < end) {
+
+      uint8_t token = *ip++;
+
+      size_t literal_length = token >> 4;
+      if (literal_length == 15 && !ReadLength(ip, end, literal_length)) return false;
+      if (literal_length > (size_t)(end - ip) || literal_length > (size_t)(op_end - op)) return false;
+
+      memcpy(op, ip, literal_length);
+      op += literal_length;
+      ip += literal_length;
+
+      // the last sequence is literals only
+
+      if (ip >= end) break;
+
+      if (end - ip < 2) return false;
+      size_t offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+      if (!offset || offset > (size_t)(op - base)) return false;
+
+      size_t match_length = token & 15;
+      if (match_length == 15 && !ReadLength(ip, end, match_length)) return false;
+      match_length += MIN_MATCH;
+      if (match_length > (size_t)(op_end - op)) return false;
+
+      // matches can overlap the output (runs), in which case we have to
+      // copy bytewise
+
+      const uint8_t *match = op - offset;
+      if (offset >= match_length) memcpy(op, match, match_length);
+      else for (size_t i = 0; i < match_length; i++) op[i] = match[i];
+      op += match_length;
+    }
+
+    return op == op_end;
+  }
+
+}
@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * fast block compression for message payloads. this writes the LZ4 block
+ * format (token, literals, 16-bit offset, match length) with a simple
+ * greedy single-probe matcher. it's not going to win on ratio, but it's
+ * fast enough that compressing big string-heavy messages is cheaper than
+ * copying the raw bytes through the pipe.
+ *
+ * the format doesn't include the uncompressed length; the caller has to
+ * store that (see MessageUtilities::Frame).
+ */
+namespace Compression {
+
+  /** worst-case compressed size for a given input size */
+  size_t CompressBound(size_t length);
+
+  /**
+   * compress source into dest. returns the compressed length, or 0 if the
+   * output doesn't fit in capacity (which can't happen if capacity is at
+   * least CompressBound(length)).
+   */
+  size_t Compress(const char *source, size_t length, char *dest, size_t capacity);
+
+  /**
+   * decompress into dest, which must be exactly the uncompressed length.
+   * returns false on malformed input; never reads or writes out of bounds.
+   */
+  bool Decompress(const char *source, size_t length, char *dest, size_t dest_length);
+
+}
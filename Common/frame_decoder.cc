@@ -0,0 +1,210 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_decoder.h"
+
+#include <string.h>
+
+FrameDecoder::FrameDecoder()
+  : position_(0)
+  , chunk_(0)
+  , chunk_length_(0)
+  , errors_(0)
+{
+}
+
+FrameDecoder::HeaderStatus FrameDecoder::ReadHeader(const char *data, size_t length, uint32_t *frame_length, uint8_t *flags) {
+
+  // check as much as we have, so we can reject garbage early
+
+  const uint8_t *bytes = reinterpret_cast<const uint8_t*>(data);
+
+  if (length > 0 && bytes[0] != (FRAME_MAGIC & 0xff)) return header_invalid;
+  if (length > 1 && bytes[1] != (FRAME_MAGIC >> 8)) return header_invalid;
+  if (length > 2 && bytes[2] != FRAME_VERSION) return header_invalid;
+  if (length > 3 && (bytes[3] & ~FRAME_FLAGS_MASK)) return header_invalid;
+  if (length < FRAME_HEADER_SIZE) return header_incomplete;
+
+  uint32_t payload_length;
+  memcpy(&payload_length, data + 4, sizeof(uint32_t));
+  if (payload_length > FRAME_MAX_LENGTH) return header_invalid;
+
+  *frame_length = payload_length + FRAME_HEADER_SIZE;
+  if (flags) *flags = bytes[3];
+  return header_valid;
+}
+
+void FrameDecoder::WriteHeader(char *data, uint32_t payload_length, uint8_t flags) {
+  data[0] = (char)(FRAME_MAGIC & 0xff);
+  data[1] = (char)(FRAME_MAGIC >> 8);
+  data[2] = (char)FRAME_VERSION;
+  data[3] = (char)flags;
+  memcpy(data + 4, &payload_length, sizeof(uint32_t));
+}
+
+size_t FrameDecoder::Scan(const char *data, size_t length, uint32_t *frame_length) {
+
+  size_t offset = 0;
+  *frame_length = 0;
+
+  while (offset < length) {
+
+    uint32_t total = 0;
+    HeaderStatus status = ReadHeader(data + offset, length - offset, &total);
+
+    if (status == header_valid) {
+      if (length - offset >= total) *frame_length = total;
+      return offset;
+    }
+    else if (status == header_incomplete) return offset;
+
+    // corrupt: skip to the next possible header
+
+    errors_++;
+    const void *next = memchr(data + offset + 1, FRAME_MAGIC & 0xff, length - offset - 1);
+    offset = next ? reinterpret_cast<const char*>(next) - data : length;
+  }
+
+  return offset;
+}
+
+void FrameDecoder::Compact() {
+  if (position_ && position_ >= buffer_.length()) {
+    if (buffer_.capacity() > FRAME_MAX_RETAINED_BUFFER_SIZE) std::string().swap(buffer_);
+    else buffer_.clear();
+    position_ = 0;
+  }
+}
+
+void FrameDecoder::Feed(const char *data, size_t length) {
+
+  Compact();
+
+  // if we're still holding a chunk, the caller didn't drain it; we have to
+  // copy it now
+
+  if (chunk_length_) {
+    buffer_.append(chunk_, chunk_length_);
+    chunk_ = 0;
+    chunk_length_ = 0;
+  }
+
+  if (position_ < buffer_.length()) buffer_.append(data, length);
+  else {
+    chunk_ = data;
+    chunk_length_ = length;
+  }
+}
+
+void FrameDecoder::Append(const char *data, size_t length) {
+
+  Compact();
+
+  if (chunk_length_) {
+    buffer_.append(chunk_, chunk_length_);
+    chunk_ = 0;
+    chunk_length_ = 0;
+  }
+
+  buffer_.append(data, length);
+}
+
+bool FrameDecoder::Available() {
+
+  uint32_t frame_length;
+
+  if (position_ < buffer_.length()) {
+    position_ += Scan(buffer_.c_str() + position_, buffer_.length() - position_, &frame_length);
+    return frame_length != 0;
+  }
+  else if (chunk_length_) {
+    size_t offset = Scan(chunk_, chunk_length_, &frame_length);
+    chunk_ += offset;
+    chunk_length_ -= offset;
+    return frame_length != 0;
+  }
+
+  return false;
+}
+
+bool FrameDecoder::Next(const char **frame, uint32_t *frame_length) {
+
+  Compact();
+
+  if (position_ < buffer_.length()) {
+
+    position_ += Scan(buffer_.c_str() + position_, buffer_.length() - position_, frame_length);
+
+    if (*frame_length) {
+      *frame = buffer_.c_str() + position_;
+      position_ += *frame_length;
+      return true;
+    }
+
+    // partial frame. move it to the front and reserve space for the rest,
+    // so we only copy it once.
+
+    uint32_t total;
+    if (ReadHeader(buffer_.c_str() + position_, buffer_.length() - position_, &total) == header_valid) {
+      if (position_) {
+        buffer_.erase(0, position_);
+        position_ = 0;
+      }
+      buffer_.reserve(total);
+    }
+
+    return false;
+  }
+
+  if (chunk_length_) {
+
+    size_t offset = Scan(chunk_, chunk_length_, frame_length);
+    const char *start = chunk_ + offset;
+    size_t remaining = chunk_length_ - offset;
+
+    chunk_ = 0;
+    chunk_length_ = 0;
+    position_ = 0;
+
+    if (*frame_length) {
+
+      // frame in place. retain anything after it, since the caller is going
+      // to reuse the chunk for the next read.
+
+      *frame = start;
+      if (remaining > *frame_length) buffer_.assign(start + *frame_length, remaining - *frame_length);
+      return true;
+    }
+
+    if (remaining) {
+      uint32_t total;
+      if (ReadHeader(start, remaining, &total) == header_valid) buffer_.reserve(total);
+      buffer_.assign(start, remaining);
+    }
+  }
+
+  return false;
+}
+
+void FrameDecoder::Reset() {
+  buffer_.clear();
+  position_ = 0;
+  chunk_ = 0;
+  chunk_length_ = 0;
+}
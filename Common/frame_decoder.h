@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/**
+ * frame header (8 bytes, little-endian):
+ *
+ *   magic    uint16  'B' 'T'
+ *   version  uint8
+ *   flags    uint8
+ *   length   uint32  payload length, not including the header
+ *
+ * compressed frames (flag) start the payload with the uncompressed length
+ * (uint32), followed by the compressed data. see MessageUtilities::Frame.
+ *
+ * shared frames (flag) are descriptors for a frame in shared memory; see
+ * SharedRing and MessageUtilities::FrameShared.
+ *
+ * the console (javascript) has its own copy of this in message_utilities.ts.
+ */
+#define FRAME_MAGIC             0x5442
+#define FRAME_VERSION           1
+#define FRAME_HEADER_SIZE       8
+
+#define FRAME_FLAG_COMPRESSED   0x01
+#define FRAME_FLAG_SHARED       0x02
+#define FRAME_FLAGS_MASK        0x03
+
+#define FRAME_MAX_LENGTH        0x3FFFFFFF
+
+// retained buffer for assembling frames is released if it grows past this
+// size (after the frame is consumed)
+#define FRAME_MAX_RETAINED_BUFFER_SIZE (4 * 1024 * 1024)
+
+/**
+ * incremental frame decoder. feed it data as it arrives, in any size
+ * chunks, and take complete frames out.
+ *
+ * frames that are entirely contained in a chunk are returned in place,
+ * without copying. otherwise data is accumulated in an internal buffer
+ * (which is reserved to the full frame length once we have the header, so
+ * it's only ever appended).
+ *
+ * if the stream is corrupt (bad magic, unknown version or flags, or an
+ * impossible length) we skip ahead to the next valid header and continue,
+ * counting the error; we don't lose sync for the rest of the connection.
+ */
+class FrameDecoder {
+
+public:
+
+  /** header validation results */
+  typedef enum {
+    header_invalid = -1,
+    header_incomplete = 0,
+    header_valid = 1
+  }
+  HeaderStatus;
+
+  /**
+   * validate a header, possibly partial. on success, sets frame length
+   * (total, including header) and optionally the flags.
+   */
+  static HeaderStatus ReadHeader(const char *data, size_t length, uint32_t *frame_length, uint8_t *flags = 0);
+
+  /** write a header into (at least) FRAME_HEADER_SIZE bytes */
+  static void WriteHeader(char *data, uint32_t payload_length, uint8_t flags = 0);
+
+protected:
+
+  /** accumulated data (partial frames, or data after a frame) */
+  std::string buffer_;
+
+  /** start of unconsumed data in buffer */
+  size_t position_;
+
+  /**
+   * chunk passed to Feed() that we haven't copied; we only hold this if
+   * the buffer is empty
+   */
+  const char *chunk_;
+  size_t chunk_length_;
+
+  /** count of resync events (corrupt data) */
+  uint32_t errors_;
+
+protected:
+
+  /**
+   * find the next frame in data, skipping corrupt data. returns the offset
+   * of the frame, or of the (possibly partial) data to retain if there's
+   * no complete frame. sets frame_length to 0 if there's no complete frame.
+   */
+  size_t Scan(const char *data, size_t length, uint32_t *frame_length);
+
+  /** release consumed data */
+  void Compact();
+
+public:
+
+  /**
+   * add data. if there's nothing buffered this doesn't copy, so the data
+   * must remain valid until Next() returns false (or until the frame it
+   * returns has been consumed).
+   */
+  void Feed(const char *data, size_t length);
+
+  /**
+   * add data, copying it. use this for partial reads into a buffer that's
+   * reused before the frames are taken out (Feed only copies when Next()
+   * runs out of complete frames).
+   */
+  void Append(const char *data, size_t length);
+
+  /**
+   * get the next complete frame (including header). the pointer is valid
+   * until the next call to Next(), Feed() or Reset(). returns false if
+   * there's no complete frame; any partial data is retained.
+   */
+  bool Next(const char **frame, uint32_t *frame_length);
+
+  /** check if there's a complete frame available, without consuming it */
+  bool Available();
+
+  /** drop all data (e.g. on disconnect) */
+  void Reset();
+
+  /** accessor */
+  uint32_t errors() { return errors_; }
+
+public:
+  FrameDecoder();
+
+};
@@ -18,11 +18,94 @@
  */
  
 #include "message_utilities.h"
+#include "compression.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <limits.h>
+
+// scratch buffers for compression are retained per thread, unless they 
+// grow past this size
+#define MAX_RETAINED_SCRATCH_SIZE (4 * 1024 * 1024)
 
 namespace MessageUtilities {
-  
+
+  static_assert(BERTBuffers::Variable::kGraphics < 16, "value case table is too small");
+
+  // unlisted cases (err, cpx, arr, ref, ...) can't be part of a typed array
+
+  const uint32_t ArraySummaryBuilder::type_table_[16] = {
+    TypeFlags::nil,                           // not set
+    any_type,                                 // nil
+    any_type,                                 // missing
+    TypeFlags::nil,                           // err
+    TypeFlags::nil,                           // (4)
+    TypeFlags::integer | TypeFlags::numeric,  // integer
+    TypeFlags::real | TypeFlags::numeric,     // real
+    TypeFlags::string,                        // str
+    TypeFlags::logical,                       // boolean
+  };
+
+  const bool ArraySummaryBuilder::na_table_[16] = {
+    false, true, true
+  };
+
+  void ArraySummaryBuilder::Set(BERTBuffers::Array *arr) const {
+    auto summary = arr->mutable_summary();
+    summary->set_type(type_);
+    summary->set_has_na(has_na_);
+    summary->set_has_names(has_names_);
+    if (max_string_length_) {
+      summary->set_min_string_length(static_cast<int32_t>(std::min<size_t>(min_string_length_, INT_MAX)));
+      summary->set_max_string_length(static_cast<int32_t>(std::min<size_t>(max_string_length_, INT_MAX)));
+    }
+  }
+
+  bool ArrayHasNames(const BERTBuffers::Array &arr) {
+    if (arr.has_summary()) return arr.summary().has_names();
+    for (const auto &element : arr.data()) {
+      if (element.name().length()) return true;
+    }
+    return false;
+  }
+
   TypeFlags CheckArrayType(const BERTBuffers::Array &arr, bool allow_nil, bool allow_missing) {
-    TypeFlags result = (TypeFlags::integer | TypeFlags::real | TypeFlags::numeric | TypeFlags::string | TypeFlags::logical);
+
+    // columnar arrays are (usually) mixed, but check anyway
+
+    if (IsColumnar(arr)) {
+      TypeFlags result = any_type;
+      for (const auto &column : arr.columns()) result = result & CheckArrayType(column, allow_nil, allow_missing);
+      return result;
+    }
+
+    // packed arrays already have a type. NA could be nil or missing, so
+    // if either is disallowed we need to check for any NA values.
+
+    if (IsPacked(arr)) {
+      if (!allow_nil || !allow_missing) {
+        for (auto c : arr.na()) if (c) return TypeFlags::nil;
+      }
+      switch (arr.packed_type()) {
+      case TypeFlags::integer: return TypeFlags::integer | TypeFlags::numeric;
+      case TypeFlags::real: return TypeFlags::real | TypeFlags::numeric;
+      case TypeFlags::string: return TypeFlags::string;
+      case TypeFlags::logical: return TypeFlags::logical;
+      }
+      return TypeFlags::nil;
+    }
+
+    // if the sender summarized the array we don't need to scan, unless
+    // there are NAs and only one of nil/missing is allowed (the summary
+    // doesn't say which).
+
+    if (arr.has_summary()) {
+      const auto &summary = arr.summary();
+      if (!summary.has_na() || (allow_nil && allow_missing)) return static_cast<TypeFlags>(summary.type());
+      if (!allow_nil && !allow_missing) return TypeFlags::nil;
+    }
+
+    TypeFlags result = any_type;
     int length = arr.data_size();
     for (int i = 0; result && i < length; i++) {
       const auto &element = arr.data(i);
@@ -52,22 +135,593 @@ namespace MessageUtilities {
     return result;
   }
   
-  bool Unframe(google::protobuf::Message &message, const char *data, uint32_t len) {
-    int32_t bytes;
-    memcpy(reinterpret_cast<void*>(&bytes), data, sizeof(int32_t));
-    return message.ParseFromArray(data + sizeof(int32_t), bytes);
+  int ArrayLength(const BERTBuffers::Array &arr) {
+
+    if (IsColumnar(arr)) {
+
+      // one column per col, and every column has to be complete
+
+      int rows = arr.rows();
+      if (rows <= 0 || arr.cols() != arr.columns_size()) return 0;
+      for (const auto &column : arr.columns()) {
+        if (IsColumnar(column) || ArrayLength(column) != rows) return 0;
+      }
+      return rows * arr.cols();
+    }
+
+    if (!IsPacked(arr)) return arr.data_size();
+
+    int length = arr.packed_length();
+    if (length <= 0) return 0;
+
+    size_t bitset_length = BitsetLength(length);
+
+    switch (arr.packed_type()) {
+    case TypeFlags::integer:
+    case TypeFlags::string:
+      if (arr.integers_size() < length) return 0;
+      break;
+    case TypeFlags::real:
+      if (arr.reals_size() < length) return 0;
+      break;
+    case TypeFlags::logical:
+      if (arr.logicals().length() < bitset_length) return 0;
+      break;
+    default:
+      return 0;
+    }
+
+    if (arr.na().length() && arr.na().length() < bitset_length) return 0;
+    return length;
+  }
+
+  const BERTBuffers::Variable& ArrayElement(const BERTBuffers::Array &arr, int index, BERTBuffers::Variable &scratch) {
+
+    if (IsColumnar(arr)) {
+      int rows = arr.rows();
+      return ArrayElement(arr.columns(index / rows), index % rows, scratch);
+    }
+
+    if (!IsPacked(arr)) return arr.data(index);
+
+    if (IsNA(arr, index)) scratch.set_nil(true);
+    else switch (arr.packed_type()) {
+    case TypeFlags::integer:
+      scratch.set_integer(arr.integers(index));
+      break;
+    case TypeFlags::real:
+      scratch.set_real(arr.reals(index));
+      break;
+    case TypeFlags::string:
+      scratch.set_str(PackedString(arr, index));
+      break;
+    case TypeFlags::logical:
+      scratch.set_boolean(TestBit(arr.logicals(), index));
+      break;
+    }
+
+    return scratch;
+  }
+
+  const std::string& PackedString(const BERTBuffers::Array &arr, int index) {
+    static const std::string empty;
+    int dictionary_index = arr.integers(index);
+    if (dictionary_index < 0 || dictionary_index >= arr.dictionary_size()) return empty;
+    return arr.dictionary(dictionary_index);
+  }
+
+  bool PackArray(BERTBuffers::Array *arr) {
+
+    int length = arr->data_size();
+    if (!length || IsPacked(*arr)) return false;
+
+    // names are per-element, so we can't pack named elements
+
+    if (ArrayHasNames(*arr)) return false;
+
+    TypeFlags type = CheckArrayType(*arr, true, true);
+    TypeFlags packed_type;
+
+    // all flags set means there were no typed elements (all nil/missing), 
+    // leave that as-is. 
+
+    if (type == any_type) return false;
+    else if (type & TypeFlags::string) packed_type = TypeFlags::string;
+    else if (type & TypeFlags::logical) packed_type = TypeFlags::logical;
+    else if (type & TypeFlags::integer) packed_type = TypeFlags::integer;
+    else if (type & TypeFlags::numeric) packed_type = TypeFlags::real; // real or mixed
+    else return false;
+
+    size_t bitset_length = BitsetLength(length);
+    std::string na;
+
+    auto set_na = [&](int index) {
+      if (na.empty()) na.assign(bitset_length, 0);
+      SetBit(na, index);
+    };
+
+    switch (packed_type) {
+    case TypeFlags::integer:
+    {
+      auto values = arr->mutable_integers();
+      values->Reserve(length);
+      for (int i = 0; i < length; i++) {
+        const auto &element = arr->data(i);
+        if (element.value_case() == BERTBuffers::Variable::ValueCase::kInteger) values->AddAlreadyReserved(element.integer());
+        else {
+          values->AddAlreadyReserved(0);
+          set_na(i);
+        }
+      }
+      break;
+    }
+    case TypeFlags::real:
+    {
+      auto values = arr->mutable_reals();
+      values->Reserve(length);
+      for (int i = 0; i < length; i++) {
+        const auto &element = arr->data(i);
+        switch (element.value_case()) {
+        case BERTBuffers::Variable::ValueCase::kReal:
+          values->AddAlreadyReserved(element.real());
+          break;
+        case BERTBuffers::Variable::ValueCase::kInteger:
+          values->AddAlreadyReserved(element.integer());
+          break;
+        default:
+          values->AddAlreadyReserved(0);
+          set_na(i);
+        }
+      }
+      break;
+    }
+    case TypeFlags::string:
+    {
+      std::unordered_map<std::string, int> dictionary;
+      auto values = arr->mutable_integers();
+      values->Reserve(length);
+      for (int i = 0; i < length; i++) {
+        const auto &element = arr->data(i);
+        if (element.value_case() == BERTBuffers::Variable::ValueCase::kStr) {
+          auto entry = dictionary.emplace(element.str(), (int)dictionary.size());
+          if (entry.second) arr->add_dictionary(element.str());
+          values->AddAlreadyReserved(entry.first->second);
+        }
+        else {
+          values->AddAlreadyReserved(-1);
+          set_na(i);
+        }
+      }
+      break;
+    }
+    case TypeFlags::logical:
+    {
+      std::string bits(bitset_length, 0);
+      for (int i = 0; i < length; i++) {
+        const auto &element = arr->data(i);
+        if (element.value_case() == BERTBuffers::Variable::ValueCase::kBoolean) {
+          if (element.boolean()) SetBit(bits, i);
+        }
+        else set_na(i);
+      }
+      arr->mutable_logicals()->swap(bits);
+      break;
+    }
+    default:
+      return false; // not reached; packed_type is one of the above
+    }
+
+    if (na.length()) arr->mutable_na()->swap(na);
+
+    arr->set_packed_type(packed_type);
+    arr->set_packed_length(length);
+    arr->clear_data();
+
+    return true;
+  }
+
+  void UnpackArray(BERTBuffers::Array *arr) {
+
+    if (IsColumnar(*arr)) {
+
+      // unpacked columns are moved, not copied
+
+      int length = ArrayLength(*arr);
+      if (length) {
+        arr->mutable_data()->Reserve(length);
+        for (auto &column : *(arr->mutable_columns())) {
+          if (IsPacked(column)) {
+            for (int i = 0; i < arr->rows(); i++) ArrayElement(column, i, *arr->add_data());
+          }
+          else {
+            for (auto &element : *(column.mutable_data())) arr->add_data()->Swap(&element);
+          }
+        }
+      }
+      arr->clear_columns();
+      return;
+    }
+
+    if (!IsPacked(*arr)) return;
+
+    int length = ArrayLength(*arr);
+    arr->mutable_data()->Reserve(length);
+
+    for (int i = 0; i < length; i++) ArrayElement(*arr, i, *arr->add_data());
+
+    arr->clear_packed_type();
+    arr->clear_packed_length();
+    arr->clear_reals();
+    arr->clear_integers();
+    arr->clear_dictionary();
+    arr->clear_logicals();
+    arr->clear_na();
+  }
+
+  void PackVariable(BERTBuffers::Variable *var) {
+    if (var->value_case() != BERTBuffers::Variable::ValueCase::kArr) return;
+    auto arr = var->mutable_arr();
+    if (!PackArray(arr)) {
+      for (auto &element : *(arr->mutable_data())) PackVariable(&element);
+    }
+  }
+
+  void UnpackVariable(BERTBuffers::Variable *var) {
+    if (var->value_case() != BERTBuffers::Variable::ValueCase::kArr) return;
+    auto arr = var->mutable_arr();
+    if (IsPacked(*arr) || IsColumnar(*arr)) UnpackArray(arr);
+    else {
+      for (auto &element : *(arr->mutable_data())) UnpackVariable(&element);
+    }
+  }
+
+  void PackMessage(BERTBuffers::CallResponse &message) {
+    switch (message.operation_case()) {
+    case BERTBuffers::CallResponse::OperationCase::kResult:
+      PackVariable(message.mutable_result());
+      break;
+    case BERTBuffers::CallResponse::OperationCase::kFunctionCall:
+      for (auto &argument : *(message.mutable_function_call()->mutable_arguments())) PackVariable(&argument);
+      break;
+    case BERTBuffers::CallResponse::OperationCase::kCallBatch:
+      for (auto &batch_call : *(message.mutable_call_batch()->mutable_calls())) {
+        for (auto &argument : *(batch_call.mutable_arguments())) PackVariable(&argument);
+      }
+      for (auto &result : *(message.mutable_call_batch()->mutable_results())) PackVariable(&result);
+      break;
+    default:
+      break; // nothing else carries arrays
+    }
+  }
+
+  void UnpackMessage(BERTBuffers::CallResponse &message) {
+    switch (message.operation_case()) {
+    case BERTBuffers::CallResponse::OperationCase::kResult:
+      UnpackVariable(message.mutable_result());
+      break;
+    case BERTBuffers::CallResponse::OperationCase::kFunctionCall:
+      for (auto &argument : *(message.mutable_function_call()->mutable_arguments())) UnpackVariable(&argument);
+      break;
+    case BERTBuffers::CallResponse::OperationCase::kCallBatch:
+      for (auto &batch_call : *(message.mutable_call_batch()->mutable_calls())) {
+        for (auto &argument : *(batch_call.mutable_arguments())) UnpackVariable(&argument);
+      }
+      for (auto &result : *(message.mutable_call_batch()->mutable_results())) UnpackVariable(&result);
+      break;
+    default:
+      break; // nothing else carries arrays
+    }
+  }
+
+  void RunCallBatch(BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call, const std::function<void(BERTBuffers::CallResponse&, BERTBuffers::CallResponse&)> &function) {
+
+    auto batch = call.mutable_call_batch();
+    int count = batch->calls_size();
+
+    auto results = response.mutable_call_batch()->mutable_results();
+    results->Reserve(count);
+
+    // the single call/response are reused for every call in the batch
+
+    BERTBuffers::CallResponse single_call, single_response;
+    single_call.set_id(call.id());
+    single_call.set_wait(call.wait());
+
+    for (int i = 0; i < count; i++) {
+
+      single_call.mutable_function_call()->Swap(batch->mutable_calls(i));
+      single_response.Clear();
+
+      function(single_response, single_call);
+
+      auto result = results->Add();
+      switch (single_response.operation_case()) {
+      case BERTBuffers::CallResponse::OperationCase::kResult:
+        result->Swap(single_response.mutable_result());
+        break;
+      case BERTBuffers::CallResponse::OperationCase::kErr:
+        result->mutable_err()->set_type(BERTBuffers::ErrorType::EXECUTION);
+        result->mutable_err()->set_message(single_response.err());
+        break;
+      default:
+        result->set_nil(true);
+        break;
+      }
+    }
+
+    batch->clear_calls();
+  }
+
+  bool IsStreamedResult(const BERTBuffers::CallResponse &response) {
+    return response.operation_case() == BERTBuffers::CallResponse::OperationCase::kResult
+      && response.result().value_case() == BERTBuffers::Variable::ValueCase::kArr
+      && response.result().arr().streamed();
+  }
+
+  bool FrameStreamedResult(const BERTBuffers::CallResponse &response, int block_size, const std::function<void(std::string&&)> &write, uint32_t compression_threshold) {
+
+    if (response.operation_case() != BERTBuffers::CallResponse::OperationCase::kResult) return false;
+    if (response.result().value_case() != BERTBuffers::Variable::ValueCase::kArr) return false;
+
+    // names on the result would have to go in the header; we don't use 
+    // that (at the moment), so don't bother.
+
+    if (response.result().name().length()) return false;
+
+    const BERTBuffers::Array &arr = response.result().arr();
+    int length = ArrayLength(arr);
+
+    block_size = ((block_size + 7) / 8) * 8;
+    if (!IsPacked(arr) || block_size <= 0 || length <= block_size) return false;
+
+    BERTBuffers::CallResponse message;
+    std::string frame;
+
+    // header
+
+    message.set_id(response.id());
+    auto header = message.mutable_result()->mutable_arr();
+    header->set_rows(arr.rows());
+    header->set_cols(arr.cols());
+    header->mutable_rownames()->CopyFrom(arr.rownames());
+    header->mutable_colnames()->CopyFrom(arr.colnames());
+    header->set_packed_type(arr.packed_type());
+    header->set_packed_length(length);
+    header->set_streamed(true);
+
+    Frame(message, frame);
+    write(std::move(frame));
+
+    // blocks. for strings, each block has its own dictionary.
+
+    std::vector<int> dictionary_map;
+    if (arr.packed_type() == TypeFlags::string) dictionary_map.resize(arr.dictionary_size());
+
+    for (int offset = 0; offset < length; offset += block_size) {
+
+      int count = (length - offset < block_size) ? length - offset : block_size;
+      size_t bitset_offset = offset / 8;
+      size_t bitset_length = BitsetLength(count);
+
+      message.Clear();
+      message.set_id(response.id());
+      auto block = message.mutable_result()->mutable_arr();
+      block->set_packed_type(arr.packed_type());
+      block->set_packed_length(count);
+
+      switch (arr.packed_type()) {
+      case TypeFlags::real:
+        block->mutable_reals()->Resize(count, 0);
+        memcpy(block->mutable_reals()->mutable_data(), arr.reals().data() + offset, sizeof(double) * count);
+        break;
+      case TypeFlags::integer:
+        block->mutable_integers()->Resize(count, 0);
+        memcpy(block->mutable_integers()->mutable_data(), arr.integers().data() + offset, sizeof(int32_t) * count);
+        break;
+      case TypeFlags::logical:
+        block->set_logicals(arr.logicals().substr(bitset_offset, bitset_length));
+        break;
+      case TypeFlags::string:
+      {
+        std::fill(dictionary_map.begin(), dictionary_map.end(), -1);
+        auto values = block->mutable_integers();
+        values->Reserve(count);
+        for (int i = offset; i < offset + count; i++) {
+          int index = arr.integers(i);
+          if (index < 0 || index >= arr.dictionary_size()) values->AddAlreadyReserved(-1);
+          else {
+            if (dictionary_map[index] < 0) {
+              dictionary_map[index] = block->dictionary_size();
+              block->add_dictionary(arr.dictionary(index));
+            }
+            values->AddAlreadyReserved(dictionary_map[index]);
+          }
+        }
+        break;
+      }
+      }
+
+      if (arr.na().length()) {
+        std::string na = arr.na().substr(bitset_offset, bitset_length);
+        for (auto c : na) {
+          if (c) {
+            block->mutable_na()->swap(na);
+            break;
+          }
+        }
+      }
+
+      Frame(message, frame, compression_threshold);
+      write(std::move(frame));
+    }
+
+    return true;
+  }
+
+  void AppendArrayBlock(BERTBuffers::Array *arr, const BERTBuffers::Array &block, int offset) {
+
+    int count = ArrayLength(block);
+    if (!count || block.packed_type() != arr->packed_type()) return;
+
+    // offset is always a multiple of 8 (see FrameStreamedResult), so we 
+    // can append bitsets bytewise.
+
+    size_t bitset_offset = BitsetLength(offset);
+
+    switch (block.packed_type()) {
+    case TypeFlags::real:
+      arr->mutable_reals()->MergeFrom(block.reals());
+      break;
+    case TypeFlags::integer:
+      arr->mutable_integers()->MergeFrom(block.integers());
+      break;
+    case TypeFlags::logical:
+      arr->mutable_logicals()->resize(bitset_offset, 0);
+      arr->mutable_logicals()->append(block.logicals());
+      break;
+    case TypeFlags::string:
+    {
+      // dictionaries are per-block, so offset indexes. that may duplicate 
+      // some strings in the dictionary, which is fine.
+
+      int dictionary_offset = arr->dictionary_size();
+      for (const auto &entry : block.dictionary()) arr->add_dictionary(entry);
+      auto values = arr->mutable_integers();
+      values->Reserve(values->size() + count);
+      for (int i = 0; i < count; i++) {
+        int index = block.integers(i);
+        values->AddAlreadyReserved(index < 0 ? -1 : index + dictionary_offset);
+      }
+      break;
+    }
+    }
+
+    // na is optional per block. if either side has it, pad the other.
+
+    if (block.na().length() || arr->na().length()) {
+      auto na = arr->mutable_na();
+      na->resize(bitset_offset, 0);
+      if (block.na().length()) na->append(block.na());
+      else na->append(BitsetLength(count), 0);
+    }
+  }
+
+  bool Unframe(google::protobuf::Message &message, const char *data, uint32_t len, SharedRing *ring) {
+
+    uint32_t frame_length;
+    uint8_t flags;
+    if (FrameDecoder::ReadHeader(data, len, &frame_length, &flags) != FrameDecoder::header_valid) return false;
+    if (frame_length > len) return false;
+
+    uint32_t bytes = frame_length - FRAME_HEADER_SIZE;
+    data += FRAME_HEADER_SIZE;
+
+    if (flags & FRAME_FLAG_SHARED) {
+
+      // the block in the ring is a regular frame. don't pass the ring, 
+      // descriptors can't nest.
+
+      if (!ring) return false;
+
+      uint32_t shared_length;
+      const char *shared = ring->Acquire(data, bytes, &shared_length);
+      if (!shared) return false;
+
+      bool result = Unframe(message, shared, shared_length);
+      ring->Release();
+      return result;
+    }
+
+    if (flags & FRAME_FLAG_COMPRESSED) {
+
+      uint32_t raw_length;
+      if (bytes < sizeof(uint32_t)) return false;
+      memcpy(reinterpret_cast<void*>(&raw_length), data, sizeof(uint32_t));
+      if (raw_length > FRAME_MAX_LENGTH) return false;
+
+      static thread_local std::string scratch;
+      scratch.resize(raw_length);
+
+      bool result = Compression::Decompress(data + sizeof(uint32_t), bytes - sizeof(uint32_t), &(scratch[0]), raw_length)
+        && message.ParseFromArray(scratch.c_str(), raw_length);
+
+      if (scratch.capacity() > MAX_RETAINED_SCRATCH_SIZE) std::string().swap(scratch);
+      return result;
+    }
+
+    return message.ParseFromArray(data, bytes);
   }
 
   bool Unframe(google::protobuf::Message &message, const std::string &message_buffer) {
     return Unframe(message, message_buffer.c_str(), (uint32_t)message_buffer.length());
   }
   
-  std::string Frame(const google::protobuf::Message &message) {
-    int32_t bytes = message.ByteSize();
-    std::stringstream stream;
-    stream.write(reinterpret_cast<char*>(&bytes), sizeof(int32_t));
-    message.SerializeToOstream(dynamic_cast<std::ostream*>(&stream));
-    return stream.str();
+  std::string Frame(const google::protobuf::Message &message, uint32_t compression_threshold) {
+    std::string buffer;
+    Frame(message, buffer, compression_threshold);
+    return buffer;
+  }
+
+  void Frame(const google::protobuf::Message &message, std::string &buffer, uint32_t compression_threshold) {
+
+    // ByteSizeLong caches sizes, so we can serialize directly into the 
+    // buffer without another pass.
+
+    uint32_t bytes = (uint32_t)message.ByteSizeLong();
+
+    if (compression_threshold && bytes >= compression_threshold) {
+
+      // serialize to scratch, then compress into the buffer. if it doesn't 
+      // get smaller, send it raw (copying from scratch).
+
+      static thread_local std::string scratch;
+      scratch.resize(bytes);
+      message.SerializeWithCachedSizesToArray(reinterpret_cast<google::protobuf::uint8*>(&(scratch[0])));
+
+      size_t bound = Compression::CompressBound(bytes);
+      buffer.resize(FRAME_HEADER_SIZE + sizeof(uint32_t) + bound);
+      char *data = &(buffer[0]);
+
+      size_t compressed = Compression::Compress(scratch.c_str(), bytes, data + FRAME_HEADER_SIZE + sizeof(uint32_t), bound);
+      if (compressed && compressed + sizeof(uint32_t) < bytes) {
+        FrameDecoder::WriteHeader(data, (uint32_t)(compressed + sizeof(uint32_t)), FRAME_FLAG_COMPRESSED);
+        memcpy(data + FRAME_HEADER_SIZE, reinterpret_cast<void*>(&bytes), sizeof(uint32_t));
+        buffer.resize(FRAME_HEADER_SIZE + sizeof(uint32_t) + compressed);
+      }
+      else {
+        buffer.resize(FRAME_HEADER_SIZE + bytes);
+        FrameDecoder::WriteHeader(data, bytes);
+        memcpy(data + FRAME_HEADER_SIZE, scratch.c_str(), bytes);
+      }
+
+      if (scratch.capacity() > MAX_RETAINED_SCRATCH_SIZE) std::string().swap(scratch);
+      return;
+    }
+
+    buffer.resize(FRAME_HEADER_SIZE + bytes);
+    char *data = &(buffer[0]);
+    FrameDecoder::WriteHeader(data, bytes);
+    message.SerializeWithCachedSizesToArray(reinterpret_cast<google::protobuf::uint8*>(data + FRAME_HEADER_SIZE));
+  }
+
+  bool FrameShared(const google::protobuf::Message &message, SharedRing *ring, std::string &buffer, uint32_t threshold) {
+
+    if (!ring || !ring->valid()) return false;
+
+    uint32_t bytes = (uint32_t)message.ByteSizeLong();
+    if (bytes < threshold || bytes > FRAME_MAX_LENGTH) return false;
+
+    char *data = ring->Reserve(FRAME_HEADER_SIZE + bytes);
+    if (!data) return false;
+
+    FrameDecoder::WriteHeader(data, bytes);
+    message.SerializeWithCachedSizesToArray(reinterpret_cast<google::protobuf::uint8*>(data + FRAME_HEADER_SIZE));
+
+    buffer.resize(FRAME_HEADER_SIZE + SHARED_RING_DESCRIPTOR_SIZE);
+    FrameDecoder::WriteHeader(&(buffer[0]), SHARED_RING_DESCRIPTOR_SIZE, FRAME_FLAG_SHARED);
+    ring->Commit(FRAME_HEADER_SIZE + bytes, &(buffer[FRAME_HEADER_SIZE]));
+
+    return true;
   }
 
 #ifdef INCLUDE_DUMP_JSON
@@ -21,8 +21,11 @@
 
 #include <string>
 #include <sstream>
+#include <functional>
 
 #include "variable.pb.h"
+#include "frame_decoder.h"
+#include "shared_ring.h"
 
 // #define INCLUDE_DUMP_JSON
 
@@ -30,6 +33,15 @@
 #include <google\protobuf\util\json_util.h>
 #endif
 
+/**
+ * default size (serialized bytes) above which we compress messages, if 
+ * compression is negotiated; 0 is off. it's off by default because the
+ * transport is a local pipe (or shared memory), and on that compression
+ * never wins at any size (see Bench/bench_compression.cc). set
+ * compressionThreshold in the config to turn it on for slower transports.
+ */
+#define DEFAULT_COMPRESSION_THRESHOLD 0
+
 /**
  * common utilities for protocol buffer messages
  */
@@ -61,10 +73,245 @@ namespace MessageUtilities {
    */
   TypeFlags CheckArrayType(const BERTBuffers::Array &arr, bool allow_nil = true, bool allow_missing = true);
 
+  /** all type flags, i.e. no typed elements yet */
+  const TypeFlags any_type = (TypeFlags::integer | TypeFlags::real | TypeFlags::numeric | TypeFlags::string | TypeFlags::logical);
+
+  /**
+   * array type summary. the sender already touches every element while it
+   * builds an array, so it can classify them at the same time and put the
+   * result in the message (Array.summary); then the receiver doesn't have
+   * to scan the elements again to find out what kind of array it has.
+   *
+   * classification is a table lookup by value case, and the flags are
+   * accumulated without branching, so it's cheap enough to run in the
+   * conversion loop. if you're adding a block of elements of a known type,
+   * use the bulk methods instead of adding elements one at a time.
+   *
+   * type is the same as CheckArrayType with nil and missing allowed.
+   */
+  class ArraySummaryBuilder {
+
+  protected:
+    uint32_t type_;
+    bool has_na_;
+    bool has_names_;
+    size_t min_string_length_;
+    size_t max_string_length_;
+
+  protected:
+    /** lookup tables by value case (see variable.proto; cases are < 16) */
+    static const uint32_t type_table_[16];
+    static const bool na_table_[16];
+
+  public:
+    ArraySummaryBuilder() { Reset(); }
+
+    void Reset() {
+      type_ = any_type;
+      has_na_ = has_names_ = false;
+      min_string_length_ = SIZE_MAX;
+      max_string_length_ = 0;
+    }
+
+    /** add a single element */
+    void Add(const BERTBuffers::Variable &element) {
+      int value_case = element.value_case() & 0x0f;
+      type_ &= type_table_[value_case];
+      has_na_ |= na_table_[value_case];
+      has_names_ |= (element.name().length() != 0);
+      if (value_case == BERTBuffers::Variable::kStr) AddStringLength(element.str().length());
+    }
+
+    /** add elements of a single type (count is only checked for zero) */
+    void AddType(TypeFlags type, size_t count = 1) {
+      if (!count) return;
+      if (type == TypeFlags::integer || type == TypeFlags::real) type = type | TypeFlags::numeric;
+      type_ &= type;
+    }
+
+    /** add nil or missing elements */
+    void AddNA(size_t count = 1) { has_na_ |= (count != 0); }
+
+    /** add a string element (call this instead of AddType for strings) */
+    void AddString(size_t length) {
+      type_ &= TypeFlags::string;
+      AddStringLength(length);
+    }
+
+    /** names may be set after the elements are added */
+    void AddNames() { has_names_ = true; }
+
+    /** write the summary into the array */
+    void Set(BERTBuffers::Array *arr) const;
+
+    /** accessors */
+    TypeFlags type() const { return static_cast<TypeFlags>(type_); }
+    bool has_names() const { return has_names_; }
+
+  protected:
+    void AddStringLength(size_t length) {
+      if (length < min_string_length_) min_string_length_ = length;
+      if (length > max_string_length_) max_string_length_ = length;
+    }
+
+  };
+
   /**
-   * unframe and return message
+   * check for named elements. uses the summary if the array has one,
+   * otherwise scans the elements.
    */
-  bool Unframe(google::protobuf::Message &message, const char *data, uint32_t len);
+  bool ArrayHasNames(const BERTBuffers::Array &arr);
+
+  /**
+   * packed arrays. if an array has a single type (plus nil/missing values),
+   * we can send it as typed repeated fields instead of one Variable per
+   * element. see the Array message in variable.proto.
+   *
+   * nil and missing values are both stored as NA, so they don't round-trip
+   * exactly (they come back as nil).
+   *
+   * packed arrays are only used on the BERT <-> control process pipes, and
+   * only if the control process says it supports them ("packed-arrays"
+   * system call). the console doesn't know about them.
+   */
+  inline bool TestBit(const std::string &bits, int index) {
+    return (bits[index >> 3] & (1 << (index & 7))) ? true : false;
+  }
+
+  inline void SetBit(std::string &bits, int index) {
+    bits[index >> 3] |= (1 << (index & 7));
+  }
+
+  /** bitset length in bytes for n elements */
+  inline size_t BitsetLength(int count) { 
+    return (count + 7) / 8; 
+  }
+
+  inline bool IsPacked(const BERTBuffers::Array &arr) {
+    return arr.packed_type() != 0;
+  }
+
+  /**
+   * columnar arrays have one array (packed, if possible) per column, for 
+   * tables where each column has a single type but the columns differ. 
+   * elements are still indexed in column-major order; see ArrayElement.
+   */
+  inline bool IsColumnar(const BERTBuffers::Array &arr) {
+    return arr.columns_size() != 0;
+  }
+
+  /** check NA for packed array element. assumes length is valid (see ArrayLength) */
+  inline bool IsNA(const BERTBuffers::Array &arr, int index) {
+    return arr.na().length() && TestBit(arr.na(), index);
+  }
+
+  /** 
+   * element count for either packed or unpacked arrays. for packed arrays, 
+   * this validates the typed fields, and returns 0 if they're inconsistent 
+   * (so you can index anything < length without further checks).
+   */
+  int ArrayLength(const BERTBuffers::Array &arr);
+
+  /**
+   * element for any array type. for unpacked arrays this returns the data 
+   * element; otherwise the element is written to scratch (NA is nil). 
+   * assumes index < ArrayLength.
+   */
+  const BERTBuffers::Variable& ArrayElement(const BERTBuffers::Array &arr, int index, BERTBuffers::Variable &scratch);
+
+  /** 
+   * dictionary string for packed string array. returns an empty string for 
+   * NA or invalid indexes.
+   */
+  const std::string& PackedString(const BERTBuffers::Array &arr, int index);
+
+  /**
+   * convert array to packed representation, if possible (single type, 
+   * no names). returns true if the array was packed. 
+   */
+  bool PackArray(BERTBuffers::Array *arr);
+
+  /** 
+   * convert packed or columnar array back to data elements. no-op for 
+   * unpacked arrays.
+   */
+  void UnpackArray(BERTBuffers::Array *arr);
+
+  /** pack arrays in variable, recursively (for lists) */
+  void PackVariable(BERTBuffers::Variable *var);
+
+  /** unpack arrays in variable, recursively */
+  void UnpackVariable(BERTBuffers::Variable *var);
+
+  /** pack/unpack result, function call arguments, or batch calls/results */
+  void PackMessage(BERTBuffers::CallResponse &message);
+
+  void UnpackMessage(BERTBuffers::CallResponse &message);
+
+  /**
+   * run a batch of calls back-to-back, putting results in the response batch
+   * (one per call, in order). each call is swapped into a single function
+   * call message and passed to the call function, so arguments aren't 
+   * copied; the calls in the batch are consumed. errors are returned as
+   * error values.
+   */
+  void RunCallBatch(BERTBuffers::CallResponse &response, BERTBuffers::CallResponse &call, const std::function<void(BERTBuffers::CallResponse&, BERTBuffers::CallResponse&)> &function);
+
+  /**
+   * streamed results. a large (packed) array result can be sent as a header 
+   * message plus a series of block messages, all with the same transaction 
+   * id. that way neither side has to hold the complete framed message, and 
+   * the receiver can convert blocks as they arrive. the sender applies 
+   * backpressure by waiting for pending writes (see Pipe::WaitForWrites).
+   *
+   * blocks are runs of elements in data (column-major) order. block size is 
+   * rounded up to a multiple of 8 so bitsets split on byte boundaries.
+   *
+   * this is negotiated via the "stream-results" system call, and only used 
+   * if packed arrays are also supported.
+   */
+  bool IsStreamedResult(const BERTBuffers::CallResponse &response);
+
+  /**
+   * frame a result as a stream, calling write for each framed message. 
+   * returns false (and doesn't write anything) if the result isn't a packed 
+   * array larger than the block size; send it normally in that case.
+   */
+  bool FrameStreamedResult(const BERTBuffers::CallResponse &response, int block_size, const std::function<void(std::string&&)> &write, uint32_t compression_threshold = 0);
+
+  /** 
+   * append a streamed block to an array. use this to reassemble the 
+   * complete array if you're not converting blocks as they arrive.
+   */
+  void AppendArrayBlock(BERTBuffers::Array *arr, const BERTBuffers::Array &block, int offset);
+
+  /**
+   * receiver for streamed results
+   */
+  class ArrayBlockHandler {
+  public:
+    virtual ~ArrayBlockHandler() {}
+
+    /** header has shape, names, packed type and total length, but no values */
+    virtual void Begin(const BERTBuffers::Array &header) = 0;
+
+    /** block is a packed array; offset is the index of its first element */
+    virtual void Block(const BERTBuffers::Array &block, int offset) = 0;
+
+    /** called when the stream is complete, or on error */
+    virtual void End(bool success) = 0;
+  };
+
+  /**
+   * unframe and return message. parses directly from the buffer; returns 
+   * false if the header is invalid or the buffer is shorter than the framed
+   * length. compressed frames are always accepted. see FrameDecoder for the
+   * header format, and for reading frames from a stream.
+   *
+   * shared frames (descriptors) are read from the ring, in place, and then
+   * released; they're rejected if there's no ring.
+   */
+  bool Unframe(google::protobuf::Message &message, const char *data, uint32_t len, SharedRing *ring = 0);
 
   /**
    * unframe passed string
@@ -74,8 +321,25 @@ namespace MessageUtilities {
   /**
    * frame and return string
    */
-  std::string Frame(const google::protobuf::Message &message);
-  
+  std::string Frame(const google::protobuf::Message &message, uint32_t compression_threshold = 0);
+
+  /**
+   * frame into an existing buffer (replacing contents). reuse the buffer 
+   * to avoid allocating for every message.
+   *
+   * if compression_threshold is non-zero, messages at least that large are
+   * compressed (unless compression doesn't help).
+   */
+  void Frame(const google::protobuf::Message &message, std::string &buffer, uint32_t compression_threshold = 0);
+
+  /**
+   * frame into shared memory. if the message is at least threshold bytes 
+   * and there's space in the ring, serialize it directly into the ring and 
+   * put a descriptor frame (which is small) in buffer; write that to the 
+   * pipe as usual. returns false if we didn't use the ring; use Frame().
+   */
+  bool FrameShared(const google::protobuf::Message &message, SharedRing *ring, std::string &buffer, uint32_t threshold);
+
 #ifdef INCLUDE_DUMP_JSON
 
   /** debug/util function */
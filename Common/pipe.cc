@@ -41,9 +41,10 @@ HANDLE Pipe::wait_handle_write() { return write_io_.hEvent; }
 DWORD Pipe::buffer_size() { return buffer_size_; }
 
 void Pipe::QueueWrites(std::vector<std::string> &list) {
-  for (auto entry : list) {
-    write_stack_.push_back(entry);
+  for (auto &entry : list) {
+    write_stack_.push_back(std::move(entry));
   }
+  list.clear();
 }
 
 void Pipe::PushWrite(const std::string &message) {
@@ -51,8 +52,22 @@ void Pipe::PushWrite(const std::string &message) {
   NextWrite();
 }
 
+void Pipe::PushWrite(std::string &&message) {
+  write_stack_.push_back(std::move(message));
+  NextWrite();
+}
+
 int Pipe::StartRead() {
   if (reading_ || error_ || !connected_) return 0;
+
+  // if we still have a complete frame from the last read, signal so the 
+  // caller comes back for it (see Read)
+
+  if (decoder_.Available()) {
+    SetEvent(read_io_.hEvent);
+    return 0;
+  }
+
   reading_ = true;
   ResetEvent(read_io_.hEvent);
   ReadFile(handle_, read_buffer_, buffer_size_, 0, &read_io_);
@@ -78,6 +93,8 @@ DWORD Pipe::Reset() {
 
   connected_ = reading_ = writing_ = error_ = false;
   message_buffer_.clear();
+  decoder_.Reset();
+  write_stack_.clear();
 
   if (ConnectNamedPipe(handle_, &read_io_)) {
     std::cerr << "ERR in connectNamedPipe" << std::endl;
@@ -127,21 +144,27 @@ int Pipe::NextWrite() {
         return 0; // err (need a flag here)
       }
     }
+
+    // pending write is complete, we can drop it
+
+    write_stack_.pop_front();
+    writing_ = false;
   }
 
   // at this point we're safe to write. we can push more than
-  // one write if they complete immediately
+  // one write if they complete immediately. we write directly from
+  // the queue; the message is removed when the write completes.
 
   while (write_stack_.size()) {
 
     ResetEvent(write_io_.hEvent);
-    std::string message = write_stack_.front();
-    write_stack_.pop_front();
+    const std::string &message = write_stack_.front();
     WriteFile(handle_, message.c_str(), (DWORD)message.length(), NULL, &write_io_);
     result = GetOverlappedResultEx(handle_, &write_io_, &bytes, 0, FALSE);
     if (result) {
       // std::cout << "immediate write success (" << bytes << ")" << std::endl;
       ResetEvent(write_io_.hEvent);
+      write_stack_.pop_front();
       writing_ = false;
     }
     else {
@@ -154,25 +177,24 @@ int Pipe::NextWrite() {
   return 1;
 }
 
-DWORD Pipe::Read(std::string &buf, bool block) {
-
-  // FIXME: what happens in message mode when the buffer is too small? 
-  //
-  // Docs:
-  // In this situation, GetLastError returns ERROR_MORE_DATA, and the client can read the 
-  // remainder of the message using additional calls to ReadFile.
-  // 
+bool Pipe::WaitForWrites(size_t max_pending) {
+  while (write_stack_.size() > max_pending) {
+    if (error_ || !connected_) return false;
+    WaitForSingleObject(write_io_.hEvent, 100);
+    NextWrite();
+  }
+  return !error_;
+}
 
-  // that implies we will need to hold on to the buffer.
+DWORD Pipe::Read(std::string &buf, bool block) {
 
   DWORD bytes = 0;
   DWORD success = GetOverlappedResultEx(handle_, &read_io_, &bytes, block ? INFINITE : 0, FALSE);
 
   if (success) {
     if (message_buffer_.length()) {
-      // std::cout << "appending long mesage (" << bytes << "), this is the end" << std::endl;
-      buf = message_buffer_;
-      buf.append(read_buffer_, bytes);
+      message_buffer_.append(read_buffer_, bytes);
+      buf.swap(message_buffer_);
       message_buffer_.clear();
     }
     else buf.assign(read_buffer_, bytes);
@@ -182,7 +204,6 @@ DWORD Pipe::Read(std::string &buf, bool block) {
   else {
     DWORD err = GetLastError();
     if (err == ERROR_MORE_DATA) {
-      // std::cout << "appending long mesage (" << bytes << "), this is a chunk" << std::endl;
       message_buffer_.append(read_buffer_, bytes);
       reading_ = false;
       StartRead();
@@ -194,6 +215,42 @@ DWORD Pipe::Read(std::string &buf, bool block) {
 
 }
 
+DWORD Pipe::Read(const char **data, DWORD *length, bool block) {
+
+  uint32_t frame_length = 0;
+
+  // a read can contain more than one frame, in which case we return 
+  // the rest without reading (StartRead signals for them)
+
+  if (!reading_ && decoder_.Next(data, &frame_length)) {
+    *length = frame_length;
+    return 0;
+  }
+
+  // in message mode, a message larger than the read buffer returns 
+  // ERROR_MORE_DATA and we read the rest with additional reads. the 
+  // decoder assembles the frame either way.
+
+  DWORD bytes = 0;
+  DWORD success = GetOverlappedResultEx(handle_, &read_io_, &bytes, block ? INFINITE : 0, FALSE);
+  DWORD err = success ? 0 : GetLastError();
+
+  if (success || err == ERROR_MORE_DATA) {
+    reading_ = false;
+    decoder_.Feed(read_buffer_, bytes);
+    if (decoder_.Next(data, &frame_length)) {
+      *length = frame_length;
+      return 0;
+    }
+    StartRead();
+    return ERROR_MORE_DATA;
+  }
+
+  if (err != WAIT_TIMEOUT) error_ = true;
+  return err;
+
+}
+
 std::string Pipe::full_name() {
   std::stringstream pipename;
   pipename << "\\\\.\\pipe\\" << name_;
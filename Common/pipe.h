@@ -29,15 +29,13 @@
 #include <windows.h>
 #include <process.h>
 
+#include "frame_decoder.h"
+
 /**
  * FIXME:
  *
  * (1) consolidate pipe with controlR; they're diverging during development
  *     (which is OK), but unify.
- *
- * (2) if this becomes cross-platform we probably have to do more packet management.
- *     we can merge in the PB framing we are already doing (but maybe add
- *     signifier/magic header?)
  */
 
 #define DEFAULT_BUFFER_SIZE (8 * 1024)
@@ -58,11 +56,18 @@ private:
   char *read_buffer_;
 
   /**
-   * message buffer is for messages that exceed the read buffer size, they're
-   * constructed over multiple reads
+   * message buffer is for (unframed) messages that exceed the read buffer 
+   * size, they're constructed over multiple reads
    */
   std::string message_buffer_;
 
+  /** decoder for framed reads */
+  FrameDecoder decoder_;
+
+  /** 
+   * pending writes. the front message stays in the queue until the write 
+   * completes, so the buffer is valid for the overlapped write.
+   */
   std::deque<std::string> write_stack_;
 
   bool connected_;
@@ -93,9 +98,24 @@ public:
   //DWORD BlockingRead(std::string &buf);
 
 
+  /** read raw data (for unframed pipes, like stdio) */
   DWORD Read(std::string &buffer, bool block = false);
 
+  /**
+   * read a frame, without copying. on success, data points to the frame, 
+   * either in the read buffer or (for frames that span reads) in the frame 
+   * decoder. it's valid until the next call to Read() or StartRead(), so 
+   * consume it (unframe) before doing anything else with the pipe. returns
+   * ERROR_MORE_DATA if we don't have a complete frame yet.
+   */
+  DWORD Read(const char **data, DWORD *length, bool block = false);
+
   void PushWrite(const std::string &message);
+
+  /** push write without copying the message */
+  void PushWrite(std::string &&message);
+
+  /** moves messages from the list (the list is cleared) */
   void QueueWrites(std::vector<std::string> &list);
 
   /**
@@ -105,6 +125,14 @@ public:
    */
   int NextWrite();
 
+  /**
+   * block until there are at most max_pending messages in the write queue.
+   * use this for backpressure when sending a long series of messages 
+   * (streamed results): pipe writes only complete when the other side reads.
+   * returns false on pipe error/disconnect.
+   */
+  bool WaitForWrites(size_t max_pending = 0);
+
   int StartRead();
 
   void ClearError();
@@ -0,0 +1,233 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shared_ring.h"
+
+#include <string.h>
+#include <atomic>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define SHARED_RING_MAGIC     0x52545242 // "BRTR"
+#define SHARED_RING_VERSION   1
+#define SHARED_RING_ALIGN     4096
+
+/**
+ * the header occupies the first page of the mapping; data follows. the
+ * writer only stores head, the reader only stores tail.
+ */
+struct SharedRing::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t capacity;
+  alignas(64) std::atomic<uint64_t> head;
+  alignas(64) std::atomic<uint64_t> tail;
+};
+
+SharedRing::SharedRing()
+  : header_(0)
+  , data_(0)
+  , capacity_(0)
+  , reserved_(0)
+  , acquired_(0)
+  , owner_(false)
+#ifdef _WIN32
+  , mapping_(0)
+#else
+  , mapped_size_(0)
+#endif
+{
+}
+
+SharedRing::~SharedRing() {
+  Close();
+}
+
+bool SharedRing::Map(const std::string &name, uint64_t capacity) {
+
+  static_assert(sizeof(Header) <= SHARED_RING_ALIGN, "shared ring header is too large");
+
+  Close();
+
+  bool create = (capacity != 0);
+  uint64_t size = capacity + SHARED_RING_ALIGN;
+  void *view = 0;
+
+#ifdef _WIN32
+
+  if (create) mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)(size & 0xffffffff), name.c_str());
+  else mapping_ = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+
+  if (!mapping_) return false;
+  if (create && GetLastError() == ERROR_ALREADY_EXISTS) {
+    CloseHandle(mapping_);
+    mapping_ = 0;
+    return false;
+  }
+
+  // size 0 maps the whole thing, which is what we want on open
+
+  view = MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, create ? (SIZE_T)size : 0);
+  if (!view) {
+    CloseHandle(mapping_);
+    mapping_ = 0;
+    return false;
+  }
+
+#else
+
+  std::string path = "/" + name;
+  int fd = create ? shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) : shm_open(path.c_str(), O_RDWR, 0);
+  if (fd < 0) return false;
+
+  if (create) {
+    if (ftruncate(fd, (off_t)size)) {
+      close(fd);
+      shm_unlink(path.c_str());
+      return false;
+    }
+  }
+  else {
+    struct stat st;
+    if (fstat(fd, &st) || (uint64_t)st.st_size <= SHARED_RING_ALIGN) {
+      close(fd);
+      return false;
+    }
+    size = st.st_size;
+  }
+
+  view = mmap(0, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (view == MAP_FAILED) {
+    if (create) shm_unlink(path.c_str());
+    return false;
+  }
+  mapped_size_ = (size_t)size;
+
+#endif
+
+  header_ = reinterpret_cast<Header*>(view);
+  data_ = reinterpret_cast<char*>(view) + SHARED_RING_ALIGN;
+  name_ = name;
+  owner_ = create;
+
+  if (create) {
+    header_->magic = SHARED_RING_MAGIC;
+    header_->version = SHARED_RING_VERSION;
+    header_->capacity = capacity;
+    header_->head.store(0);
+    header_->tail.store(0);
+  }
+  else if (header_->magic != SHARED_RING_MAGIC || header_->version != SHARED_RING_VERSION) {
+    Close();
+    return false;
+  }
+
+  capacity_ = header_->capacity;
+  reserved_ = acquired_ = 0;
+
+  return true;
+}
+
+bool SharedRing::Create(const std::string &name, uint64_t capacity) {
+  if (!capacity) return false;
+  capacity = (capacity + SHARED_RING_ALIGN - 1) & ~((uint64_t)SHARED_RING_ALIGN - 1);
+  return Map(name, capacity);
+}
+
+bool SharedRing::Open(const std::string &name) {
+  return Map(name, 0);
+}
+
+void SharedRing::Close() {
+
+  if (!header_) return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(header_);
+  CloseHandle(mapping_);
+  mapping_ = 0;
+#else
+  munmap(header_, mapped_size_);
+  mapped_size_ = 0;
+  if (owner_) shm_unlink(("/" + name_).c_str());
+#endif
+
+  header_ = 0;
+  data_ = 0;
+  capacity_ = 0;
+  owner_ = false;
+  name_.clear();
+}
+
+char *SharedRing::Reserve(uint32_t length) {
+
+  if (!header_ || !length || length > capacity_) return 0;
+
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  uint64_t tail = header_->tail.load(std::memory_order_acquire);
+
+  // if it doesn't fit before the end, skip to the start
+
+  uint64_t offset = head % capacity_;
+  uint64_t skip = (offset + length > capacity_) ? capacity_ - offset : 0;
+
+  if (length + skip > capacity_ - (head - tail)) return 0;
+
+  reserved_ = head + skip;
+  return data_ + (reserved_ % capacity_);
+}
+
+void SharedRing::Commit(uint32_t length, char *descriptor) {
+  header_->head.store(reserved_ + length, std::memory_order_release);
+  memcpy(descriptor, &reserved_, sizeof(uint64_t));
+  memcpy(descriptor + sizeof(uint64_t), &length, sizeof(uint32_t));
+}
+
+const char *SharedRing::Acquire(const char *descriptor, uint32_t descriptor_length, uint32_t *length) {
+
+  if (!header_ || descriptor_length != SHARED_RING_DESCRIPTOR_SIZE) return 0;
+
+  uint64_t position;
+  memcpy(&position, descriptor, sizeof(uint64_t));
+  memcpy(length, descriptor + sizeof(uint64_t), sizeof(uint32_t));
+
+  // the block has to be published, not yet released, and contiguous
+
+  uint64_t head = header_->head.load(std::memory_order_acquire);
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+
+  if (position < tail || position + *length > head) return 0;
+  if ((position % capacity_) + *length > capacity_) return 0;
+
+  acquired_ = position + *length;
+  return data_ + (position % capacity_);
+}
+
+void SharedRing::Release() {
+  if (header_ && acquired_ > header_->tail.load(std::memory_order_relaxed)) {
+    header_->tail.store(acquired_, std::memory_order_release);
+  }
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#ifdef _WIN32
+#include <SDKDDKVer.h>
+#include <windows.h>
+#endif
+
+// default ring size (per direction), and the message size above which we
+// use shared memory instead of writing through the pipe
+#define DEFAULT_SHARED_RING_SIZE        (32 * 1024 * 1024)
+#define DEFAULT_SHARED_RING_THRESHOLD   (256 * 1024)
+
+// descriptor is position (uint64) and length (uint32)
+#define SHARED_RING_DESCRIPTOR_SIZE     12
+
+/**
+ * single-producer, single-consumer ring buffer in shared memory. one
+ * process creates the ring, the other opens it by name; each ring carries
+ * data in one direction.
+ *
+ * the writer reserves a contiguous block, writes in place and commits,
+ * which produces a (small) descriptor. the descriptor goes through the
+ * pipe as usual, so ordering and signaling are unchanged; the reader uses
+ * the descriptor to find the data, reads in place and releases it.
+ *
+ * positions are monotonic byte counts (offset is position % capacity). if
+ * a block doesn't fit at the end of the ring, we skip to the start; the
+ * skipped space is released along with the block.
+ *
+ * uses file mappings on windows and POSIX shared memory elsewhere.
+ */
+class SharedRing {
+
+protected:
+
+  /** shared header. head and tail are on separate cache lines. */
+  struct Header;
+
+  Header *header_;
+  char *data_;
+  uint64_t capacity_;
+
+  /** writer: position of the reserved block */
+  uint64_t reserved_;
+
+  /** reader: end of the acquired block */
+  uint64_t acquired_;
+
+  /** flag: we created the ring (and should remove it) */
+  bool owner_;
+
+  std::string name_;
+
+#ifdef _WIN32
+  HANDLE mapping_;
+#else
+  size_t mapped_size_;
+#endif
+
+protected:
+
+  /** map, and create if size is non-zero */
+  bool Map(const std::string &name, uint64_t capacity);
+
+public:
+
+  /** create a ring. capacity is rounded up to 4K. */
+  bool Create(const std::string &name, uint64_t capacity);
+
+  /** open a ring created by the other process */
+  bool Open(const std::string &name);
+
+  /** unmap (and remove, if we created it) */
+  void Close();
+
+  /**
+   * writer: reserve a contiguous block. returns 0 if there's not enough
+   * free space (the reader hasn't released enough); send via the pipe
+   * instead in that case.
+   */
+  char *Reserve(uint32_t length);
+
+  /**
+   * writer: publish the reserved block, and write a descriptor
+   * (SHARED_RING_DESCRIPTOR_SIZE bytes) for the reader.
+   */
+  void Commit(uint32_t length, char *descriptor);
+
+  /**
+   * reader: get the block for a descriptor. returns 0 if the descriptor
+   * is invalid. the data is valid until Release().
+   */
+  const char *Acquire(const char *descriptor, uint32_t descriptor_length, uint32_t *length);
+
+  /** reader: release the last acquired block (and anything before it) */
+  void Release();
+
+  /** accessor */
+  bool valid() { return header_ != 0; }
+
+  /** accessor */
+  const std::string &name() { return name_; }
+
+  /** accessor */
+  uint64_t capacity() { return capacity_; }
+
+public:
+  SharedRing();
+  ~SharedRing();
+
+};
@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "transcode.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSCODE_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSCODE_SSE2
+#endif
+
+// strings up to this length (UTF-16 units) are converted on the stack and
+// then copied, so the destination string is sized exactly in one pass
+#define STACK_BUFFER_UNITS 256
+
+#define REPLACEMENT_CHARACTER 0xFFFD
+
+namespace Transcode {
+
+  /**
+   * convert a leading run of ASCII in blocks. returns the number of units
+   * converted, which may stop short of the end of the run; the caller
+   * finishes it one at a time.
+   */
+  static inline size_t AsciiRun16(const uint16_t *source, size_t length, char *dest) {
+
+    size_t i = 0;
+
+#ifdef TRANSCODE_AVX2
+    {
+      const __m256i mask = _mm256_set1_epi16((short)0xff80);
+      for (; i + 32 <= length; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 16));
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), mask)) break;
+
+        // pack works within 128-bit lanes, so fix the order afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), packed);
+      }
+    }
+#endif
+
+#ifdef TRANSCODE_SSE2
+    {
+      const __m128i mask = _mm_set1_epi16((short)0xff80);
+      const __m128i zero = _mm_setzero_si128();
+      for (; i + 16 <= length; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 8));
+        __m128i high = _mm_and_si128(_mm_or_si128(a, b), mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xffff) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(a, b));
+      }
+    }
+#endif
+
+    for (; i + 4 <= length; i += 4) {
+      uint64_t block;
+      memcpy(&block, source + i, sizeof(uint64_t));
+      if (block & 0xFF80FF80FF80FF80ULL) break;
+      dest[i] = (char)source[i];
+      dest[i + 1] = (char)source[i + 1];
+      dest[i + 2] = (char)source[i + 2];
+      dest[i + 3] = (char)source[i + 3];
+    }
+
+    return i;
+  }
+
+  /** same as above, in the other direction */
+  static inline size_t AsciiRun8(const uint8_t *source, size_t length, uint16_t *dest) {
+
+    size_t i = 0;
+
+#ifdef TRANSCODE_AVX2
+    for (; i + 32 <= length; i += 32) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+      if (_mm256_movemask_epi8(v)) break;
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+    }
+#endif
+
+#ifdef TRANSCODE_SSE2
+    {
+      const __m128i zero = _mm_setzero_si128();
+      for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        if (_mm_movemask_epi8(v)) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 8), _mm_unpackhi_epi8(v, zero));
+      }
+    }
+#endif
+
+    for (; i + 8 <= length; i += 8) {
+      uint64_t block;
+      memcpy(&block, source + i, sizeof(uint64_t));
+      if (block & 0x8080808080808080ULL) break;
+      for (int j = 0; j < 8; j++) dest[i + j] = source[i + j];
+    }
+
+    return i;
+  }
+
+  static inline bool IsContinuation(uint8_t b) {
+    return (b & 0xC0) == 0x80;
+  }
+
+  size_t Utf8Length(const uint16_t *source, size_t length) {
+
+    size_t i = 0, count = 0;
+
+    while (i < length) {
+      uint32_t c = source[i++];
+      if (c < 0x80) count++;
+      else if (c < 0x800) count += 2;
+      else if (c >= 0xD800 && c <= 0xDBFF && i < length && source[i] >= 0xDC00 && source[i] <= 0xDFFF) {
+        count += 4;
+        i++;
+      }
+      else count += 3; // including unpaired surrogates (replaced)
+    }
+
+    return count;
+  }
+
+  size_t Utf16ToUtf8(const uint16_t *source, size_t length, char *dest) {
+
+    size_t i = 0;
+    char *out = dest;
+
+    while (i < length) {
+
+      uint32_t c = source[i];
+
+      if (c < 0x80) {
+        size_t count = AsciiRun16(source + i, length - i, out);
+        i += count;
+        out += count;
+        while (i < length && source[i] < 0x80) *out++ = (char)source[i++];
+        continue;
+      }
+
+      i++;
+
+      if (c < 0x800) {
+        *out++ = (char)(0xC0 | (c >> 6));
+        *out++ = (char)(0x80 | (c & 0x3F));
+        continue;
+      }
+
+      if (c >= 0xD800 && c <= 0xDFFF) {
+        if (c <= 0xDBFF && i < length && source[i] >= 0xDC00 && source[i] <= 0xDFFF) {
+          c = 0x10000 + ((c - 0xD800) << 10) + (source[i++] - 0xDC00);
+          *out++ = (char)(0xF0 | (c >> 18));
+          *out++ = (char)(0x80 | ((c >> 12) & 0x3F));
+          *out++ = (char)(0x80 | ((c >> 6) & 0x3F));
+          *out++ = (char)(0x80 | (c & 0x3F));
+          continue;
+        }
+        c = REPLACEMENT_CHARACTER;
+      }
+
+      *out++ = (char)(0xE0 | (c >> 12));
+      *out++ = (char)(0x80 | ((c >> 6) & 0x3F));
+      *out++ = (char)(0x80 | (c & 0x3F));
+    }
+
+    return out - dest;
+  }
+
+  size_t Utf8ToUtf16(const char *data, size_t length, uint16_t *dest) {
+
+    const uint8_t *source = reinterpret_cast<const uint8_t*>(data);
+    size_t i = 0;
+    uint16_t *out = dest;
+
+    while (i < length) {
+
+      uint8_t b0 = source[i];
+
+      if (b0 < 0x80) {
+        size_t count = AsciiRun8(source + i, length - i, out);
+        i += count;
+        out += count;
+        while (i < length && source[i] < 0x80) *out++ = source[i++];
+        continue;
+      }
+
+      // on error we replace the longest valid prefix of the sequence (at
+      // least one byte) with a single replacement character.
+
+      if (b0 >= 0xC2 && b0 <= 0xDF) {
+        if (i + 1 < length && IsContinuation(source[i + 1])) {
+          *out++ = (uint16_t)(((b0 & 0x1F) << 6) | (source[i + 1] & 0x3F));
+          i += 2;
+        }
+        else {
+          *out++ = REPLACEMENT_CHARACTER;
+          i++;
+        }
+      }
+      else if (b0 >= 0xE0 && b0 <= 0xEF) {
+
+        // exclude overlong forms and surrogates
+
+        uint8_t low = (b0 == 0xE0) ? 0xA0 : 0x80;
+        uint8_t high = (b0 == 0xED) ? 0x9F : 0xBF;
+
+        if (i + 1 >= length || source[i + 1] < low || source[i + 1] > high) {
+          *out++ = REPLACEMENT_CHARACTER;
+          i++;
+        }
+        else if (i + 2 >= length || !IsContinuation(source[i + 2])) {
+          *out++ = REPLACEMENT_CHARACTER;
+          i += 2;
+        }
+        else {
+          *out++ = (uint16_t)(((b0 & 0x0F) << 12) | ((source[i + 1] & 0x3F) << 6) | (source[i + 2] & 0x3F));
+          i += 3;
+        }
+      }
+      else if (b0 >= 0xF0 && b0 <= 0xF4) {
+
+        // exclude overlong forms and values past U+10FFFF
+
+        uint8_t low = (b0 == 0xF0) ? 0x90 : 0x80;
+        uint8_t high = (b0 == 0xF4) ? 0x8F : 0xBF;
+
+        if (i + 1 >= length || source[i + 1] < low || source[i + 1] > high) {
+          *out++ = REPLACEMENT_CHARACTER;
+          i++;
+        }
+        else if (i + 2 >= length || !IsContinuation(source[i + 2])) {
+          *out++ = REPLACEMENT_CHARACTER;
+          i += 2;
+        }
+        else if (i + 3 >= length || !IsContinuation(source[i + 3])) {
+          *out++ = REPLACEMENT_CHARACTER;
+          i += 3;
+        }
+        else {
+          uint32_t c = ((b0 & 0x07) << 18) | ((source[i + 1] & 0x3F) << 12) | ((source[i + 2] & 0x3F) << 6) | (source[i + 3] & 0x3F);
+          c -= 0x10000;
+          *out++ = (uint16_t)(0xD800 + (c >> 10));
+          *out++ = (uint16_t)(0xDC00 + (c & 0x3FF));
+          i += 4;
+        }
+      }
+      else {
+        *out++ = REPLACEMENT_CHARACTER;
+        i++;
+      }
+    }
+
+    return out - dest;
+  }
+
+  void Utf16ToUtf8(const uint16_t *source, size_t length, std::string &dest) {
+
+    if (length <= STACK_BUFFER_UNITS) {
+      char buffer[STACK_BUFFER_UNITS * 3];
+      dest.assign(buffer, Utf16ToUtf8(source, length, buffer));
+      return;
+    }
+
+    // for long strings, measure first rather than over-allocating by 3x
+    // (these usually end up in messages, so the capacity sticks around)
+
+    dest.resize(Utf8Length(source, length));
+    Utf16ToUtf8(source, length, &dest[0]);
+  }
+
+}
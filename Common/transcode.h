@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2017-2018 Structured Data, LLC
+ *
+ * This file is part of BERT.
+ *
+ * BERT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BERT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/**
+ * UTF-16 <-> UTF-8 transcoding. this replaces the WideCharToMultiByte/
+ * MultiByteToWideChar pairs (one call to measure, one to convert) we used
+ * for string conversion, and works the same way on other platforms.
+ *
+ * conversion is a single pass that writes directly into the destination,
+ * which has to be large enough for the worst case (see the bound functions).
+ * runs of ASCII are handled 16 (or 32, with AVX2) characters at a time.
+ *
+ * invalid input (unpaired surrogates, malformed UTF-8) is replaced with
+ * U+FFFD, which is what the windows functions do by default.
+ *
+ * there's no shared state, so these are safe to call from any thread.
+ */
+namespace Transcode {
+
+  /** worst-case UTF-8 length (bytes) for length UTF-16 units */
+  inline size_t Utf8Bound(size_t length) { return length * 3; }
+
+  /** worst-case UTF-16 length (units) for length bytes of UTF-8 */
+  inline size_t Utf16Bound(size_t length) { return length; }
+
+  /** exact UTF-8 length (bytes) for UTF-16 data */
+  size_t Utf8Length(const uint16_t *source, size_t length);
+
+  /**
+   * convert UTF-16 to UTF-8. dest must have space for Utf8Bound(length)
+   * bytes. returns the number of bytes written (no terminator).
+   */
+  size_t Utf16ToUtf8(const uint16_t *source, size_t length, char *dest);
+
+  /**
+   * convert UTF-8 to UTF-16. dest must have space for Utf16Bound(length)
+   * units. returns the number of units written (no terminator).
+   */
+  size_t Utf8ToUtf16(const char *source, size_t length, uint16_t *dest);
+
+  /**
+   * convert UTF-16 into a string, replacing its contents. the string is
+   * sized exactly; use this to write into a message field (mutable_str),
+   * or reuse a string across calls to avoid allocating.
+   */
+  void Utf16ToUtf8(const uint16_t *source, size_t length, std::string &dest);
+
+#ifdef _WIN32
+
+  // WCHAR is UTF-16 on windows
+
+  inline size_t Utf16ToUtf8(const wchar_t *source, size_t length, char *dest) {
+    return Utf16ToUtf8(reinterpret_cast<const uint16_t*>(source), length, dest);
+  }
+
+  inline void Utf16ToUtf8(const wchar_t *source, size_t length, std::string &dest) {
+    Utf16ToUtf8(reinterpret_cast<const uint16_t*>(source), length, dest);
+  }
+
+  inline size_t Utf8ToUtf16(const char *source, size_t length, wchar_t *dest) {
+    return Utf8ToUtf16(source, length, reinterpret_cast<uint16_t*>(dest));
+  }
+
+#endif
+
+}
@@ -134,4 +134,95 @@ export class MessageUtilities {
     return v;
   }
 
-}
\ No newline at end of file
+}
+
+/** 
+ * frame header constants, see Common/frame_decoder.h. header is magic 
+ * (uint16), version (uint8), flags (uint8), payload length (uint32), all
+ * little-endian.
+ */
+const FRAME_MAGIC = 0x5442;
+const FRAME_VERSION = 1;
+const FRAME_HEADER_SIZE = 8;
+const FRAME_FLAG_COMPRESSED = 0x01;
+const FRAME_MAX_LENGTH = 0x3FFFFFFF;
+
+/**
+ * framing and incremental frame decoding. mirrors the C++ FrameDecoder:
+ * data can arrive in any size chunks, and on corrupt data we skip ahead
+ * to the next valid header rather than losing sync.
+ */
+export class FrameDecoder {
+
+  /** unconsumed data */
+  private buffer_ = new Uint8Array(0);
+
+  /** count of resync events */
+  private errors_ = 0;
+
+  /** accessor */
+  get errors() { return this.errors_; }
+
+  /** frame a serialized message */
+  static Frame(data: Uint8Array): Uint8Array {
+    let frame = new Uint8Array(data.length + FRAME_HEADER_SIZE);
+    let view = new DataView(frame.buffer);
+    view.setUint16(0, FRAME_MAGIC, true);
+    view.setUint8(2, FRAME_VERSION);
+    view.setUint8(3, 0);
+    view.setUint32(4, data.length, true);
+    frame.set(data, FRAME_HEADER_SIZE);
+    return frame;
+  }
+
+  /** 
+   * check header at offset. returns total frame length, 0 if we need more
+   * data, or -1 if the header is invalid.
+   */
+  private ReadHeader(data: Uint8Array, offset: number): number {
+    let available = data.length - offset;
+    if (available > 0 && data[offset] !== (FRAME_MAGIC & 0xff)) return -1;
+    if (available > 1 && data[offset + 1] !== (FRAME_MAGIC >> 8)) return -1;
+    if (available > 2 && data[offset + 2] !== FRAME_VERSION) return -1;
+    if (available > 3 && (data[offset + 3] & ~FRAME_FLAG_COMPRESSED)) return -1;
+    if (available < FRAME_HEADER_SIZE) return 0;
+    let length = new DataView(data.buffer, data.byteOffset + offset + 4, 4).getUint32(0, true);
+    if (length > FRAME_MAX_LENGTH) return -1;
+    return length + FRAME_HEADER_SIZE;
+  }
+
+  /** 
+   * add a chunk, and return payloads for any complete frames. we don't 
+   * negotiate compression, so compressed frames are dropped.
+   */
+  Push(chunk: Uint8Array): Uint8Array[] {
+
+    let data = chunk;
+    if (this.buffer_.length) {
+      data = new Uint8Array(this.buffer_.length + chunk.length);
+      data.set(this.buffer_, 0);
+      data.set(chunk, this.buffer_.length);
+    }
+
+    let payloads: Uint8Array[] = [];
+    let offset = 0;
+
+    while (offset < data.length) {
+      let frame_length = this.ReadHeader(data, offset);
+      if (frame_length < 0) {
+        this.errors_++;
+        let next = data.indexOf(FRAME_MAGIC & 0xff, offset + 1);
+        offset = next < 0 ? data.length : next;
+        continue;
+      }
+      if (frame_length === 0 || data.length - offset < frame_length) break;
+      if (data[offset + 3] & FRAME_FLAG_COMPRESSED) console.warn("dropping compressed frame");
+      else payloads.push(data.subarray(offset + FRAME_HEADER_SIZE, offset + frame_length));
+      offset += frame_length;
+    }
+
+    this.buffer_ = data.slice(offset);
+    return payloads;
+  }
+
+}
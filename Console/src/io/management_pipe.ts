@@ -19,6 +19,7 @@
 
 import * as net from "net";
 import * as messages from "../../generated/variable_pb.js";
+import { FrameDecoder } from '../common/message_utilities';
 
 /**
  * second pipe for out-of-band management tasks [FIXME: merge]
@@ -56,13 +57,7 @@ export class Pipe2 {
 
     console.info(JSON.stringify(call.toObject(), undefined, 2));
 
-    let data = call.serializeBinary();
-    let frame_length = new Int32Array(1);
-    let frame = new Uint8Array(data.length + 4);
-
-    frame_length[0] = data.length;
-    frame.set(new Uint8Array(frame_length), 0);
-    frame.set(data, 4);
+    let frame = FrameDecoder.Frame(call.serializeBinary());
     this.client_.write(Buffer.from(frame as any)); // ts type is wrong?
 
   }
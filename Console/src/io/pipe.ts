@@ -21,7 +21,7 @@ import * as net from "net";
 import * as messages from "../../generated/variable_pb.js";
 import * as Rx from "rxjs";
 
-import { MessageUtilities } from '../common/message_utilities';
+import { MessageUtilities, FrameDecoder } from '../common/message_utilities';
 
 enum Channel {
   INTERNAL,
@@ -74,6 +74,9 @@ export class Pipe {
   /** pipe connection (nodejs socket) */
   private client_: any;
 
+  /** assembles frames from data events */
+  private decoder_ = new FrameDecoder();
+
   /** 
    * observable state. we can't know about actual state, this
    * just reflects whether _we_ (the console client) are running 
@@ -213,13 +216,7 @@ export class Pipe {
     this.pending_[message.id] = message;
     this.SetBusy(true);
 
-    let data = call.serializeBinary();
-    let frame_length = new Int32Array(1);
-    let frame = new Uint8Array(data.length + 4);
-
-    frame_length[0] = data.length;
-    frame.set(new Uint8Array(frame_length.buffer), 0);
-    frame.set(data, 4);
+    let frame = FrameDecoder.Frame(call.serializeBinary());
 
     try {
       this.client_.write(Buffer.from(frame as any)); // ts type is wrong?
@@ -346,18 +343,12 @@ export class Pipe {
     let resolve = false;
     try {
 
-      let array = new Uint8Array(data.buffer);
-      let stack = [];
+      // data may contain partial frames (or more than one frame); the
+      // decoder holds on to partial data until the rest arrives
 
-      // FIXME: there may be partial packets, in that case we need 
-      // to keep a buffer around
-
-      while (array && array.length) {
-        let byte_length = new Int32Array(array.buffer.slice(0, 4))[0];
-        let response = messages.CallResponse.deserializeBinary(array.slice(4, byte_length + 4));
-        stack.push(response);
-        array = array.slice(byte_length + 4);
-      }
+      let array = new Uint8Array(data.buffer, data.byteOffset, data.length);
+      let stack = this.decoder_.Push(array).map(payload => 
+        messages.CallResponse.deserializeBinary(payload));
 
       stack.forEach(response => {
 
@@ -26,6 +26,7 @@
 #include <deque>
 #include <sstream>
 #include <vector>
+#include <stack>
 #include <iostream>
 
 #include <stdlib.h>
@@ -39,3 +40,14 @@
 #include "message_utilities.h"
 #include "pipe.h"
 #include "process_exit_codes.h"
+
+// pipe index of callback
+#define CALLBACK_INDEX          0
+
+// pipe index of primary client
+#define PRIMARY_CLIENT_INDEX    1
+
+// streamed results: minimum block size (elements), and the number of 
+// blocks we allow in the write queue before waiting for the client
+#define MIN_STREAM_BLOCK_SIZE     1024
+#define MAX_PENDING_STREAM_BLOCKS 2
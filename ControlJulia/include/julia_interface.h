@@ -71,10 +71,21 @@ void JuliaCall(BERTBuffers::CallResponse &response, const BERTBuffers::CallRespo
 /** second-level init */
 bool JuliaPostInit();
 
+/** 
+ * runs queued tasks and pumps the event loop once. call periodically from
+ * the pipe loop; returns true if there's still pending work (call again 
+ * soon), false if julia is idle.
+ */
+bool JuliaIdleTick();
+
 /** reads source file; for julia this uses `import` */
 bool ReadSourceFile(const std::string &file, bool notify = false);
 
-bool Callback(const BERTBuffers::CallResponse &call, BERTBuffers::CallResponse &response);
+/**
+ * callback to BERT (excel, COM). the call is tagged with the id of the BERT
+ * call we're running, so BERT runs it on that call's thread.
+ */
+bool Callback(BERTBuffers::CallResponse &call, BERTBuffers::CallResponse &response);
 
 /** 
  * send message to the console. in julia, stdio is handled separately. console
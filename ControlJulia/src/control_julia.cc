@@ -32,11 +32,40 @@ std::vector<std::string> console_buffer;
 std::string pipename;
 int console_client = -1;
 
+// flag: BERT supports packed arrays (set via system call). typed arrays are
+// packed when they're converted, so if this isn't set (or for the console 
+// client) responses are unpacked.
+bool packed_arrays = false;
+
+// compress responses at least this large (bytes), or 0 for no compression
+// (set via system call). not used for the console client.
+uint32_t compression_threshold = 0;
+
+// block size for streamed results, or 0 if BERT doesn't support streaming
+// (set via system call). also never used for the console client.
+int stream_block_size = 0;
+
+// shared memory rings for large messages, created by BERT (set via system 
+// call). calls come in on call_ring, responses go out on response_ring; only
+// used for the client that set them up.
+SharedRing call_ring, response_ring;
+uint32_t shared_memory_threshold = 0;
+int shared_memory_client = -1;
+
+// id of the BERT call we're running (0 for anything else), by depth. 
+// callbacks carry it, so BERT can run them on the thread that made the call.
+std::stack<uint32_t> active_transaction;
+
 HANDLE prompt_event_handle;
 
 Pipe stdout_pipe, stderr_pipe;
 
-extern void JuliaRunUVLoop(bool until_done);
+/** 
+ * wait timeouts for the pipe loop, in ms. we tick julia on timeout (see
+ * JuliaIdleTick), quickly while it has pending work and slowly otherwise.
+ */
+#define PENDING_TICK_MS 10
+#define IDLE_TICK_MS 100
 
 
 void NextPipeInstance(bool block, std::string &name) {
@@ -100,10 +129,10 @@ std::string GetLastErrorAsString(DWORD err = -1)
 void PushConsoleMessage(google::protobuf::Message &message) {
   std::string framed = MessageUtilities::Frame(message);
   if (console_client >= 0) {
-    pipes[console_client]->PushWrite(framed);
+    pipes[console_client]->PushWrite(std::move(framed));
   }
   else {
-    console_buffer.push_back(framed);
+    console_buffer.push_back(std::move(framed));
   }
 }
 
@@ -141,6 +170,37 @@ void QueueConsoleWrites() {
   console_buffer.clear();
 }
 
+/**
+ * send a response to a call. for BERT (not the console), arrays are packed,
+ * large messages go through shared memory, or else large results are 
+ * streamed and large messages compressed, if supported. streaming blocks 
+ * until the client has read all but the last few blocks.
+ */
+void WriteResponse(Pipe *pipe, int index, BERTBuffers::CallResponse &response) {
+  if (index != console_client) {
+    if (packed_arrays) MessageUtilities::PackMessage(response);
+    else MessageUtilities::UnpackMessage(response);
+    if (index == shared_memory_client) {
+      std::string descriptor;
+      if (MessageUtilities::FrameShared(response, &response_ring, descriptor, shared_memory_threshold)) {
+        pipe->PushWrite(std::move(descriptor));
+        return;
+      }
+    }
+    if (stream_block_size && MessageUtilities::FrameStreamedResult(response, stream_block_size, [pipe](std::string &&frame) {
+      pipe->PushWrite(std::move(frame));
+      pipe->WaitForWrites(MAX_PENDING_STREAM_BLOCKS);
+    }, compression_threshold)) return;
+    pipe->PushWrite(MessageUtilities::Frame(response, compression_threshold));
+    return;
+  }
+
+  // the console doesn't know about packed arrays
+
+  MessageUtilities::UnpackMessage(response);
+  pipe->PushWrite(MessageUtilities::Frame(response));
+}
+
 /**
  * in an effort to make the core language agnostic, all actual functions are moved
  * here. this should cover things like initialization and setting the COM pointers.
@@ -154,6 +214,47 @@ bool SystemCall(BERTBuffers::CallResponse &response, const BERTBuffers::CallResp
   if (!function.compare("get-language")) {
     response.mutable_result()->set_str("Julia");
   }
+  else if (!function.compare("packed-arrays")) {
+    packed_arrays = true;
+    response.mutable_result()->set_boolean(true);
+  }
+  else if (!function.compare("call-batch")) {
+    response.mutable_result()->set_boolean(true);
+  }
+  else if (!function.compare("compression")) {
+    int threshold = 0;
+    if (call.function_call().arguments_size() > 0) threshold = call.function_call().arguments(0).integer();
+    compression_threshold = threshold > 0 ? threshold : 0;
+    response.mutable_result()->set_boolean(true);
+  }
+  else if (!function.compare("stream-results")) {
+    int block_size = 0;
+    if (call.function_call().arguments_size() > 0) block_size = call.function_call().arguments(0).integer();
+    if (block_size > 0) {
+      stream_block_size = ((max(block_size, MIN_STREAM_BLOCK_SIZE) + 7) / 8) * 8;
+      std::cout << "stream results: " << stream_block_size << std::endl;
+    }
+    else stream_block_size = 0;
+    response.mutable_result()->set_boolean(true);
+  }
+  else if (!function.compare("shared-memory")) {
+    bool success = false;
+    if (call.function_call().arguments_size() > 2) {
+      success = call_ring.Open(call.function_call().arguments(0).str())
+        && response_ring.Open(call.function_call().arguments(1).str());
+      int threshold = call.function_call().arguments(2).integer();
+      shared_memory_threshold = threshold > 0 ? threshold : DEFAULT_SHARED_RING_THRESHOLD;
+    }
+    if (success) {
+      shared_memory_client = pipe_index;
+    }
+    else {
+      call_ring.Close();
+      response_ring.Close();
+      shared_memory_client = -1;
+    }
+    response.mutable_result()->set_boolean(success);
+  }
   else if (!function.compare("read-source-file")) {
     std::string file = call.function_call().arguments(0).str();
     bool notify = false;
@@ -223,15 +324,22 @@ void pipe_loop() {
 
   DWORD result;
   uint32_t console_prompt_id = 1;
-  std::string message;
+  const char *message_data = 0;
+  DWORD message_length = 0;
 
   bool executing_command = false;
 
+  // calls can start async work, so after any message we tick soon; the
+  // tick decides whether there's anything actually pending.
+
+  bool julia_pending = false;
+
   ConsolePrompt(default_prompt, console_prompt_id++);
 
   while (true) {
 
-    result = WaitForMultipleObjects((DWORD)handles.size(), &(handles[0]), FALSE, 100);
+    result = WaitForMultipleObjects((DWORD)handles.size(), &(handles[0]), FALSE, julia_pending ? PENDING_TICK_MS : IDLE_TICK_MS);
+    if (result != WAIT_TIMEOUT) julia_pending = true;
 
     if (result == WAIT_OBJECT_0) {
 
@@ -264,15 +372,16 @@ void pipe_loop() {
         pipe->NextWrite();
       }
       else {
-        result = pipe->Read(message);
+        result = pipe->Read(&message_data, &message_length);
         if (!result) {
 
           BERTBuffers::CallResponse call, response;
-          bool success = MessageUtilities::Unframe(call, message);
+          bool success = MessageUtilities::Unframe(call, message_data, message_length, (index == shared_memory_client) ? &call_ring : 0);
 
           if (success) {
 
             response.set_id(call.id());
+            active_transaction.push((index == PRIMARY_CLIENT_INDEX) ? call.id() : 0);
 
             switch (call.operation_case()) {
 
@@ -287,13 +396,30 @@ void pipe_loop() {
                 JuliaCall(response, call);
                 break;
               }
-              if (call.wait()) pipe->PushWrite(MessageUtilities::Frame(response));
+              if (call.wait()) {
+                WriteResponse(pipe, index, response);
+              }
               break;
 
             case BERTBuffers::CallResponse::kCode:
               // std::cout << "code" << std::endl;
               JuliaExec(response, call);
-              if (call.wait()) pipe->PushWrite(MessageUtilities::Frame(response));
+              if (call.wait()) {
+                WriteResponse(pipe, index, response);
+              }
+              break;
+
+            case BERTBuffers::CallResponse::kCallBatch:
+
+              // run all the calls before we go back to the loop. there's one
+              // response for the whole batch.
+
+              MessageUtilities::RunCallBatch(response, call, [](BERTBuffers::CallResponse &single_response, BERTBuffers::CallResponse &single_call) {
+                JuliaCall(single_response, single_call);
+              });
+              if (call.wait()) {
+                WriteResponse(pipe, index, response);
+              }
               break;
 
             case BERTBuffers::CallResponse::kShellCommand:
@@ -315,6 +441,8 @@ void pipe_loop() {
             default:
               0;
             }
+
+            active_transaction.pop();
           }
           else {
             if (pipe->error()) {
@@ -336,10 +464,7 @@ void pipe_loop() {
       }
     }
     else if (result == WAIT_TIMEOUT) {
-      // ...
-
-      // maybe // JuliaRunUVLoop(false); // why not? 
-
+      julia_pending = JuliaIdleTick();
     }
     else {
       std::cerr << "ERR " << result << ": " << GetLastErrorAsString(result) << std::endl;
@@ -481,7 +606,8 @@ unsigned __stdcall ManagementThreadFunction(void *data) {
   std::cout << "start management pipe on " << name << std::endl;
 
   int rslt = pipe.Start(name, false);
-  std::string message;
+  const char *message_data = 0;
+  DWORD message_length = 0;
 
   while (true) {
     result = WaitForSingleObject(pipe.wait_handle_read(), 1000);
@@ -492,10 +618,10 @@ unsigned __stdcall ManagementThreadFunction(void *data) {
         pipe.Connect(); // this will start reading
       }
       else {
-        result = pipe.Read(message);
+        result = pipe.Read(&message_data, &message_length);
         if (!result) {
           BERTBuffers::CallResponse call;
-          bool success = MessageUtilities::Unframe(call, message);
+          bool success = MessageUtilities::Unframe(call, message_data, message_length);
           if (success) {
             //std::string command = call.control_message();
             std::string command = call.function_call().function();
@@ -535,10 +661,12 @@ unsigned __stdcall ManagementThreadFunction(void *data) {
 }
 
 
-bool Callback(const BERTBuffers::CallResponse &call, BERTBuffers::CallResponse &response) {
+bool Callback(BERTBuffers::CallResponse &call, BERTBuffers::CallResponse &response) {
 
   Pipe *pipe = 0;
 
+  call.set_id(active_transaction.size() ? active_transaction.top() : 0);
+
   /* FIXME
   if (active_pipe.size()) {
     int index = active_pipe.top();
@@ -559,13 +687,18 @@ bool Callback(const BERTBuffers::CallResponse &call, BERTBuffers::CallResponse &
   pipe->PushWrite(MessageUtilities::Frame(call));
   pipe->StartRead(); // probably not necessary
 
-  std::string data;
+  const char *data = 0;
+  DWORD length = 0;
   DWORD result;
   do {
-    result = pipe->Read(data, true);
+    result = pipe->Read(&data, &length, true);
   } while (result == ERROR_MORE_DATA);
 
-  if (!result) MessageUtilities::Unframe(response, data);
+  // callback responses are always framed on the pipe, never via the ring
+  // (BERT's callback thread doesn't hold the main pipe's write lock, so it
+  // can't keep ring descriptors in order)
+
+  if (!result) MessageUtilities::Unframe(response, data, length);
 
   pipe->StartRead(); // probably not necessary either
   return (result == 0);
@@ -19,15 +19,202 @@
 
 #include "julia_interface.h"
 
+#include <unordered_map>
+#include <set>
+
 #define JULIA_ENABLE_THREADING 1
 #include "julia.h"
 
 #include "windows_api_functions.h"
 #include "json11/json11.hpp"
+#include "array_conversion.h"
 
 jl_ptls_t ptls; 
 
-jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable) {
+/** precompile functions for the signatures we've seen (see FunctionCache) */
+static bool precompile_signatures = false;
+
+jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable, bool named = true);
+void JlValueToVariable(BERTBuffers::Variable *variable, jl_value_t *value);
+
+/**
+ * base types we need to recognize but which aren't exported from the 
+ * runtime, plus constructors for named values and the task queue, looked 
+ * up once (after init). these are module globals, so they don't need 
+ * rooting. Missing and NamedTuple are null before 0.7; workqueue is null
+ * if it's not a plain array (1.x has per-thread queues).
+ */
+struct BaseTypes {
+  jl_value_t *missing_type;
+  jl_typename_t *complex;
+  jl_typename_t *named_tuple;
+  jl_typename_t *dict;
+  jl_value_t *pair;
+  jl_function_t *kwfunc;
+  jl_function_t *tuple;
+  jl_array_t *workqueue;
+  jl_function_t *yield;
+};
+
+static jl_typename_t *TypeName(jl_value_t *type) {
+  if (!type) return 0;
+  type = jl_unwrap_unionall(type);
+  return jl_is_datatype(type) ? ((jl_datatype_t*)type)->name : 0;
+}
+
+static const BaseTypes& GetBaseTypes() {
+  static BaseTypes base_types = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  static bool initialized = false;
+  if (!initialized) {
+    base_types.missing_type = jl_get_global(jl_base_module, jl_symbol("Missing"));
+    base_types.complex = TypeName(jl_get_global(jl_base_module, jl_symbol("Complex")));
+    base_types.named_tuple = TypeName(jl_get_global(jl_core_module, jl_symbol("NamedTuple")));
+    base_types.dict = TypeName(jl_get_global(jl_base_module, jl_symbol("Dict")));
+    base_types.pair = jl_get_global(jl_base_module, jl_symbol("Pair"));
+    base_types.kwfunc = jl_get_global(jl_core_module, jl_symbol("kwfunc"));
+    base_types.tuple = jl_get_global(jl_core_module, jl_symbol("tuple"));
+    jl_value_t *workqueue = jl_get_global(jl_base_module, jl_symbol("Workqueue"));
+    if (workqueue && jl_is_array(workqueue)) base_types.workqueue = (jl_array_t*)workqueue;
+    base_types.yield = jl_get_global(jl_base_module, jl_symbol("yield"));
+    initialized = true;
+  }
+  return base_types;
+}
+
+/** 
+ * filling large boxed (Any or String) arrays allocates once per element, 
+ * so we turn off gc while filling arrays at least this large. everything 
+ * is still rooted; the point is not to run collections mid-fill.
+ */
+#define DEFER_GC_THRESHOLD (16 * 1024)
+
+jl_value_t * MakeJlString(const std::string &str) {
+  return jl_pchar_to_string(str.c_str(), str.length());
+}
+
+/** per-conversion string cache (see ArrayConversion::StringCache) */
+typedef ArrayConversion::StringCache<jl_value_t*, MakeJlString> JlStringCache;
+
+/**
+ * array conversion sink for typed julia arrays (see ArrayConversion): 
+ * Float64, Int64 and Bool, writing directly into the array data. these 
+ * can't represent NA, so only use them for arrays without NAs. 
+ */
+template <typename T> class TypedArraySink : public ArrayConversion::Sink<TypedArraySink<T>> {
+  T *data_;
+public:
+  TypedArraySink(jl_array_t *julia_array) : data_(reinterpret_cast<T*>(jl_array_data(julia_array))) {}
+  void Real(int out, double value) { data_[out] = static_cast<T>(value); }
+  void Integer(int out, int32_t value) { data_[out] = static_cast<T>(value); }
+  void Logical(int out, bool value) { data_[out] = static_cast<T>(value ? 1 : 0); }
+  void NA(int out) { data_[out] = 0; }
+};
+
+/**
+ * array conversion sink for boxed values, in Any arrays (or typed arrays
+ * via jl_arrayset). NA is nothing. packed strings are created once per 
+ * dictionary entry, and unpacked strings once per distinct value; the 
+ * array and the dictionary are rooted by the caller, and each value goes
+ * into one of them as soon as it's created.
+ *
+ * with defer_gc, gc is off while the sink is in scope (see above).
+ */
+class BoxedArraySink : public ArrayConversion::Sink<BoxedArraySink> {
+  jl_array_t *julia_array_;
+  jl_array_t **dictionary_;
+  JlStringCache cache_;
+  int gc_state_;
+public:
+  BoxedArraySink(jl_array_t *julia_array, jl_array_t **dictionary, bool defer_gc) : julia_array_(julia_array), dictionary_(dictionary), gc_state_(-1) {
+    if (defer_gc) gc_state_ = jl_gc_enable(0);
+  }
+  ~BoxedArraySink() { if (gc_state_ >= 0) jl_gc_enable(gc_state_); }
+  void Real(int out, double value) { jl_arrayset(julia_array_, jl_box_float64(value), out); }
+  void Integer(int out, int32_t value) { jl_arrayset(julia_array_, jl_box_int64(value), out); }
+  void Logical(int out, bool value) { jl_arrayset(julia_array_, jl_box_bool(value), out); }
+  void String(int out, const std::string &str) { jl_arrayset(julia_array_, cache_.Get(str), out); }
+  void Entry(int out, const BERTBuffers::Array &arr, int entry) { jl_arrayset(julia_array_, jl_arrayref(*dictionary_, entry), out); }
+  void NA(int out) { jl_arrayset(julia_array_, jl_nothing, out); }
+  void Other(int out, const BERTBuffers::Variable &var) { jl_arrayset(julia_array_, VariableToJlValue(&var), out); }
+  void Dictionary(const BERTBuffers::Array &arr) {
+    int dictionary_size = arr.dictionary_size();
+    *dictionary_ = jl_alloc_array_1d(jl_apply_array_type((jl_value_t*)jl_any_type, 1), dictionary_size);
+    for (int i = 0; i < dictionary_size; i++) {
+      jl_arrayset(*dictionary_, MakeJlString(arr.dictionary(i)), i);
+    }
+  }
+};
+
+/**
+ * packed array -> julia array. if there are no NAs we can use a typed array
+ * and write the data directly; otherwise we use an Any array with nothing 
+ * for NA values (same as the unpacked version).
+ */
+jl_value_t * PackedArrayToJlValue(const BERTBuffers::Array &arr) {
+
+  int len = MessageUtilities::ArrayLength(arr);
+  int nrows = arr.rows();
+  int ncols = arr.cols();
+
+  if (!nrows || !ncols || len != (nrows * ncols)) {
+    ncols = 1;
+    nrows = len;
+  }
+
+  bool na = false;
+  for (auto c : arr.na()) {
+    if (c) {
+      na = true;
+      break;
+    }
+  }
+
+  jl_datatype_t *array_base_type = jl_any_type;
+  if (!na) {
+    switch (arr.packed_type()) {
+    case MessageUtilities::TypeFlags::integer: array_base_type = jl_int64_type; break;
+    case MessageUtilities::TypeFlags::real: array_base_type = jl_float64_type; break;
+    case MessageUtilities::TypeFlags::string: array_base_type = jl_string_type; break;
+    case MessageUtilities::TypeFlags::logical: array_base_type = jl_bool_type; break;
+    }
+  }
+
+  // both sides are column-major, so we can use linear indexes for 2d arrays
+
+  jl_array_t *julia_array = 0;
+  jl_array_t *dictionary = 0;
+  JL_GC_PUSH2(&julia_array, &dictionary);
+
+  if (ncols == 1) julia_array = jl_alloc_array_1d(jl_apply_array_type((jl_value_t*)array_base_type, 1), nrows);
+  else julia_array = jl_alloc_array_2d(jl_apply_array_type((jl_value_t*)array_base_type, 2), nrows, ncols);
+
+  if (array_base_type == jl_float64_type) {
+    TypedArraySink<double> sink(julia_array);
+    ArrayConversion::Convert(sink, arr, len);
+  }
+  else if (array_base_type == jl_int64_type) {
+    TypedArraySink<int64_t> sink(julia_array);
+    ArrayConversion::Convert(sink, arr, len);
+  }
+  else if (array_base_type == jl_bool_type) {
+    TypedArraySink<int8_t> sink(julia_array);
+    ArrayConversion::Convert(sink, arr, len);
+  }
+  else {
+    BoxedArraySink sink(julia_array, &dictionary, len >= DEFER_GC_THRESHOLD);
+    ArrayConversion::Convert(sink, arr, len);
+  }
+
+  JL_GC_POP();
+  return (jl_value_t*)julia_array;
+}
+
+/**
+ * convert a variable. if named is set and the variable has a name, the 
+ * result is a Pair (name => value). named arrays (any element has a name)
+ * are Any arrays, with Pairs for the named elements.
+ */
+jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable, bool named) {
 
   jl_value_t* value = jl_nothing;
 
@@ -53,11 +240,14 @@ jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable) {
     const auto &com_pointer = variable->com_pointer();
     // std::cout << "installing external pointer: " << com_pointer.interface_name() << " @ " << std::hex << com_pointer.pointer() << std::endl;
 
+    // only the outer array is rooted. inner arrays go into their parent 
+    // as soon as they're allocated, before we fill them, so they're 
+    // always reachable. (the array type is cached, so it doesn't need
+    // rooting).
+
     jl_value_t* array_type = jl_apply_array_type((jl_value_t*)jl_any_type, 1);
     jl_array_t* julia_array = jl_alloc_array_1d(array_type, 4);
-
-    //jl_value_t *element = VariableToJlValue(&(arr.data(i)));
-    //jl_arrayset(julia_array, element, i);
+    JL_GC_PUSH1(&julia_array);
 
     // name
     jl_arrayset(julia_array,
@@ -69,11 +259,13 @@ jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable) {
     // functions
     if (com_pointer.functions_size()) {
       jl_array_t *functions_array = jl_alloc_array_1d(array_type, com_pointer.functions_size());
+      jl_arrayset(julia_array, (jl_value_t*)functions_array, 2);
       for (int i = 0, len = com_pointer.functions_size(); i < len; i++) {
         const auto &function_definition = com_pointer.functions(i);
 
          // function definition should be name, type, index, [params]
         jl_array_t *function_def_array = jl_alloc_array_1d(array_type, 4);
+        jl_arrayset(functions_array, (jl_value_t*)function_def_array, i);
 
         jl_arrayset(function_def_array, 
           jl_pchar_to_string(function_definition.function().name().c_str(), function_definition.function().name().length()), 0);
@@ -92,55 +284,56 @@ jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable) {
         int arguments_count = function_definition.arguments_size();
         if (arguments_count > 0) {
           jl_array_t *arguments_array = jl_alloc_array_1d(array_type, arguments_count);
+          jl_arrayset(function_def_array, (jl_value_t*)arguments_array, 3);
           for (int j = 0; j < arguments_count; j++) {
             const auto &argument = function_definition.arguments(j);
             jl_arrayset(arguments_array,
               jl_pchar_to_string(argument.name().c_str(), argument.name().length()), j);
           }
-          jl_arrayset(function_def_array, (jl_value_t*)arguments_array, 3);
         }
         else {
           jl_arrayset(function_def_array, jl_nothing, 3);
         }
 
-        jl_arrayset(functions_array, (jl_value_t*)function_def_array, i);
       }
-      jl_arrayset(julia_array, (jl_value_t*)functions_array, 2);
     }
     else jl_arrayset(julia_array, jl_nothing, 2);
 
     // enums
     if (com_pointer.enums_size()) {
       jl_array_t *enums_array = jl_alloc_array_1d(array_type, com_pointer.enums_size());
+      jl_arrayset(julia_array, (jl_value_t*)enums_array, 3);
       //jl_tupletype_t *tupletype = jl_apply_tuple_type(jl_svec2(jl_string_type, jl_int32_type));
 
       for (int i = 0, len = com_pointer.enums_size(); i < len; i++) {
         const auto &enum_definition = com_pointer.enums(i);
 
         jl_array_t *enum_array = jl_alloc_array_1d(array_type, 2);
+        jl_arrayset(enums_array, (jl_value_t*)enum_array, i);
         jl_arrayset(enum_array, jl_pchar_to_string(enum_definition.name().c_str(), enum_definition.name().length()), 0);
 
         int enum_values_length = enum_definition.values_size();
         jl_array_t *enum_values_array = jl_alloc_array_1d(array_type, enum_values_length);
+        jl_arrayset(enum_array, (jl_value_t*)enum_values_array, 1);
         for (int j = 0; j < enum_values_length; j++) {
 
-          auto enum_value_list = enum_definition.values(j);
+          const auto &enum_value_list = enum_definition.values(j);
 
-          jl_value_t* jl_value_name = jl_pchar_to_string(enum_value_list.name().c_str(), enum_value_list.name().length());
-          jl_value_t* jl_value_value = jl_box_int32(enum_value_list.value());
+          jl_value_t* jl_value_name = 0;
+          jl_value_t* jl_value_value = 0;
+          JL_GC_PUSH2(&jl_value_name, &jl_value_value);
+          jl_value_name = jl_pchar_to_string(enum_value_list.name().c_str(), enum_value_list.name().length());
+          jl_value_value = jl_box_int32(enum_value_list.value());
           jl_svec_t* svec = jl_svec2(jl_value_name, jl_value_value);
-
           jl_arrayset(enum_values_array, (jl_value_t*)svec, j);
+          JL_GC_POP();
 
         }
-        jl_arrayset(enum_array, (jl_value_t*)enum_values_array, 1);
-
-        jl_arrayset(enums_array, (jl_value_t*)enum_array, i);
       }
-      jl_arrayset(julia_array, (jl_value_t*)enums_array, 3);
     }
     else jl_arrayset(julia_array, jl_nothing, 3);
 
+    JL_GC_POP();
     value = (jl_value_t*)julia_array;
 
     break;
@@ -149,21 +342,35 @@ jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable) {
   {
     const BERTBuffers::Array &arr = variable->arr();
 
+    if (MessageUtilities::IsPacked(arr)) {
+      value = PackedArrayToJlValue(arr);
+      break;
+    }
+
+    // columnar arrays go through here as well
+
     int nrows = arr.rows();
     int ncols = arr.cols();
-    int len = arr.data_size();
+    int len = MessageUtilities::ArrayLength(arr);
 
     if (!nrows || !ncols || len != (nrows * ncols)) {
       ncols = 1;
       nrows = len;
     }
 
-    // FIXME: names?
-
-    // FIXME: types? we should either determine (here or at array creation time)
-    // if the array is a single type (we already do this somewhat for R); then we
-    // can use more efficient julia arrays and use a data pointer rather than the 
-    // set() syntax
+    // names are per-element (only in unpacked arrays), so named arrays
+    // are always Any. this is a vector of Pairs (and values, if not every
+    // element is named), which converts easily to a Dict or NamedTuple.
+
+    if (!MessageUtilities::IsColumnar(arr) && MessageUtilities::ArrayHasNames(arr)) {
+      jl_array_t *julia_array = 0;
+      JL_GC_PUSH1(&julia_array);
+      julia_array = jl_alloc_array_1d(jl_apply_array_type((jl_value_t*)jl_any_type, 1), len);
+      for (int i = 0; i < len; i++) jl_arrayset(julia_array, VariableToJlValue(&(arr.data(i))), i);
+      JL_GC_POP();
+      value = (jl_value_t*)julia_array;
+      break;
+    }
 
     // julia doesn't like sparse arrays [actually they are fine, but they're a 
     // separate type; we will only allow full arrays]
@@ -176,33 +383,37 @@ jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable) {
     else if (type_flags & MessageUtilities::TypeFlags::string) array_base_type = jl_string_type;
     else if (type_flags & MessageUtilities::TypeFlags::logical) array_base_type = jl_bool_type;
 
-    jl_array_t *julia_array = 0; //  jl_nothing;
-    if (ncols == 1) 
-    {
-      jl_value_t* array_type = jl_apply_array_type((jl_value_t*)array_base_type, 1);
-      julia_array = jl_alloc_array_1d(array_type, nrows);
-      
-      for (int i = 0; i < nrows; i++) {
-        jl_value_t *element = VariableToJlValue(&(arr.data(i)));
-        jl_arrayset(julia_array, element, i);
-      }
+    // both sides are column-major, so we can use linear indexes for 2d arrays
 
-    }
-    else {
+    jl_array_t *julia_array = 0;
+    jl_array_t *dictionary = 0;
+    JL_GC_PUSH2(&julia_array, &dictionary);
 
-      jl_value_t* array_type = jl_apply_array_type((jl_value_t*)array_base_type, 2);
-      julia_array = jl_alloc_array_2d(array_type, nrows, ncols);
+    if (ncols == 1) julia_array = jl_alloc_array_1d(jl_apply_array_type((jl_value_t*)array_base_type, 1), nrows);
+    else julia_array = jl_alloc_array_2d(jl_apply_array_type((jl_value_t*)array_base_type, 2), nrows, ncols);
 
-      int index = 0;
-      for (int i = 0; i < ncols; i++) {
-        for (int j = 0; j < nrows; j++) {
-          jl_value_t *element = VariableToJlValue(&(arr.data(index++)));
-          jl_arrayset(julia_array, element, j + nrows * i);
-        }
-      }
+    // single-type arrays have no NAs (see above), so numbers and logicals 
+    // can go directly into the array data
 
+    if (array_base_type == jl_float64_type) {
+      TypedArraySink<double> sink(julia_array);
+      ArrayConversion::Convert(sink, arr, len);
     }
-    
+    else if (array_base_type == jl_int64_type) {
+      TypedArraySink<int64_t> sink(julia_array);
+      ArrayConversion::Convert(sink, arr, len);
+    }
+    else if (array_base_type == jl_bool_type) {
+      TypedArraySink<int8_t> sink(julia_array);
+      ArrayConversion::Convert(sink, arr, len);
+    }
+    else {
+      BoxedArraySink sink(julia_array, &dictionary, len >= DEFER_GC_THRESHOLD);
+      ArrayConversion::Convert(sink, arr, len);
+    }
+
+    JL_GC_POP();
+
     value = (jl_value_t*)julia_array;
     break;
   }
@@ -216,32 +427,260 @@ jl_value_t * VariableToJlValue(const BERTBuffers::Variable *variable) {
     break;
   }
 
-  if (variable->name().length()) {
+  if (named && variable->name().length()) {
+
+    // name => value. this used to create a tuple type per named value,
+    // which went into julia's type cache; Pair{String, T} is created once
+    // per value type. the constructor is cached (see GetBaseTypes).
+
+    jl_value_t* jl_name = 0;
+    JL_GC_PUSH2(&value, &jl_name);
+    jl_name = MakeJlString(variable->name());
+    jl_value_t *pair = jl_call2(GetBaseTypes().pair, jl_name, value);
+    JL_GC_POP();
+    if (pair) return pair;
+    jl_exception_clear();
+
+  }
+
+  return value;
+  
+}
+
+/** nothing and missing are both NA (nil) */
+static inline bool IsNAType(jl_value_t *type) {
+  return type == jl_typeof(jl_nothing) || (type && type == GetBaseTypes().missing_type);
+}
 
-    // create tuple with name, value. the below creates a "DataType" type.
-    // I'd prefer this to be a typed tuple, but one thing at a time.
+/** 
+ * packed type for a julia bits type, or 0 if we don't pack it. integers
+ * go into int32 (as they always have; see ReadIntegers). 
+ */
+static MessageUtilities::TypeFlags PackedTypeFor(jl_value_t *type) {
+  if (type == (jl_value_t*)jl_float64_type || type == (jl_value_t*)jl_float32_type) return MessageUtilities::TypeFlags::real;
+  if (type == (jl_value_t*)jl_int64_type || type == (jl_value_t*)jl_uint64_type 
+    || type == (jl_value_t*)jl_int32_type || type == (jl_value_t*)jl_uint32_type
+    || type == (jl_value_t*)jl_int16_type || type == (jl_value_t*)jl_uint16_type
+    || type == (jl_value_t*)jl_int8_type || type == (jl_value_t*)jl_uint8_type) return MessageUtilities::TypeFlags::integer;
+  if (type == (jl_value_t*)jl_bool_type) return MessageUtilities::TypeFlags::logical;
+  return MessageUtilities::TypeFlags::nil;
+}
 
-    jl_value_t* jl_name = jl_pchar_to_string(variable->name().c_str(), variable->name().length());
+/** read a bits value (possibly unaligned) as T */
+template <typename T> inline T ReadBits(const char *p) {
+  T value;
+  memcpy(&value, p, sizeof(T));
+  return value;
+}
 
-    jl_svec_t * svec = jl_svec2(jl_name, value);
+/** read a float bits value as a double */
+static inline double ReadNumber(jl_value_t *type, const char *p) {
+  if (type == (jl_value_t*)jl_float64_type) return ReadBits<double>(p);
+  if (type == (jl_value_t*)jl_float32_type) return ReadBits<float>(p);
+  return 0;
+}
 
-//    jl_value_t* tuple[] = { jl_name, value };
-//    return (jl_value_t*)jl_apply_tuple_type_v(tuple, 2);
-//    return jl_new_structv(jl_any_type, tuple, 2);
+/** 
+ * read integer bits values as T and narrow to int32, the same way scalars
+ * are narrowed. not via double, which loses 64-bit values. NA is 0.
+ */
+template <typename T> static void ReadIntegers(int32_t *p, const char *data, size_t stride, int len, const std::string &na) {
+  for (int i = 0; i < len; i++) {
+    p[i] = (na.length() && MessageUtilities::TestBit(na, i)) ? 0 : (int32_t)ReadBits<T>(data + i * stride);
+  }
+}
 
-    return (jl_value_t*) jl_apply_tuple_type(svec);
+/**
+ * bits array data -> packed array, for any type with a PackedTypeFor. 
+ * stride is the element size, which for union arrays can be larger than 
+ * the type. if na is set (union arrays) it marks NA elements; it's moved
+ * into the array.
+ */
+static void BitsToPacked(BERTBuffers::Array *arr, jl_value_t *type, const char *data, size_t stride, int len, std::string &na) {
 
+  MessageUtilities::TypeFlags packed_type = PackedTypeFor(type);
+  auto is_na = [&](int i) { return na.length() && MessageUtilities::TestBit(na, i); };
 
+  if (packed_type == MessageUtilities::TypeFlags::real) {
+    auto values = arr->mutable_reals();
+    values->Resize(len, 0);
+    double *p = values->mutable_data();
+    if (type == (jl_value_t*)jl_float64_type && stride == sizeof(double) && na.empty()) memcpy(p, data, sizeof(double) * len);
+    else for (int i = 0; i < len; i++) p[i] = is_na(i) ? 0 : ReadNumber(type, data + i * stride);
+  }
+  else if (packed_type == MessageUtilities::TypeFlags::integer) {
+    auto values = arr->mutable_integers();
+    values->Resize(len, 0);
+    int32_t *p = values->mutable_data();
+    if (type == (jl_value_t*)jl_int32_type && stride == sizeof(int32_t) && na.empty()) memcpy(p, data, sizeof(int32_t) * len);
+    else if (type == (jl_value_t*)jl_int64_type) ReadIntegers<int64_t>(p, data, stride, len, na);
+    else if (type == (jl_value_t*)jl_uint64_type) ReadIntegers<uint64_t>(p, data, stride, len, na);
+    else if (type == (jl_value_t*)jl_int32_type) ReadIntegers<int32_t>(p, data, stride, len, na);
+    else if (type == (jl_value_t*)jl_uint32_type) ReadIntegers<uint32_t>(p, data, stride, len, na);
+    else if (type == (jl_value_t*)jl_int16_type) ReadIntegers<int16_t>(p, data, stride, len, na);
+    else if (type == (jl_value_t*)jl_uint16_type) ReadIntegers<uint16_t>(p, data, stride, len, na);
+    else if (type == (jl_value_t*)jl_int8_type) ReadIntegers<int8_t>(p, data, stride, len, na);
+    else if (type == (jl_value_t*)jl_uint8_type) ReadIntegers<uint8_t>(p, data, stride, len, na);
+  }
+  else {
+    std::string bits(MessageUtilities::BitsetLength(len), 0);
+    for (int i = 0; i < len; i++) {
+      if (!is_na(i) && data[i * stride]) MessageUtilities::SetBit(bits, i);
+    }
+    arr->mutable_logicals()->swap(bits);
   }
 
-  return value;
-  
+  if (na.length()) arr->mutable_na()->swap(na);
+  arr->set_packed_type(packed_type);
+  arr->set_packed_length(len);
+
+}
+
+/**
+ * pointer (boxed) array -> packed array, if every element is a String, or
+ * every element is the same packable bits type, allowing for nothing and 
+ * missing (NA). strings are deduplicated into the dictionary, by object 
+ * and then by value. returns false for anything else (mixed arrays, 
+ * nested arrays, all NA...) and leaves the array alone.
+ */
+static bool PointerArrayToPacked(BERTBuffers::Array *arr, jl_value_t **data, int len) {
+
+  jl_value_t *element_type = 0;
+  bool has_na = false;
+
+  for (int i = 0; i < len; i++) {
+    if (!data[i]) return false; // #undef
+    jl_value_t *type = jl_typeof(data[i]);
+    if (IsNAType(type)) has_na = true;
+    else if (!element_type) {
+      if (type != (jl_value_t*)jl_string_type && !PackedTypeFor(type)) return false;
+      element_type = type;
+    }
+    else if (type != element_type) return false;
+  }
+  if (!element_type) return false;
+
+  std::string na;
+  if (has_na) {
+    na.assign(MessageUtilities::BitsetLength(len), 0);
+    for (int i = 0; i < len; i++) {
+      if (IsNAType(jl_typeof(data[i]))) MessageUtilities::SetBit(na, i);
+    }
+  }
+
+  if (element_type != (jl_value_t*)jl_string_type) {
+
+    // boxed bits values: gather into a contiguous buffer first
+
+    size_t size = jl_datatype_size(element_type);
+    std::string buffer(size * len, 0);
+    for (int i = 0; i < len; i++) {
+      if (!has_na || !MessageUtilities::TestBit(na, i)) memcpy(&(buffer[i * size]), jl_data_ptr(data[i]), size);
+    }
+    BitsToPacked(arr, element_type, buffer.data(), size, len, na);
+    return true;
+
+  }
+
+  std::unordered_map<jl_value_t*, int> objects;
+  std::unordered_map<std::string, int> strings;
+
+  auto values = arr->mutable_integers();
+  values->Resize(len, 0);
+  int32_t *p = values->mutable_data();
+
+  for (int i = 0; i < len; i++) {
+    if (has_na && MessageUtilities::TestBit(na, i)) {
+      p[i] = -1;
+      continue;
+    }
+    auto object = objects.emplace(data[i], 0);
+    if (object.second) {
+      auto str = strings.emplace(std::string(jl_string_ptr(data[i]), jl_string_len(data[i])), (int)strings.size());
+      if (str.second) arr->add_dictionary(str.first->first);
+      object.first->second = str.first->second;
+    }
+    p[i] = object.first->second;
+  }
+
+  if (na.length()) arr->mutable_na()->swap(na);
+  arr->set_packed_type(MessageUtilities::TypeFlags::string);
+  arr->set_packed_length(len);
+  return true;
+
+}
+
+/** Complex{Float64} or Complex{Float32} (bits) -> cpx */
+static bool ComplexToVariable(BERTBuffers::Variable *variable, jl_value_t *type, const char *data) {
+  jl_value_t *component = jl_tparam0(type);
+  auto cpx = variable->mutable_cpx();
+  if (component == (jl_value_t*)jl_float64_type) {
+    cpx->set_r(ReadBits<double>(data));
+    cpx->set_i(ReadBits<double>(data + sizeof(double)));
+  }
+  else if (component == (jl_value_t*)jl_float32_type) {
+    cpx->set_r(ReadBits<float>(data));
+    cpx->set_i(ReadBits<float>(data + sizeof(float)));
+  }
+  else {
+    variable->clear_cpx();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Dict -> array of values, named by key (strings and symbols as-is, 
+ * anything else via string()). order is the dict's iteration order.
+ */
+static bool DictToVariable(BERTBuffers::Variable *variable, jl_value_t *dict) {
+
+  // the dict has to be rooted too: the caller may hold the only reference,
+  // and collect, string() and the element conversions all allocate
+
+  jl_value_t *keys = 0, *values = 0, *key = 0, *element = 0;
+  JL_GC_PUSH5(&keys, &values, &key, &element, &dict);
+
+  jl_function_t *collect = jl_get_function(jl_base_module, "collect");
+  keys = jl_call1(collect, jl_call1(jl_get_function(jl_base_module, "keys"), dict));
+  if (keys) values = jl_call1(collect, jl_call1(jl_get_function(jl_base_module, "values"), dict));
+
+  if (!keys || !values || !jl_is_array(keys) || !jl_is_array(values)) {
+    jl_exception_clear();
+    JL_GC_POP();
+    return false;
+  }
+
+  jl_function_t *string_function = jl_get_function(jl_base_module, "string");
+  auto results_array = variable->mutable_arr();
+  int len = (int)jl_array_len(keys);
+  results_array->set_rows(len);
+  results_array->set_cols(1);
+  results_array->mutable_data()->Reserve(len);
+
+  for (int i = 0; i < len; i++) {
+    auto result = results_array->add_data();
+    element = jl_arrayref((jl_array_t*)values, i);
+    JlValueToVariable(result, element);
+    key = jl_arrayref((jl_array_t*)keys, i);
+    if (jl_is_symbol(key)) result->set_name(jl_symbol_name((jl_sym_t*)key));
+    else {
+      if (!jl_is_string(key)) key = jl_call1(string_function, key);
+      if (key && jl_is_string(key)) result->set_name(std::string(jl_string_ptr(key), jl_string_len(key)));
+    }
+  }
+
+  JL_GC_POP();
+  return true;
+
 }
 
 void JlValueToVariable(BERTBuffers::Variable *variable, jl_value_t *value) {
 
-  // nothing/null/nil
-  if (jl_is_nothing(value)) {
+  const BaseTypes &base_types = GetBaseTypes();
+
+  // nothing/null/nil, missing
+  if (jl_is_nothing(value) || IsNAType(jl_typeof(value))) {
     variable->set_nil(true);
     return;
   }
@@ -293,8 +732,21 @@ void JlValueToVariable(BERTBuffers::Variable *variable, jl_value_t *value) {
     variable->set_integer(jl_unbox_int8(value));
     return;
   }
+  if (jl_typeis(value, jl_uint16_type)) {
+    variable->set_integer(jl_unbox_uint16(value));
+    return;
+  }
+  if (jl_typeis(value, jl_uint8_type)) {
+    variable->set_integer(jl_unbox_uint8(value));
+    return;
+  }
 
-  // complex...
+  // complex
+
+  jl_value_t *value_type = jl_typeof(value);
+  if (jl_is_datatype(value_type) && ((jl_datatype_t*)value_type)->name == base_types.complex) {
+    if (ComplexToVariable(variable, value_type, (const char*)jl_data_ptr(value))) return;
+  }
 
   // array
 
@@ -326,51 +778,113 @@ void JlValueToVariable(BERTBuffers::Variable *variable, jl_value_t *value) {
 
     // std::cout << "arr: " << ncols << ", " << nrows << ", " << len << "; dims=" << ndims << ", p? " << (jl_array->flags.ptrarray != 0) << std::endl;
 
+    // typed arrays are written as packed arrays. that includes boxed 
+    // arrays (strings, unions with missing, Any) if all the elements 
+    // have the same type; otherwise it's one element at a time. if BERT
+    // doesn't support packed arrays they're unpacked on the way out.
+
     if (jl_array->flags.ptrarray) {
       jl_value_t** data = (jl_value_t**)(jl_array_data(jl_array));
-      for (int i = 0; i < len; i++) JlValueToVariable(results_array->add_data(), data[i]);
-      return;
-    }
-    else if (eltype == jl_float64_type) {
-      double *d = (double*)jl_array_data(jl_array);
-      for (int i = 0; i < len; i++) results_array->add_data()->set_real(d[i]);
-      return;
-    }
-    else if (eltype == jl_float32_type) {
-      float *d = (float*)jl_array_data(jl_array);
-      for (int i = 0; i < len; i++) results_array->add_data()->set_real(d[i]);
+      if (PointerArrayToPacked(results_array, data, len)) return;
+      results_array->mutable_data()->Reserve(len);
+      for (int i = 0; i < len; i++) {
+        if (data[i]) JlValueToVariable(results_array->add_data(), data[i]);
+        else results_array->add_data()->set_nil(true);
+      }
       return;
     }
-    else if (eltype == jl_int64_type) {
-      int64_t *d = (int64_t*)jl_array_data(jl_array);
-      for (int i = 0; i < len; i++) results_array->add_data()->set_integer(d[i]);
+
+    if (PackedTypeFor(eltype)) {
+      std::string na;
+      BitsToPacked(results_array, eltype, (const char*)jl_array_data(jl_array), jl_array->elsize, len, na);
       return;
     }
-    else if (eltype == jl_uint64_type) {
-      uint64_t *d = (uint64_t*)jl_array_data(jl_array);
-      for (int i = 0; i < len; i++) results_array->add_data()->set_integer(d[i]);
-      return;
+
+    if (jl_is_datatype(eltype) && ((jl_datatype_t*)eltype)->name == base_types.complex) {
+      const char *data = (const char*)jl_array_data(jl_array);
+      results_array->mutable_data()->Reserve(len);
+      for (int i = 0; i < len; i++) {
+        if (!ComplexToVariable(results_array->add_data(), eltype, data + i * jl_array->elsize)) {
+          results_array->clear_data();
+          break;
+        }
+      }
+      if (results_array->data_size()) return;
     }
-    else if (eltype == jl_int32_type) {
-      int32_t *d = (int32_t*)jl_array_data(jl_array);
-      for (int i = 0; i < len; i++) results_array->add_data()->set_integer(d[i]);
-      return;
+
+#if JULIA_VERSION_MAJOR >= 1 || JULIA_VERSION_MINOR >= 7
+
+    // bits unions, like Union{Missing, Float64}, store values inline 
+    // followed by a selector byte per element, which is the index of the
+    // element's type in the union (in order, a then b).
+
+    if (jl_is_uniontype(eltype)) {
+      jl_value_t *a = ((jl_uniontype_t*)eltype)->a;
+      jl_value_t *b = ((jl_uniontype_t*)eltype)->b;
+      uint8_t na_selector = IsNAType(a) ? 0 : 1;
+      jl_value_t *type = na_selector ? a : b;
+      if (IsNAType(na_selector ? b : a) && PackedTypeFor(type)) {
+        const uint8_t *selectors = (const uint8_t*)jl_array_typetagdata(jl_array);
+        std::string na(MessageUtilities::BitsetLength(len), 0);
+        bool has_na = false;
+        for (int i = 0; i < len; i++) {
+          if (selectors[i] == na_selector) {
+            MessageUtilities::SetBit(na, i);
+            has_na = true;
+          }
+        }
+        if (!has_na) na.clear();
+        BitsToPacked(results_array, type, (const char*)jl_array_data(jl_array), jl_array->elsize, len, na);
+        return;
+      }
     }
-    else if (eltype == jl_int8_type) {
-      int8_t *d = (int8_t*)jl_array_data(jl_array);
-      for (int i = 0; i < len; i++) results_array->add_data()->set_integer(d[i]);
-      return;
+
+#endif
+
+  }
+
+  // named tuple (0.7+): named array, in field order
+
+  if (base_types.named_tuple && jl_is_datatype(value_type) && ((jl_datatype_t*)value_type)->name == base_types.named_tuple) {
+    jl_value_t *names = jl_tparam0(value_type);
+    jl_value_t *field = 0;
+    JL_GC_PUSH2(&field, &value); // fieldref boxes, so root the tuple too
+    auto results_array = variable->mutable_arr();
+    int len = jl_nfields(value);
+    results_array->set_rows(len);
+    results_array->set_cols(1);
+    for (int i = 0; i < len; i++) {
+      auto result = results_array->add_data();
+      field = jl_fieldref(value, i);
+      JlValueToVariable(result, field);
+      jl_value_t *name = jl_fieldref(names, i);
+      if (jl_is_symbol(name)) result->set_name(jl_symbol_name((jl_sym_t*)name));
     }
-    else if (eltype == jl_bool_type) {
-      int8_t *d = (int8_t*)jl_array_data(jl_array);
-      for (int i = 0; i < len; i++) results_array->add_data()->set_boolean(d[i]);
-      return;
+    JL_GC_POP();
+    return;
+  }
+
+  // tuple: array
+
+  if (jl_is_tuple(value)) {
+    jl_value_t *field = 0;
+    JL_GC_PUSH2(&field, &value);
+    auto results_array = variable->mutable_arr();
+    int len = jl_nfields(value);
+    results_array->set_rows(len);
+    results_array->set_cols(1);
+    for (int i = 0; i < len; i++) {
+      field = jl_fieldref(value, i);
+      JlValueToVariable(results_array->add_data(), field);
     }
-   
-    // string? 
+    JL_GC_POP();
+    return;
+  }
 
-    // pointer?
-    
+  // dict: named array
+
+  if (base_types.dict && jl_is_datatype(value_type) && ((jl_datatype_t*)value_type)->name == base_types.dict) {
+    if (DictToVariable(variable, value)) return;
   }
 
   /*
@@ -428,9 +942,9 @@ void JlValueToVariable(BERTBuffers::Variable *variable, jl_value_t *value) {
 
     // FIXME: this may have changed in v0.7; check when you switch
 
-    jl_datatype_t* value_type = (jl_datatype_t*)(jl_typeof(value));
-    if (value_type->size != 8) {
-      std::cerr << "warning: pointer size not == 8 (" << value_type->size << ")" << std::endl;
+    jl_datatype_t* pointer_type = (jl_datatype_t*)value_type;
+    if (pointer_type->size != 8) {
+      std::cerr << "warning: pointer size not == 8 (" << pointer_type->size << ")" << std::endl;
     }
     else {
       auto com_pointer = variable->mutable_com_pointer();
@@ -443,7 +957,6 @@ void JlValueToVariable(BERTBuffers::Variable *variable, jl_value_t *value) {
 
   // FIXME: remove
 
-  jl_value_t *value_type = jl_typeof(value);
   jl_printf(JL_STDOUT, "unexpected type (0x%X): ", value_type);
   jl_static_show(JL_STDOUT, value_type);
   jl_printf(JL_STDOUT, "\n");
@@ -504,6 +1017,10 @@ void JuliaInit() {
       if (compare == "off") jl_options.polly = JL_OPTIONS_POLLY_OFF;
     }
 
+    if (julia["precompileSignatures"].is_string()) {
+      precompile_signatures = (julia["precompileSignatures"].string_value() == "yes");
+    }
+
   }
 
   ptls = jl_get_ptls_states();
@@ -543,6 +1060,102 @@ jl_function_t* ResolveFunction(const std::string &function) {
 
 }
 
+/**
+ * resolved functions, by name, so calls from the sheet don't have to walk
+ * modules every time. a name can be rebound (and the old function 
+ * collected) while we're holding it, so cached functions are rooted in an 
+ * Any vector bound in the BERT module. top-level code (source files, exec, 
+ * shell) is what rebinds names, so running any of that clears the cache.
+ *
+ * with "precompileSignatures" set in the Julia config, we also keep the 
+ * argument types each function has been called with (positional calls 
+ * only). when a source file is reloaded we precompile the new definitions
+ * for those signatures, so the first call after a reload doesn't pay for
+ * compilation. types are rooted separately, since they outlive the cache.
+ */
+struct FunctionCache {
+  std::unordered_map<std::string, jl_function_t*> functions;
+  std::unordered_map<std::string, std::set<std::vector<jl_value_t*>>> signatures;
+  jl_array_t *function_roots;
+  jl_array_t *type_roots;
+};
+
+static FunctionCache function_cache;
+
+static jl_array_t *RootArray(const char *name) {
+  jl_sym_t *symbol = jl_symbol(name);
+  jl_value_t *module = jl_get_global(jl_main_module, jl_symbol("BERT"));
+  if (!module || !jl_is_module(module)) module = (jl_value_t*)jl_main_module;
+  jl_array_t *roots = jl_alloc_array_1d(jl_apply_array_type((jl_value_t*)jl_any_type, 1), 0);
+  jl_set_global((jl_module_t*)module, symbol, (jl_value_t*)roots);
+  return roots;
+}
+
+jl_function_t* CachedFunction(const std::string &name) {
+
+  auto iter = function_cache.functions.find(name);
+  if (iter != function_cache.functions.end()) return iter->second;
+
+  // don't cache misses; the name may be defined later
+
+  jl_function_t *function_pointer = ResolveFunction(name);
+  if (!function_pointer || jl_is_nothing(function_pointer)) return function_pointer;
+
+  if (!function_cache.function_roots) function_cache.function_roots = RootArray("__function_cache");
+  jl_array_ptr_1d_push(function_cache.function_roots, function_pointer);
+  function_cache.functions[name] = function_pointer;
+  return function_pointer;
+
+}
+
+void ClearFunctionCache() {
+  function_cache.functions.clear();
+  if (function_cache.function_roots) jl_array_del_end(function_cache.function_roots, jl_array_len(function_cache.function_roots));
+}
+
+/** arguments must be rooted */
+static void RecordSignature(const std::string &name, jl_value_t **arguments, int count) {
+
+  std::vector<jl_value_t*> types(count);
+  for (int i = 0; i < count; i++) types[i] = jl_typeof(arguments[i]);
+
+  auto &seen = function_cache.signatures[name];
+  if (seen.find(types) != seen.end()) return;
+
+  if (!function_cache.type_roots) function_cache.type_roots = RootArray("__signature_types");
+  for (auto type : types) jl_array_ptr_1d_push(function_cache.type_roots, type);
+  seen.insert(types);
+
+}
+
+/**
+ * precompile(f, (types...)) for every signature we've seen. errors (the 
+ * function no longer takes those types, or is gone) are just dropped.
+ */
+static void PrecompileSignatures() {
+
+  if (!precompile_signatures || function_cache.signatures.empty()) return;
+
+  jl_function_t *precompile = jl_get_function(jl_base_module, "precompile");
+  if (!precompile) return;
+
+  jl_value_t *types = 0;
+  JL_GC_PUSH1(&types);
+
+  for (const auto &entry : function_cache.signatures) {
+    jl_function_t *function_pointer = CachedFunction(entry.first);
+    if (!function_pointer || jl_is_nothing(function_pointer)) continue;
+    for (const auto &signature : entry.second) {
+      types = jl_call(GetBaseTypes().tuple, const_cast<jl_value_t**>(signature.data()), (int32_t)signature.size());
+      if (types) jl_call2(precompile, function_pointer, types);
+      jl_exception_clear();
+    }
+  }
+
+  JL_GC_POP();
+
+}
+
 void ReportJuliaException(const char *tag, bool backtrace = false) {
 
   std::cout << " * CATCH [" << tag << "]" << std::endl;
@@ -575,12 +1188,31 @@ void ReportJuliaException(const char *tag, bool backtrace = false) {
 
 }
 
-void JuliaRunUVLoop(bool until_done) {
-  while (true) {
-    int remaining_handles = uv_run(jl_global_event_loop(), UV_RUN_NOWAIT);
-    if (!remaining_handles) break;
-    if (!until_done) break;
+/**
+ * we used to drain the libuv loop after every call, which is expensive 
+ * next to a trivial function. now we only run it if there's something 
+ * active (output being written, timers, sockets), and only for a few 
+ * passes: a repeating timer or an open socket keeps the loop alive 
+ * indefinitely, and draining that would never return. anything left over
+ * is picked up by the idle tick (JuliaIdleTick).
+ *
+ * returns true if the loop still has active handles or requests.
+ */
+#define UV_DRAIN_PASSES 8
+
+bool JuliaRunUVLoop(bool until_done) {
+  uv_loop_t *loop = jl_global_event_loop();
+  if (!uv_loop_alive(loop)) return false;
+  int passes = until_done ? UV_DRAIN_PASSES : 1;
+  for (int i = 0; i < passes; i++) {
+    if (!uv_run(loop, UV_RUN_NOWAIT)) return false;
   }
+  return true;
+}
+
+static bool TasksQueued() {
+  const BaseTypes &base_types = GetBaseTypes();
+  return base_types.workqueue && jl_array_len(base_types.workqueue) > 0;
 }
 
 __inline bool ReportException(const char *tag) {
@@ -595,6 +1227,21 @@ __inline bool ReportException(const char *tag) {
   return false;
 }
 
+bool JuliaIdleTick() {
+
+  // uv callbacks only schedule tasks; they run when the root task yields.
+  // we are the root task, so yield if anything's waiting.
+
+  const BaseTypes &base_types = GetBaseTypes();
+  if (base_types.yield && TasksQueued()) {
+    jl_call0(base_types.yield);
+    ReportException("idle-tick");
+  }
+
+  return JuliaRunUVLoop(false) || TasksQueued();
+
+}
+
 bool ReadSourceFile(const std::string &file, bool notify) {
 
   // should be able to cache this one
@@ -617,6 +1264,12 @@ bool ReadSourceFile(const std::string &file, bool notify) {
     jl_exception_clear();
   }
 
+  // new definitions: drop cached functions, and optionally compile 
+  // the new versions for signatures we've already seen
+
+  ClearFunctionCache();
+  PrecompileSignatures();
+
   JuliaRunUVLoop(true);
 
   return function_result; // false;
@@ -719,6 +1372,7 @@ ExecResult JuliaShellExec(const std::string &command, const std::string &shell_b
     result = ExecResult::Error;
   }
 
+  ClearFunctionCache();
   JuliaRunUVLoop(true);
 
   return result;
@@ -801,7 +1455,6 @@ jl_value_t* Callback2(const char *command, void *data1, void *data2, void *data3
   }
   */
   
-  static uint32_t callback_id = 1;
   jl_value_t *jl_result = jl_nothing;
 
   if (!command || !command[0]) return jl_result;
@@ -809,7 +1462,6 @@ jl_value_t* Callback2(const char *command, void *data1, void *data2, void *data3
   BERTBuffers::CallResponse *call = new BERTBuffers::CallResponse;
   BERTBuffers::CallResponse *response = new BERTBuffers::CallResponse;
 
-  call->set_id(callback_id++);
   call->set_wait(true);
 
   auto callback = call->mutable_function_call();
@@ -835,26 +1487,111 @@ jl_value_t* Callback2(const char *command, void *data1, void *data2, void *data3
 }
 
 
+/**
+ * call a function with arguments from a call message. unnamed arguments
+ * are positional; named arguments are keyword arguments, passed through
+ * the function's keyword sorter (Core.kwfunc). the keywords are a flat
+ * Any array of symbols and values before 0.7, and a NamedTuple after. 
+ * everything is rooted while we convert and call. like jl_call, this 
+ * returns null if there's an exception.
+ *
+ * if signature_name is set, successful positional calls record their 
+ * argument types under that name (see FunctionCache).
+ */
+jl_value_t *CallWithArguments(jl_function_t *function, const google::protobuf::RepeatedPtrField<BERTBuffers::Variable> &arguments, const std::string *signature_name = 0) {
+
+  const BaseTypes &base_types = GetBaseTypes();
+  int len = arguments.size();
+  int keyword_count = 0;
+  for (const auto &argument : arguments) {
+    if (argument.name().length()) keyword_count++;
+  }
+
+  // no keywords: just positional arguments. if there's no kwfunc, names
+  // are passed as Pairs. the last slot roots the result.
+
+  if (!keyword_count || !base_types.kwfunc) {
+    jl_value_t **values;
+    JL_GC_PUSHARGS(values, len + 1);
+    for (int i = 0; i < len; i++) values[i] = VariableToJlValue(&(arguments.Get(i)));
+    jl_value_t *result = values[len] = jl_call(function, values, len);
+    if (result && signature_name) RecordSignature(*signature_name, values, len);
+    JL_GC_POP();
+    return result;
+  }
+
+  // slots: sorter, keywords, function, positional arguments, then scratch 
+  // for building the keywords. we call sorter(keywords, function, ...).
+
+  const int scratch_count = 3;
+  int positional_count = len - keyword_count;
+  jl_value_t **values;
+  JL_GC_PUSHARGS(values, positional_count + 3 + scratch_count);
+  jl_value_t **scratch = values + positional_count + 3;
+
+  values[2] = function;
+  jl_value_t *result = 0;
+
+  jl_array_t *keyword_values = jl_alloc_array_1d(jl_apply_array_type((jl_value_t*)jl_any_type, 1), keyword_count);
+  scratch[0] = (jl_value_t*)keyword_values;
+  std::vector<jl_value_t*> keyword_names;
+
+  for (int i = 0, positional = 0; i < len; i++) {
+    const auto &argument = arguments.Get(i);
+    if (argument.name().length()) {
+      jl_arrayset(keyword_values, VariableToJlValue(&argument, false), keyword_names.size());
+      keyword_names.push_back((jl_value_t*)jl_symbol(argument.name().c_str()));
+    }
+    else values[3 + positional++] = VariableToJlValue(&argument);
+  }
+
+#if JULIA_VERSION_MAJOR >= 1 || JULIA_VERSION_MINOR >= 7
+
+  // NamedTuple{names}(values). symbols are permanent, so the names 
+  // vector doesn't need rooting.
+
+  scratch[1] = jl_call(base_types.tuple, keyword_names.data(), keyword_count);
+  if (scratch[1]) scratch[2] = jl_call(base_types.tuple, (jl_value_t**)jl_array_data(keyword_values), keyword_count);
+  if (scratch[2]) {
+    jl_value_t *named_tuple_type = jl_apply_type1(jl_get_global(jl_core_module, jl_symbol("NamedTuple")), scratch[1]);
+    scratch[1] = named_tuple_type;
+    values[1] = jl_call1(named_tuple_type, scratch[2]);
+  }
+
+#else
+
+  // [:name1, value1, :name2, value2, ...]
+
+  jl_array_t *keywords = jl_alloc_array_1d(jl_apply_array_type((jl_value_t*)jl_any_type, 1), keyword_count * 2);
+  values[1] = (jl_value_t*)keywords;
+  for (int i = 0; i < keyword_count; i++) {
+    jl_arrayset(keywords, keyword_names[i], i * 2);
+    jl_arrayset(keywords, jl_arrayref(keyword_values, i), i * 2 + 1);
+  }
+
+#endif
+
+  if (values[1]) values[0] = jl_call1(base_types.kwfunc, function);
+  if (values[0]) result = jl_call(values[0], values + 1, positional_count + 2);
+
+  JL_GC_POP();
+  return result;
+
+}
+
 jl_value_t *JuliaCallJlValue(const BERTBuffers::CompositeFunctionCall &call) {
 
-  jl_function_t *function_pointer = ResolveFunction(call.function());
+  jl_function_t *function_pointer = CachedFunction(call.function());
   jl_value_t *function_result = jl_nothing;
   if (!function_pointer || jl_is_nothing(function_pointer)) return function_result;
 
+  // nothing else holds the result until we return it
+  JL_GC_PUSH1(&function_result);
+
   JL_TRY{
 
     // call here, with or without arguments
-    int len = call.arguments().size();
-  if (len > 0) {
-    std::vector<jl_value_t*> arguments_vector;
-    for (auto argument : call.arguments()) {
-      arguments_vector.push_back(VariableToJlValue(&argument));
-    }
-    function_result = jl_call(function_pointer, &(arguments_vector[0]), len);
-  }
-  else {
-    function_result = jl_call0(function_pointer);
-  }
+    function_result = CallWithArguments(function_pointer, call.arguments(), precompile_signatures ? &call.function() : 0);
   ReportException("JCJV");
 
   }
@@ -874,6 +1611,7 @@ jl_value_t *JuliaCallJlValue(const BERTBuffers::CompositeFunctionCall &call) {
 
   }
 
+  JL_GC_POP();
   return function_result;
 }
 
@@ -892,7 +1630,6 @@ jl_value_t * COMCallback(uint64_t pointer, const char *name, const char *calltyp
 
   */
   
-  static uint32_t callback_id = 1;
   jl_value_t *jl_result = jl_nothing;
 
   if (!name || !name[0]) return jl_result;
@@ -900,7 +1637,6 @@ jl_value_t * COMCallback(uint64_t pointer, const char *name, const char *calltyp
   BERTBuffers::CallResponse *call = new BERTBuffers::CallResponse;
   BERTBuffers::CallResponse *response = new BERTBuffers::CallResponse;
 
-  call->set_id(callback_id++);
   call->set_wait(true);
 
   //auto callback = call->mutable_com_callback();
@@ -1017,26 +1753,22 @@ void JuliaCall(BERTBuffers::CallResponse &response, const BERTBuffers::CallRespo
 
   // lookup in main includes our defined functions plus (apparently) Base, which 
   // is attached is some fashion. can we dereference pacakges? [A: no, probably 
-  // need to do that manually]. [moved to function]
+  // need to do that manually]. [moved to function; cached, see FunctionCache]
 
-  jl_function_t *function_pointer = ResolveFunction(function);
+  jl_function_t *function_pointer = CachedFunction(function);
   if (!function_pointer || jl_is_nothing(function_pointer)) return;
-  jl_value_t *function_result;
+
+  // the result isn't referenced from julia, and the conversion allocates 
+  // (boxing, strings, dict/tuple walks), so keep it rooted until we're done
+
+  jl_value_t *function_result = 0;
+  JL_GC_PUSH1(&function_result);
 
   JL_TRY {
 
-    // call here, with or without arguments
-    int len = call.function_call().arguments().size();
-    if (len > 0) {
-      std::vector<jl_value_t*> arguments_vector;
-      for (auto argument : call.function_call().arguments()) {
-        arguments_vector.push_back(VariableToJlValue(&argument));
-      }
-      function_result = jl_call(function_pointer, &(arguments_vector[0]), len);
-    }
-    else {
-      function_result = jl_call0(function_pointer);
-    }
+    // call here, with or without arguments. named arguments are keyword
+    // arguments (see CallWithArguments).
+    function_result = CallWithArguments(function_pointer, call.function_call().arguments(), precompile_signatures ? &function : 0);
 
     // check for a julia exception (handled)
     if (jl_exception_occurred()) {
@@ -1075,6 +1807,8 @@ void JuliaCall(BERTBuffers::CallResponse &response, const BERTBuffers::CallRespo
 
   }
 
+  JL_GC_POP();
+
   JuliaRunUVLoop(true);
 
   // JlValueToVariable(response.mutable_result(), function_result);
@@ -1240,6 +1974,8 @@ void JuliaExec(BERTBuffers::CallResponse &response, const BERTBuffers::CallRespo
     jl_exception_clear();
   }
 
+  ClearFunctionCache();
+
   // flag indicates that this is startup, so take any final setup actions.
   // FIXME: should this gate on success, above? (...)
 
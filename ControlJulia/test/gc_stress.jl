@@ -0,0 +1,94 @@
+#
+# Copyright (c) 2017-2018 Structured Data, LLC
+# 
+# This file is part of BERT.
+#
+# BERT is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# BERT is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with BERT.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+#
+# GC stress for result conversion (JlValueToVariable). load this file as a
+# functions file in BERT, then recalculate a sheet with
+#
+#   =GCStressDict(1000)   =GCStressTuple(1000)   =GCStressNamedTuple(1000)
+#
+# (a few hundred times: put each in a column, or use F9). every result is
+# built fresh and returned, so nothing but the converter holds it. the dict
+# keys are a type without a string method of their own, so the converter
+# calls string() on each one -- and that runs a full collection, in the
+# middle of the walk. anything the converter hasn't rooted (the dict, the
+# tuple, boxed fields) is collected and reused, which shows up as garbage
+# values or a crash in the control process.
+#
+# GCStressDictCheck compares a dict result with what was built.
+#
+
+struct GCStressKey
+  value::Int
+end
+
+collect_garbage() = VERSION >= v"0.7.0-" ? Base.GC.gc() : Base.gc()
+
+# every key conversion runs a full collection
+Base.string(key::GCStressKey) = (collect_garbage(); "key $(key.value)")
+
+# values that need boxing or allocation when they're converted
+stress_value(i) = (i % 3 == 0) ? Float64(i) : (i % 3 == 1) ? "value $i" : Int32(i)
+
+"""
+Dict with keys that collect garbage when converted. values are a mix of
+reals, strings and integers, so conversion allocates too.
+
+"""
+function GCStressDict(n)
+  d = Dict{Any, Any}(GCStressKey(i) => stress_value(i) for i in 1:Int(n))
+  d[GCStressKey(0)] = sum(1:Int(n))
+  d
+end
+
+"""
+Tuple of freshly allocated values, with a GC-stress dict in the middle
+(converted while the tuple's later fields are still to come).
+
+"""
+function GCStressTuple(n)
+  n = Int(n)
+  (string("first ", n), GCStressDict(n), [Float64(i) for i in 1:n], string("last ", n), sum(1:n))
+end
+
+"""
+NamedTuple version of GCStressTuple (julia 0.7+).
+
+"""
+function GCStressNamedTuple(n)
+  n = Int(n)
+  NamedTuple{(:first, :dict, :values, :last, :check)}(GCStressTuple(n))
+end
+
+"""
+check a GCStressDict result after it has been through excel, e.g. 
+=GCStressDictCheck(1000, GCStressDict(1000)). the values come back in
+the dict's order, so compare as sets.
+
+"""
+function GCStressDictCheck(n, result...)
+  n = Int(n)
+  values = collect(Base.Iterators.flatten(result))
+  expected = Any[stress_value(i) for i in 1:n]
+  push!(expected, sum(1:n))
+  strings = sort([x for x in values if isa(x, AbstractString)])
+  numbers = sort([Float64(x) for x in values if isa(x, Number)])
+  strings == sort([x for x in expected if isa(x, AbstractString)]) && numbers == sort([Float64(x) for x in expected if isa(x, Number)])
+end
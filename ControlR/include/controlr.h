@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include <stack>
+#include <unordered_map>
 
 #include "variable.pb.h"
 #include "string_utilities.h"
@@ -44,10 +45,15 @@
 #define SYSTEMCALL_OK           0
 #define SYSTEMCALL_SHUTDOWN    -1
 
+// streamed results: minimum block size (elements), and the number of 
+// blocks we allow in the write queue before waiting for the client
+#define MIN_STREAM_BLOCK_SIZE     1024
+#define MAX_PENDING_STREAM_BLOCKS 2
+
 /**
  * calls an R function, by name, possibly with arguments
  */
-BERTBuffers::CallResponse& RCall(BERTBuffers::CallResponse &rsp, const BERTBuffers::CallResponse &call);
+BERTBuffers::CallResponse& RCall(BERTBuffers::CallResponse &rsp, BERTBuffers::CallResponse &call);
 
 /** 
  * runs arbitrary R code
@@ -75,9 +81,10 @@ bool ConsoleCallback(const BERTBuffers::CallResponse &call, BERTBuffers::CallRes
 bool ReadSourceFile(const std::string &file, bool notify = false);
 
 /**
- *
+ * callback to BERT (excel, COM, graphics). the call is tagged with the id
+ * of the BERT call we're running, so BERT runs it on that call's thread.
  */
-bool Callback(const BERTBuffers::CallResponse &call, BERTBuffers::CallResponse &response);
+bool Callback(BERTBuffers::CallResponse &call, BERTBuffers::CallResponse &response);
 
 /**
 * this is a reimplementation of R's parse status eunm; that one is
@@ -19,16 +19,25 @@
  
 #pragma once
 
-#include <Windows.h>
 #include <stdint.h>
+#include <string.h>
 #include <string>
 
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
 /**
- * thanks to
- * http://www.zedwood.com/article/cpp-is-valid-utf8-string-function
+ * check for valid UTF-8. if len is <= 0, string is null-terminated.
  */
 bool ValidUTF8(const char *string, int len);
 
-void WindowsCPToUTF8(const char *input_buffer, int input_length, char **output_buffer, int *output_length);
+#ifdef _WIN32
+
+/**
+ * convert from a windows code page (by default the system code page) to 
+ * UTF-8. if input_length is <= 0, input is null-terminated.
+ */
+void WindowsCPToUTF8(const char *input_buffer, int input_length, std::string *output, UINT code_page = CP_ACP);
 
-std::string WindowsCPToUTF8_2(const char *input_buffer, int input_length);
+#endif // #ifdef _WIN32
@@ -19,92 +19,161 @@
 
 #include "convert.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CONVERT_SSE2
+#endif
+
 /**
- * thanks to
- * http://www.zedwood.com/article/cpp-is-valid-utf8-string-function
+ * below this length, the block checks cost more than they save (short 
+ * columns like tickers), so ValidUTF8 checks bytes instead. see 
+ * Bench/bench_valid_utf8.cc.
  */
-bool ValidUTF8(const char *string, int len) {
+#define ASCII_BLOCK_MIN_LENGTH 16
 
-  if (len <= 0) len = strlen(string);
-
-  int c, i, ix, n, j;
-  for (i = 0, ix = len; i < ix; i++)
-  {
-    c = (unsigned char)string[i];
-    //if (c==0x09 || c==0x0a || c==0x0d || (0x20 <= c && c <= 0x7e) ) n = 0; // is_printable_ascii
-    if (0x00 <= c && c <= 0x7f) n = 0; // 0bbbbbbb
-    else if ((c & 0xE0) == 0xC0) n = 1; // 110bbbbb
-    else if (c == 0xed && i<(ix - 1) && ((unsigned char)string[i + 1] & 0xa0) == 0xa0) return false; //U+d800 to U+dfff
-    else if ((c & 0xF0) == 0xE0) n = 2; // 1110bbbb
-    else if ((c & 0xF8) == 0xF0) n = 3; // 11110bbb
-                                        //else if (($c & 0xFC) == 0xF8) n=4; // 111110bb //byte 5, unnecessary in 4 byte UTF-8
-                                        //else if (($c & 0xFE) == 0xFC) n=5; // 1111110b //byte 6, unnecessary in 4 byte UTF-8
-    else return false;
-    for (j = 0; j<n && i<ix; j++) { // n bytes matching 10bbbbbb follow ?
-      if ((++i == ix) || (((unsigned char)string[i] & 0xC0) != 0x80))
-        return false;
-    }
+/**
+ * length of the leading run of ASCII bytes. checks 16 bytes at a time 
+ * (SSE2: the high bit of each byte is the movemask), then words, then 
+ * bytes for the tail or to find the exact position.
+ */
+static inline int AsciiPrefixLength(const unsigned char *string, int len) {
+
+  int i = 0;
+
+#ifdef CONVERT_SSE2
+  for (; i + 16 <= len; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string + i));
+    if (_mm_movemask_epi8(block)) break;
   }
-  return true;
+#endif
+
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, string + i, 8);
+    if (word & 0x8080808080808080ULL) break;
+  }
+
+  for (; i < len && string[i] < 0x80; i++);
+  return i;
+
 }
 
 /**
- * convert. see docs elsewhere on rationale. this method owns
- * the output buffer; copy if you need to preserve it.
+ * length of the (non-ASCII) UTF-8 sequence at the start of string, or 0 if 
+ * it's not valid. this follows RFC 3629, so it rejects overlong forms, 
+ * surrogates (U+D800-DFFF) and anything past U+10FFFF.
  */
-void WindowsCPToUTF8(const char *input_buffer, int input_length, char **output_buffer, int *output_length){
+static inline int SequenceLength(const unsigned char *string, int len) {
+
+  unsigned char c = string[0];
+  unsigned char low = 0x80, high = 0xbf; // range for the second byte
+  int n;
+
+  if (c < 0xc2) return 0; // continuation byte, or overlong 2-byte lead
+  else if (c < 0xe0) n = 2;
+  else if (c < 0xf0) {
+    n = 3;
+    if (c == 0xe0) low = 0xa0;
+    else if (c == 0xed) high = 0x9f;
+  }
+  else if (c < 0xf5) {
+    n = 4;
+    if (c == 0xf0) low = 0x90;
+    else if (c == 0xf4) high = 0x8f;
+  }
+  else return 0;
 
-  const int32_t chunk = 256; // 32;
+  if (len < n) return 0;
+  if (string[1] < low || string[1] > high) return 0;
+  for (int j = 2; j < n; j++) {
+    if ((string[j] & 0xc0) != 0x80) return 0;
+  }
+  return n;
 
-  static char *narrow_string = new char[chunk];
-  static uint32_t narrow_string_length = chunk;
+}
 
-  static WCHAR *wide_string = new WCHAR[chunk];
-  static uint32_t wide_string_length = chunk;
-  
-  // stats? bad guesses?
+/**
+ * most strings are all or mostly ASCII, so skip ASCII runs in blocks and 
+ * only look at multibyte sequences one at a time. consecutive sequences
+ * (CJK text) go straight from one to the next, without an ASCII scan.
+ */
+bool ValidUTF8(const char *string, int len) {
+
+  if (len <= 0) len = (int)strlen(string);
+
+  const unsigned char *bytes = reinterpret_cast<const unsigned char*>(string);
+  int i = 0;
 
-  // we can probably use fixed buffers here and expand, on the theory
-  // that they won't get too large... if anything most console messages are 
-  // too small, we should do some buffering (not here)
+  // short strings that start with ASCII are usually all ASCII. check the 
+  // whole string with two overlapping loads (first and last 8 or 4 bytes),
+  // and only fall back to the loop if any high bit is set.
 
-  int wide_size = MultiByteToWideChar(CP_ACP, MB_COMPOSITE, input_buffer, input_length, 0, 0);
-  if (wide_size >= wide_string_length) {
-    wide_string_length = chunk * (1 + (wide_size / chunk));
-    delete[] wide_string;
-    wide_string = new WCHAR[wide_string_length];
+  if (len < ASCII_BLOCK_MIN_LENGTH && bytes[0] < 0x80) {
+    if (len >= 8) {
+      uint64_t head, tail;
+      memcpy(&head, bytes, 8);
+      memcpy(&tail, bytes + len - 8, 8);
+      if (!((head | tail) & 0x8080808080808080ULL)) return true;
+    }
+    else if (len >= 4) {
+      uint32_t head, tail;
+      memcpy(&head, bytes, 4);
+      memcpy(&tail, bytes + len - 4, 4);
+      if (!((head | tail) & 0x80808080U)) return true;
+    }
+    else {
+      unsigned char high = 0;
+      for (; i < len; i++) high |= bytes[i];
+      if (!(high & 0x80)) return true;
+      i = 0;
+    }
   }
-  MultiByteToWideChar(CP_ACP, MB_COMPOSITE, input_buffer, input_length, wide_string, wide_string_length);
-  wide_string[wide_size] = 0;
 
-  int narrow_size = WideCharToMultiByte(CP_UTF8, 0, wide_string, wide_size, 0, 0, 0, 0);
-  if (narrow_size >= narrow_string_length) {
-    narrow_string_length = chunk * (1 + (narrow_size / chunk));
-    delete[] narrow_string;
-    narrow_string = new char[narrow_string_length];
+  while (i < len) {
+    if (bytes[i] < 0x80) i += AsciiPrefixLength(bytes + i, len - i);
+    else {
+      int n = SequenceLength(bytes + i, len - i);
+      if (!n) return false;
+      i += n;
+    }
   }
-  WideCharToMultiByte(CP_UTF8, 0, wide_string, wide_size, narrow_string, narrow_string_length, 0, 0);
-  narrow_string[narrow_size] = 0;
 
-  *output_buffer = narrow_string;
-  *output_length = narrow_size;
+  return true;
 
 }
 
+#ifdef _WIN32
+
 /**
- * alloc-heavy version
+ * code page -> UTF-8 (via UTF-16). output is owned by the caller, so this
+ * is reentrant; reuse the output string to keep its capacity. the wide 
+ * string is on the stack unless it's large.
  */
-std::string WindowsCPToUTF8_2(const char *input_buffer, int input_length) {
-  
-  if (input_length <= 0) input_length = strlen(input_buffer);
+void WindowsCPToUTF8(const char *input_buffer, int input_length, std::string *output, UINT code_page) {
+
+  const int stack_chunk = 256;
+
+  if (input_length <= 0) input_length = (int)strlen(input_buffer);
+  if (!input_length) {
+    output->clear();
+    return;
+  }
 
-  int wide_size = MultiByteToWideChar(CP_ACP, MB_COMPOSITE, input_buffer, input_length, 0, 0);
-  std::wstring wide_string(wide_size, '\0');
-  MultiByteToWideChar(CP_ACP, MB_COMPOSITE, input_buffer, input_length, &(wide_string[0]), wide_size);
+  WCHAR stack_buffer[stack_chunk];
+  std::wstring heap_buffer;
+  WCHAR *wide_string = stack_buffer;
 
-  int narrow_size = WideCharToMultiByte(CP_UTF8, 0, &(wide_string[0]), wide_size, 0, 0, 0, 0);
-  std::string narrow_string(narrow_size, '\0');
-  WideCharToMultiByte(CP_UTF8, 0, &(wide_string[0]), wide_size, &(narrow_string[0]), narrow_size, 0, 0);
+  int wide_size = MultiByteToWideChar(code_page, MB_COMPOSITE, input_buffer, input_length, 0, 0);
+  if (wide_size > stack_chunk) {
+    heap_buffer.resize(wide_size);
+    wide_string = &(heap_buffer[0]);
+  }
+  MultiByteToWideChar(code_page, MB_COMPOSITE, input_buffer, input_length, wide_string, wide_size);
+
+  int narrow_size = WideCharToMultiByte(CP_UTF8, 0, wide_string, wide_size, 0, 0, 0, 0);
+  output->resize(narrow_size);
+  if (narrow_size) WideCharToMultiByte(CP_UTF8, 0, wide_string, wide_size, &((*output)[0]), narrow_size, 0, 0);
 
-  return narrow_string;
 }
+
+#endif // #ifdef _WIN32
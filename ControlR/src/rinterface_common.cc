@@ -22,6 +22,7 @@
 #include "console_graphics_device.h"
 #include "spreadsheet_graphics_device.h"
 #include "convert.h"
+#include "array_conversion.h"
 
 #include "gdi_graphics_device.h"
 
@@ -42,6 +43,96 @@ void SetNames(SEXP variable, const std::vector<std::string> &names) {
   Rf_setAttrib(variable, R_NamesSymbol, names_sexp);
 }
 
+/**
+ * array conversion sinks for R vectors (see ArrayConversion). NA is the R
+ * NA for the vector type; so are values that don't fit the type (these 
+ * shouldn't happen, the type comes from the array).
+ */
+class RealVectorSink : public ArrayConversion::Sink<RealVectorSink> {
+  double *p_;
+public:
+  RealVectorSink(SEXP vector) : p_(REAL(vector)) {}
+  void Real(int out, double value) { p_[out] = value; }
+  void NA(int out) { p_[out] = NA_REAL; }
+};
+
+class IntegerVectorSink : public ArrayConversion::Sink<IntegerVectorSink> {
+  int *p_;
+public:
+  IntegerVectorSink(SEXP vector) : p_(INTEGER(vector)) {}
+  void Integer(int out, int32_t value) { p_[out] = value; }
+  void NA(int out) { p_[out] = NA_INTEGER; }
+};
+
+class LogicalVectorSink : public ArrayConversion::Sink<LogicalVectorSink> {
+  int *p_;
+public:
+  LogicalVectorSink(SEXP vector) : p_(LOGICAL(vector)) {}
+  void Logical(int out, bool value) { p_[out] = value ? 1 : 0; }
+  void NA(int out) { p_[out] = NA_LOGICAL; }
+};
+
+/** UTF-8 string -> CHARSXP. strings from BERT are always UTF-8. */
+inline SEXP MakeChar(const std::string &str) {
+  return Rf_mkCharLenCE(str.c_str(), (int)str.length(), CE_UTF8);
+}
+
+/** UTF-8 string -> character vector (length 1) */
+SEXP MakeString(const std::string &str) {
+  SEXP charsxp = PROTECT(MakeChar(str));
+  SEXP result = Rf_ScalarString(charsxp);
+  UNPROTECT(1);
+  return result;
+}
+
+/**
+ * per-call CHARSXP cache (see ArrayConversion::StringCache). store each 
+ * CHARSXP in a protected vector right away (SET_STRING_ELT).
+ */
+typedef ArrayConversion::StringCache<SEXP, MakeChar> CharsxpCache;
+
+/** 
+ * strings are interned (see CharsxpCache). packed strings create each 
+ * dictionary string once, then share the CHARSXPs; the dictionary is 
+ * protected while the sink is in scope.
+ */
+class StringVectorSink : public ArrayConversion::Sink<StringVectorSink> {
+  SEXP vector_;
+  SEXP dictionary_;
+  PROTECT_INDEX index_;
+  CharsxpCache &cache_;
+public:
+  StringVectorSink(SEXP vector, CharsxpCache &cache) : vector_(vector), dictionary_(R_NilValue), cache_(cache) {
+    PROTECT_WITH_INDEX(dictionary_, &index_);
+  }
+  ~StringVectorSink() { UNPROTECT(1); }
+  void String(int out, const std::string &str) { SET_STRING_ELT(vector_, out, cache_.Get(str)); }
+  void Entry(int out, const BERTBuffers::Array &arr, int entry) { SET_STRING_ELT(vector_, out, STRING_ELT(dictionary_, entry)); }
+  void NA(int out) { SET_STRING_ELT(vector_, out, NA_STRING); }
+  void Dictionary(const BERTBuffers::Array &arr) {
+    int dictionary_size = arr.dictionary_size();
+    REPROTECT(dictionary_ = Rf_allocVector(STRSXP, dictionary_size), index_);
+    for (int i = 0; i < dictionary_size; i++) {
+      SET_STRING_ELT(dictionary_, i, MakeChar(arr.dictionary(i)));
+    }
+  }
+};
+
+SEXP VariableToSEXP(const BERTBuffers::Variable &var);
+
+/** mixed types (and columnar arrays) are lists. NA is NULL, same as nil. */
+class ListSink : public ArrayConversion::Sink<ListSink> {
+  SEXP list_;
+public:
+  ListSink(SEXP list) : list_(list) {}
+  void Real(int out, double value) { SET_VECTOR_ELT(list_, out, Rf_ScalarReal(value)); }
+  void Integer(int out, int32_t value) { SET_VECTOR_ELT(list_, out, Rf_ScalarInteger(value)); }
+  void Logical(int out, bool value) { SET_VECTOR_ELT(list_, out, Rf_ScalarLogical(value ? 1 : 0)); }
+  void String(int out, const std::string &str) { SET_VECTOR_ELT(list_, out, MakeString(str)); }
+  void NA(int out) { SET_VECTOR_ELT(list_, out, R_NilValue); }
+  void Other(int out, const BERTBuffers::Variable &var) { SET_VECTOR_ELT(list_, out, VariableToSEXP(var)); }
+};
+
 SEXP VariableToSEXP(const BERTBuffers::Variable &var) {
 
   switch (var.value_case()) {
@@ -50,7 +141,7 @@ SEXP VariableToSEXP(const BERTBuffers::Variable &var) {
     return R_NilValue;
 
   case BERTBuffers::Variable::ValueCase::kStr:
-    return Rf_mkString(var.str().c_str());
+    return MakeString(var.str());
 
   case BERTBuffers::Variable::ValueCase::kInteger:
     return Rf_ScalarInteger(var.integer());
@@ -88,95 +179,99 @@ SEXP VariableToSEXP(const BERTBuffers::Variable &var) {
   {
     const BERTBuffers::Array &arr = var.arr();
 
+    int count = MessageUtilities::ArrayLength(arr);
     int rows = arr.rows();
     int cols = arr.cols();
-    int count = rows * cols;
 
-    // if there are now rows/cols, use data_size() and treat as rows (for no reason).
-    // do this as well if there's a mismatch.
+    // if there are no rows/cols, treat as a vector. do this as well if 
+    // there's a mismatch.
 
-    if (!count && arr.data_size()
-      || count != arr.data_size()) {
-      count = rows = arr.data_size();
+    if (rows * cols != count) {
+      rows = count;
       cols = 0;
     }
-    
-    // check for single type (in R, we can include nulls and NAs in the array)
 
-    MessageUtilities::TypeFlags type_flags = MessageUtilities::CheckArrayType(arr, true, true);
+    // packed arrays have a single type. for unpacked arrays, check for a 
+    // single type (in R, we can include nulls and NAs in the array) and 
+    // names. use the sender's summary if there is one, otherwise scan once
+    // for both. columnar arrays have mixed types, so they're lists, the 
+    // same as mixed unpacked arrays.
 
+    bool packed = MessageUtilities::IsPacked(arr);
+    bool columnar = MessageUtilities::IsColumnar(arr);
+    MessageUtilities::TypeFlags type_flags = MessageUtilities::TypeFlags::nil;
     bool has_names = false;
 
-    for (int i = 0; i < count && !has_names; i++) {
-      has_names = has_names || arr.data(i).name().length();
+    if (packed) type_flags = static_cast<MessageUtilities::TypeFlags>(arr.packed_type());
+    else if (!columnar) {
+      if (arr.has_summary()) {
+        type_flags = static_cast<MessageUtilities::TypeFlags>(arr.summary().type());
+        has_names = arr.summary().has_names();
+      }
+      else {
+        MessageUtilities::ArraySummaryBuilder summary;
+        for (const auto &element : arr.data()) summary.Add(element);
+        type_flags = summary.type();
+        has_names = summary.has_names();
+      }
     }
 
-    // FIXME: can merge int and logical? (...)
-    // FIXME: can we use the coercion functions (asReal &c) here?  would simplify
+    CharsxpCache cache;
+
+    SEXPTYPE sexp_type = VECSXP;
+    if (type_flags & MessageUtilities::TypeFlags::integer) sexp_type = INTSXP;
+    else if (type_flags & (MessageUtilities::TypeFlags::numeric | MessageUtilities::TypeFlags::real)) sexp_type = REALSXP;
+    else if (type_flags & MessageUtilities::TypeFlags::logical) sexp_type = LGLSXP;
+    else if (type_flags & MessageUtilities::TypeFlags::string) sexp_type = STRSXP;
 
     SEXP list;
-    if (type_flags & MessageUtilities::TypeFlags::numeric) {
-      if (type_flags & MessageUtilities::TypeFlags::integer) {
-        if (!cols) list = Rf_allocVector(INTSXP, count);
-        else list = Rf_allocMatrix(INTSXP, rows, cols);
-        int *p = INTEGER(list);
-        for (int i = 0; i < count; i++) {
-          auto value_case = arr.data(i).value_case();
-          if((value_case == BERTBuffers::Variable::ValueCase::kNil) || (value_case == BERTBuffers::Variable::ValueCase::kMissing)) p[i] = NA_INTEGER;
-          else p[i] = arr.data(i).integer();
-        }
-      }
-      else {
-        if (!cols) list = Rf_allocVector(REALSXP, count);
-        else list = Rf_allocMatrix(REALSXP, rows, cols);
-        double *p = REAL(list);
-        for (int i = 0; i < count; i++) {
-          auto value_case = arr.data(i).value_case();
-          if ((value_case == BERTBuffers::Variable::ValueCase::kNil) || (value_case == BERTBuffers::Variable::ValueCase::kMissing)) p[i] = NA_REAL;
-          else if( value_case == BERTBuffers::Variable::ValueCase::kInteger) p[i] = arr.data(i).integer();
-          else p[i] = arr.data(i).real();
-        }
-      }
+    if (!cols) list = PROTECT(Rf_allocVector(sexp_type, count));
+    else list = PROTECT(Rf_allocMatrix(sexp_type, rows, cols));
+
+    switch (sexp_type) {
+    case INTSXP:
+    {
+      IntegerVectorSink sink(list);
+      ArrayConversion::Convert(sink, arr, count);
+      break;
     }
-    else if (type_flags & MessageUtilities::TypeFlags::logical) {
-      if (!cols) list = Rf_allocVector(LGLSXP, count);
-      else list = Rf_allocMatrix(LGLSXP, rows, cols);
-      int *p = LOGICAL(list);
-      for (int i = 0; i < count; i++) {
-        auto value_case = arr.data(i).value_case();
-        if ((value_case == BERTBuffers::Variable::ValueCase::kNil) || (value_case == BERTBuffers::Variable::ValueCase::kMissing)) p[i] = NA_LOGICAL;
-        else p[i] = arr.data(i).boolean() ? -1 : 0;
-      }
+    case REALSXP:
+    {
+      RealVectorSink sink(list);
+      ArrayConversion::Convert(sink, arr, count);
+      break;
     }
-    else if (type_flags & MessageUtilities::TypeFlags::string) {
-      if (!cols) list = Rf_allocVector(STRSXP, count);
-      else list = Rf_allocMatrix(STRSXP, rows, cols);
-      for (int i = 0; i < count; i++) {
-        auto value_case = arr.data(i).value_case();
-        if ((value_case == BERTBuffers::Variable::ValueCase::kNil) || (value_case == BERTBuffers::Variable::ValueCase::kMissing)) {
-          SET_STRING_ELT(list, i, NA_STRING);
-        }
-        else {
-          SET_STRING_ELT(list, i, Rf_mkChar(arr.data(i).str().c_str()));
-        }
-      }
+    case LGLSXP:
+    {
+      LogicalVectorSink sink(list);
+      ArrayConversion::Convert(sink, arr, count);
+      break;
+    }
+    case STRSXP:
+    {
+      StringVectorSink sink(list, cache);
+      ArrayConversion::Convert(sink, arr, count);
+      break;
+    }
+    default:
+    {
+      ListSink sink(list);
+      ArrayConversion::Convert(sink, arr, count);
+      break;
     }
-    else {
-      if (!cols) list = Rf_allocVector(VECSXP, count);
-      else list = Rf_allocMatrix(VECSXP, rows, cols);
-      for (int i = 0; i < count; i++) {
-        SEXP elt = SET_VECTOR_ELT(list, i, VariableToSEXP(arr.data(i)));
-      }
     }
 
     if (has_names) {
-      SEXP names = Rf_allocVector(VECSXP, count);
+      SEXP names = PROTECT(Rf_allocVector(STRSXP, count));
       for (int i = 0; i < count; i++) {
-        if (arr.data(i).name().length()) SET_VECTOR_ELT(names, i, Rf_mkString(arr.data(i).name().c_str()));
+        const std::string &name = arr.data(i).name();
+        SET_STRING_ELT(names, i, name.length() ? cache.Get(name) : R_BlankString);
       }
       Rf_setAttrib(list, R_NamesSymbol, names);
+      UNPROTECT(1);
     }
 
+    UNPROTECT(1);
     return list;
   }
   case BERTBuffers::Variable::ValueCase::kComPointer:
@@ -277,7 +372,95 @@ SEXP VariableToSEXP(const BERTBuffers::Variable &var) {
 
 }
 
-SEXP RCallSEXP(const BERTBuffers::CompositeFunctionCall &fc, bool wait, int &err) {
+/**
+ * wire vectors are ALTREP vectors that read a buffer we hold, instead of a
+ * copy. the support module (BERTModule) creates them, because we build 
+ * against R headers that predate ALTREP; it gives us the constructor when 
+ * it loads. if it doesn't (old R), this is null and we always copy.
+ */
+typedef SEXP WIRE_VECTOR_FUNCTION(int type, void *data, R_xlen_t length, void(*release)(void*), void *context);
+
+static WIRE_VECTOR_FUNCTION *wire_vector_function = 0;
+
+/** don't bother wrapping arrays smaller than this (elements) */
+#define WIRE_VECTOR_THRESHOLD (64 * 1024)
+
+template <typename T> void ReleaseWireBuffer(void *context) {
+  delete static_cast<google::protobuf::RepeatedField<T>*>(context);
+}
+
+/**
+ * take the field out of the message and hand it to a wire vector, which 
+ * deletes it when the vector is finalized. NA values are written into the
+ * buffer as R NAs. returns null (and restores the field) on failure.
+ */
+template <typename T> SEXP WrapRepeatedField(google::protobuf::RepeatedField<T> *source, SEXPTYPE type, T na_value, const std::string &na) {
+
+  auto field = new google::protobuf::RepeatedField<T>;
+  field->Swap(source);
+
+  if (na.length()) {
+    T *data = field->mutable_data();
+    int count = field->size();
+    for (int i = 0; i < count; i++) {
+      if (MessageUtilities::TestBit(na, i)) data[i] = na_value;
+    }
+  }
+
+  SEXP vector = wire_vector_function(type, field->mutable_data(), field->size(), ReleaseWireBuffer<T>, field);
+  if (!vector || vector == R_NilValue) {
+    source->Swap(field);
+    delete field;
+    return 0;
+  }
+  return vector;
+
+}
+
+/**
+ * function arguments are converted from the call message, which is
+ * discarded (or cleared for reuse) after the call. so large packed numeric
+ * arrays can give their buffers to wire vectors, and a function that only 
+ * calls sum() or length() never copies the data. anything else converts 
+ * as usual.
+ */
+SEXP ArgumentToSEXP(BERTBuffers::Variable *var) {
+
+  if (wire_vector_function && var->value_case() == BERTBuffers::Variable::ValueCase::kArr) {
+
+    BERTBuffers::Array *arr = var->mutable_arr();
+    int count = MessageUtilities::ArrayLength(*arr);
+
+    if (count >= WIRE_VECTOR_THRESHOLD && MessageUtilities::IsPacked(*arr) && !MessageUtilities::IsColumnar(*arr)) {
+
+      SEXP vector = 0;
+      if (arr->packed_type() == MessageUtilities::TypeFlags::real && arr->reals_size() == count) {
+        vector = WrapRepeatedField<double>(arr->mutable_reals(), REALSXP, NA_REAL, arr->na());
+      }
+      else if (arr->packed_type() == MessageUtilities::TypeFlags::integer && arr->integers_size() == count) {
+        vector = WrapRepeatedField<int32_t>(arr->mutable_integers(), INTSXP, NA_INTEGER, arr->na());
+      }
+
+      if (vector) {
+        int rows = arr->rows(), cols = arr->cols();
+        if (cols && rows * cols == count) {
+          PROTECT(vector);
+          SEXP dims = PROTECT(Rf_allocVector(INTSXP, 2));
+          INTEGER(dims)[0] = rows;
+          INTEGER(dims)[1] = cols;
+          Rf_setAttrib(vector, R_DimSymbol, dims);
+          UNPROTECT(2);
+        }
+        return vector;
+      }
+    }
+  }
+
+  return VariableToSEXP(*var);
+
+}
+
+SEXP RCallSEXP(BERTBuffers::CompositeFunctionCall &fc, bool wait, int &err) {
 
   // auto fc = call.function_call();
   err = 0;
@@ -292,7 +475,7 @@ SEXP RCallSEXP(const BERTBuffers::CompositeFunctionCall &fc, bool wait, int &err
     SET_VECTOR_ELT(sargs, 0, Rf_mkString(fc.function().c_str()));
 
     for (int i = 0; i < len; i++) {
-      SET_VECTOR_ELT(sargs, i + 1, VariableToSEXP(fc.arguments(i)));
+      SET_VECTOR_ELT(sargs, i + 1, ArgumentToSEXP(fc.mutable_arguments(i)));
     }
 
     SEXP env = R_tryEvalSilent(Rf_lang2(Rf_install("get"), Rf_mkString("BERT")), R_GlobalEnv, &err);
@@ -307,7 +490,7 @@ SEXP RCallSEXP(const BERTBuffers::CompositeFunctionCall &fc, bool wait, int &err
 
     SEXP sargs = Rf_allocVector(VECSXP, len);
     for (int i = 0; i < len; i++) {
-      SET_VECTOR_ELT(sargs, i, VariableToSEXP(fc.arguments(i)));
+      SET_VECTOR_ELT(sargs, i, ArgumentToSEXP(fc.mutable_arguments(i)));
     }
 
     SEXP env = R_GlobalEnv;
@@ -351,28 +534,65 @@ bool ReadSourceFile(const std::string &file, bool notify) {
   return !err;
 }
 
-__inline bool HandleSimpleTypes(SEXP sexp, int len, int rtype, BERTBuffers::Array *arr, BERTBuffers::Variable *var, const std::vector<std::string> &levels = {}) {
+/**
+ * R string (CHARSXP) -> UTF-8. if R has marked the string as UTF-8 we can
+ * use it as-is; latin-1 is converted. native strings that aren't valid 
+ * UTF-8 are assumed to be in the windows code page.
+ */
+void CharsxpToString(SEXP charsxp, std::string *str) {
+  const char *sexp_string = CHAR(charsxp);
+  int length = LENGTH(charsxp);
+  switch (Rf_getCharCE(charsxp)) {
+  case CE_UTF8:
+    str->assign(sexp_string, length);
+    break;
+  case CE_LATIN1:
+    WindowsCPToUTF8(sexp_string, length, str, 28591); // iso-8859-1
+    break;
+  default:
+    if (ValidUTF8(sexp_string, length)) str->assign(sexp_string, length);
+    else WindowsCPToUTF8(sexp_string, length, str);
+    break;
+  }
+}
+
+/**
+ * if summary is set, element types are added to it (we know the type for 
+ * each branch, so this is mostly in bulk). summary is only used for arrays.
+ */
+__inline bool HandleSimpleTypes(SEXP sexp, int len, int rtype, BERTBuffers::Array *arr, BERTBuffers::Variable *var, const std::vector<std::string> &levels = {}, MessageUtilities::ArraySummaryBuilder *summary = 0) {
+
+  if (!arr) summary = 0;
 
   if (Rf_isLogical(sexp) || rtype == LGLSXP)
   {
+    bool has_na = false;
     for (int i = 0; i < len; i++) {
       auto ptr = arr ? arr->add_data() : var;
       int lgl = (INTEGER(sexp))[i];
       if (lgl == NA_LOGICAL) {
         ptr->mutable_err()->set_type(BERTBuffers::ErrorType::NA);
+        has_na = true;
       }
       else {
         ptr->set_boolean(lgl ? true : false);
       }
     }
+    if (summary) summary->AddType(has_na ? MessageUtilities::TypeFlags::nil : MessageUtilities::TypeFlags::logical, len);
   }
   else if (Rf_isFactor(sexp)) {
     int levels_size = levels.size();
     for (int i = 0; i < len; i++) {
       auto ptr = arr ? arr->add_data() : var;
       int level = INTEGER(sexp)[i];
-      if (level > 0 && levels_size >= level) ptr->set_str(levels[level-1]); // factors are 1-based
-      else ptr->set_integer(level);
+      if (level > 0 && levels_size >= level) {
+        ptr->set_str(levels[level - 1]); // factors are 1-based
+        if (summary) summary->AddString(levels[level - 1].length());
+      }
+      else {
+        ptr->set_integer(level);
+        if (summary) summary->AddType(MessageUtilities::TypeFlags::integer);
+      }
     }
   }
   else if (Rf_isComplex(sexp)) {
@@ -384,6 +604,7 @@ __inline bool HandleSimpleTypes(SEXP sexp, int len, int rtype, BERTBuffers::Arra
       complex->set_i(COMPLEX(sexp)[i].i);
       complex->set_r(COMPLEX(sexp)[i].r);
     }
+    if (summary) summary->AddType(MessageUtilities::TypeFlags::nil, len); // not a simple type
 
   }
   else if (Rf_isInteger(sexp) || rtype == INTSXP)
@@ -392,6 +613,7 @@ __inline bool HandleSimpleTypes(SEXP sexp, int len, int rtype, BERTBuffers::Arra
       auto ptr = arr ? arr->add_data() : var;
       ptr->set_integer(INTEGER(sexp)[i]);
     }
+    if (summary) summary->AddType(MessageUtilities::TypeFlags::integer, len);
   }
   else if (isReal(sexp) || Rf_isNumber(sexp) || rtype == REALSXP)
   {
@@ -399,17 +621,14 @@ __inline bool HandleSimpleTypes(SEXP sexp, int len, int rtype, BERTBuffers::Arra
       auto ptr = arr ? arr->add_data() : var;
       ptr->set_real(REAL(sexp)[i]);
     }
+    if (summary) summary->AddType(MessageUtilities::TypeFlags::real, len);
   }
   else if (isString(sexp) || rtype == STRSXP)
   {
     for (int i = 0; i < len; i++) {
       auto ptr = arr ? arr->add_data() : var;
-      SEXP strsxp = STRING_ELT(sexp, i);
-      const char *sexp_string = CHAR(Rf_asChar(strsxp));
-      if (!ValidUTF8(sexp_string, 0)) {
-        ptr->set_str(WindowsCPToUTF8_2(sexp_string, 0));
-      }
-      else ptr->set_str(sexp_string);
+      CharsxpToString(STRING_ELT(sexp, i), ptr->mutable_str());
+      if (summary) summary->AddString(ptr->str().length());
     }
   }
   else return false;
@@ -477,6 +696,137 @@ void SEXPXlReferenceToVariable(BERTBuffers::Variable *var, SEXP sexp) {
 
 }
 
+/**
+ * atomic vector -> packed array, writing the typed fields directly instead
+ * of one element message per value. R NA values are NA (for reals, NA but
+ * not NaN). factors are packed strings: the codes, with the levels as the
+ * dictionary.
+ *
+ * character vectors are deduplicated by CHARSXP. R caches strings, so equal
+ * strings are the same CHARSXP; we only compare pointers, and convert each
+ * distinct string once.
+ *
+ * returns false (and leaves the array alone) for types we don't pack: 
+ * complex, lists, and so on.
+ */
+bool SEXPToPackedArray(BERTBuffers::Array *arr, SEXP sexp, int len) {
+
+  int rtype = TYPEOF(sexp);
+  bool factor = Rf_isFactor(sexp);
+
+  if (len <= 0) return false;
+  if (!factor && rtype != REALSXP && rtype != INTSXP && rtype != LGLSXP && rtype != STRSXP) return false;
+
+  std::string na;
+  auto set_na = [&](int index) {
+    if (na.empty()) na.assign(MessageUtilities::BitsetLength(len), 0);
+    MessageUtilities::SetBit(na, index);
+  };
+
+  if (factor) {
+
+    SEXP levels = getAttrib(sexp, R_LevelsSymbol);
+    int level_count = (levels != R_NilValue && Rf_isString(levels)) ? Rf_length(levels) : 0;
+    auto dictionary = arr->mutable_dictionary();
+    dictionary->Reserve(level_count);
+    for (int i = 0; i < level_count; i++) CharsxpToString(STRING_ELT(levels, i), dictionary->Add());
+
+    // factor codes are 1-based. out-of-range codes are invalid indexes, 
+    // which are NA on the other side.
+
+    const int *codes = INTEGER(sexp);
+    auto values = arr->mutable_integers();
+    values->Resize(len, 0);
+    int32_t *p = values->mutable_data();
+    for (int i = 0; i < len; i++) {
+      if (codes[i] == NA_INTEGER) {
+        p[i] = -1;
+        set_na(i);
+      }
+      else p[i] = codes[i] - 1;
+    }
+    arr->set_packed_type(MessageUtilities::TypeFlags::string);
+  }
+  else if (rtype == REALSXP) {
+    const double *source = REAL(sexp);
+    auto values = arr->mutable_reals();
+    values->Resize(len, 0);
+    memcpy(values->mutable_data(), source, sizeof(double) * len);
+    for (int i = 0; i < len; i++) {
+      if (ISNAN(source[i]) && R_IsNA(source[i])) set_na(i);
+    }
+    arr->set_packed_type(MessageUtilities::TypeFlags::real);
+  }
+  else if (rtype == INTSXP) {
+    const int *source = INTEGER(sexp);
+    auto values = arr->mutable_integers();
+    values->Resize(len, 0);
+    memcpy(values->mutable_data(), source, sizeof(int) * len);
+    for (int i = 0; i < len; i++) {
+      if (source[i] == NA_INTEGER) set_na(i);
+    }
+    arr->set_packed_type(MessageUtilities::TypeFlags::integer);
+  }
+  else if (rtype == LGLSXP) {
+    const int *source = LOGICAL(sexp);
+    std::string bits(MessageUtilities::BitsetLength(len), 0);
+    for (int i = 0; i < len; i++) {
+      if (source[i] == NA_LOGICAL) set_na(i);
+      else if (source[i]) MessageUtilities::SetBit(bits, i);
+    }
+    arr->mutable_logicals()->swap(bits);
+    arr->set_packed_type(MessageUtilities::TypeFlags::logical);
+  }
+  else {
+    std::unordered_map<SEXP, int> dictionary;
+    auto values = arr->mutable_integers();
+    values->Resize(len, 0);
+    int32_t *p = values->mutable_data();
+    for (int i = 0; i < len; i++) {
+      SEXP charsxp = STRING_ELT(sexp, i);
+      if (charsxp == NA_STRING) {
+        p[i] = -1;
+        set_na(i);
+        continue;
+      }
+      auto entry = dictionary.emplace(charsxp, (int)dictionary.size());
+      if (entry.second) CharsxpToString(charsxp, arr->add_dictionary());
+      p[i] = entry.first->second;
+    }
+    arr->set_packed_type(MessageUtilities::TypeFlags::string);
+  }
+
+  if (na.length()) arr->mutable_na()->swap(na);
+  arr->set_packed_length(len);
+
+  return true;
+}
+
+/**
+ * data frame row names. R stores automatic row names in a compact form, 
+ * c(NA, -n), which getAttrib expands to 1:n; so read the attribute 
+ * directly, and don't materialize them. sets the row count; returns the 
+ * row names if they're strings, otherwise R_NilValue.
+ */
+SEXP DataFrameRowNames(SEXP frame, int *rows) {
+
+  for (SEXP attribute = ATTRIB(frame); attribute != R_NilValue; attribute = CDR(attribute)) {
+    if (TAG(attribute) != R_RowNamesSymbol) continue;
+    SEXP row_names = CAR(attribute);
+    if (TYPEOF(row_names) == INTSXP && Rf_length(row_names) == 2 && INTEGER(row_names)[0] == NA_INTEGER) {
+      *rows = abs(INTEGER(row_names)[1]);
+      return R_NilValue;
+    }
+    *rows = Rf_length(row_names);
+    return Rf_isString(row_names) ? row_names : R_NilValue;
+  }
+
+  // no row names attribute (shouldn't happen), use the first column
+
+  *rows = Rf_length(frame) ? Rf_length(VECTOR_ELT(frame, 0)) : 0;
+  return R_NilValue;
+}
+
 void SEXPToVariable(BERTBuffers::Variable *var, SEXP sexp, std::vector <SEXP> envir_list = std::vector<SEXP>()) {
 
   if (!sexp || Rf_isNull(sexp)) {
@@ -521,43 +871,36 @@ void SEXPToVariable(BERTBuffers::Variable *var, SEXP sexp, std::vector <SEXP> en
         
     if (Rf_isFrame(sexp) && rtype == VECSXP) {
 
-      // this is a list of lists; we want to flatten it and we don't want nested 
-      // arrays. for this one, columns is the number of entries in the outer 
-      // list, and then we need to look at an inner list to check rows.
-  
+      // data frames are columnar arrays: one array per column, packed if 
+      // the column type allows, so most columns convert in bulk. other 
+      // columns (complex, lists) go element by element.
+
       ncol = len;
-      if (len > 0) {
-        SEXP first_list = VECTOR_ELT(sexp, 0);
-        nrow = Rf_length(first_list);
-      }
+      SEXP row_names = DataFrameRowNames(sexp, &nrow);
+
       arr = var->mutable_arr();
       arr->set_rows(nrow);
       arr->set_cols(ncol);
+      arr->mutable_columns()->Reserve(ncol);
 
-      // do we need to change direction?
+      for (int col = 0; col < ncol; col++) {
 
-      int column_count = len; // we're going to reuse that var
-      for (int col = 0; col < column_count; col++) {
+        SEXP column_sexp = VECTOR_ELT(sexp, col);
+        int column_len = Rf_length(column_sexp);
 
-        SEXP column_list = VECTOR_ELT(sexp, col);
-        int column_type = TYPEOF(column_list);
-        int column_len = Rf_length(column_list);
+        auto column = arr->add_columns();
+        column->set_rows(nrow);
+        column->set_cols(1);
 
-        std::vector<std::string> level_strings;
+        if (column_len == nrow && SEXPToPackedArray(column, column_sexp, nrow)) continue;
 
-        if (Rf_isFactor(column_list)) {
-          SEXP levels = getAttrib(column_list, R_LevelsSymbol);
-          if (levels && Rf_isString(levels)) {
-            int level_count = Rf_length(levels);
-            for (int level = 0; level < level_count; level++) {
-              SEXP strsxp = STRING_ELT(levels, level);
-              level_strings.push_back(CHAR(Rf_asChar(strsxp)));
-            }
-          }
-        }
-
-        HandleSimpleTypes(column_list, column_len, column_type, arr, var, level_strings);
+        // columns have to be complete, so pad (or truncate) to the row count
 
+        int count = (std::min)(column_len, nrow);
+        if (!HandleSimpleTypes(column_sexp, count, TYPEOF(column_sexp), column, var) && TYPEOF(column_sexp) == VECSXP) {
+          for (int i = 0; i < count; i++) SEXPToVariable(column->add_data(), VECTOR_ELT(column_sexp, i));
+        }
+        while (column->data_size() < nrow) column->add_data()->set_nil(true);
       }
 
       {
@@ -571,14 +914,9 @@ void SEXPToVariable(BERTBuffers::Variable *var, SEXP sexp, std::vector <SEXP> en
         }
       }
 
-      {
-        // row names
-        SEXP names = getAttrib(sexp, R_RowNamesSymbol);
-        int names_len = Rf_length(names);
-        if (names && names_len && isString(names)) {
-          for (int i = 0; i < names_len; i++) {
-            arr->add_rownames()->assign(CHAR(Rf_asChar(STRING_ELT(names, i))));
-          }
+      if (row_names != R_NilValue) {
+        for (int i = 0; i < nrow; i++) {
+          arr->add_rownames()->assign(CHAR(Rf_asChar(STRING_ELT(row_names, i))));
         }
       }
 
@@ -597,7 +935,17 @@ void SEXPToVariable(BERTBuffers::Variable *var, SEXP sexp, std::vector <SEXP> en
       arr->set_cols(ncol);
     }
 
-    if (HandleSimpleTypes(sexp, len, rtype, arr, var)) {
+    MessageUtilities::ArraySummaryBuilder summary;
+
+    // vectors and matrices of a single type go directly into a packed 
+    // array, unless they have names (those are per element)
+
+    bool packed = arr && (getAttrib(sexp, R_NamesSymbol) == R_NilValue) && SEXPToPackedArray(arr, sexp, len);
+
+    if (packed) {
+      // ...
+    }
+    else if (HandleSimpleTypes(sexp, len, rtype, arr, var, {}, &summary)) {
       // ...
     } 
     else if (rtype == EXTPTRSXP) {
@@ -609,7 +957,9 @@ void SEXPToVariable(BERTBuffers::Variable *var, SEXP sexp, std::vector <SEXP> en
     }
     else if (rtype == VECSXP) {
       for (int i = 0; i < len; i++) {
-        SEXPToVariable(arr->add_data(), VECTOR_ELT(sexp, i));
+        auto element = arr->add_data();
+        SEXPToVariable(element, VECTOR_ELT(sexp, i));
+        summary.Add(*element);
       }
     }
     else if (rtype == S4SXP) {
@@ -628,10 +978,15 @@ void SEXPToVariable(BERTBuffers::Variable *var, SEXP sexp, std::vector <SEXP> en
         auto ref = arr ? arr->mutable_data(i) : var;
         SEXP name = STRING_ELT(names, i);
         std::string str(CHAR(Rf_asChar(name)));
-        if (str.length()) { ref->set_name(str); }
+        if (str.length()) { 
+          ref->set_name(str); 
+          summary.AddNames();
+        }
       }
     }
 
+    if (arr && !packed) summary.Set(arr);
+
     SEXP dimnames = getAttrib(sexp, R_DimNamesSymbol);
     if (dimnames && TYPEOF(dimnames) != 0) {
       if (TYPEOF(dimnames) == VECSXP) {
@@ -761,12 +1116,12 @@ BERTBuffers::CallResponse& ListScriptFunctions(BERTBuffers::CallResponse &respon
 }
 
 
-BERTBuffers::CallResponse& RCall(BERTBuffers::CallResponse &rsp, const BERTBuffers::CallResponse &call) {
+BERTBuffers::CallResponse& RCall(BERTBuffers::CallResponse &rsp, BERTBuffers::CallResponse &call) {
 
   int err = 0;
   bool wait = call.wait();
 
-  SEXP result = PROTECT(RCallSEXP(call.function_call(), wait, err));
+  SEXP result = PROTECT(RCallSEXP(*call.mutable_function_call(), wait, err));
 
   if (err) {
     rsp.set_err("parse error");
@@ -825,7 +1180,6 @@ BERTBuffers::CallResponse& RExec(BERTBuffers::CallResponse &rsp, const BERTBuffe
 
 SEXP COMCallback(SEXP function_name, SEXP call_type, SEXP index, SEXP pointer_key, SEXP arguments) {
 
-  static uint32_t callback_id = 1;
   SEXP sexp_result = R_NilValue;
 
   std::string string_name;
@@ -839,7 +1193,6 @@ SEXP COMCallback(SEXP function_name, SEXP call_type, SEXP index, SEXP pointer_ke
   BERTBuffers::CallResponse *call = new BERTBuffers::CallResponse;
   BERTBuffers::CallResponse *response = new BERTBuffers::CallResponse;
 
-  call->set_id(callback_id);
   call->set_wait(true);
 
   //auto callback = call->mutable_com_callback();
@@ -881,7 +1234,7 @@ SEXP COMCallback(SEXP function_name, SEXP call_type, SEXP index, SEXP pointer_ke
   if (success) {
     int err = 0;
     if (response->operation_case() == BERTBuffers::CallResponse::OperationCase::kFunctionCall) {
-      sexp_result = RCallSEXP(response->function_call(), true, err);
+      sexp_result = RCallSEXP(*response->mutable_function_call(), true, err);
     }
     else if (response->operation_case() == BERTBuffers::CallResponse::OperationCase::kResult
       && response->result().value_case() == BERTBuffers::Variable::ValueCase::kComPointer) {
@@ -944,7 +1297,6 @@ void UpdateSpreadsheetGraphics() {
 
 SEXP RCallback(SEXP command, SEXP data) {
 
-  static uint32_t callback_id = 1;
   SEXP sexp_result = R_NilValue;
   std::string string_command;
 
@@ -1000,6 +1352,10 @@ SEXP RCallback(SEXP command, SEXP data) {
     std::cerr << "ENOTIMPL: " << string_command << std::endl;
     return Rf_ScalarLogical(0);
   }
+  else if (!string_command.compare("install-wire-vectors")) {
+    wire_vector_function = (WIRE_VECTOR_FUNCTION*)R_ExternalPtrAddrFn(data);
+    return R_NilValue;
+  }
   else if (!string_command.compare("console-history")) {
     
     BERTBuffers::CallResponse message, response;
@@ -1017,7 +1373,6 @@ SEXP RCallback(SEXP command, SEXP data) {
   BERTBuffers::CallResponse *call = new BERTBuffers::CallResponse;
   BERTBuffers::CallResponse *response = new BERTBuffers::CallResponse;
 
-  call->set_id(callback_id++);
   call->set_wait(true);
 
   if (!string_command.compare("remap-functions")) {
@@ -50,11 +50,9 @@ void R_WriteConsoleEx(const char *buf, int len, int flag) {
     return ConsoleMessage(buf, len, flag);
   }
 
-  char *string;
-  int length;
-
-  WindowsCPToUTF8(buf, len, &string, &length);
-  ConsoleMessage(string, length, flag);
+  std::string utf8;
+  WindowsCPToUTF8(buf, len, &utf8);
+  ConsoleMessage(utf8.c_str(), (int)utf8.length(), flag);
 
 }
 
@@ -18,10 +18,16 @@
  */
  
 #include <Rconfig.h>
+#include <Rversion.h>
 #include <Rinternals.h>
 #include <R_ext/Rdynload.h>
 #include <R_ext/GraphicsEngine.h>
 
+#if defined(R_VERSION) && R_VERSION >= R_Version(3, 5, 0)
+#include <R_ext/Altrep.h>
+#define HAVE_ALTREP
+#endif
+
 #ifdef length
 #undef length
 #endif
@@ -158,6 +164,171 @@ SEXP CreateSpreadsheetDevice(SEXP name, SEXP background, SEXP width, SEXP height
   
 }
 
+//=============================================================================
+//
+// wire vectors: ALTREP vectors over buffers received by the control 
+// process. the buffer stays with the control process, which gives us 
+// a release function; we call that from the finalizer. we only copy 
+// (materialize) if R wants to write to the vector.
+//
+// the control process is built against older R headers, so it can't 
+// create these itself. we pass it the constructor when we load.
+//
+//=============================================================================
+
+#ifdef HAVE_ALTREP
+
+typedef void RELEASE_FUNCTION(void*);
+
+struct WireBuffer {
+  void *data;
+  R_xlen_t length;
+  RELEASE_FUNCTION *release;
+  void *context;
+};
+
+static R_altrep_class_t wire_real_class;
+static R_altrep_class_t wire_integer_class;
+
+static void WireBufferFinalizer(SEXP external_pointer){
+  WireBuffer *buffer = (WireBuffer*)R_ExternalPtrAddr(external_pointer);
+  if(!buffer) return;
+  if(buffer->release) buffer->release(buffer->context);
+  delete buffer;
+  R_ClearExternalPtr(external_pointer);
+}
+
+static inline WireBuffer* GetWireBuffer(SEXP x){
+  return (WireBuffer*)R_ExternalPtrAddr(R_altrep_data1(x));
+}
+
+static inline size_t WireElementSize(SEXP x){
+  return TYPEOF(x) == REALSXP ? sizeof(double) : sizeof(int);
+}
+
+/** 
+ * data pointer, from the copy if we've materialized, otherwise from
+ * the buffer (which is read-only)
+ */
+static inline const void* WireData(SEXP x){
+  SEXP copy = R_altrep_data2(x);
+  if(copy != R_NilValue) return DATAPTR(copy);
+  return GetWireBuffer(x)->data;
+}
+
+static R_xlen_t WireLength(SEXP x){
+  return GetWireBuffer(x)->length;
+}
+
+static Rboolean WireInspect(SEXP x, int pre, int deep, int pvec, void (*inspect_subtree)(SEXP, int, int, int)){
+  Rprintf(" wire vector (%s)\n", R_altrep_data2(x) == R_NilValue ? "buffer" : "materialized");
+  return TRUE;
+}
+
+static void* WireDataptr(SEXP x, Rboolean writeable){
+  if(!writeable) return (void*)WireData(x);
+  SEXP copy = R_altrep_data2(x);
+  if(copy == R_NilValue){
+    WireBuffer *buffer = GetWireBuffer(x);
+    copy = PROTECT(Rf_allocVector(TYPEOF(x), buffer->length));
+    memcpy(DATAPTR(copy), buffer->data, buffer->length * WireElementSize(x));
+    R_set_altrep_data2(x, copy);
+    UNPROTECT(1);
+  }
+  return DATAPTR(copy);
+}
+
+static const void* WireDataptrOrNull(SEXP x){
+  return WireData(x);
+}
+
+static SEXP WireDuplicate(SEXP x, Rboolean deep){
+  R_xlen_t length = WireLength(x);
+  SEXP duplicate = PROTECT(Rf_allocVector(TYPEOF(x), length));
+  memcpy(DATAPTR(duplicate), WireData(x), length * WireElementSize(x));
+  UNPROTECT(1);
+  return duplicate;
+}
+
+static double WireRealElt(SEXP x, R_xlen_t i){
+  return ((const double*)WireData(x))[i];
+}
+
+static int WireIntegerElt(SEXP x, R_xlen_t i){
+  return ((const int*)WireData(x))[i];
+}
+
+static R_xlen_t WireRealGetRegion(SEXP x, R_xlen_t i, R_xlen_t n, double *buf){
+  R_xlen_t length = WireLength(x);
+  R_xlen_t count = (length - i < n) ? length - i : n;
+  memcpy(buf, (const double*)WireData(x) + i, count * sizeof(double));
+  return count;
+}
+
+static R_xlen_t WireIntegerGetRegion(SEXP x, R_xlen_t i, R_xlen_t n, int *buf){
+  R_xlen_t length = WireLength(x);
+  R_xlen_t count = (length - i < n) ? length - i : n;
+  memcpy(buf, (const int*)WireData(x) + i, count * sizeof(int));
+  return count;
+}
+
+/**
+ * create a wire vector. type is REALSXP or INTSXP; data has length 
+ * elements, with NA values already in R's representation. returns 
+ * R_NilValue for any other type (the caller should copy).
+ */
+SEXP WrapBuffer(int type, void *data, R_xlen_t length, RELEASE_FUNCTION *release, void *context){
+
+  R_altrep_class_t wire_class;
+  if(type == REALSXP) wire_class = wire_real_class;
+  else if(type == INTSXP) wire_class = wire_integer_class;
+  else return R_NilValue;
+
+  WireBuffer *buffer = new WireBuffer;
+  buffer->data = data;
+  buffer->length = length;
+  buffer->release = release;
+  buffer->context = context;
+
+  SEXP external_pointer = PROTECT(R_MakeExternalPtr(buffer, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(external_pointer, WireBufferFinalizer, TRUE);
+
+  SEXP vector = R_new_altrep(wire_class, external_pointer, R_NilValue);
+  UNPROTECT(1);
+
+  return vector;
+
+}
+
+static void InitWireVectors(DllInfo *info){
+
+  wire_real_class = R_make_altreal_class("wire_real", "BERTModule", info);
+  wire_integer_class = R_make_altinteger_class("wire_integer", "BERTModule", info);
+
+  R_altrep_class_t classes[] = { wire_real_class, wire_integer_class };
+  for(int i = 0; i < 2; i++){
+    R_set_altrep_Length_method(classes[i], WireLength);
+    R_set_altrep_Inspect_method(classes[i], WireInspect);
+    R_set_altrep_Duplicate_method(classes[i], WireDuplicate);
+    R_set_altvec_Dataptr_method(classes[i], WireDataptr);
+    R_set_altvec_Dataptr_or_null_method(classes[i], WireDataptrOrNull);
+  }
+
+  R_set_altreal_Elt_method(wire_real_class, WireRealElt);
+  R_set_altreal_Get_region_method(wire_real_class, WireRealGetRegion);
+  R_set_altinteger_Elt_method(wire_integer_class, WireIntegerElt);
+  R_set_altinteger_Get_region_method(wire_integer_class, WireIntegerGetRegion);
+
+  // hand the constructor to the control process
+
+  SEXP constructor = PROTECT(R_MakeExternalPtrFn((DL_FUNC)WrapBuffer, R_NilValue, R_NilValue));
+  Callback2(Rf_mkString("install-wire-vectors"), constructor);
+  UNPROTECT(1);
+
+}
+
+#endif // #ifdef HAVE_ALTREP
+
 void CloseConsole(){
   Callback2(Rf_mkString("close-console"), 0);
 }
@@ -177,5 +348,8 @@ extern "C" {
       { NULL, NULL, 0 }
     };
     R_registerRoutines( info, NULL, methods, NULL, NULL);
+#ifdef HAVE_ALTREP
+    InitWireVectors(info);
+#endif
   }
 }
@@ -1,6 +1,15 @@
 #!/bin/sh
 
-PROTOC=../../protoc-3.5.0-win32/bin/protoc.exe 
+# generated code has to match the protobuf 3.5 runtime we link against, 
+# so don't use whatever protoc happens to be on the path. set PROTOC to 
+# point somewhere else.
+
+PROTOC=${PROTOC:-../../protoc-3.5.0-win32/bin/protoc.exe}
+
+case "`$PROTOC --version`" in
+  "libprotoc 3.5."*) ;;
+  *) echo "need protoc 3.5 (got: `$PROTOC --version`)"; exit 1 ;;
+esac
 
 $PROTOC --cpp_out=. variable.proto
 $PROTOC --js_out=import_style=commonjs,binary:../Console/generated/ variable.proto
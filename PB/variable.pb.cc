@@ -144,7 +144,18 @@ class CallResponseDefaultTypeInternal {
   ::google::protobuf::internal::ArenaStringPtr shell_command_;
   const ::BERTBuffers::CompositeFunctionCall* function_call_;
   const ::BERTBuffers::FunctionList* function_list_;
+  const ::BERTBuffers::CallBatch* call_batch_;
 } _CallResponse_default_instance_;
+class CallBatchDefaultTypeInternal {
+ public:
+  ::google::protobuf::internal::ExplicitlyConstructed<CallBatch>
+      _instance;
+} _CallBatch_default_instance_;
+class ArraySummaryDefaultTypeInternal {
+ public:
+  ::google::protobuf::internal::ExplicitlyConstructed<ArraySummary>
+      _instance;
+} _ArraySummary_default_instance_;
 }  // namespace BERTBuffers
 namespace protobuf_variable_2eproto {
 void InitDefaultsComplexImpl() {
@@ -181,6 +192,7 @@ void InitDefaultsArrayImpl() {
   protobuf_variable_2eproto::InitDefaultsComplex();
   protobuf_variable_2eproto::InitDefaultsSheetReference();
   protobuf_variable_2eproto::InitDefaultsGraphicsUpdate();
+  protobuf_variable_2eproto::InitDefaultsArraySummary();
   {
     void* ptr = &::BERTBuffers::_Array_default_instance_;
     new (ptr) ::BERTBuffers::Array();
@@ -512,6 +524,7 @@ void InitDefaultsCallResponseImpl() {
   protobuf_variable_2eproto::InitDefaultsCode();
   protobuf_variable_2eproto::InitDefaultsCompositeFunctionCall();
   protobuf_variable_2eproto::InitDefaultsFunctionList();
+  protobuf_variable_2eproto::InitDefaultsCallBatch();
   {
     void* ptr = &::BERTBuffers::_CallResponse_default_instance_;
     new (ptr) ::BERTBuffers::CallResponse();
@@ -525,7 +538,51 @@ void InitDefaultsCallResponse() {
   ::google::protobuf::GoogleOnceInit(&once, &InitDefaultsCallResponseImpl);
 }
 
-::google::protobuf::Metadata file_level_metadata[20];
+void InitDefaultsCallBatchImpl() {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+#ifdef GOOGLE_PROTOBUF_ENFORCE_UNIQUENESS
+  ::google::protobuf::internal::InitProtobufDefaultsForceUnique();
+#else
+  ::google::protobuf::internal::InitProtobufDefaults();
+#endif  // GOOGLE_PROTOBUF_ENFORCE_UNIQUENESS
+  protobuf_variable_2eproto::InitDefaultsCompositeFunctionCall();
+  protobuf_variable_2eproto::InitDefaultsArray();
+  {
+    void* ptr = &::BERTBuffers::_CallBatch_default_instance_;
+    new (ptr) ::BERTBuffers::CallBatch();
+    ::google::protobuf::internal::OnShutdownDestroyMessage(ptr);
+  }
+  ::BERTBuffers::CallBatch::InitAsDefaultInstance();
+}
+
+void InitDefaultsCallBatch() {
+  static GOOGLE_PROTOBUF_DECLARE_ONCE(once);
+  ::google::protobuf::GoogleOnceInit(&once, &InitDefaultsCallBatchImpl);
+}
+
+void InitDefaultsArraySummaryImpl() {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+#ifdef GOOGLE_PROTOBUF_ENFORCE_UNIQUENESS
+  ::google::protobuf::internal::InitProtobufDefaultsForceUnique();
+#else
+  ::google::protobuf::internal::InitProtobufDefaults();
+#endif  // GOOGLE_PROTOBUF_ENFORCE_UNIQUENESS
+  {
+    void* ptr = &::BERTBuffers::_ArraySummary_default_instance_;
+    new (ptr) ::BERTBuffers::ArraySummary();
+    ::google::protobuf::internal::OnShutdownDestroyMessage(ptr);
+  }
+  ::BERTBuffers::ArraySummary::InitAsDefaultInstance();
+}
+
+void InitDefaultsArraySummary() {
+  static GOOGLE_PROTOBUF_DECLARE_ONCE(once);
+  ::google::protobuf::GoogleOnceInit(&once, &InitDefaultsArraySummaryImpl);
+}
+
+::google::protobuf::Metadata file_level_metadata[22];
 const ::google::protobuf::EnumDescriptor* file_level_enum_descriptors[4];
 
 const ::google::protobuf::uint32 TableStruct::offsets[] GOOGLE_PROTOBUF_ATTRIBUTE_SECTION_VARIABLE(protodesc_cold) = {
@@ -546,6 +603,16 @@ const ::google::protobuf::uint32 TableStruct::offsets[] GOOGLE_PROTOBUF_ATTRIBUT
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, data_),
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, rownames_),
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, colnames_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, packed_type_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, packed_length_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, reals_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, integers_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, dictionary_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, logicals_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, na_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, streamed_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, summary_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Array, columns_),
   ~0u,  // no _has_bits_
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::Error, _internal_metadata_),
   ~0u,  // no _extensions_
@@ -737,29 +804,49 @@ const ::google::protobuf::uint32 TableStruct::offsets[] GOOGLE_PROTOBUF_ATTRIBUT
   offsetof(::BERTBuffers::CallResponseDefaultTypeInternal, shell_command_),
   offsetof(::BERTBuffers::CallResponseDefaultTypeInternal, function_call_),
   offsetof(::BERTBuffers::CallResponseDefaultTypeInternal, function_list_),
+  offsetof(::BERTBuffers::CallResponseDefaultTypeInternal, call_batch_),
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::CallResponse, operation_),
+  ~0u,  // no _has_bits_
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::CallBatch, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::CallBatch, calls_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::CallBatch, results_),
+  ~0u,  // no _has_bits_
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::ArraySummary, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::ArraySummary, type_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::ArraySummary, has_na_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::ArraySummary, has_names_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::ArraySummary, min_string_length_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::BERTBuffers::ArraySummary, max_string_length_),
 };
 static const ::google::protobuf::internal::MigrationSchema schemas[] GOOGLE_PROTOBUF_ATTRIBUTE_SECTION_VARIABLE(protodesc_cold) = {
   { 0, -1, sizeof(::BERTBuffers::Complex)},
   { 7, -1, sizeof(::BERTBuffers::Array)},
-  { 17, -1, sizeof(::BERTBuffers::Error)},
-  { 24, -1, sizeof(::BERTBuffers::SheetReference)},
-  { 34, -1, sizeof(::BERTBuffers::Variable)},
-  { 53, -1, sizeof(::BERTBuffers::Code)},
-  { 60, -1, sizeof(::BERTBuffers::CompositeFunctionCall)},
-  { 72, -1, sizeof(::BERTBuffers::GraphicsUpdate)},
-  { 82, -1, sizeof(::BERTBuffers::GraphicsCommand)},
-  { 99, -1, sizeof(::BERTBuffers::Color)},
-  { 108, -1, sizeof(::BERTBuffers::GraphicsContext)},
-  { 126, -1, sizeof(::BERTBuffers::MIMEData)},
-  { 133, -1, sizeof(::BERTBuffers::Console)},
-  { 145, -1, sizeof(::BERTBuffers::FunctionElement)},
-  { 155, -1, sizeof(::BERTBuffers::FunctionDescriptor)},
-  { 165, -1, sizeof(::BERTBuffers::FunctionList)},
-  { 171, -1, sizeof(::BERTBuffers::EnumValue)},
-  { 178, -1, sizeof(::BERTBuffers::EnumType)},
-  { 185, -1, sizeof(::BERTBuffers::ExternalPointer)},
-  { 194, -1, sizeof(::BERTBuffers::CallResponse)},
+  { 27, -1, sizeof(::BERTBuffers::Error)},
+  { 34, -1, sizeof(::BERTBuffers::SheetReference)},
+  { 44, -1, sizeof(::BERTBuffers::Variable)},
+  { 63, -1, sizeof(::BERTBuffers::Code)},
+  { 70, -1, sizeof(::BERTBuffers::CompositeFunctionCall)},
+  { 82, -1, sizeof(::BERTBuffers::GraphicsUpdate)},
+  { 92, -1, sizeof(::BERTBuffers::GraphicsCommand)},
+  { 109, -1, sizeof(::BERTBuffers::Color)},
+  { 118, -1, sizeof(::BERTBuffers::GraphicsContext)},
+  { 136, -1, sizeof(::BERTBuffers::MIMEData)},
+  { 143, -1, sizeof(::BERTBuffers::Console)},
+  { 155, -1, sizeof(::BERTBuffers::FunctionElement)},
+  { 165, -1, sizeof(::BERTBuffers::FunctionDescriptor)},
+  { 175, -1, sizeof(::BERTBuffers::FunctionList)},
+  { 181, -1, sizeof(::BERTBuffers::EnumValue)},
+  { 188, -1, sizeof(::BERTBuffers::EnumType)},
+  { 195, -1, sizeof(::BERTBuffers::ExternalPointer)},
+  { 204, -1, sizeof(::BERTBuffers::CallResponse)},
+  { 220, -1, sizeof(::BERTBuffers::CallBatch)},
+  { 227, -1, sizeof(::BERTBuffers::ArraySummary)},
 };
 
 static ::google::protobuf::Message const * const file_default_instances[] = {
@@ -783,6 +870,8 @@ static ::google::protobuf::Message const * const file_default_instances[] = {
   reinterpret_cast<const ::google::protobuf::Message*>(&::BERTBuffers::_EnumType_default_instance_),
   reinterpret_cast<const ::google::protobuf::Message*>(&::BERTBuffers::_ExternalPointer_default_instance_),
   reinterpret_cast<const ::google::protobuf::Message*>(&::BERTBuffers::_CallResponse_default_instance_),
+  reinterpret_cast<const ::google::protobuf::Message*>(&::BERTBuffers::_CallBatch_default_instance_),
+  reinterpret_cast<const ::google::protobuf::Message*>(&::BERTBuffers::_ArraySummary_default_instance_),
 };
 
 void protobuf_AssignDescriptors() {
@@ -801,94 +890,107 @@ void protobuf_AssignDescriptorsOnce() {
 void protobuf_RegisterTypes(const ::std::string&) GOOGLE_PROTOBUF_ATTRIBUTE_COLD;
 void protobuf_RegisterTypes(const ::std::string&) {
   protobuf_AssignDescriptorsOnce();
-  ::google::protobuf::internal::RegisterAllTypes(file_level_metadata, 20);
+  ::google::protobuf::internal::RegisterAllTypes(file_level_metadata, 22);
 }
 
 void AddDescriptorsImpl() {
   InitDefaults();
   static const char descriptor[] GOOGLE_PROTOBUF_ATTRIBUTE_SECTION_VARIABLE(protodesc_cold) = {
       "\n\016variable.proto\022\013BERTBuffers\"\037\n\007Complex"
-      "\022\t\n\001r\030\001 \001(\001\022\t\n\001i\030\002 \001(\001\"l\n\005Array\022\014\n\004rows\030"
-      "\001 \001(\005\022\014\n\004cols\030\002 \001(\005\022#\n\004data\030\003 \003(\0132\025.BERT"
-      "Buffers.Variable\022\020\n\010rownames\030\004 \003(\t\022\020\n\010co"
-      "lnames\030\005 \003(\t\">\n\005Error\022$\n\004type\030\001 \001(\0162\026.BE"
-      "RTBuffers.ErrorType\022\017\n\007message\030\002 \001(\t\"p\n\016"
-      "SheetReference\022\021\n\tstart_row\030\001 \001(\r\022\024\n\014sta"
-      "rt_column\030\002 \001(\r\022\017\n\007end_row\030\003 \001(\r\022\022\n\nend_"
-      "column\030\004 \001(\r\022\020\n\010sheet_id\030\005 \001(\004\"\205\003\n\010Varia"
-      "ble\022\r\n\003nil\030\001 \001(\010H\000\022\021\n\007missing\030\002 \001(\010H\000\022!\n"
-      "\003err\030\003 \001(\0132\022.BERTBuffers.ErrorH\000\022\021\n\007inte"
-      "ger\030\005 \001(\005H\000\022\016\n\004real\030\006 \001(\001H\000\022\r\n\003str\030\007 \001(\t"
-      "H\000\022\021\n\007boolean\030\010 \001(\010H\000\022#\n\003cpx\030\t \001(\0132\024.BER"
-      "TBuffers.ComplexH\000\022!\n\003arr\030\n \001(\0132\022.BERTBu"
-      "ffers.ArrayH\000\022*\n\003ref\030\013 \001(\0132\033.BERTBuffers"
-      ".SheetReferenceH\000\0223\n\013com_pointer\030\014 \001(\0132\034"
-      ".BERTBuffers.ExternalPointerH\000\022/\n\010graphi"
-      "cs\030\r \001(\0132\033.BERTBuffers.GraphicsUpdateH\000\022"
-      "\014\n\004name\030\017 \001(\tB\007\n\005value\"%\n\004Code\022\014\n\004line\030\001"
-      " \003(\t\022\017\n\007startup\030\002 \001(\010\"\320\001\n\025CompositeFunct"
-      "ionCall\022\020\n\010function\030\001 \001(\t\022(\n\targuments\030\002"
-      " \003(\0132\025.BERTBuffers.Variable\022\017\n\007pointer\030\003"
-      " \001(\004\022\r\n\005index\030\004 \001(\r\022#\n\004type\030\005 \001(\0162\025.BERT"
-      "Buffers.CallType\022\'\n\006target\030\006 \001(\0162\027.BERTB"
-      "uffers.CallTarget\022\r\n\005flags\030\007 \001(\r\"\200\001\n\016Gra"
-      "phicsUpdate\0223\n\007command\030\001 \001(\0162\".BERTBuffe"
-      "rs.GraphicsUpdateCommand\022\014\n\004name\030\002 \001(\t\022\014"
-      "\n\004path\030\003 \001(\t\022\r\n\005width\030\004 \001(\r\022\016\n\006height\030\005 "
-      "\001(\r\"\345\001\n\017GraphicsCommand\022\017\n\007command\030\001 \001(\t"
-      "\022\t\n\001x\030\002 \003(\001\022\t\n\001y\030\003 \003(\001\022\t\n\001r\030\004 \001(\001\022\013\n\003rot"
-      "\030\005 \001(\001\022\014\n\004text\030\006 \001(\t\022\016\n\006filled\030\007 \001(\010\022\014\n\004"
-      "hadj\030\010 \001(\001\022\016\n\006raster\030\t \001(\014\022\023\n\013interpolat"
-      "e\030\n \001(\010\022\023\n\013device_type\030\016 \001(\t\022-\n\007context\030"
-      "\017 \001(\0132\034.BERTBuffers.GraphicsContext\"3\n\005C"
-      "olor\022\t\n\001a\030\001 \001(\r\022\t\n\001r\030\002 \001(\r\022\t\n\001g\030\003 \001(\r\022\t\n"
-      "\001b\030\004 \001(\r\"\375\001\n\017GraphicsContext\022\037\n\003col\030\001 \001("
-      "\0132\022.BERTBuffers.Color\022 \n\004fill\030\002 \001(\0132\022.BE"
-      "RTBuffers.Color\022\r\n\005gamma\030\003 \001(\001\022\013\n\003lwd\030\004 "
-      "\001(\001\022\013\n\003lty\030\005 \001(\005\022\014\n\004lend\030\006 \001(\005\022\r\n\005ljoin\030"
-      "\007 \001(\005\022\016\n\006lmitre\030\010 \001(\001\022\013\n\003cex\030\t \001(\001\022\n\n\002ps"
-      "\030\n \001(\001\022\022\n\nlineheight\030\013 \001(\001\022\020\n\010fontface\030\014"
-      " \001(\005\022\022\n\nfontfamily\030\r \001(\t\"+\n\010MIMEData\022\021\n\t"
-      "mime_type\030\001 \001(\t\022\014\n\004data\030\002 \001(\014\"\315\001\n\007Consol"
-      "e\022\016\n\004text\030\001 \001(\tH\000\022\r\n\003err\030\002 \001(\tH\000\022\020\n\006prom"
-      "pt\030\003 \001(\tH\000\0220\n\010graphics\030\004 \001(\0132\034.BERTBuffe"
-      "rs.GraphicsCommandH\000\022*\n\tmime_data\030\005 \001(\0132"
-      "\025.BERTBuffers.MIMEDataH\000\022(\n\007history\030\006 \001("
-      "\0132\025.BERTBuffers.VariableH\000B\t\n\007message\"\204\001"
-      "\n\017FunctionElement\022\014\n\004name\030\001 \001(\t\022\021\n\ttype_"
-      "name\030\002 \001(\t\022,\n\rdefault_value\030\003 \001(\0132\025.BERT"
-      "Buffers.Variable\022\023\n\013description\030\004 \001(\t\022\r\n"
-      "\005index\030\005 \001(\r\"\300\001\n\022FunctionDescriptor\022.\n\010f"
-      "unction\030\001 \001(\0132\034.BERTBuffers.FunctionElem"
-      "ent\022(\n\tcall_type\030\002 \001(\0162\025.BERTBuffers.Cal"
-      "lType\022\r\n\005flags\030\003 \001(\r\022\020\n\010category\030\004 \001(\t\022/"
-      "\n\targuments\030\005 \003(\0132\034.BERTBuffers.Function"
-      "Element\"B\n\014FunctionList\0222\n\tfunctions\030\001 \003"
-      "(\0132\037.BERTBuffers.FunctionDescriptor\"(\n\tE"
-      "numValue\022\014\n\004name\030\001 \001(\t\022\r\n\005value\030\002 \001(\005\"@\n"
-      "\010EnumType\022\014\n\004name\030\001 \001(\t\022&\n\006values\030\002 \003(\0132"
-      "\026.BERTBuffers.EnumValue\"\224\001\n\017ExternalPoin"
-      "ter\022\026\n\016interface_name\030\001 \001(\t\022\017\n\007pointer\030\002"
-      " \001(\004\0222\n\tfunctions\030\003 \003(\0132\037.BERTBuffers.Fu"
-      "nctionDescriptor\022$\n\005enums\030\004 \003(\0132\025.BERTBu"
-      "ffers.EnumType\"\303\002\n\014CallResponse\022\n\n\002id\030\001 "
-      "\001(\r\022\014\n\004wait\030\002 \001(\010\022\r\n\003err\030\003 \001(\tH\000\022\'\n\006resu"
-      "lt\030\004 \001(\0132\025.BERTBuffers.VariableH\000\022\'\n\007con"
-      "sole\030\005 \001(\0132\024.BERTBuffers.ConsoleH\000\022!\n\004co"
-      "de\030\006 \001(\0132\021.BERTBuffers.CodeH\000\022\027\n\rshell_c"
-      "ommand\030\007 \001(\tH\000\022;\n\rfunction_call\030\010 \001(\0132\"."
-      "BERTBuffers.CompositeFunctionCallH\000\0222\n\rf"
-      "unction_list\030\t \001(\0132\031.BERTBuffers.Functio"
-      "nListH\000B\013\n\toperation*N\n\tErrorType\022\013\n\007GEN"
-      "ERIC\020\000\022\006\n\002NA\020\001\022\007\n\003INF\020\002\022\t\n\005PARSE\020\003\022\r\n\tEX"
-      "ECUTION\020\004\022\t\n\005OTHER\020\017*(\n\010CallType\022\n\n\006meth"
-      "od\020\000\022\007\n\003get\020\001\022\007\n\003put\020\002*=\n\nCallTarget\022\014\n\010"
-      "language\020\000\022\007\n\003COM\020\001\022\n\n\006system\020\002\022\014\n\010graph"
-      "ics\020\003*3\n\025GraphicsUpdateCommand\022\n\n\006update"
-      "\020\000\022\016\n\nquery_size\020\001B\002H\001b\006proto3"
+      "\022\t\n\001r\030\001 \001(\001\022\t\n\001i\030\002 \001(\001\"\316\002\n\005Array\022\014\n\004rows"
+      "\030\001 \001(\005\022\014\n\004cols\030\002 \001(\005\022#\n\004data\030\003 \003(\0132\025.BER"
+      "TBuffers.Variable\022\020\n\010rownames\030\004 \003(\t\022\020\n\010c"
+      "olnames\030\005 \003(\t\022\023\n\013packed_type\030\006 \001(\r\022\025\n\rpa"
+      "cked_length\030\007 \001(\005\022\r\n\005reals\030\010 \003(\001\022\020\n\010inte"
+      "gers\030\t \003(\005\022\022\n\ndictionary\030\n \003(\t\022\020\n\010logica"
+      "ls\030\013 \001(\014\022\n\n\002na\030\014 \001(\014\022\020\n\010streamed\030\r \001(\010\022*"
+      "\n\007summary\030\016 \001(\0132\031.BERTBuffers.ArraySumma"
+      "ry\022#\n\007columns\030\017 \003(\0132\022.BERTBuffers.Array\""
+      ">\n\005Error\022$\n\004type\030\001 \001(\0162\026.BERTBuffers.Err"
+      "orType\022\017\n\007message\030\002 \001(\t\"p\n\016SheetReferenc"
+      "e\022\021\n\tstart_row\030\001 \001(\r\022\024\n\014start_column\030\002 \001"
+      "(\r\022\017\n\007end_row\030\003 \001(\r\022\022\n\nend_column\030\004 \001(\r\022"
+      "\020\n\010sheet_id\030\005 \001(\004\"\205\003\n\010Variable\022\r\n\003nil\030\001 "
+      "\001(\010H\000\022\021\n\007missing\030\002 \001(\010H\000\022!\n\003err\030\003 \001(\0132\022."
+      "BERTBuffers.ErrorH\000\022\021\n\007integer\030\005 \001(\005H\000\022\016"
+      "\n\004real\030\006 \001(\001H\000\022\r\n\003str\030\007 \001(\tH\000\022\021\n\007boolean"
+      "\030\010 \001(\010H\000\022#\n\003cpx\030\t \001(\0132\024.BERTBuffers.Comp"
+      "lexH\000\022!\n\003arr\030\n \001(\0132\022.BERTBuffers.ArrayH\000"
+      "\022*\n\003ref\030\013 \001(\0132\033.BERTBuffers.SheetReferen"
+      "ceH\000\0223\n\013com_pointer\030\014 \001(\0132\034.BERTBuffers."
+      "ExternalPointerH\000\022/\n\010graphics\030\r \001(\0132\033.BE"
+      "RTBuffers.GraphicsUpdateH\000\022\014\n\004name\030\017 \001(\t"
+      "B\007\n\005value\"%\n\004Code\022\014\n\004line\030\001 \003(\t\022\017\n\007start"
+      "up\030\002 \001(\010\"\320\001\n\025CompositeFunctionCall\022\020\n\010fu"
+      "nction\030\001 \001(\t\022(\n\targuments\030\002 \003(\0132\025.BERTBu"
+      "ffers.Variable\022\017\n\007pointer\030\003 \001(\004\022\r\n\005index"
+      "\030\004 \001(\r\022#\n\004type\030\005 \001(\0162\025.BERTBuffers.CallT"
+      "ype\022\'\n\006target\030\006 \001(\0162\027.BERTBuffers.CallTa"
+      "rget\022\r\n\005flags\030\007 \001(\r\"\200\001\n\016GraphicsUpdate\0223"
+      "\n\007command\030\001 \001(\0162\".BERTBuffers.GraphicsUp"
+      "dateCommand\022\014\n\004name\030\002 \001(\t\022\014\n\004path\030\003 \001(\t\022"
+      "\r\n\005width\030\004 \001(\r\022\016\n\006height\030\005 \001(\r\"\345\001\n\017Graph"
+      "icsCommand\022\017\n\007command\030\001 \001(\t\022\t\n\001x\030\002 \003(\001\022\t"
+      "\n\001y\030\003 \003(\001\022\t\n\001r\030\004 \001(\001\022\013\n\003rot\030\005 \001(\001\022\014\n\004tex"
+      "t\030\006 \001(\t\022\016\n\006filled\030\007 \001(\010\022\014\n\004hadj\030\010 \001(\001\022\016\n"
+      "\006raster\030\t \001(\014\022\023\n\013interpolate\030\n \001(\010\022\023\n\013de"
+      "vice_type\030\016 \001(\t\022-\n\007context\030\017 \001(\0132\034.BERTB"
+      "uffers.GraphicsContext\"3\n\005Color\022\t\n\001a\030\001 \001"
+      "(\r\022\t\n\001r\030\002 \001(\r\022\t\n\001g\030\003 \001(\r\022\t\n\001b\030\004 \001(\r\"\375\001\n\017"
+      "GraphicsContext\022\037\n\003col\030\001 \001(\0132\022.BERTBuffe"
+      "rs.Color\022 \n\004fill\030\002 \001(\0132\022.BERTBuffers.Col"
+      "or\022\r\n\005gamma\030\003 \001(\001\022\013\n\003lwd\030\004 \001(\001\022\013\n\003lty\030\005 "
+      "\001(\005\022\014\n\004lend\030\006 \001(\005\022\r\n\005ljoin\030\007 \001(\005\022\016\n\006lmit"
+      "re\030\010 \001(\001\022\013\n\003cex\030\t \001(\001\022\n\n\002ps\030\n \001(\001\022\022\n\nlin"
+      "eheight\030\013 \001(\001\022\020\n\010fontface\030\014 \001(\005\022\022\n\nfontf"
+      "amily\030\r \001(\t\"+\n\010MIMEData\022\021\n\tmime_type\030\001 \001"
+      "(\t\022\014\n\004data\030\002 \001(\014\"\315\001\n\007Console\022\016\n\004text\030\001 \001"
+      "(\tH\000\022\r\n\003err\030\002 \001(\tH\000\022\020\n\006prompt\030\003 \001(\tH\000\0220\n"
+      "\010graphics\030\004 \001(\0132\034.BERTBuffers.GraphicsCo"
+      "mmandH\000\022*\n\tmime_data\030\005 \001(\0132\025.BERTBuffers"
+      ".MIMEDataH\000\022(\n\007history\030\006 \001(\0132\025.BERTBuffe"
+      "rs.VariableH\000B\t\n\007message\"\204\001\n\017FunctionEle"
+      "ment\022\014\n\004name\030\001 \001(\t\022\021\n\ttype_name\030\002 \001(\t\022,\n"
+      "\rdefault_value\030\003 \001(\0132\025.BERTBuffers.Varia"
+      "ble\022\023\n\013description\030\004 \001(\t\022\r\n\005index\030\005 \001(\r\""
+      "\300\001\n\022FunctionDescriptor\022.\n\010function\030\001 \001(\013"
+      "2\034.BERTBuffers.FunctionElement\022(\n\tcall_t"
+      "ype\030\002 \001(\0162\025.BERTBuffers.CallType\022\r\n\005flag"
+      "s\030\003 \001(\r\022\020\n\010category\030\004 \001(\t\022/\n\targuments\030\005"
+      " \003(\0132\034.BERTBuffers.FunctionElement\"B\n\014Fu"
+      "nctionList\0222\n\tfunctions\030\001 \003(\0132\037.BERTBuff"
+      "ers.FunctionDescriptor\"(\n\tEnumValue\022\014\n\004n"
+      "ame\030\001 \001(\t\022\r\n\005value\030\002 \001(\005\"@\n\010EnumType\022\014\n\004"
+      "name\030\001 \001(\t\022&\n\006values\030\002 \003(\0132\026.BERTBuffers"
+      ".EnumValue\"\224\001\n\017ExternalPointer\022\026\n\016interf"
+      "ace_name\030\001 \001(\t\022\017\n\007pointer\030\002 \001(\004\0222\n\tfunct"
+      "ions\030\003 \003(\0132\037.BERTBuffers.FunctionDescrip"
+      "tor\022$\n\005enums\030\004 \003(\0132\025.BERTBuffers.EnumTyp"
+      "e\"\361\002\n\014CallResponse\022\n\n\002id\030\001 \001(\r\022\014\n\004wait\030\002"
+      " \001(\010\022\r\n\003err\030\003 \001(\tH\000\022\'\n\006result\030\004 \001(\0132\025.BE"
+      "RTBuffers.VariableH\000\022\'\n\007console\030\005 \001(\0132\024."
+      "BERTBuffers.ConsoleH\000\022!\n\004code\030\006 \001(\0132\021.BE"
+      "RTBuffers.CodeH\000\022\027\n\rshell_command\030\007 \001(\tH"
+      "\000\022;\n\rfunction_call\030\010 \001(\0132\".BERTBuffers.C"
+      "ompositeFunctionCallH\000\0222\n\rfunction_list\030"
+      "\t \001(\0132\031.BERTBuffers.FunctionListH\000\022,\n\nca"
+      "ll_batch\030\n \001(\0132\026.BERTBuffers.CallBatchH\000"
+      "B\013\n\toperation\"f\n\tCallBatch\0221\n\005calls\030\001 \003("
+      "\0132\".BERTBuffers.CompositeFunctionCall\022&\n"
+      "\007results\030\002 \003(\0132\025.BERTBuffers.Variable\"u\n"
+      "\014ArraySummary\022\014\n\004type\030\001 \001(\r\022\016\n\006has_na\030\002 "
+      "\001(\010\022\021\n\thas_names\030\003 \001(\010\022\031\n\021min_string_len"
+      "gth\030\004 \001(\005\022\031\n\021max_string_length\030\005 \001(\005*N\n\t"
+      "ErrorType\022\013\n\007GENERIC\020\000\022\006\n\002NA\020\001\022\007\n\003INF\020\002\022"
+      "\t\n\005PARSE\020\003\022\r\n\tEXECUTION\020\004\022\t\n\005OTHER\020\017*(\n\010"
+      "CallType\022\n\n\006method\020\000\022\007\n\003get\020\001\022\007\n\003put\020\002*="
+      "\n\nCallTarget\022\014\n\010language\020\000\022\007\n\003COM\020\001\022\n\n\006s"
+      "ystem\020\002\022\014\n\010graphics\020\003*3\n\025GraphicsUpdateC"
+      "ommand\022\n\n\006update\020\000\022\016\n\nquery_size\020\001B\002H\001b\006"
+      "proto3"
   };
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-      descriptor, 3150);
+      descriptor, 3646);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "variable.proto", &protobuf_RegisterTypes);
 }
@@ -1248,6 +1350,8 @@ void Complex::InternalSwap(Complex* other) {
 // ===================================================================
 
 void Array::InitAsDefaultInstance() {
+  ::BERTBuffers::_Array_default_instance_._instance.get_mutable()->summary_ = const_cast< ::BERTBuffers::ArraySummary*>(
+      ::BERTBuffers::ArraySummary::internal_default_instance());
 }
 #if !defined(_MSC_VER) || _MSC_VER >= 1900
 const int Array::kRowsFieldNumber;
@@ -1255,6 +1359,16 @@ const int Array::kColsFieldNumber;
 const int Array::kDataFieldNumber;
 const int Array::kRownamesFieldNumber;
 const int Array::kColnamesFieldNumber;
+const int Array::kPackedTypeFieldNumber;
+const int Array::kPackedLengthFieldNumber;
+const int Array::kRealsFieldNumber;
+const int Array::kIntegersFieldNumber;
+const int Array::kDictionaryFieldNumber;
+const int Array::kLogicalsFieldNumber;
+const int Array::kNaFieldNumber;
+const int Array::kStreamedFieldNumber;
+const int Array::kSummaryFieldNumber;
+const int Array::kColumnsFieldNumber;
 #endif  // !defined(_MSC_VER) || _MSC_VER >= 1900
 
 Array::Array()
@@ -1271,18 +1385,37 @@ Array::Array(const Array& from)
       data_(from.data_),
       rownames_(from.rownames_),
       colnames_(from.colnames_),
+      reals_(from.reals_),
+      integers_(from.integers_),
+      dictionary_(from.dictionary_),
+      columns_(from.columns_),
       _cached_size_(0) {
   _internal_metadata_.MergeFrom(from._internal_metadata_);
+  logicals_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  if (from.logicals().size() > 0) {
+    logicals_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.logicals_);
+  }
+  na_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  if (from.na().size() > 0) {
+    na_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.na_);
+  }
+  if (from.has_summary()) {
+    summary_ = new ::BERTBuffers::ArraySummary(*from.summary_);
+  } else {
+    summary_ = NULL;
+  }
   ::memcpy(&rows_, &from.rows_,
-    static_cast<size_t>(reinterpret_cast<char*>(&cols_) -
-    reinterpret_cast<char*>(&rows_)) + sizeof(cols_));
+    static_cast<size_t>(reinterpret_cast<char*>(&streamed_) -
+    reinterpret_cast<char*>(&rows_)) + sizeof(streamed_));
   // @@protoc_insertion_point(copy_constructor:BERTBuffers.Array)
 }
 
 void Array::SharedCtor() {
-  ::memset(&rows_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&cols_) -
-      reinterpret_cast<char*>(&rows_)) + sizeof(cols_));
+  logicals_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  na_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  ::memset(&summary_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&streamed_) -
+      reinterpret_cast<char*>(&summary_)) + sizeof(streamed_));
   _cached_size_ = 0;
 }
 
@@ -1292,6 +1425,9 @@ Array::~Array() {
 }
 
 void Array::SharedDtor() {
+  logicals_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  na_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  if (this != internal_default_instance()) delete summary_;
 }
 
 void Array::SetCachedSize(int size) const {
@@ -1326,9 +1462,19 @@ void Array::Clear() {
   data_.Clear();
   rownames_.Clear();
   colnames_.Clear();
+  reals_.Clear();
+  integers_.Clear();
+  dictionary_.Clear();
+  columns_.Clear();
+  logicals_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  na_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  if (GetArenaNoVirtual() == NULL && summary_ != NULL) {
+    delete summary_;
+  }
+  summary_ = NULL;
   ::memset(&rows_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&cols_) -
-      reinterpret_cast<char*>(&rows_)) + sizeof(cols_));
+      reinterpret_cast<char*>(&streamed_) -
+      reinterpret_cast<char*>(&rows_)) + sizeof(streamed_));
   _internal_metadata_.Clear();
 }
 
@@ -1415,6 +1561,150 @@ bool Array::MergePartialFromCodedStream(
         break;
       }
 
+      // uint32 packed_type = 6;
+      case 6: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(48u /* 48 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &packed_type_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // int32 packed_length = 7;
+      case 7: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(56u /* 56 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &packed_length_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // repeated double reals = 8;
+      case 8: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(66u /* 66 & 0xFF */)) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPackedPrimitive<
+                   double, ::google::protobuf::internal::WireFormatLite::TYPE_DOUBLE>(
+                 input, this->mutable_reals())));
+        } else if (
+            static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(65u /* 65 & 0xFF */)) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadRepeatedPrimitiveNoInline<
+                   double, ::google::protobuf::internal::WireFormatLite::TYPE_DOUBLE>(
+                 1, 66u, input, this->mutable_reals())));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // repeated int32 integers = 9;
+      case 9: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(74u /* 74 & 0xFF */)) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPackedPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, this->mutable_integers())));
+        } else if (
+            static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(72u /* 72 & 0xFF */)) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadRepeatedPrimitiveNoInline<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 1, 74u, input, this->mutable_integers())));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // repeated string dictionary = 10;
+      case 10: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(82u /* 82 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
+                input, this->add_dictionary()));
+          DO_(::google::protobuf::internal::WireFormatLite::VerifyUtf8String(
+            this->dictionary(this->dictionary_size() - 1).data(),
+            static_cast<int>(this->dictionary(this->dictionary_size() - 1).length()),
+            ::google::protobuf::internal::WireFormatLite::PARSE,
+            "BERTBuffers.Array.dictionary"));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bytes logicals = 11;
+      case 11: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(90u /* 90 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
+                input, this->mutable_logicals()));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bytes na = 12;
+      case 12: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(98u /* 98 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
+                input, this->mutable_na()));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bool streamed = 13;
+      case 13: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(104u /* 104 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &streamed_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // .BERTBuffers.ArraySummary summary = 14;
+      case 14: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(114u /* 114 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessage(
+               input, mutable_summary()));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // repeated .BERTBuffers.Array columns = 15;
+      case 15: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(122u /* 122 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessage(input, add_columns()));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
       default: {
       handle_unusual:
         if (tag == 0) {
@@ -1478,6 +1768,76 @@ void Array::SerializeWithCachedSizes(
       5, this->colnames(i), output);
   }
 
+  // uint32 packed_type = 6;
+  if (this->packed_type() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(6, this->packed_type(), output);
+  }
+
+  // int32 packed_length = 7;
+  if (this->packed_length() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(7, this->packed_length(), output);
+  }
+
+  // repeated double reals = 8;
+  if (this->reals_size() > 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteTag(8, ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED, output);
+    output->WriteVarint32(static_cast< ::google::protobuf::uint32>(
+        _reals_cached_byte_size_));
+    ::google::protobuf::internal::WireFormatLite::WriteDoubleArray(
+      this->reals().data(), this->reals_size(), output);
+  }
+
+  // repeated int32 integers = 9;
+  if (this->integers_size() > 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteTag(9, ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED, output);
+    output->WriteVarint32(static_cast< ::google::protobuf::uint32>(
+        _integers_cached_byte_size_));
+  }
+  for (int i = 0, n = this->integers_size(); i < n; i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32NoTag(
+      this->integers(i), output);
+  }
+
+  // repeated string dictionary = 10;
+  for (int i = 0, n = this->dictionary_size(); i < n; i++) {
+    ::google::protobuf::internal::WireFormatLite::VerifyUtf8String(
+      this->dictionary(i).data(), static_cast<int>(this->dictionary(i).length()),
+      ::google::protobuf::internal::WireFormatLite::SERIALIZE,
+      "BERTBuffers.Array.dictionary");
+    ::google::protobuf::internal::WireFormatLite::WriteString(
+      10, this->dictionary(i), output);
+  }
+
+  // bytes logicals = 11;
+  if (this->logicals().size() > 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBytesMaybeAliased(
+      11, this->logicals(), output);
+  }
+
+  // bytes na = 12;
+  if (this->na().size() > 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBytesMaybeAliased(
+      12, this->na(), output);
+  }
+
+  // bool streamed = 13;
+  if (this->streamed() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(13, this->streamed(), output);
+  }
+
+  // .BERTBuffers.ArraySummary summary = 14;
+  if (this->has_summary()) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      14, *this->summary_, output);
+  }
+
+  // repeated .BERTBuffers.Array columns = 15;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->columns_size()); i < n; i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      15, this->columns(static_cast<int>(i)), output);
+  }
+
   if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), output);
@@ -1530,6 +1890,86 @@ void Array::SerializeWithCachedSizes(
       WriteStringToArray(5, this->colnames(i), target);
   }
 
+  // uint32 packed_type = 6;
+  if (this->packed_type() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(6, this->packed_type(), target);
+  }
+
+  // int32 packed_length = 7;
+  if (this->packed_length() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(7, this->packed_length(), target);
+  }
+
+  // repeated double reals = 8;
+  if (this->reals_size() > 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteTagToArray(
+      8,
+      ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED,
+      target);
+    target = ::google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+        static_cast< ::google::protobuf::int32>(
+            _reals_cached_byte_size_), target);
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteDoubleNoTagToArray(this->reals_, target);
+  }
+
+  // repeated int32 integers = 9;
+  if (this->integers_size() > 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteTagToArray(
+      9,
+      ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED,
+      target);
+    target = ::google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+        static_cast< ::google::protobuf::int32>(
+            _integers_cached_byte_size_), target);
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteInt32NoTagToArray(this->integers_, target);
+  }
+
+  // repeated string dictionary = 10;
+  for (int i = 0, n = this->dictionary_size(); i < n; i++) {
+    ::google::protobuf::internal::WireFormatLite::VerifyUtf8String(
+      this->dictionary(i).data(), static_cast<int>(this->dictionary(i).length()),
+      ::google::protobuf::internal::WireFormatLite::SERIALIZE,
+      "BERTBuffers.Array.dictionary");
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteStringToArray(10, this->dictionary(i), target);
+  }
+
+  // bytes logicals = 11;
+  if (this->logicals().size() > 0) {
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteBytesToArray(
+        11, this->logicals(), target);
+  }
+
+  // bytes na = 12;
+  if (this->na().size() > 0) {
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteBytesToArray(
+        12, this->na(), target);
+  }
+
+  // bool streamed = 13;
+  if (this->streamed() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(13, this->streamed(), target);
+  }
+
+  // .BERTBuffers.ArraySummary summary = 14;
+  if (this->has_summary()) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      InternalWriteMessageToArray(
+        14, *this->summary_, deterministic, target);
+  }
+
+  // repeated .BERTBuffers.Array columns = 15;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->columns_size()); i < n; i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      InternalWriteMessageToArray(
+        15, this->columns(static_cast<int>(i)), deterministic, target);
+  }
+
   if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), target);
@@ -1574,20 +2014,111 @@ size_t Array::ByteSizeLong() const {
       this->colnames(i));
   }
 
-  // int32 rows = 1;
-  if (this->rows() != 0) {
-    total_size += 1 +
-      ::google::protobuf::internal::WireFormatLite::Int32Size(
-        this->rows());
-  }
-
-  // int32 cols = 2;
-  if (this->cols() != 0) {
-    total_size += 1 +
-      ::google::protobuf::internal::WireFormatLite::Int32Size(
-        this->cols());
-  }
-
+  // repeated double reals = 8;
+  {
+    unsigned int count = static_cast<unsigned int>(this->reals_size());
+    size_t data_size = 8UL * count;
+    if (data_size > 0) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+            static_cast< ::google::protobuf::int32>(data_size));
+    }
+    int cached_size = ::google::protobuf::internal::ToCachedSize(data_size);
+    GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+    _reals_cached_byte_size_ = cached_size;
+    GOOGLE_SAFE_CONCURRENT_WRITES_END();
+    total_size += data_size;
+  }
+
+  // repeated int32 integers = 9;
+  {
+    size_t data_size = ::google::protobuf::internal::WireFormatLite::
+      Int32Size(this->integers_);
+    if (data_size > 0) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+            static_cast< ::google::protobuf::int32>(data_size));
+    }
+    int cached_size = ::google::protobuf::internal::ToCachedSize(data_size);
+    GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+    _integers_cached_byte_size_ = cached_size;
+    GOOGLE_SAFE_CONCURRENT_WRITES_END();
+    total_size += data_size;
+  }
+
+  // repeated string dictionary = 10;
+  total_size += 1 *
+      ::google::protobuf::internal::FromIntSize(this->dictionary_size());
+  for (int i = 0, n = this->dictionary_size(); i < n; i++) {
+    total_size += ::google::protobuf::internal::WireFormatLite::StringSize(
+      this->dictionary(i));
+  }
+
+  // repeated .BERTBuffers.Array columns = 15;
+  {
+    unsigned int count = static_cast<unsigned int>(this->columns_size());
+    total_size += 1UL * count;
+    for (unsigned int i = 0; i < count; i++) {
+      total_size +=
+        ::google::protobuf::internal::WireFormatLite::MessageSize(
+          this->columns(static_cast<int>(i)));
+    }
+  }
+
+  // bytes logicals = 11;
+  if (this->logicals().size() > 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::BytesSize(
+        this->logicals());
+  }
+
+  // bytes na = 12;
+  if (this->na().size() > 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::BytesSize(
+        this->na());
+  }
+
+  // .BERTBuffers.ArraySummary summary = 14;
+  if (this->has_summary()) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::MessageSize(
+        *this->summary_);
+  }
+
+  // int32 rows = 1;
+  if (this->rows() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int32Size(
+        this->rows());
+  }
+
+  // int32 cols = 2;
+  if (this->cols() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int32Size(
+        this->cols());
+  }
+
+  // uint32 packed_type = 6;
+  if (this->packed_type() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->packed_type());
+  }
+
+  // int32 packed_length = 7;
+  if (this->packed_length() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int32Size(
+        this->packed_length());
+  }
+
+  // bool streamed = 13;
+  if (this->streamed() != 0) {
+    total_size += 1 + 1;
+  }
+
   int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
   _cached_size_ = cached_size;
@@ -1620,12 +2151,36 @@ void Array::MergeFrom(const Array& from) {
   data_.MergeFrom(from.data_);
   rownames_.MergeFrom(from.rownames_);
   colnames_.MergeFrom(from.colnames_);
+  reals_.MergeFrom(from.reals_);
+  integers_.MergeFrom(from.integers_);
+  dictionary_.MergeFrom(from.dictionary_);
+  columns_.MergeFrom(from.columns_);
+  if (from.logicals().size() > 0) {
+
+    logicals_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.logicals_);
+  }
+  if (from.na().size() > 0) {
+
+    na_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.na_);
+  }
+  if (from.has_summary()) {
+    mutable_summary()->::BERTBuffers::ArraySummary::MergeFrom(from.summary());
+  }
   if (from.rows() != 0) {
     set_rows(from.rows());
   }
   if (from.cols() != 0) {
     set_cols(from.cols());
   }
+  if (from.packed_type() != 0) {
+    set_packed_type(from.packed_type());
+  }
+  if (from.packed_length() != 0) {
+    set_packed_length(from.packed_length());
+  }
+  if (from.streamed() != 0) {
+    set_streamed(from.streamed());
+  }
 }
 
 void Array::CopyFrom(const ::google::protobuf::Message& from) {
@@ -1655,8 +2210,18 @@ void Array::InternalSwap(Array* other) {
   data_.InternalSwap(&other->data_);
   rownames_.InternalSwap(&other->rownames_);
   colnames_.InternalSwap(&other->colnames_);
+  reals_.InternalSwap(&other->reals_);
+  integers_.InternalSwap(&other->integers_);
+  dictionary_.InternalSwap(&other->dictionary_);
+  columns_.InternalSwap(&other->columns_);
+  logicals_.Swap(&other->logicals_);
+  na_.Swap(&other->na_);
+  swap(summary_, other->summary_);
   swap(rows_, other->rows_);
   swap(cols_, other->cols_);
+  swap(packed_type_, other->packed_type_);
+  swap(packed_length_, other->packed_length_);
+  swap(streamed_, other->streamed_);
   _internal_metadata_.Swap(&other->_internal_metadata_);
   swap(_cached_size_, other->_cached_size_);
 }
@@ -9342,6 +9907,8 @@ void CallResponse::InitAsDefaultInstance() {
       ::BERTBuffers::CompositeFunctionCall::internal_default_instance());
   ::BERTBuffers::_CallResponse_default_instance_.function_list_ = const_cast< ::BERTBuffers::FunctionList*>(
       ::BERTBuffers::FunctionList::internal_default_instance());
+  ::BERTBuffers::_CallResponse_default_instance_.call_batch_ = const_cast< ::BERTBuffers::CallBatch*>(
+      ::BERTBuffers::CallBatch::internal_default_instance());
 }
 void CallResponse::set_allocated_result(::BERTBuffers::Variable* result) {
   ::google::protobuf::Arena* message_arena = GetArenaNoVirtual();
@@ -9413,6 +9980,20 @@ void CallResponse::set_allocated_function_list(::BERTBuffers::FunctionList* func
   }
   // @@protoc_insertion_point(field_set_allocated:BERTBuffers.CallResponse.function_list)
 }
+void CallResponse::set_allocated_call_batch(::BERTBuffers::CallBatch* call_batch) {
+  ::google::protobuf::Arena* message_arena = GetArenaNoVirtual();
+  clear_operation();
+  if (call_batch) {
+    ::google::protobuf::Arena* submessage_arena = NULL;
+    if (message_arena != submessage_arena) {
+      call_batch = ::google::protobuf::internal::GetOwnedMessage(
+          message_arena, call_batch, submessage_arena);
+    }
+    set_has_call_batch();
+    operation_.call_batch_ = call_batch;
+  }
+  // @@protoc_insertion_point(field_set_allocated:BERTBuffers.CallResponse.call_batch)
+}
 #if !defined(_MSC_VER) || _MSC_VER >= 1900
 const int CallResponse::kIdFieldNumber;
 const int CallResponse::kWaitFieldNumber;
@@ -9423,6 +10004,7 @@ const int CallResponse::kCodeFieldNumber;
 const int CallResponse::kShellCommandFieldNumber;
 const int CallResponse::kFunctionCallFieldNumber;
 const int CallResponse::kFunctionListFieldNumber;
+const int CallResponse::kCallBatchFieldNumber;
 #endif  // !defined(_MSC_VER) || _MSC_VER >= 1900
 
 CallResponse::CallResponse()
@@ -9471,6 +10053,10 @@ CallResponse::CallResponse(const CallResponse& from)
       mutable_function_list()->::BERTBuffers::FunctionList::MergeFrom(from.function_list());
       break;
     }
+    case kCallBatch: {
+      mutable_call_batch()->::BERTBuffers::CallBatch::MergeFrom(from.call_batch());
+      break;
+    }
     case OPERATION_NOT_SET: {
       break;
     }
@@ -9551,6 +10137,10 @@ void CallResponse::clear_operation() {
       delete operation_.function_list_;
       break;
     }
+    case kCallBatch: {
+      delete operation_.call_batch_;
+      break;
+    }
     case OPERATION_NOT_SET: {
       break;
     }
@@ -9702,6 +10292,18 @@ bool CallResponse::MergePartialFromCodedStream(
         break;
       }
 
+      // .BERTBuffers.CallBatch call_batch = 10;
+      case 10: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(82u /* 82 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessage(
+               input, mutable_call_batch()));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
       default: {
       handle_unusual:
         if (tag == 0) {
@@ -9788,6 +10390,12 @@ void CallResponse::SerializeWithCachedSizes(
       9, *operation_.function_list_, output);
   }
 
+  // .BERTBuffers.CallBatch call_batch = 10;
+  if (has_call_batch()) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      10, *operation_.call_batch_, output);
+  }
+
   if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), output);
@@ -9869,6 +10477,13 @@ void CallResponse::SerializeWithCachedSizes(
         9, *operation_.function_list_, deterministic, target);
   }
 
+  // .BERTBuffers.CallBatch call_batch = 10;
+  if (has_call_batch()) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      InternalWriteMessageToArray(
+        10, *operation_.call_batch_, deterministic, target);
+  }
+
   if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), target);
@@ -9948,6 +10563,13 @@ size_t CallResponse::ByteSizeLong() const {
           *operation_.function_list_);
       break;
     }
+    // .BERTBuffers.CallBatch call_batch = 10;
+    case kCallBatch: {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::MessageSize(
+          *operation_.call_batch_);
+      break;
+    }
     case OPERATION_NOT_SET: {
       break;
     }
@@ -10016,6 +10638,10 @@ void CallResponse::MergeFrom(const CallResponse& from) {
       mutable_function_list()->::BERTBuffers::FunctionList::MergeFrom(from.function_list());
       break;
     }
+    case kCallBatch: {
+      mutable_call_batch()->::BERTBuffers::CallBatch::MergeFrom(from.call_batch());
+      break;
+    }
     case OPERATION_NOT_SET: {
       break;
     }
@@ -10060,6 +10686,672 @@ void CallResponse::InternalSwap(CallResponse* other) {
 }
 
 
+// ===================================================================
+
+void CallBatch::InitAsDefaultInstance() {
+}
+#if !defined(_MSC_VER) || _MSC_VER >= 1900
+const int CallBatch::kCallsFieldNumber;
+const int CallBatch::kResultsFieldNumber;
+#endif  // !defined(_MSC_VER) || _MSC_VER >= 1900
+
+CallBatch::CallBatch()
+  : ::google::protobuf::Message(), _internal_metadata_(NULL) {
+  if (GOOGLE_PREDICT_TRUE(this != internal_default_instance())) {
+    ::protobuf_variable_2eproto::InitDefaultsCallBatch();
+  }
+  SharedCtor();
+  // @@protoc_insertion_point(constructor:BERTBuffers.CallBatch)
+}
+CallBatch::CallBatch(const CallBatch& from)
+  : ::google::protobuf::Message(),
+      _internal_metadata_(NULL),
+      calls_(from.calls_),
+      results_(from.results_),
+      _cached_size_(0) {
+  _internal_metadata_.MergeFrom(from._internal_metadata_);
+  // @@protoc_insertion_point(copy_constructor:BERTBuffers.CallBatch)
+}
+
+void CallBatch::SharedCtor() {
+  _cached_size_ = 0;
+}
+
+CallBatch::~CallBatch() {
+  // @@protoc_insertion_point(destructor:BERTBuffers.CallBatch)
+  SharedDtor();
+}
+
+void CallBatch::SharedDtor() {
+}
+
+void CallBatch::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* CallBatch::descriptor() {
+  ::protobuf_variable_2eproto::protobuf_AssignDescriptorsOnce();
+  return ::protobuf_variable_2eproto::file_level_metadata[kIndexInFileMessages].descriptor;
+}
+
+const CallBatch& CallBatch::default_instance() {
+  ::protobuf_variable_2eproto::InitDefaultsCallBatch();
+  return *internal_default_instance();
+}
+
+CallBatch* CallBatch::New(::google::protobuf::Arena* arena) const {
+  CallBatch* n = new CallBatch;
+  if (arena != NULL) {
+    arena->Own(n);
+  }
+  return n;
+}
+
+void CallBatch::Clear() {
+// @@protoc_insertion_point(message_clear_start:BERTBuffers.CallBatch)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  calls_.Clear();
+  results_.Clear();
+  _internal_metadata_.Clear();
+}
+
+bool CallBatch::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!GOOGLE_PREDICT_TRUE(EXPRESSION)) goto failure
+  ::google::protobuf::uint32 tag;
+  // @@protoc_insertion_point(parse_start:BERTBuffers.CallBatch)
+  for (;;) {
+    ::std::pair< ::google::protobuf::uint32, bool> p = input->ReadTagWithCutoffNoLastTag(127u);
+    tag = p.first;
+    if (!p.second) goto handle_unusual;
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // repeated .BERTBuffers.CompositeFunctionCall calls = 1;
+      case 1: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(10u /* 10 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessage(input, add_calls()));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // repeated .BERTBuffers.Variable results = 2;
+      case 2: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(18u /* 18 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessage(input, add_results()));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      default: {
+      handle_unusual:
+        if (tag == 0) {
+          goto success;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, _internal_metadata_.mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+success:
+  // @@protoc_insertion_point(parse_success:BERTBuffers.CallBatch)
+  return true;
+failure:
+  // @@protoc_insertion_point(parse_failure:BERTBuffers.CallBatch)
+  return false;
+#undef DO_
+}
+
+void CallBatch::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // @@protoc_insertion_point(serialize_start:BERTBuffers.CallBatch)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // repeated .BERTBuffers.CompositeFunctionCall calls = 1;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->calls_size()); i < n; i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      1, this->calls(static_cast<int>(i)), output);
+  }
+
+  // repeated .BERTBuffers.Variable results = 2;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->results_size()); i < n; i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      2, this->results(static_cast<int>(i)), output);
+  }
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), output);
+  }
+  // @@protoc_insertion_point(serialize_end:BERTBuffers.CallBatch)
+}
+
+::google::protobuf::uint8* CallBatch::InternalSerializeWithCachedSizesToArray(
+    bool deterministic, ::google::protobuf::uint8* target) const {
+  (void)deterministic; // Unused
+  // @@protoc_insertion_point(serialize_to_array_start:BERTBuffers.CallBatch)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // repeated .BERTBuffers.CompositeFunctionCall calls = 1;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->calls_size()); i < n; i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      InternalWriteMessageToArray(
+        1, this->calls(static_cast<int>(i)), deterministic, target);
+  }
+
+  // repeated .BERTBuffers.Variable results = 2;
+  for (unsigned int i = 0,
+      n = static_cast<unsigned int>(this->results_size()); i < n; i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      InternalWriteMessageToArray(
+        2, this->results(static_cast<int>(i)), deterministic, target);
+  }
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), target);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:BERTBuffers.CallBatch)
+  return target;
+}
+
+size_t CallBatch::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:BERTBuffers.CallBatch)
+  size_t total_size = 0;
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()));
+  }
+  // repeated .BERTBuffers.CompositeFunctionCall calls = 1;
+  {
+    unsigned int count = static_cast<unsigned int>(this->calls_size());
+    total_size += 1UL * count;
+    for (unsigned int i = 0; i < count; i++) {
+      total_size +=
+        ::google::protobuf::internal::WireFormatLite::MessageSize(
+          this->calls(static_cast<int>(i)));
+    }
+  }
+
+  // repeated .BERTBuffers.Variable results = 2;
+  {
+    unsigned int count = static_cast<unsigned int>(this->results_size());
+    total_size += 1UL * count;
+    for (unsigned int i = 0; i < count; i++) {
+      total_size +=
+        ::google::protobuf::internal::WireFormatLite::MessageSize(
+          this->results(static_cast<int>(i)));
+    }
+  }
+
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = cached_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void CallBatch::MergeFrom(const ::google::protobuf::Message& from) {
+// @@protoc_insertion_point(generalized_merge_from_start:BERTBuffers.CallBatch)
+  GOOGLE_DCHECK_NE(&from, this);
+  const CallBatch* source =
+      ::google::protobuf::internal::DynamicCastToGenerated<const CallBatch>(
+          &from);
+  if (source == NULL) {
+  // @@protoc_insertion_point(generalized_merge_from_cast_fail:BERTBuffers.CallBatch)
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+  // @@protoc_insertion_point(generalized_merge_from_cast_success:BERTBuffers.CallBatch)
+    MergeFrom(*source);
+  }
+}
+
+void CallBatch::MergeFrom(const CallBatch& from) {
+// @@protoc_insertion_point(class_specific_merge_from_start:BERTBuffers.CallBatch)
+  GOOGLE_DCHECK_NE(&from, this);
+  _internal_metadata_.MergeFrom(from._internal_metadata_);
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  calls_.MergeFrom(from.calls_);
+  results_.MergeFrom(from.results_);
+}
+
+void CallBatch::CopyFrom(const ::google::protobuf::Message& from) {
+// @@protoc_insertion_point(generalized_copy_from_start:BERTBuffers.CallBatch)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void CallBatch::CopyFrom(const CallBatch& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:BERTBuffers.CallBatch)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool CallBatch::IsInitialized() const {
+  return true;
+}
+
+void CallBatch::Swap(CallBatch* other) {
+  if (other == this) return;
+  InternalSwap(other);
+}
+void CallBatch::InternalSwap(CallBatch* other) {
+  using std::swap;
+  calls_.InternalSwap(&other->calls_);
+  results_.InternalSwap(&other->results_);
+  _internal_metadata_.Swap(&other->_internal_metadata_);
+  swap(_cached_size_, other->_cached_size_);
+}
+
+::google::protobuf::Metadata CallBatch::GetMetadata() const {
+  protobuf_variable_2eproto::protobuf_AssignDescriptorsOnce();
+  return ::protobuf_variable_2eproto::file_level_metadata[kIndexInFileMessages];
+}
+
+
+// ===================================================================
+
+void ArraySummary::InitAsDefaultInstance() {
+}
+#if !defined(_MSC_VER) || _MSC_VER >= 1900
+const int ArraySummary::kTypeFieldNumber;
+const int ArraySummary::kHasNaFieldNumber;
+const int ArraySummary::kHasNamesFieldNumber;
+const int ArraySummary::kMinStringLengthFieldNumber;
+const int ArraySummary::kMaxStringLengthFieldNumber;
+#endif  // !defined(_MSC_VER) || _MSC_VER >= 1900
+
+ArraySummary::ArraySummary()
+  : ::google::protobuf::Message(), _internal_metadata_(NULL) {
+  if (GOOGLE_PREDICT_TRUE(this != internal_default_instance())) {
+    ::protobuf_variable_2eproto::InitDefaultsArraySummary();
+  }
+  SharedCtor();
+  // @@protoc_insertion_point(constructor:BERTBuffers.ArraySummary)
+}
+ArraySummary::ArraySummary(const ArraySummary& from)
+  : ::google::protobuf::Message(),
+      _internal_metadata_(NULL),
+      _cached_size_(0) {
+  _internal_metadata_.MergeFrom(from._internal_metadata_);
+  ::memcpy(&type_, &from.type_,
+    static_cast<size_t>(reinterpret_cast<char*>(&max_string_length_) -
+    reinterpret_cast<char*>(&type_)) + sizeof(max_string_length_));
+  // @@protoc_insertion_point(copy_constructor:BERTBuffers.ArraySummary)
+}
+
+void ArraySummary::SharedCtor() {
+  ::memset(&type_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&max_string_length_) -
+      reinterpret_cast<char*>(&type_)) + sizeof(max_string_length_));
+  _cached_size_ = 0;
+}
+
+ArraySummary::~ArraySummary() {
+  // @@protoc_insertion_point(destructor:BERTBuffers.ArraySummary)
+  SharedDtor();
+}
+
+void ArraySummary::SharedDtor() {
+}
+
+void ArraySummary::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* ArraySummary::descriptor() {
+  ::protobuf_variable_2eproto::protobuf_AssignDescriptorsOnce();
+  return ::protobuf_variable_2eproto::file_level_metadata[kIndexInFileMessages].descriptor;
+}
+
+const ArraySummary& ArraySummary::default_instance() {
+  ::protobuf_variable_2eproto::InitDefaultsArraySummary();
+  return *internal_default_instance();
+}
+
+ArraySummary* ArraySummary::New(::google::protobuf::Arena* arena) const {
+  ArraySummary* n = new ArraySummary;
+  if (arena != NULL) {
+    arena->Own(n);
+  }
+  return n;
+}
+
+void ArraySummary::Clear() {
+// @@protoc_insertion_point(message_clear_start:BERTBuffers.ArraySummary)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  ::memset(&type_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&max_string_length_) -
+      reinterpret_cast<char*>(&type_)) + sizeof(max_string_length_));
+  _internal_metadata_.Clear();
+}
+
+bool ArraySummary::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!GOOGLE_PREDICT_TRUE(EXPRESSION)) goto failure
+  ::google::protobuf::uint32 tag;
+  // @@protoc_insertion_point(parse_start:BERTBuffers.ArraySummary)
+  for (;;) {
+    ::std::pair< ::google::protobuf::uint32, bool> p = input->ReadTagWithCutoffNoLastTag(127u);
+    tag = p.first;
+    if (!p.second) goto handle_unusual;
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // uint32 type = 1;
+      case 1: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(8u /* 8 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &type_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bool has_na = 2;
+      case 2: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(16u /* 16 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &has_na_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bool has_names = 3;
+      case 3: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(24u /* 24 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &has_names_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // int32 min_string_length = 4;
+      case 4: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(32u /* 32 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &min_string_length_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // int32 max_string_length = 5;
+      case 5: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(40u /* 40 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &max_string_length_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      default: {
+      handle_unusual:
+        if (tag == 0) {
+          goto success;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, _internal_metadata_.mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+success:
+  // @@protoc_insertion_point(parse_success:BERTBuffers.ArraySummary)
+  return true;
+failure:
+  // @@protoc_insertion_point(parse_failure:BERTBuffers.ArraySummary)
+  return false;
+#undef DO_
+}
+
+void ArraySummary::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // @@protoc_insertion_point(serialize_start:BERTBuffers.ArraySummary)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // uint32 type = 1;
+  if (this->type() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(1, this->type(), output);
+  }
+
+  // bool has_na = 2;
+  if (this->has_na() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(2, this->has_na(), output);
+  }
+
+  // bool has_names = 3;
+  if (this->has_names() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(3, this->has_names(), output);
+  }
+
+  // int32 min_string_length = 4;
+  if (this->min_string_length() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(4, this->min_string_length(), output);
+  }
+
+  // int32 max_string_length = 5;
+  if (this->max_string_length() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(5, this->max_string_length(), output);
+  }
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), output);
+  }
+  // @@protoc_insertion_point(serialize_end:BERTBuffers.ArraySummary)
+}
+
+::google::protobuf::uint8* ArraySummary::InternalSerializeWithCachedSizesToArray(
+    bool deterministic, ::google::protobuf::uint8* target) const {
+  (void)deterministic; // Unused
+  // @@protoc_insertion_point(serialize_to_array_start:BERTBuffers.ArraySummary)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // uint32 type = 1;
+  if (this->type() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(1, this->type(), target);
+  }
+
+  // bool has_na = 2;
+  if (this->has_na() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(2, this->has_na(), target);
+  }
+
+  // bool has_names = 3;
+  if (this->has_names() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(3, this->has_names(), target);
+  }
+
+  // int32 min_string_length = 4;
+  if (this->min_string_length() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(4, this->min_string_length(), target);
+  }
+
+  // int32 max_string_length = 5;
+  if (this->max_string_length() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(5, this->max_string_length(), target);
+  }
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), target);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:BERTBuffers.ArraySummary)
+  return target;
+}
+
+size_t ArraySummary::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:BERTBuffers.ArraySummary)
+  size_t total_size = 0;
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()));
+  }
+  // uint32 type = 1;
+  if (this->type() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->type());
+  }
+
+  // bool has_na = 2;
+  if (this->has_na() != 0) {
+    total_size += 1 + 1;
+  }
+
+  // bool has_names = 3;
+  if (this->has_names() != 0) {
+    total_size += 1 + 1;
+  }
+
+  // int32 min_string_length = 4;
+  if (this->min_string_length() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int32Size(
+        this->min_string_length());
+  }
+
+  // int32 max_string_length = 5;
+  if (this->max_string_length() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::Int32Size(
+        this->max_string_length());
+  }
+
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = cached_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void ArraySummary::MergeFrom(const ::google::protobuf::Message& from) {
+// @@protoc_insertion_point(generalized_merge_from_start:BERTBuffers.ArraySummary)
+  GOOGLE_DCHECK_NE(&from, this);
+  const ArraySummary* source =
+      ::google::protobuf::internal::DynamicCastToGenerated<const ArraySummary>(
+          &from);
+  if (source == NULL) {
+  // @@protoc_insertion_point(generalized_merge_from_cast_fail:BERTBuffers.ArraySummary)
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+  // @@protoc_insertion_point(generalized_merge_from_cast_success:BERTBuffers.ArraySummary)
+    MergeFrom(*source);
+  }
+}
+
+void ArraySummary::MergeFrom(const ArraySummary& from) {
+// @@protoc_insertion_point(class_specific_merge_from_start:BERTBuffers.ArraySummary)
+  GOOGLE_DCHECK_NE(&from, this);
+  _internal_metadata_.MergeFrom(from._internal_metadata_);
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  if (from.type() != 0) {
+    set_type(from.type());
+  }
+  if (from.has_na() != 0) {
+    set_has_na(from.has_na());
+  }
+  if (from.has_names() != 0) {
+    set_has_names(from.has_names());
+  }
+  if (from.min_string_length() != 0) {
+    set_min_string_length(from.min_string_length());
+  }
+  if (from.max_string_length() != 0) {
+    set_max_string_length(from.max_string_length());
+  }
+}
+
+void ArraySummary::CopyFrom(const ::google::protobuf::Message& from) {
+// @@protoc_insertion_point(generalized_copy_from_start:BERTBuffers.ArraySummary)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void ArraySummary::CopyFrom(const ArraySummary& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:BERTBuffers.ArraySummary)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool ArraySummary::IsInitialized() const {
+  return true;
+}
+
+void ArraySummary::Swap(ArraySummary* other) {
+  if (other == this) return;
+  InternalSwap(other);
+}
+void ArraySummary::InternalSwap(ArraySummary* other) {
+  using std::swap;
+  swap(type_, other->type_);
+  swap(has_na_, other->has_na_);
+  swap(has_names_, other->has_names_);
+  swap(min_string_length_, other->min_string_length_);
+  swap(max_string_length_, other->max_string_length_);
+  _internal_metadata_.Swap(&other->_internal_metadata_);
+  swap(_cached_size_, other->_cached_size_);
+}
+
+::google::protobuf::Metadata ArraySummary::GetMetadata() const {
+  protobuf_variable_2eproto::protobuf_AssignDescriptorsOnce();
+  return ::protobuf_variable_2eproto::file_level_metadata[kIndexInFileMessages];
+}
+
 // @@protoc_insertion_point(namespace_scope)
 }  // namespace BERTBuffers
 
@@ -37,7 +37,7 @@ namespace protobuf_variable_2eproto {
 struct TableStruct {
   static const ::google::protobuf::internal::ParseTableField entries[];
   static const ::google::protobuf::internal::AuxillaryParseTableField aux[];
-  static const ::google::protobuf::internal::ParseTable schema[20];
+  static const ::google::protobuf::internal::ParseTable schema[22];
   static const ::google::protobuf::internal::FieldMetadata field_metadata[];
   static const ::google::protobuf::internal::SerializationTable serialization_table[];
   static const ::google::protobuf::uint32 offsets[];
@@ -75,6 +75,10 @@ void InitDefaultsEnumTypeImpl();
 void InitDefaultsEnumType();
 void InitDefaultsCallResponseImpl();
 void InitDefaultsCallResponse();
+void InitDefaultsCallBatchImpl();
+void InitDefaultsCallBatch();
+void InitDefaultsArraySummaryImpl();
+void InitDefaultsArraySummary();
 inline void InitDefaults() {
   InitDefaultsComplex();
   InitDefaultsArray();
@@ -92,12 +96,20 @@ inline void InitDefaults() {
   InitDefaultsEnumValue();
   InitDefaultsEnumType();
   InitDefaultsCallResponse();
+  InitDefaultsCallBatch();
+  InitDefaultsArraySummary();
 }
 }  // namespace protobuf_variable_2eproto
 namespace BERTBuffers {
 class Array;
 class ArrayDefaultTypeInternal;
 extern ArrayDefaultTypeInternal _Array_default_instance_;
+class ArraySummary;
+class ArraySummaryDefaultTypeInternal;
+extern ArraySummaryDefaultTypeInternal _ArraySummary_default_instance_;
+class CallBatch;
+class CallBatchDefaultTypeInternal;
+extern CallBatchDefaultTypeInternal _CallBatch_default_instance_;
 class CallResponse;
 class CallResponseDefaultTypeInternal;
 extern CallResponseDefaultTypeInternal _CallResponse_default_instance_;
@@ -495,6 +507,92 @@ class Array : public ::google::protobuf::Message /* @@protoc_insertion_point(cla
   const ::google::protobuf::RepeatedPtrField< ::std::string>& colnames() const;
   ::google::protobuf::RepeatedPtrField< ::std::string>* mutable_colnames();
 
+  // repeated double reals = 8;
+  int reals_size() const;
+  void clear_reals();
+  static const int kRealsFieldNumber = 8;
+  double reals(int index) const;
+  void set_reals(int index, double value);
+  void add_reals(double value);
+  const ::google::protobuf::RepeatedField< double >&
+      reals() const;
+  ::google::protobuf::RepeatedField< double >*
+      mutable_reals();
+
+  // repeated int32 integers = 9;
+  int integers_size() const;
+  void clear_integers();
+  static const int kIntegersFieldNumber = 9;
+  ::google::protobuf::int32 integers(int index) const;
+  void set_integers(int index, ::google::protobuf::int32 value);
+  void add_integers(::google::protobuf::int32 value);
+  const ::google::protobuf::RepeatedField< ::google::protobuf::int32 >&
+      integers() const;
+  ::google::protobuf::RepeatedField< ::google::protobuf::int32 >*
+      mutable_integers();
+
+  // repeated string dictionary = 10;
+  int dictionary_size() const;
+  void clear_dictionary();
+  static const int kDictionaryFieldNumber = 10;
+  const ::std::string& dictionary(int index) const;
+  ::std::string* mutable_dictionary(int index);
+  void set_dictionary(int index, const ::std::string& value);
+  #if LANG_CXX11
+  void set_dictionary(int index, ::std::string&& value);
+  #endif
+  void set_dictionary(int index, const char* value);
+  void set_dictionary(int index, const char* value, size_t size);
+  ::std::string* add_dictionary();
+  void add_dictionary(const ::std::string& value);
+  #if LANG_CXX11
+  void add_dictionary(::std::string&& value);
+  #endif
+  void add_dictionary(const char* value);
+  void add_dictionary(const char* value, size_t size);
+  const ::google::protobuf::RepeatedPtrField< ::std::string>& dictionary() const;
+  ::google::protobuf::RepeatedPtrField< ::std::string>* mutable_dictionary();
+
+  // repeated .BERTBuffers.Array columns = 15;
+  int columns_size() const;
+  void clear_columns();
+  static const int kColumnsFieldNumber = 15;
+  const ::BERTBuffers::Array& columns(int index) const;
+  ::BERTBuffers::Array* mutable_columns(int index);
+  ::BERTBuffers::Array* add_columns();
+  ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Array >*
+      mutable_columns();
+  const ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Array >&
+      columns() const;
+
+  // bytes logicals = 11;
+  void clear_logicals();
+  static const int kLogicalsFieldNumber = 11;
+  const ::std::string& logicals() const;
+  void set_logicals(const ::std::string& value);
+  #if LANG_CXX11
+  void set_logicals(::std::string&& value);
+  #endif
+  void set_logicals(const char* value);
+  void set_logicals(const void* value, size_t size);
+  ::std::string* mutable_logicals();
+  ::std::string* release_logicals();
+  void set_allocated_logicals(::std::string* logicals);
+
+  // bytes na = 12;
+  void clear_na();
+  static const int kNaFieldNumber = 12;
+  const ::std::string& na() const;
+  void set_na(const ::std::string& value);
+  #if LANG_CXX11
+  void set_na(::std::string&& value);
+  #endif
+  void set_na(const char* value);
+  void set_na(const void* value, size_t size);
+  ::std::string* mutable_na();
+  ::std::string* release_na();
+  void set_allocated_na(::std::string* na);
+
   // int32 rows = 1;
   void clear_rows();
   static const int kRowsFieldNumber = 1;
@@ -507,6 +605,33 @@ class Array : public ::google::protobuf::Message /* @@protoc_insertion_point(cla
   ::google::protobuf::int32 cols() const;
   void set_cols(::google::protobuf::int32 value);
 
+  // uint32 packed_type = 6;
+  void clear_packed_type();
+  static const int kPackedTypeFieldNumber = 6;
+  ::google::protobuf::uint32 packed_type() const;
+  void set_packed_type(::google::protobuf::uint32 value);
+
+  // int32 packed_length = 7;
+  void clear_packed_length();
+  static const int kPackedLengthFieldNumber = 7;
+  ::google::protobuf::int32 packed_length() const;
+  void set_packed_length(::google::protobuf::int32 value);
+
+  // bool streamed = 13;
+  void clear_streamed();
+  static const int kStreamedFieldNumber = 13;
+  bool streamed() const;
+  void set_streamed(bool value);
+
+  // .BERTBuffers.ArraySummary summary = 14;
+  bool has_summary() const;
+  void clear_summary();
+  static const int kSummaryFieldNumber = 14;
+  const ::BERTBuffers::ArraySummary& summary() const;
+  ::BERTBuffers::ArraySummary* release_summary();
+  ::BERTBuffers::ArraySummary* mutable_summary();
+  void set_allocated_summary(::BERTBuffers::ArraySummary* summary);
+
   // @@protoc_insertion_point(class_scope:BERTBuffers.Array)
  private:
 
@@ -514,8 +639,20 @@ class Array : public ::google::protobuf::Message /* @@protoc_insertion_point(cla
   ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Variable > data_;
   ::google::protobuf::RepeatedPtrField< ::std::string> rownames_;
   ::google::protobuf::RepeatedPtrField< ::std::string> colnames_;
+  ::google::protobuf::RepeatedField< double > reals_;
+  mutable int _reals_cached_byte_size_;
+  ::google::protobuf::RepeatedField< ::google::protobuf::int32 > integers_;
+  mutable int _integers_cached_byte_size_;
+  ::google::protobuf::RepeatedPtrField< ::std::string> dictionary_;
+  ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Array > columns_;
+  ::google::protobuf::internal::ArenaStringPtr logicals_;
+  ::google::protobuf::internal::ArenaStringPtr na_;
+  ::BERTBuffers::ArraySummary* summary_;
   ::google::protobuf::int32 rows_;
   ::google::protobuf::int32 cols_;
+  ::google::protobuf::uint32 packed_type_;
+  ::google::protobuf::int32 packed_length_;
+  bool streamed_;
   mutable int _cached_size_;
   friend struct ::protobuf_variable_2eproto::TableStruct;
   friend void ::protobuf_variable_2eproto::InitDefaultsArrayImpl();
@@ -3136,6 +3273,7 @@ class CallResponse : public ::google::protobuf::Message /* @@protoc_insertion_po
     kShellCommand = 7,
     kFunctionCall = 8,
     kFunctionList = 9,
+    kCallBatch = 10,
     OPERATION_NOT_SET = 0,
   };
 
@@ -3283,6 +3421,15 @@ class CallResponse : public ::google::protobuf::Message /* @@protoc_insertion_po
   ::BERTBuffers::FunctionList* mutable_function_list();
   void set_allocated_function_list(::BERTBuffers::FunctionList* function_list);
 
+  // .BERTBuffers.CallBatch call_batch = 10;
+  bool has_call_batch() const;
+  void clear_call_batch();
+  static const int kCallBatchFieldNumber = 10;
+  const ::BERTBuffers::CallBatch& call_batch() const;
+  ::BERTBuffers::CallBatch* release_call_batch();
+  ::BERTBuffers::CallBatch* mutable_call_batch();
+  void set_allocated_call_batch(::BERTBuffers::CallBatch* call_batch);
+
   OperationCase operation_case() const;
   // @@protoc_insertion_point(class_scope:BERTBuffers.CallResponse)
  private:
@@ -3293,6 +3440,7 @@ class CallResponse : public ::google::protobuf::Message /* @@protoc_insertion_po
   void set_has_shell_command();
   void set_has_function_call();
   void set_has_function_list();
+  void set_has_call_batch();
 
   inline bool has_operation() const;
   void clear_operation();
@@ -3310,6 +3458,7 @@ class CallResponse : public ::google::protobuf::Message /* @@protoc_insertion_po
     ::google::protobuf::internal::ArenaStringPtr shell_command_;
     ::BERTBuffers::CompositeFunctionCall* function_call_;
     ::BERTBuffers::FunctionList* function_list_;
+    ::BERTBuffers::CallBatch* call_batch_;
   } operation_;
   mutable int _cached_size_;
   ::google::protobuf::uint32 _oneof_case_[1];
@@ -3317,6 +3466,251 @@ class CallResponse : public ::google::protobuf::Message /* @@protoc_insertion_po
   friend struct ::protobuf_variable_2eproto::TableStruct;
   friend void ::protobuf_variable_2eproto::InitDefaultsCallResponseImpl();
 };
+// -------------------------------------------------------------------
+
+class CallBatch : public ::google::protobuf::Message /* @@protoc_insertion_point(class_definition:BERTBuffers.CallBatch) */ {
+ public:
+  CallBatch();
+  virtual ~CallBatch();
+
+  CallBatch(const CallBatch& from);
+
+  inline CallBatch& operator=(const CallBatch& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  #if LANG_CXX11
+  CallBatch(CallBatch&& from) noexcept
+    : CallBatch() {
+    *this = ::std::move(from);
+  }
+
+  inline CallBatch& operator=(CallBatch&& from) noexcept {
+    if (GetArenaNoVirtual() == from.GetArenaNoVirtual()) {
+      if (this != &from) InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+  #endif
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const CallBatch& default_instance();
+
+  static void InitAsDefaultInstance();  // FOR INTERNAL USE ONLY
+  static inline const CallBatch* internal_default_instance() {
+    return reinterpret_cast<const CallBatch*>(
+               &_CallBatch_default_instance_);
+  }
+  static PROTOBUF_CONSTEXPR int const kIndexInFileMessages =
+    20;
+
+  void Swap(CallBatch* other);
+  friend void swap(CallBatch& a, CallBatch& b) {
+    a.Swap(&b);
+  }
+
+  // implements Message ----------------------------------------------
+
+  inline CallBatch* New() const PROTOBUF_FINAL { return New(NULL); }
+
+  CallBatch* New(::google::protobuf::Arena* arena) const PROTOBUF_FINAL;
+  void CopyFrom(const ::google::protobuf::Message& from) PROTOBUF_FINAL;
+  void MergeFrom(const ::google::protobuf::Message& from) PROTOBUF_FINAL;
+  void CopyFrom(const CallBatch& from);
+  void MergeFrom(const CallBatch& from);
+  void Clear() PROTOBUF_FINAL;
+  bool IsInitialized() const PROTOBUF_FINAL;
+
+  size_t ByteSizeLong() const PROTOBUF_FINAL;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input) PROTOBUF_FINAL;
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const PROTOBUF_FINAL;
+  ::google::protobuf::uint8* InternalSerializeWithCachedSizesToArray(
+      bool deterministic, ::google::protobuf::uint8* target) const PROTOBUF_FINAL;
+  int GetCachedSize() const PROTOBUF_FINAL { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const PROTOBUF_FINAL;
+  void InternalSwap(CallBatch* other);
+  private:
+  inline ::google::protobuf::Arena* GetArenaNoVirtual() const {
+    return NULL;
+  }
+  inline void* MaybeArenaPtr() const {
+    return NULL;
+  }
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const PROTOBUF_FINAL;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // repeated .BERTBuffers.CompositeFunctionCall calls = 1;
+  int calls_size() const;
+  void clear_calls();
+  static const int kCallsFieldNumber = 1;
+  const ::BERTBuffers::CompositeFunctionCall& calls(int index) const;
+  ::BERTBuffers::CompositeFunctionCall* mutable_calls(int index);
+  ::BERTBuffers::CompositeFunctionCall* add_calls();
+  ::google::protobuf::RepeatedPtrField< ::BERTBuffers::CompositeFunctionCall >*
+      mutable_calls();
+  const ::google::protobuf::RepeatedPtrField< ::BERTBuffers::CompositeFunctionCall >&
+      calls() const;
+
+  // repeated .BERTBuffers.Variable results = 2;
+  int results_size() const;
+  void clear_results();
+  static const int kResultsFieldNumber = 2;
+  const ::BERTBuffers::Variable& results(int index) const;
+  ::BERTBuffers::Variable* mutable_results(int index);
+  ::BERTBuffers::Variable* add_results();
+  ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Variable >*
+      mutable_results();
+  const ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Variable >&
+      results() const;
+
+  // @@protoc_insertion_point(class_scope:BERTBuffers.CallBatch)
+ private:
+
+  ::google::protobuf::internal::InternalMetadataWithArena _internal_metadata_;
+  ::google::protobuf::RepeatedPtrField< ::BERTBuffers::CompositeFunctionCall > calls_;
+  ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Variable > results_;
+  mutable int _cached_size_;
+  friend struct ::protobuf_variable_2eproto::TableStruct;
+  friend void ::protobuf_variable_2eproto::InitDefaultsCallBatchImpl();
+};
+// -------------------------------------------------------------------
+
+class ArraySummary : public ::google::protobuf::Message /* @@protoc_insertion_point(class_definition:BERTBuffers.ArraySummary) */ {
+ public:
+  ArraySummary();
+  virtual ~ArraySummary();
+
+  ArraySummary(const ArraySummary& from);
+
+  inline ArraySummary& operator=(const ArraySummary& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  #if LANG_CXX11
+  ArraySummary(ArraySummary&& from) noexcept
+    : ArraySummary() {
+    *this = ::std::move(from);
+  }
+
+  inline ArraySummary& operator=(ArraySummary&& from) noexcept {
+    if (GetArenaNoVirtual() == from.GetArenaNoVirtual()) {
+      if (this != &from) InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+  #endif
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const ArraySummary& default_instance();
+
+  static void InitAsDefaultInstance();  // FOR INTERNAL USE ONLY
+  static inline const ArraySummary* internal_default_instance() {
+    return reinterpret_cast<const ArraySummary*>(
+               &_ArraySummary_default_instance_);
+  }
+  static PROTOBUF_CONSTEXPR int const kIndexInFileMessages =
+    21;
+
+  void Swap(ArraySummary* other);
+  friend void swap(ArraySummary& a, ArraySummary& b) {
+    a.Swap(&b);
+  }
+
+  // implements Message ----------------------------------------------
+
+  inline ArraySummary* New() const PROTOBUF_FINAL { return New(NULL); }
+
+  ArraySummary* New(::google::protobuf::Arena* arena) const PROTOBUF_FINAL;
+  void CopyFrom(const ::google::protobuf::Message& from) PROTOBUF_FINAL;
+  void MergeFrom(const ::google::protobuf::Message& from) PROTOBUF_FINAL;
+  void CopyFrom(const ArraySummary& from);
+  void MergeFrom(const ArraySummary& from);
+  void Clear() PROTOBUF_FINAL;
+  bool IsInitialized() const PROTOBUF_FINAL;
+
+  size_t ByteSizeLong() const PROTOBUF_FINAL;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input) PROTOBUF_FINAL;
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const PROTOBUF_FINAL;
+  ::google::protobuf::uint8* InternalSerializeWithCachedSizesToArray(
+      bool deterministic, ::google::protobuf::uint8* target) const PROTOBUF_FINAL;
+  int GetCachedSize() const PROTOBUF_FINAL { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const PROTOBUF_FINAL;
+  void InternalSwap(ArraySummary* other);
+  private:
+  inline ::google::protobuf::Arena* GetArenaNoVirtual() const {
+    return NULL;
+  }
+  inline void* MaybeArenaPtr() const {
+    return NULL;
+  }
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const PROTOBUF_FINAL;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // uint32 type = 1;
+  void clear_type();
+  static const int kTypeFieldNumber = 1;
+  ::google::protobuf::uint32 type() const;
+  void set_type(::google::protobuf::uint32 value);
+
+  // bool has_na = 2;
+  void clear_has_na();
+  static const int kHasNaFieldNumber = 2;
+  bool has_na() const;
+  void set_has_na(bool value);
+
+  // bool has_names = 3;
+  void clear_has_names();
+  static const int kHasNamesFieldNumber = 3;
+  bool has_names() const;
+  void set_has_names(bool value);
+
+  // int32 min_string_length = 4;
+  void clear_min_string_length();
+  static const int kMinStringLengthFieldNumber = 4;
+  ::google::protobuf::int32 min_string_length() const;
+  void set_min_string_length(::google::protobuf::int32 value);
+
+  // int32 max_string_length = 5;
+  void clear_max_string_length();
+  static const int kMaxStringLengthFieldNumber = 5;
+  ::google::protobuf::int32 max_string_length() const;
+  void set_max_string_length(::google::protobuf::int32 value);
+
+  // @@protoc_insertion_point(class_scope:BERTBuffers.ArraySummary)
+ private:
+
+  ::google::protobuf::internal::InternalMetadataWithArena _internal_metadata_;
+  ::google::protobuf::uint32 type_;
+  bool has_na_;
+  bool has_names_;
+  ::google::protobuf::int32 min_string_length_;
+  ::google::protobuf::int32 max_string_length_;
+  mutable int _cached_size_;
+  friend struct ::protobuf_variable_2eproto::TableStruct;
+  friend void ::protobuf_variable_2eproto::InitDefaultsArraySummaryImpl();
+};
 // ===================================================================
 
 
@@ -3556,6 +3950,363 @@ Array::mutable_colnames() {
   return &colnames_;
 }
 
+// uint32 packed_type = 6;
+inline void Array::clear_packed_type() {
+  packed_type_ = 0u;
+}
+inline ::google::protobuf::uint32 Array::packed_type() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.packed_type)
+  return packed_type_;
+}
+inline void Array::set_packed_type(::google::protobuf::uint32 value) {
+  
+  packed_type_ = value;
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.packed_type)
+}
+
+// int32 packed_length = 7;
+inline void Array::clear_packed_length() {
+  packed_length_ = 0;
+}
+inline ::google::protobuf::int32 Array::packed_length() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.packed_length)
+  return packed_length_;
+}
+inline void Array::set_packed_length(::google::protobuf::int32 value) {
+  
+  packed_length_ = value;
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.packed_length)
+}
+
+// repeated double reals = 8;
+inline int Array::reals_size() const {
+  return reals_.size();
+}
+inline void Array::clear_reals() {
+  reals_.Clear();
+}
+inline double Array::reals(int index) const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.reals)
+  return reals_.Get(index);
+}
+inline void Array::set_reals(int index, double value) {
+  reals_.Set(index, value);
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.reals)
+}
+inline void Array::add_reals(double value) {
+  reals_.Add(value);
+  // @@protoc_insertion_point(field_add:BERTBuffers.Array.reals)
+}
+inline const ::google::protobuf::RepeatedField< double >&
+Array::reals() const {
+  // @@protoc_insertion_point(field_list:BERTBuffers.Array.reals)
+  return reals_;
+}
+inline ::google::protobuf::RepeatedField< double >*
+Array::mutable_reals() {
+  // @@protoc_insertion_point(field_mutable_list:BERTBuffers.Array.reals)
+  return &reals_;
+}
+
+// repeated int32 integers = 9;
+inline int Array::integers_size() const {
+  return integers_.size();
+}
+inline void Array::clear_integers() {
+  integers_.Clear();
+}
+inline ::google::protobuf::int32 Array::integers(int index) const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.integers)
+  return integers_.Get(index);
+}
+inline void Array::set_integers(int index, ::google::protobuf::int32 value) {
+  integers_.Set(index, value);
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.integers)
+}
+inline void Array::add_integers(::google::protobuf::int32 value) {
+  integers_.Add(value);
+  // @@protoc_insertion_point(field_add:BERTBuffers.Array.integers)
+}
+inline const ::google::protobuf::RepeatedField< ::google::protobuf::int32 >&
+Array::integers() const {
+  // @@protoc_insertion_point(field_list:BERTBuffers.Array.integers)
+  return integers_;
+}
+inline ::google::protobuf::RepeatedField< ::google::protobuf::int32 >*
+Array::mutable_integers() {
+  // @@protoc_insertion_point(field_mutable_list:BERTBuffers.Array.integers)
+  return &integers_;
+}
+
+// repeated string dictionary = 10;
+inline int Array::dictionary_size() const {
+  return dictionary_.size();
+}
+inline void Array::clear_dictionary() {
+  dictionary_.Clear();
+}
+inline const ::std::string& Array::dictionary(int index) const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.dictionary)
+  return dictionary_.Get(index);
+}
+inline ::std::string* Array::mutable_dictionary(int index) {
+  // @@protoc_insertion_point(field_mutable:BERTBuffers.Array.dictionary)
+  return dictionary_.Mutable(index);
+}
+inline void Array::set_dictionary(int index, const ::std::string& value) {
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.dictionary)
+  dictionary_.Mutable(index)->assign(value);
+}
+#if LANG_CXX11
+inline void Array::set_dictionary(int index, ::std::string&& value) {
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.dictionary)
+  dictionary_.Mutable(index)->assign(std::move(value));
+}
+#endif
+inline void Array::set_dictionary(int index, const char* value) {
+  GOOGLE_DCHECK(value != NULL);
+  dictionary_.Mutable(index)->assign(value);
+  // @@protoc_insertion_point(field_set_char:BERTBuffers.Array.dictionary)
+}
+inline void Array::set_dictionary(int index, const char* value, size_t size) {
+  dictionary_.Mutable(index)->assign(
+    reinterpret_cast<const char*>(value), size);
+  // @@protoc_insertion_point(field_set_pointer:BERTBuffers.Array.dictionary)
+}
+inline ::std::string* Array::add_dictionary() {
+  // @@protoc_insertion_point(field_add_mutable:BERTBuffers.Array.dictionary)
+  return dictionary_.Add();
+}
+inline void Array::add_dictionary(const ::std::string& value) {
+  dictionary_.Add()->assign(value);
+  // @@protoc_insertion_point(field_add:BERTBuffers.Array.dictionary)
+}
+#if LANG_CXX11
+inline void Array::add_dictionary(::std::string&& value) {
+  dictionary_.Add(std::move(value));
+  // @@protoc_insertion_point(field_add:BERTBuffers.Array.dictionary)
+}
+#endif
+inline void Array::add_dictionary(const char* value) {
+  GOOGLE_DCHECK(value != NULL);
+  dictionary_.Add()->assign(value);
+  // @@protoc_insertion_point(field_add_char:BERTBuffers.Array.dictionary)
+}
+inline void Array::add_dictionary(const char* value, size_t size) {
+  dictionary_.Add()->assign(reinterpret_cast<const char*>(value), size);
+  // @@protoc_insertion_point(field_add_pointer:BERTBuffers.Array.dictionary)
+}
+inline const ::google::protobuf::RepeatedPtrField< ::std::string>&
+Array::dictionary() const {
+  // @@protoc_insertion_point(field_list:BERTBuffers.Array.dictionary)
+  return dictionary_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::std::string>*
+Array::mutable_dictionary() {
+  // @@protoc_insertion_point(field_mutable_list:BERTBuffers.Array.dictionary)
+  return &dictionary_;
+}
+
+// repeated .BERTBuffers.Array columns = 15;
+inline int Array::columns_size() const {
+  return columns_.size();
+}
+inline void Array::clear_columns() {
+  columns_.Clear();
+}
+inline const ::BERTBuffers::Array& Array::columns(int index) const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.columns)
+  return columns_.Get(index);
+}
+inline ::BERTBuffers::Array* Array::mutable_columns(int index) {
+  // @@protoc_insertion_point(field_mutable:BERTBuffers.Array.columns)
+  return columns_.Mutable(index);
+}
+inline ::BERTBuffers::Array* Array::add_columns() {
+  // @@protoc_insertion_point(field_add:BERTBuffers.Array.columns)
+  return columns_.Add();
+}
+inline ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Array >*
+Array::mutable_columns() {
+  // @@protoc_insertion_point(field_mutable_list:BERTBuffers.Array.columns)
+  return &columns_;
+}
+inline const ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Array >&
+Array::columns() const {
+  // @@protoc_insertion_point(field_list:BERTBuffers.Array.columns)
+  return columns_;
+}
+
+// bytes logicals = 11;
+inline void Array::clear_logicals() {
+  logicals_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline const ::std::string& Array::logicals() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.logicals)
+  return logicals_.GetNoArena();
+}
+inline void Array::set_logicals(const ::std::string& value) {
+  
+  logicals_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), value);
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.logicals)
+}
+#if LANG_CXX11
+inline void Array::set_logicals(::std::string&& value) {
+  
+  logicals_.SetNoArena(
+    &::google::protobuf::internal::GetEmptyStringAlreadyInited(), ::std::move(value));
+  // @@protoc_insertion_point(field_set_rvalue:BERTBuffers.Array.logicals)
+}
+#endif
+inline void Array::set_logicals(const char* value) {
+  GOOGLE_DCHECK(value != NULL);
+  
+  logicals_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), ::std::string(value));
+  // @@protoc_insertion_point(field_set_char:BERTBuffers.Array.logicals)
+}
+inline void Array::set_logicals(const void* value, size_t size) {
+  
+  logicals_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(),
+      ::std::string(reinterpret_cast<const char*>(value), size));
+  // @@protoc_insertion_point(field_set_pointer:BERTBuffers.Array.logicals)
+}
+inline ::std::string* Array::mutable_logicals() {
+  
+  // @@protoc_insertion_point(field_mutable:BERTBuffers.Array.logicals)
+  return logicals_.MutableNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline ::std::string* Array::release_logicals() {
+  // @@protoc_insertion_point(field_release:BERTBuffers.Array.logicals)
+  
+  return logicals_.ReleaseNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline void Array::set_allocated_logicals(::std::string* logicals) {
+  if (logicals != NULL) {
+    
+  } else {
+    
+  }
+  logicals_.SetAllocatedNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), logicals);
+  // @@protoc_insertion_point(field_set_allocated:BERTBuffers.Array.logicals)
+}
+
+// bytes na = 12;
+inline void Array::clear_na() {
+  na_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline const ::std::string& Array::na() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.na)
+  return na_.GetNoArena();
+}
+inline void Array::set_na(const ::std::string& value) {
+  
+  na_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), value);
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.na)
+}
+#if LANG_CXX11
+inline void Array::set_na(::std::string&& value) {
+  
+  na_.SetNoArena(
+    &::google::protobuf::internal::GetEmptyStringAlreadyInited(), ::std::move(value));
+  // @@protoc_insertion_point(field_set_rvalue:BERTBuffers.Array.na)
+}
+#endif
+inline void Array::set_na(const char* value) {
+  GOOGLE_DCHECK(value != NULL);
+  
+  na_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), ::std::string(value));
+  // @@protoc_insertion_point(field_set_char:BERTBuffers.Array.na)
+}
+inline void Array::set_na(const void* value, size_t size) {
+  
+  na_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(),
+      ::std::string(reinterpret_cast<const char*>(value), size));
+  // @@protoc_insertion_point(field_set_pointer:BERTBuffers.Array.na)
+}
+inline ::std::string* Array::mutable_na() {
+  
+  // @@protoc_insertion_point(field_mutable:BERTBuffers.Array.na)
+  return na_.MutableNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline ::std::string* Array::release_na() {
+  // @@protoc_insertion_point(field_release:BERTBuffers.Array.na)
+  
+  return na_.ReleaseNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline void Array::set_allocated_na(::std::string* na) {
+  if (na != NULL) {
+    
+  } else {
+    
+  }
+  na_.SetAllocatedNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), na);
+  // @@protoc_insertion_point(field_set_allocated:BERTBuffers.Array.na)
+}
+
+// bool streamed = 13;
+inline void Array::clear_streamed() {
+  streamed_ = false;
+}
+inline bool Array::streamed() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.streamed)
+  return streamed_;
+}
+inline void Array::set_streamed(bool value) {
+  
+  streamed_ = value;
+  // @@protoc_insertion_point(field_set:BERTBuffers.Array.streamed)
+}
+
+// .BERTBuffers.ArraySummary summary = 14;
+inline bool Array::has_summary() const {
+  return this != internal_default_instance() && summary_ != NULL;
+}
+inline void Array::clear_summary() {
+  if (GetArenaNoVirtual() == NULL && summary_ != NULL) {
+    delete summary_;
+  }
+  summary_ = NULL;
+}
+inline const ::BERTBuffers::ArraySummary& Array::summary() const {
+  const ::BERTBuffers::ArraySummary* p = summary_;
+  // @@protoc_insertion_point(field_get:BERTBuffers.Array.summary)
+  return p != NULL ? *p : *reinterpret_cast<const ::BERTBuffers::ArraySummary*>(
+      &::BERTBuffers::_ArraySummary_default_instance_);
+}
+inline ::BERTBuffers::ArraySummary* Array::release_summary() {
+  // @@protoc_insertion_point(field_release:BERTBuffers.Array.summary)
+  
+  ::BERTBuffers::ArraySummary* temp = summary_;
+  summary_ = NULL;
+  return temp;
+}
+inline ::BERTBuffers::ArraySummary* Array::mutable_summary() {
+  
+  if (summary_ == NULL) {
+    summary_ = new ::BERTBuffers::ArraySummary;
+  }
+  // @@protoc_insertion_point(field_mutable:BERTBuffers.Array.summary)
+  return summary_;
+}
+inline void Array::set_allocated_summary(::BERTBuffers::ArraySummary* summary) {
+  ::google::protobuf::Arena* message_arena = GetArenaNoVirtual();
+  if (message_arena == NULL) {
+    delete summary_;
+  }
+  if (summary) {
+    ::google::protobuf::Arena* submessage_arena = NULL;
+    if (message_arena != submessage_arena) {
+      summary = ::google::protobuf::internal::GetOwnedMessage(
+          message_arena, summary, submessage_arena);
+    }
+    
+  } else {
+    
+  }
+  summary_ = summary;
+  // @@protoc_insertion_point(field_set_allocated:BERTBuffers.Array.summary)
+}
+
 // -------------------------------------------------------------------
 
 // Error
@@ -7061,6 +7812,46 @@ inline ::BERTBuffers::FunctionList* CallResponse::mutable_function_list() {
   return operation_.function_list_;
 }
 
+// .BERTBuffers.CallBatch call_batch = 10;
+inline bool CallResponse::has_call_batch() const {
+  return operation_case() == kCallBatch;
+}
+inline void CallResponse::set_has_call_batch() {
+  _oneof_case_[0] = kCallBatch;
+}
+inline void CallResponse::clear_call_batch() {
+  if (has_call_batch()) {
+    delete operation_.call_batch_;
+    clear_has_operation();
+  }
+}
+inline ::BERTBuffers::CallBatch* CallResponse::release_call_batch() {
+  // @@protoc_insertion_point(field_release:BERTBuffers.CallResponse.call_batch)
+  if (has_call_batch()) {
+    clear_has_operation();
+      ::BERTBuffers::CallBatch* temp = operation_.call_batch_;
+    operation_.call_batch_ = NULL;
+    return temp;
+  } else {
+    return NULL;
+  }
+}
+inline const ::BERTBuffers::CallBatch& CallResponse::call_batch() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.CallResponse.call_batch)
+  return has_call_batch()
+      ? *operation_.call_batch_
+      : *reinterpret_cast< ::BERTBuffers::CallBatch*>(&::BERTBuffers::_CallBatch_default_instance_);
+}
+inline ::BERTBuffers::CallBatch* CallResponse::mutable_call_batch() {
+  if (!has_call_batch()) {
+    clear_operation();
+    set_has_call_batch();
+    operation_.call_batch_ = new ::BERTBuffers::CallBatch;
+  }
+  // @@protoc_insertion_point(field_mutable:BERTBuffers.CallResponse.call_batch)
+  return operation_.call_batch_;
+}
+
 inline bool CallResponse::has_operation() const {
   return operation_case() != OPERATION_NOT_SET;
 }
@@ -7070,6 +7861,144 @@ inline void CallResponse::clear_has_operation() {
 inline CallResponse::OperationCase CallResponse::operation_case() const {
   return CallResponse::OperationCase(_oneof_case_[0]);
 }
+// -------------------------------------------------------------------
+
+// CallBatch
+
+// repeated .BERTBuffers.CompositeFunctionCall calls = 1;
+inline int CallBatch::calls_size() const {
+  return calls_.size();
+}
+inline void CallBatch::clear_calls() {
+  calls_.Clear();
+}
+inline const ::BERTBuffers::CompositeFunctionCall& CallBatch::calls(int index) const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.CallBatch.calls)
+  return calls_.Get(index);
+}
+inline ::BERTBuffers::CompositeFunctionCall* CallBatch::mutable_calls(int index) {
+  // @@protoc_insertion_point(field_mutable:BERTBuffers.CallBatch.calls)
+  return calls_.Mutable(index);
+}
+inline ::BERTBuffers::CompositeFunctionCall* CallBatch::add_calls() {
+  // @@protoc_insertion_point(field_add:BERTBuffers.CallBatch.calls)
+  return calls_.Add();
+}
+inline ::google::protobuf::RepeatedPtrField< ::BERTBuffers::CompositeFunctionCall >*
+CallBatch::mutable_calls() {
+  // @@protoc_insertion_point(field_mutable_list:BERTBuffers.CallBatch.calls)
+  return &calls_;
+}
+inline const ::google::protobuf::RepeatedPtrField< ::BERTBuffers::CompositeFunctionCall >&
+CallBatch::calls() const {
+  // @@protoc_insertion_point(field_list:BERTBuffers.CallBatch.calls)
+  return calls_;
+}
+
+// repeated .BERTBuffers.Variable results = 2;
+inline int CallBatch::results_size() const {
+  return results_.size();
+}
+inline void CallBatch::clear_results() {
+  results_.Clear();
+}
+inline const ::BERTBuffers::Variable& CallBatch::results(int index) const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.CallBatch.results)
+  return results_.Get(index);
+}
+inline ::BERTBuffers::Variable* CallBatch::mutable_results(int index) {
+  // @@protoc_insertion_point(field_mutable:BERTBuffers.CallBatch.results)
+  return results_.Mutable(index);
+}
+inline ::BERTBuffers::Variable* CallBatch::add_results() {
+  // @@protoc_insertion_point(field_add:BERTBuffers.CallBatch.results)
+  return results_.Add();
+}
+inline ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Variable >*
+CallBatch::mutable_results() {
+  // @@protoc_insertion_point(field_mutable_list:BERTBuffers.CallBatch.results)
+  return &results_;
+}
+inline const ::google::protobuf::RepeatedPtrField< ::BERTBuffers::Variable >&
+CallBatch::results() const {
+  // @@protoc_insertion_point(field_list:BERTBuffers.CallBatch.results)
+  return results_;
+}
+
+// -------------------------------------------------------------------
+
+// ArraySummary
+
+// uint32 type = 1;
+inline void ArraySummary::clear_type() {
+  type_ = 0u;
+}
+inline ::google::protobuf::uint32 ArraySummary::type() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.ArraySummary.type)
+  return type_;
+}
+inline void ArraySummary::set_type(::google::protobuf::uint32 value) {
+  
+  type_ = value;
+  // @@protoc_insertion_point(field_set:BERTBuffers.ArraySummary.type)
+}
+
+// bool has_na = 2;
+inline void ArraySummary::clear_has_na() {
+  has_na_ = false;
+}
+inline bool ArraySummary::has_na() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.ArraySummary.has_na)
+  return has_na_;
+}
+inline void ArraySummary::set_has_na(bool value) {
+  
+  has_na_ = value;
+  // @@protoc_insertion_point(field_set:BERTBuffers.ArraySummary.has_na)
+}
+
+// bool has_names = 3;
+inline void ArraySummary::clear_has_names() {
+  has_names_ = false;
+}
+inline bool ArraySummary::has_names() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.ArraySummary.has_names)
+  return has_names_;
+}
+inline void ArraySummary::set_has_names(bool value) {
+  
+  has_names_ = value;
+  // @@protoc_insertion_point(field_set:BERTBuffers.ArraySummary.has_names)
+}
+
+// int32 min_string_length = 4;
+inline void ArraySummary::clear_min_string_length() {
+  min_string_length_ = 0;
+}
+inline ::google::protobuf::int32 ArraySummary::min_string_length() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.ArraySummary.min_string_length)
+  return min_string_length_;
+}
+inline void ArraySummary::set_min_string_length(::google::protobuf::int32 value) {
+  
+  min_string_length_ = value;
+  // @@protoc_insertion_point(field_set:BERTBuffers.ArraySummary.min_string_length)
+}
+
+// int32 max_string_length = 5;
+inline void ArraySummary::clear_max_string_length() {
+  max_string_length_ = 0;
+}
+inline ::google::protobuf::int32 ArraySummary::max_string_length() const {
+  // @@protoc_insertion_point(field_get:BERTBuffers.ArraySummary.max_string_length)
+  return max_string_length_;
+}
+inline void ArraySummary::set_max_string_length(::google::protobuf::int32 value) {
+  
+  max_string_length_ = value;
+  // @@protoc_insertion_point(field_set:BERTBuffers.ArraySummary.max_string_length)
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
@@ -7111,6 +8040,10 @@ inline CallResponse::OperationCase CallResponse::operation_case() const {
 
 // -------------------------------------------------------------------
 
+// -------------------------------------------------------------------
+
+// -------------------------------------------------------------------
+
 
 // @@protoc_insertion_point(namespace_scope)
 